@@ -402,6 +402,98 @@ static void test_case_multithread_malloc_free()
 }
 
 
+/** Test binary tracing
+ *
+ *  Given a memory trace mechanism using the binary callback
+ *  When perform all memory operations
+ *  Then the records read back from the ring buffer match the operations
+ *
+ */
+static void test_case_binary_trace()
+{
+    const size_t malloc_size = 40, realloc_size = 80, nmemb = 25, size = 10;
+    mbed_mem_trace_record_t records[6];
+
+    // Discard records left over by other tests
+    while (mbed_mem_trace_binary_read(records, 6));
+    const uint32_t dropped = mbed_mem_trace_binary_dropped();
+
+    mbed_mem_trace_set_callback(mbed_mem_trace_binary_callback);
+
+    void *p_malloc = malloc(malloc_size);
+    TEST_ASSERT_NOT_EQUAL(p_malloc, NULL);
+    void *p_realloc = realloc(p_malloc, realloc_size);
+    TEST_ASSERT_NOT_EQUAL(p_realloc, NULL);
+    void *p_calloc = calloc(nmemb, size);
+    TEST_ASSERT_NOT_EQUAL(p_calloc, NULL);
+    free(p_realloc);
+    free(p_calloc);
+
+    // Stop tracing
+    mbed_mem_trace_set_callback(NULL);
+
+    TEST_ASSERT_EQUAL_UINT32(5, mbed_mem_trace_binary_read(records, 6));
+    TEST_ASSERT_EQUAL_UINT32(dropped, mbed_mem_trace_binary_dropped());
+
+    TEST_ASSERT_EQUAL_UINT8(MBED_MEM_TRACE_MALLOC, records[0].op);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)p_malloc, records[0].res);
+    TEST_ASSERT_EQUAL_UINT32(malloc_size, records[0].size);
+
+    TEST_ASSERT_EQUAL_UINT8(MBED_MEM_TRACE_REALLOC, records[1].op);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)p_realloc, records[1].res);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)p_malloc, records[1].ptr);
+    TEST_ASSERT_EQUAL_UINT32(realloc_size, records[1].size);
+
+    TEST_ASSERT_EQUAL_UINT8(MBED_MEM_TRACE_CALLOC, records[2].op);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)p_calloc, records[2].res);
+    TEST_ASSERT_EQUAL_UINT32(nmemb * size, records[2].size);
+
+    TEST_ASSERT_EQUAL_UINT8(MBED_MEM_TRACE_FREE, records[3].op);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)p_realloc, records[3].ptr);
+    TEST_ASSERT_EQUAL_UINT8(MBED_MEM_TRACE_FREE, records[4].op);
+    TEST_ASSERT_EQUAL_UINT32((uint32_t)p_calloc, records[4].ptr);
+
+    for (int i = 1; i < 5; i++) {
+        TEST_ASSERT_EQUAL_UINT16((uint16_t)(records[0].sequence + i), records[i].sequence);
+        TEST_ASSERT_TRUE(records[i].timestamp - records[0].timestamp < 1000000);
+    }
+}
+
+
+/** Test binary trace overflow
+ *
+ *  Given a memory trace mechanism using the binary callback
+ *  When more operations are traced than the ring buffer can hold
+ *  Then the extra records are dropped and counted
+ *
+ */
+static void test_case_binary_trace_overflow()
+{
+    const uint32_t ring_size = MBED_CONF_PLATFORM_MEMORY_TRACE_BINARY_RECORDS;
+    const uint32_t extra = 3;
+    mbed_mem_trace_record_t record;
+
+    while (mbed_mem_trace_binary_read(&record, 1));
+    const uint32_t dropped = mbed_mem_trace_binary_dropped();
+
+    mbed_mem_trace_set_callback(mbed_mem_trace_binary_callback);
+    for (uint32_t i = 0; i < ring_size + extra; i++) {
+        // free(NULL) is traced without touching the heap
+        free(NULL);
+    }
+    mbed_mem_trace_set_callback(NULL);
+
+    TEST_ASSERT_EQUAL_UINT32(dropped + extra, mbed_mem_trace_binary_dropped());
+
+    uint32_t count = 0;
+    while (mbed_mem_trace_binary_read(&record, 1)) {
+        TEST_ASSERT_EQUAL_UINT8(MBED_MEM_TRACE_FREE, record.op);
+        count++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(ring_size, count);
+}
+
+
 
 static Case cases[] =
 {
@@ -410,7 +502,9 @@ static Case cases[] =
     Case("Test trace off", test_case_trace_off),
     Case("Test partial trace", test_case_partial_trace),
     Case("Test new/delete trace", test_case_new_delete),
-    Case("Test multithreaded trace", test_case_multithread_malloc_free)
+    Case("Test multithreaded trace", test_case_multithread_malloc_free),
+    Case("Test binary trace", test_case_binary_trace),
+    Case("Test binary trace overflow", test_case_binary_trace_overflow)
 };
 
 static utest::v1::status_t greentea_test_setup(const size_t number_of_cases)
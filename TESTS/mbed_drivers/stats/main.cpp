@@ -22,6 +22,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+// The mbed_app.json of this directory enables the heap statistics, including
+// the per thread and per caller ones:
+// mbed test -n tests-mbed_drivers-stats --app-config TESTS/mbed_drivers/stats/mbed_app.json
 #if !defined(MBED_HEAP_STATS_ENABLED)
   #error [NOT_SUPPORTED] test not supported
 #endif
@@ -181,11 +184,170 @@ void test_case_realloc_size()
     TEST_ASSERT_EQUAL_UINT32(stats_start.current_size, stats_current.current_size);
 }
 
+#if MBED_CONF_PLATFORM_HEAP_STATS_THREAD_SLOTS && MBED_CONF_RTOS_PRESENT
+static bool find_thread_stats(uint32_t thread_id, mbed_stats_heap_thread_t *stats)
+{
+    mbed_stats_heap_thread_t all[MBED_CONF_PLATFORM_HEAP_STATS_THREAD_SLOTS + 1];
+    size_t count = mbed_stats_heap_get_each_thread(all, MBED_CONF_PLATFORM_HEAP_STATS_THREAD_SLOTS + 1);
+    for (size_t i = 0; i < count; i++) {
+        if (all[i].thread_id == thread_id) {
+            *stats = all[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+typedef struct {
+    void *data;
+    uint32_t thread_id;
+    Semaphore allocated;
+    Semaphore done;
+} thread_alloc_t;
+
+static void thread_malloc(thread_alloc_t *alloc)
+{
+    alloc->thread_id = (uint32_t)Thread::gettid();
+    alloc->data = malloc(ALLOCATION_SIZE_SMALL);
+    alloc->allocated.release();
+    alloc->done.wait();
+}
+
+void test_case_thread_stats()
+{
+    mbed_stats_heap_thread_t stats_start;
+    mbed_stats_heap_thread_t stats_current;
+    mbed_stats_heap_thread_t retired_start;
+    mbed_stats_heap_thread_t retired_current;
+    thread_alloc_t alloc;
+    void *data;
+
+    alloc.data = NULL;
+    alloc.thread_id = 0;
+
+    // Allocation accounted to the allocating thread, even when another thread frees it
+    Thread thread;
+    thread.start(callback(thread_malloc, &alloc));
+    alloc.allocated.wait();
+    TEST_ASSERT(alloc.data != NULL);
+    TEST_ASSERT_TRUE(find_thread_stats(alloc.thread_id, &stats_start));
+    TEST_ASSERT_EQUAL_UINT32(ALLOCATION_SIZE_SMALL, stats_start.current_size);
+    TEST_ASSERT_EQUAL_UINT32(1, stats_start.alloc_cnt);
+
+    // A terminated thread releases its slot, what it still holds moves to entry 0
+    memset(&retired_start, 0, sizeof(retired_start));
+    find_thread_stats(0, &retired_start);
+    alloc.done.release();
+    thread.join();
+    TEST_ASSERT_FALSE(find_thread_stats(alloc.thread_id, &stats_current));
+    TEST_ASSERT_TRUE(find_thread_stats(0, &retired_current));
+    TEST_ASSERT_EQUAL_UINT32(retired_start.current_size + ALLOCATION_SIZE_SMALL, retired_current.current_size);
+    TEST_ASSERT_EQUAL_UINT32(retired_start.alloc_cnt + 1, retired_current.alloc_cnt);
+    free(alloc.data);
+    TEST_ASSERT_TRUE(find_thread_stats(0, &retired_current));
+    TEST_ASSERT_EQUAL_UINT32(retired_start.current_size, retired_current.current_size);
+    TEST_ASSERT_EQUAL_UINT32(retired_start.alloc_cnt, retired_current.alloc_cnt);
+
+    // Allocations of this thread
+    uint32_t thread_id = (uint32_t)Thread::gettid();
+    memset(&stats_start, 0, sizeof(stats_start));
+    find_thread_stats(thread_id, &stats_start);
+    data = malloc(ALLOCATION_SIZE_DEFAULT);
+    TEST_ASSERT(data != NULL);
+    TEST_ASSERT_TRUE(find_thread_stats(thread_id, &stats_current));
+    TEST_ASSERT_EQUAL_UINT32(stats_start.current_size + ALLOCATION_SIZE_DEFAULT, stats_current.current_size);
+    TEST_ASSERT_EQUAL_UINT32(stats_start.total_size + ALLOCATION_SIZE_DEFAULT, stats_current.total_size);
+    free(data);
+    TEST_ASSERT(malloc(ALLOCATION_SIZE_FAIL) == NULL);
+    TEST_ASSERT_TRUE(find_thread_stats(thread_id, &stats_current));
+    TEST_ASSERT_EQUAL_UINT32(stats_start.current_size, stats_current.current_size);
+    TEST_ASSERT_EQUAL_UINT32(stats_start.alloc_fail_cnt + 1, stats_current.alloc_fail_cnt);
+}
+
+void test_case_thread_slot_reuse()
+{
+    mbed_stats_heap_thread_t stats;
+
+    // More threads than slots one after the other, each one gets fresh statistics
+    for (int i = 0; i < 2 * MBED_CONF_PLATFORM_HEAP_STATS_THREAD_SLOTS; i++) {
+        thread_alloc_t alloc;
+        alloc.data = NULL;
+        alloc.thread_id = 0;
+
+        Thread thread;
+        thread.start(callback(thread_malloc, &alloc));
+        alloc.allocated.wait();
+        TEST_ASSERT_TRUE(find_thread_stats(alloc.thread_id, &stats));
+        TEST_ASSERT_EQUAL_UINT32(ALLOCATION_SIZE_SMALL, stats.current_size);
+        TEST_ASSERT_EQUAL_UINT32(ALLOCATION_SIZE_SMALL, stats.total_size);
+        free(alloc.data);
+        alloc.done.release();
+        thread.join();
+    }
+}
+#endif
+
+#if MBED_CONF_PLATFORM_HEAP_STATS_CALLER_SLOTS
+static size_t count_caller_bytes(mbed_stats_heap_caller_t *all, size_t count)
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < count; i++) {
+        bytes += all[i].current_size;
+    }
+    return bytes;
+}
+
+void test_case_caller_stats()
+{
+    mbed_stats_heap_t heap;
+    mbed_stats_heap_caller_t all[MBED_CONF_PLATFORM_HEAP_STATS_CALLER_SLOTS + 1];
+    size_t count;
+
+    // The caller table accounts for every byte on the heap
+    void *data = malloc(ALLOCATION_SIZE_LARGE);
+    TEST_ASSERT(data != NULL);
+    count = mbed_stats_heap_get_each_caller(all, MBED_CONF_PLATFORM_HEAP_STATS_CALLER_SLOTS + 1);
+    mbed_stats_heap_get(&heap);
+    TEST_ASSERT_EQUAL_UINT32(heap.current_size, count_caller_bytes(all, count));
+
+    // Two allocations from the same call site share an entry
+    void *blocks[2];
+    for (int i = 0; i < 2; i++) {
+        blocks[i] = malloc(ALLOCATION_SIZE_SMALL);
+        TEST_ASSERT(blocks[i] != NULL);
+    }
+    count = mbed_stats_heap_get_each_caller(all, MBED_CONF_PLATFORM_HEAP_STATS_CALLER_SLOTS + 1);
+    mbed_stats_heap_get(&heap);
+    TEST_ASSERT_EQUAL_UINT32(heap.current_size, count_caller_bytes(all, count));
+    bool found = false;
+    for (size_t i = 0; i < count; i++) {
+        if (all[i].caller != 0 && all[i].alloc_cnt == 2 && all[i].current_size == 2 * ALLOCATION_SIZE_SMALL) {
+            found = true;
+        }
+    }
+    TEST_ASSERT_TRUE(found);
+
+    free(blocks[0]);
+    free(blocks[1]);
+    free(data);
+    count = mbed_stats_heap_get_each_caller(all, MBED_CONF_PLATFORM_HEAP_STATS_CALLER_SLOTS + 1);
+    mbed_stats_heap_get(&heap);
+    TEST_ASSERT_EQUAL_UINT32(heap.current_size, count_caller_bytes(all, count));
+}
+#endif
+
 Case cases[] = {
     Case("malloc and free size", test_case_malloc_free_size),
     Case("allocate size zero", test_case_allocate_zero),
     Case("allocation failure", test_case_allocate_fail),
     Case("realloc size", test_case_realloc_size),
+#if MBED_CONF_PLATFORM_HEAP_STATS_THREAD_SLOTS && MBED_CONF_RTOS_PRESENT
+    Case("per thread stats", test_case_thread_stats),
+    Case("thread slot reuse", test_case_thread_slot_reuse),
+#endif
+#if MBED_CONF_PLATFORM_HEAP_STATS_CALLER_SLOTS
+    Case("per caller stats", test_case_caller_stats),
+#endif
 };
 
 utest::v1::status_t greentea_test_setup(const size_t number_of_cases)
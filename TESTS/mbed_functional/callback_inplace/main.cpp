@@ -0,0 +1,236 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity.h"
+#include "utest.h"
+#include "platform/InplaceCallback.h"
+
+using namespace utest::v1;
+
+#define BENCHMARK_ITERATIONS 20000
+
+// static functions
+static int static_func2(int a0, int a1) { return 0x80 | a0 | a1; }
+
+// class functions
+struct Thing {
+    int t;
+    Thing() : t(0x80) {}
+
+    int member_func2(int a0, int a1) { return t | a0 | a1; }
+    int const_member_func2(int a0, int a1) const { return t | a0 | a1; }
+    int volatile_member_func2(int a0, int a1) volatile { return t | a0 | a1; }
+    int const_volatile_member_func2(int a0, int a1) const volatile { return t | a0 | a1; }
+};
+
+// bound functions
+static int bound_func2(Thing *t, int a0, int a1) { return t->t | a0 | a1; }
+static int const_bound_func2(const Thing *t, int a0, int a1) { return t->t | a0 | a1; }
+
+// Function object with three words of bound state, too large for Callback
+struct Accumulate {
+    int *total;
+    int scale;
+    int offset;
+
+    int operator()(int a0, int a1) const {
+        *total += scale * (a0 + a1) + offset;
+        return *total;
+    }
+};
+
+// Function object counting its live copies
+struct Counted {
+    static int live;
+    int value;
+
+    Counted(int value) : value(value) { live++; }
+    Counted(const Counted &that) : value(that.value) { live++; }
+    ~Counted() { live--; }
+
+    int operator()(int a0, int a1) const { return value | a0 | a1; }
+};
+
+int Counted::live = 0;
+
+typedef InplaceCallback<int(int, int)> inplace_t;
+
+static void verify(const inplace_t &cb)
+{
+    TEST_ASSERT_TRUE(cb);
+    TEST_ASSERT_EQUAL(0x83, cb(0x01, 0x02));
+    TEST_ASSERT_EQUAL(0x83, cb.call(0x01, 0x02));
+    TEST_ASSERT_EQUAL(0x83, inplace_t::thunk((void *)&cb, 0x01, 0x02));
+
+    inplace_t copy(cb);
+    TEST_ASSERT_TRUE(copy == cb);
+    TEST_ASSERT_EQUAL(0x83, copy(0x01, 0x02));
+}
+
+void test_dispatch()
+{
+    Thing thing;
+    verify(static_func2);
+    verify(inplace_t(&thing, &Thing::member_func2));
+    verify(inplace_t((const Thing *)&thing, &Thing::const_member_func2));
+    verify(inplace_t((volatile Thing *)&thing, &Thing::volatile_member_func2));
+    verify(inplace_t((const volatile Thing *)&thing, &Thing::const_volatile_member_func2));
+    verify(inplace_t(bound_func2, &thing));
+    verify(inplace_t(const_bound_func2, (const Thing *)&thing));
+    verify(inplace_t(callback(&thing, &Thing::member_func2)));
+}
+
+void test_functor_storage()
+{
+    int total = 0;
+    Accumulate acc = { &total, 2, 1 };
+    TEST_ASSERT_TRUE(sizeof(acc) > sizeof(uintptr_t));
+
+    inplace_t cb(acc);
+    TEST_ASSERT_EQUAL(7, cb(1, 2));
+
+    // The copy carries the bound state along
+    inplace_t copy;
+    copy = cb;
+    TEST_ASSERT_EQUAL(14, copy(1, 2));
+    TEST_ASSERT_EQUAL(14, total);
+
+    // Larger storage is selected through the template argument
+    InplaceCallback<int(int, int), 8 * sizeof(void *)> big(acc);
+    TEST_ASSERT_EQUAL(21, big(1, 2));
+}
+
+void test_functor_lifetime()
+{
+    {
+        Counted counted(0x80);
+        inplace_t cb(counted);
+        TEST_ASSERT_EQUAL(2, Counted::live);
+
+        inplace_t copy(cb);
+        TEST_ASSERT_EQUAL(3, Counted::live);
+        TEST_ASSERT_EQUAL(0x83, copy(0x01, 0x02));
+
+        copy = static_func2;
+        TEST_ASSERT_EQUAL(2, Counted::live);
+        TEST_ASSERT_EQUAL(0x83, copy(0x01, 0x02));
+
+        copy = cb;
+        TEST_ASSERT_EQUAL(3, Counted::live);
+    }
+    TEST_ASSERT_EQUAL(0, Counted::live);
+}
+
+void test_empty()
+{
+    inplace_t empty;
+    TEST_ASSERT_FALSE(empty);
+    TEST_ASSERT_TRUE(empty == inplace_t(Callback<int(int, int)>()));
+
+    inplace_t cb(static_func2);
+    TEST_ASSERT_TRUE(empty != cb);
+    cb = empty;
+    TEST_ASSERT_FALSE(cb);
+}
+
+void test_equality()
+{
+    Thing thing;
+    Thing other;
+
+    // Bound functions compare their function and object pointers
+    TEST_ASSERT_TRUE(inplace_t(&thing, &Thing::member_func2) == inplace_t(&thing, &Thing::member_func2));
+    TEST_ASSERT_TRUE(inplace_t(&thing, &Thing::member_func2) != inplace_t(&other, &Thing::member_func2));
+    TEST_ASSERT_TRUE(inplace_t(&thing, &Thing::member_func2) != inplace_t(&thing, &Thing::const_member_func2));
+    TEST_ASSERT_TRUE(inplace_t(bound_func2, &thing) == inplace_t(bound_func2, &thing));
+    TEST_ASSERT_TRUE(inplace_t(bound_func2, &thing) != inplace_t(bound_func2, &other));
+    TEST_ASSERT_TRUE(inplace_t(static_func2) != inplace_t(bound_func2, &thing));
+}
+
+// The dispatch loops are kept out of line so that their code size
+// can be compared in the map file of this test
+static volatile int sink;
+
+template <typename C>
+MBED_NOINLINE static void call_loop(const C &cb, int iterations)
+{
+    for (int i = 0; i < iterations; i++) {
+        sink = cb(i, 1);
+    }
+}
+
+template <typename C>
+static int time_calls(const C &cb)
+{
+    Timer timer;
+    timer.start();
+    call_loop(cb, BENCHMARK_ITERATIONS);
+    timer.stop();
+    return timer.read_us();
+}
+
+void test_benchmark_call_latency()
+{
+    Thing thing;
+    int total = 0;
+    Accumulate acc = { &total, 1, 0 };
+
+    int cb_static = time_calls(Callback<int(int, int)>(static_func2));
+    int inplace_static = time_calls(inplace_t(static_func2));
+    int cb_member = time_calls(Callback<int(int, int)>(&thing, &Thing::member_func2));
+    int inplace_member = time_calls(inplace_t(&thing, &Thing::member_func2));
+    int inplace_functor = time_calls(inplace_t(acc));
+
+    utest_printf("%d calls, time in us\r\n", BENCHMARK_ITERATIONS);
+    utest_printf("  Callback static function:        %d\r\n", cb_static);
+    utest_printf("  InplaceCallback static function: %d\r\n", inplace_static);
+    utest_printf("  Callback member function:        %d\r\n", cb_member);
+    utest_printf("  InplaceCallback member function: %d\r\n", inplace_member);
+    utest_printf("  InplaceCallback 3 word functor:  %d\r\n", inplace_functor);
+    TEST_ASSERT_EQUAL(BENCHMARK_ITERATIONS * (BENCHMARK_ITERATIONS + 1) / 2, total);
+}
+
+void test_benchmark_footprint()
+{
+    utest_printf("Callback:           %u bytes\r\n", (unsigned)sizeof(Callback<int(int, int)>));
+    utest_printf("InplaceCallback:    %u bytes\r\n", (unsigned)sizeof(inplace_t));
+    utest_printf("InplaceCallback<8>: %u bytes\r\n", (unsigned)sizeof(InplaceCallback<int(int, int), 8 * sizeof(void *)>));
+    TEST_ASSERT_TRUE(sizeof(inplace_t) >= MBED_INPLACE_CALLBACK_SIZE + 2 * sizeof(void *));
+}
+
+
+// Test setup
+utest::v1::status_t test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(20, "default_auto");
+    return verbose_test_setup_handler(number_of_cases);
+}
+
+Case cases[] = {
+    Case("Testing inplace callback dispatch", test_dispatch),
+    Case("Testing inplace callback functor storage", test_functor_storage),
+    Case("Testing inplace callback functor lifetime", test_functor_lifetime),
+    Case("Testing empty inplace callbacks", test_empty),
+    Case("Testing inplace callback equality", test_equality),
+    Case("Benchmark callback call latency", test_benchmark_call_latency),
+    Case("Benchmark callback footprint", test_benchmark_footprint),
+};
+
+Specification specification(test_setup, cases);
+
+int main() {
+    return !Harness::run(specification);
+}
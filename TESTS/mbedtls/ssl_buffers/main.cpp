@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2018, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVICE_TRNG
+    #error [NOT_SUPPORTED] TRNG required
+#endif
+
+#if !defined(MBED_HEAP_STATS_ENABLED)
+    #error [NOT_SUPPORTED] heap statistics required
+#endif
+
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest.h"
+#include "mbed_stats.h"
+
+#include "mbedtls/ssl.h"
+#include "mbedtls/ssl_internal.h"
+#include "mbedtls/certs.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+
+#if !defined(MBEDTLS_SSL_CLI_C) || !defined(MBEDTLS_SSL_SRV_C) || !defined(MBEDTLS_CERTS_C) || \
+    !defined(MBEDTLS_ECDSA_C) || !defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    #error [NOT_SUPPORTED] TLS client, server, ECDSA and max fragment length required
+#endif
+
+using namespace utest::v1;
+
+#ifndef MBED_CFG_SSL_BUFFERS_TRANSFER_SIZE
+#define MBED_CFG_SSL_BUFFERS_TRANSFER_SIZE 8192
+#endif
+
+// Client and server talk through a pair of memory pipes
+struct pipe_t {
+    unsigned char buf[4096];
+    size_t len;
+};
+
+struct end_t {
+    pipe_t *in;
+    pipe_t *out;
+};
+
+pipe_t c2s, s2c;
+end_t client_end = {&s2c, &c2s};
+end_t server_end = {&c2s, &s2c};
+
+mbedtls_entropy_context entropy;
+mbedtls_ctr_drbg_context drbg;
+mbedtls_x509_crt ca, srv_crt;
+mbedtls_pk_context srv_key;
+mbedtls_ssl_config client_conf, server_conf;
+
+unsigned char tx_buf[MBED_CFG_SSL_BUFFERS_TRANSFER_SIZE];
+unsigned char rx_buf[MBED_CFG_SSL_BUFFERS_TRANSFER_SIZE];
+
+int pipe_send(void *ctx, const unsigned char *buf, size_t len)
+{
+    pipe_t *pipe = ((end_t *)ctx)->out;
+    if (len > sizeof(pipe->buf) - pipe->len) {
+        len = sizeof(pipe->buf) - pipe->len;
+    }
+    if (len == 0) {
+        return MBEDTLS_ERR_SSL_WANT_WRITE;
+    }
+    memcpy(pipe->buf + pipe->len, buf, len);
+    pipe->len += len;
+    return len;
+}
+
+int pipe_recv(void *ctx, unsigned char *buf, size_t len)
+{
+    pipe_t *pipe = ((end_t *)ctx)->in;
+    if (pipe->len == 0) {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+    if (len > pipe->len) {
+        len = pipe->len;
+    }
+    memcpy(buf, pipe->buf, len);
+    memmove(pipe->buf, pipe->buf + len, pipe->len - len);
+    pipe->len -= len;
+    return len;
+}
+
+bool want(int ret)
+{
+    return ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE;
+}
+
+void handshake(mbedtls_ssl_context *client, mbedtls_ssl_context *server)
+{
+    int client_ret = MBEDTLS_ERR_SSL_WANT_READ;
+    int server_ret = MBEDTLS_ERR_SSL_WANT_READ;
+    while (want(client_ret) || want(server_ret)) {
+        if (client_ret) {
+            client_ret = mbedtls_ssl_handshake(client);
+        }
+        if (server_ret) {
+            server_ret = mbedtls_ssl_handshake(server);
+        }
+    }
+    TEST_ASSERT_EQUAL(0, client_ret);
+    TEST_ASSERT_EQUAL(0, server_ret);
+}
+
+// Sends the whole transfer buffer from one end to the other, in records
+// limited by the sender's fragment length
+void transfer(mbedtls_ssl_context *from, mbedtls_ssl_context *to)
+{
+    size_t sent = 0;
+    size_t received = 0;
+
+    for (size_t i = 0; i < sizeof(tx_buf); i++) {
+        tx_buf[i] = i * 7 + 3;
+    }
+    memset(rx_buf, 0, sizeof(rx_buf));
+
+    while (received < sizeof(rx_buf)) {
+        int ret = mbedtls_ssl_write(from, tx_buf + sent, sizeof(tx_buf) - sent);
+        if (ret > 0) {
+            sent += ret;
+        } else {
+            TEST_ASSERT_TRUE(want(ret) || sent == sizeof(tx_buf));
+        }
+
+        ret = mbedtls_ssl_read(to, rx_buf + received, sizeof(rx_buf) - received);
+        if (ret > 0) {
+            received += ret;
+        } else {
+            TEST_ASSERT_TRUE(want(ret));
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(tx_buf, rx_buf, sizeof(tx_buf));
+}
+
+void test_setup_tls()
+{
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&drbg);
+    TEST_ASSERT_EQUAL(0, mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy, NULL, 0));
+
+    mbedtls_x509_crt_init(&ca);
+    mbedtls_x509_crt_init(&srv_crt);
+    mbedtls_pk_init(&srv_key);
+    // The RSA test certificates are signed with SHA-1, which is disabled by default
+    TEST_ASSERT_EQUAL(0, mbedtls_x509_crt_parse(&ca, (const unsigned char *)mbedtls_test_cas_pem,
+                                                mbedtls_test_cas_pem_len));
+    TEST_ASSERT_EQUAL(0, mbedtls_x509_crt_parse(&srv_crt, (const unsigned char *)mbedtls_test_srv_crt_ec,
+                                                mbedtls_test_srv_crt_ec_len));
+    TEST_ASSERT_EQUAL(0, mbedtls_pk_parse_key(&srv_key, (const unsigned char *)mbedtls_test_srv_key_ec,
+                                              mbedtls_test_srv_key_ec_len, NULL, 0));
+
+    mbedtls_ssl_config_init(&server_conf);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_config_defaults(&server_conf, MBEDTLS_SSL_IS_SERVER,
+                                                     MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT));
+    mbedtls_ssl_conf_rng(&server_conf, mbedtls_ctr_drbg_random, &drbg);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_conf_own_cert(&server_conf, &srv_crt, &srv_key));
+
+    mbedtls_ssl_config_init(&client_conf);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_config_defaults(&client_conf, MBEDTLS_SSL_IS_CLIENT,
+                                                     MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT));
+    mbedtls_ssl_conf_rng(&client_conf, mbedtls_ctr_drbg_random, &drbg);
+    mbedtls_ssl_conf_ca_chain(&client_conf, &ca, NULL);
+    mbedtls_ssl_conf_authmode(&client_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+}
+
+// Measures the heap held by an established client connection, with the
+// client requesting the given maximum fragment length
+template <unsigned char MFL_CODE, size_t MFL_LEN>
+void test_connection_ram()
+{
+    mbed_stats_heap_t start;
+    mbed_stats_heap_t stats;
+    mbedtls_ssl_context client, server;
+
+    if (mbedtls_ssl_conf_max_frag_len(&client_conf, MFL_CODE) != 0) {
+        // Longer than MBEDTLS_SSL_IN_CONTENT_LEN, the client could not receive it
+        TEST_ASSERT_TRUE(MFL_LEN > MBEDTLS_SSL_IN_CONTENT_LEN);
+        return;
+    }
+
+    mbed_stats_heap_get(&start);
+    mbedtls_ssl_init(&client);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_setup(&client, &client_conf));
+    mbed_stats_heap_get(&stats);
+    uint32_t setup_size = stats.current_size - start.current_size;
+
+    mbedtls_ssl_init(&server);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_setup(&server, &server_conf));
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_set_hostname(&client, "localhost"));
+    mbedtls_ssl_set_bio(&client, &client_end, pipe_send, pipe_recv, NULL);
+    mbedtls_ssl_set_bio(&server, &server_end, pipe_send, pipe_recv, NULL);
+    c2s.len = 0;
+    s2c.len = 0;
+
+    handshake(&client, &server);
+    transfer(&client, &server);
+    transfer(&server, &client);
+
+    size_t out_len = MFL_LEN < MBEDTLS_SSL_OUT_CONTENT_LEN ? MFL_LEN : MBEDTLS_SSL_OUT_CONTENT_LEN;
+    TEST_ASSERT_EQUAL(out_len, mbedtls_ssl_get_max_frag_len(&client));
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    size_t in_len = MFL_LEN < MBEDTLS_SSL_IN_CONTENT_LEN ? MFL_LEN : MBEDTLS_SSL_IN_CONTENT_LEN;
+    TEST_ASSERT_EQUAL(MBEDTLS_SSL_IN_BUFFER_LEN - MBEDTLS_SSL_IN_CONTENT_LEN + in_len, client.in_buf_len);
+    TEST_ASSERT_EQUAL(MBEDTLS_SSL_OUT_BUFFER_LEN - MBEDTLS_SSL_OUT_CONTENT_LEN + out_len, client.out_buf_len);
+#endif
+
+    // Only the client is left
+    mbedtls_ssl_free(&server);
+    mbed_stats_heap_get(&stats);
+    uint32_t connection_size = stats.current_size - start.current_size;
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    if (in_len < MBEDTLS_SSL_IN_CONTENT_LEN || out_len < MBEDTLS_SSL_OUT_CONTENT_LEN) {
+        TEST_ASSERT_TRUE(connection_size < setup_size);
+    }
+#endif
+
+    printf("MBED: max fragment length %u: %lu bytes at setup, %lu bytes per connection\r\n",
+           (unsigned)MFL_LEN, (unsigned long)setup_size, (unsigned long)connection_size);
+
+    mbedtls_ssl_free(&client);
+    mbed_stats_heap_get(&stats);
+    TEST_ASSERT_EQUAL_UINT32(start.current_size, stats.current_size);
+}
+
+
+// Test setup
+utest::v1::status_t test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(120, "default_auto");
+    return verbose_test_setup_handler(number_of_cases);
+}
+
+Case cases[] = {
+    Case("TLS buffers setup", test_setup_tls),
+    Case("TLS connection RAM, no max fragment length",
+         test_connection_ram<MBEDTLS_SSL_MAX_FRAG_LEN_NONE, 16384>),
+    Case("TLS connection RAM, max fragment length 512", test_connection_ram<MBEDTLS_SSL_MAX_FRAG_LEN_512, 512>),
+    Case("TLS connection RAM, max fragment length 1024", test_connection_ram<MBEDTLS_SSL_MAX_FRAG_LEN_1024, 1024>),
+    Case("TLS connection RAM, max fragment length 2048", test_connection_ram<MBEDTLS_SSL_MAX_FRAG_LEN_2048, 2048>),
+    Case("TLS connection RAM, max fragment length 4096", test_connection_ram<MBEDTLS_SSL_MAX_FRAG_LEN_4096, 4096>),
+};
+
+Specification specification(test_setup, cases);
+
+int main() {
+    return !Harness::run(specification);
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2018, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#if !defined(MBED_HEAP_STATS_ENABLED)
+    #error [NOT_SUPPORTED] heap statistics required
+#endif
+
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest.h"
+#include "mbed_stats.h"
+
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/pem.h"
+#include "mbedtls/oid.h"
+#include "mbedtls/certs.h"
+
+#if !defined(MBEDTLS_X509_CRT_PARSE_C) || !defined(MBEDTLS_PEM_PARSE_C) || !defined(MBEDTLS_CERTS_C) || \
+    !defined(MBEDTLS_ECDSA_C)
+    #error [NOT_SUPPORTED] X.509 parsing, PEM, test certificates and ECDSA required
+#endif
+
+using namespace utest::v1;
+
+// DER of the test certificates, standing in for certificates kept in flash
+struct der_t {
+    unsigned char buf[1024];
+    size_t len;
+};
+
+der_t ca_der, srv_der, cli_der;
+
+void pem_to_der(const char *pem, der_t *der)
+{
+    mbedtls_pem_context ctx;
+    size_t use_len;
+
+    mbedtls_pem_init(&ctx);
+    TEST_ASSERT_EQUAL(0, mbedtls_pem_read_buffer(&ctx, "-----BEGIN CERTIFICATE-----",
+                                                 "-----END CERTIFICATE-----",
+                                                 (const unsigned char *)pem, NULL, 0, &use_len));
+    TEST_ASSERT_TRUE(ctx.buflen <= sizeof(der->buf));
+    memcpy(der->buf, ctx.buf, ctx.buflen);
+    der->len = ctx.buflen;
+    mbedtls_pem_free(&ctx);
+}
+
+void test_setup_der()
+{
+    pem_to_der(mbedtls_test_ca_crt_ec, &ca_der);
+    pem_to_der(mbedtls_test_srv_crt_ec, &srv_der);
+    pem_to_der(mbedtls_test_cli_crt_ec, &cli_der);
+}
+
+// Parses the certificates in both modes and compares the heap they hold
+void test_parse_ram()
+{
+    const der_t *ders[] = {&ca_der, &srv_der, &cli_der};
+    mbed_stats_heap_t start;
+    mbed_stats_heap_t stats;
+    mbedtls_x509_crt copy, nocopy;
+    uint32_t copy_size, nocopy_size;
+
+    mbed_stats_heap_get(&start);
+    mbedtls_x509_crt_init(&copy);
+    for (size_t i = 0; i < sizeof(ders) / sizeof(ders[0]); i++) {
+        TEST_ASSERT_EQUAL(0, mbedtls_x509_crt_parse_der(&copy, ders[i]->buf, ders[i]->len));
+    }
+    mbed_stats_heap_get(&stats);
+    copy_size = stats.current_size - start.current_size;
+
+    mbedtls_x509_crt_init(&nocopy);
+    for (size_t i = 0; i < sizeof(ders) / sizeof(ders[0]); i++) {
+        TEST_ASSERT_EQUAL(0, mbedtls_x509_crt_parse_der_nocopy(&nocopy, ders[i]->buf, ders[i]->len));
+    }
+    mbed_stats_heap_get(&stats);
+    nocopy_size = stats.current_size - start.current_size - copy_size;
+
+    // The certificates reference the DER and are otherwise the same
+    mbedtls_x509_crt *a = &copy;
+    mbedtls_x509_crt *b = &nocopy;
+    for (size_t i = 0; i < sizeof(ders) / sizeof(ders[0]); i++) {
+        TEST_ASSERT_TRUE(a->raw.p != ders[i]->buf);
+        TEST_ASSERT_TRUE(b->raw.p == ders[i]->buf);
+        TEST_ASSERT_EQUAL(a->raw.len, b->raw.len);
+        TEST_ASSERT_EQUAL(a->ext_types, b->ext_types);
+        TEST_ASSERT_EQUAL(a->key_usage, b->key_usage);
+        TEST_ASSERT_EQUAL(a->ca_istrue, b->ca_istrue);
+        TEST_ASSERT_EQUAL(a->subject_raw.len, b->subject_raw.len);
+        TEST_ASSERT_EQUAL(mbedtls_pk_get_type(&a->pk), mbedtls_pk_get_type(&b->pk));
+        a = a->next;
+        b = b->next;
+    }
+
+    printf("MBED: %u bytes of DER: %lu bytes of heap copied, %lu bytes not copied\r\n",
+           (unsigned)(ca_der.len + srv_der.len + cli_der.len),
+           (unsigned long)copy_size, (unsigned long)nocopy_size);
+    TEST_ASSERT_TRUE(nocopy_size + ca_der.len + srv_der.len + cli_der.len < copy_size);
+
+    mbedtls_x509_crt_free(&copy);
+    mbedtls_x509_crt_free(&nocopy);
+    mbed_stats_heap_get(&stats);
+    TEST_ASSERT_EQUAL_UINT32(start.current_size, stats.current_size);
+}
+
+// Verifies a certificate chain with both certificates parsed without a copy
+void test_verify()
+{
+    mbedtls_x509_crt ca, srv;
+    uint32_t flags;
+
+    mbedtls_x509_crt_init(&ca);
+    mbedtls_x509_crt_init(&srv);
+    TEST_ASSERT_EQUAL(0, mbedtls_x509_crt_parse_der_nocopy(&ca, ca_der.buf, ca_der.len));
+    TEST_ASSERT_EQUAL(0, mbedtls_x509_crt_parse_der_nocopy(&srv, srv_der.buf, srv_der.len));
+
+    TEST_ASSERT_EQUAL(0, mbedtls_x509_crt_verify(&srv, &ca, NULL, "localhost", &flags, NULL, NULL));
+    TEST_ASSERT_EQUAL(0, flags);
+
+    TEST_ASSERT_EQUAL(MBEDTLS_ERR_X509_CERT_VERIFY_FAILED,
+                      mbedtls_x509_crt_verify(&srv, &ca, NULL, "otherhost", &flags, NULL, NULL));
+    TEST_ASSERT_EQUAL(MBEDTLS_X509_BADCERT_CN_MISMATCH, flags);
+
+    TEST_ASSERT_EQUAL(0, mbedtls_x509_crt_check_key_usage(&ca, MBEDTLS_X509_KU_KEY_CERT_SIGN));
+    TEST_ASSERT_EQUAL(0, mbedtls_x509_crt_check_extended_key_usage(&srv, MBEDTLS_OID_SERVER_AUTH,
+                                                                   MBEDTLS_OID_SIZE(MBEDTLS_OID_SERVER_AUTH)));
+
+    mbedtls_x509_crt_free(&srv);
+    mbedtls_x509_crt_free(&ca);
+}
+
+// Prints a certificate the same way in both modes
+void test_info()
+{
+    const der_t *ders[] = {&ca_der, &srv_der, &cli_der};
+    static char copy_info[1024];
+    static char nocopy_info[1024];
+    mbedtls_x509_crt copy, nocopy;
+
+    for (size_t i = 0; i < sizeof(ders) / sizeof(ders[0]); i++) {
+        mbedtls_x509_crt_init(&copy);
+        mbedtls_x509_crt_init(&nocopy);
+        TEST_ASSERT_EQUAL(0, mbedtls_x509_crt_parse_der(&copy, ders[i]->buf, ders[i]->len));
+        TEST_ASSERT_EQUAL(0, mbedtls_x509_crt_parse_der_nocopy(&nocopy, ders[i]->buf, ders[i]->len));
+
+        TEST_ASSERT_TRUE(mbedtls_x509_crt_info(copy_info, sizeof(copy_info), "", &copy) > 0);
+        TEST_ASSERT_TRUE(mbedtls_x509_crt_info(nocopy_info, sizeof(nocopy_info), "", &nocopy) > 0);
+        TEST_ASSERT_EQUAL_STRING(copy_info, nocopy_info);
+
+        mbedtls_x509_crt_free(&copy);
+        mbedtls_x509_crt_free(&nocopy);
+    }
+}
+
+
+// Test setup
+utest::v1::status_t test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(60, "default_auto");
+    return verbose_test_setup_handler(number_of_cases);
+}
+
+Case cases[] = {
+    Case("X.509 DER setup", test_setup_der),
+    Case("X.509 parse RAM, copy and no copy", test_parse_ram),
+    Case("X.509 verify without copy", test_verify),
+    Case("X.509 info without copy", test_info),
+};
+
+Specification specification(test_setup, cases);
+
+int main() {
+    return !Harness::run(specification);
+}
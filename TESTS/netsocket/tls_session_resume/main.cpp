@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2018, ARM Limited, All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVICE_TRNG
+    #error [NOT_SUPPORTED] TRNG required
+#endif
+
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest.h"
+
+#include "HeapBlockDevice.h"
+#include "LittleFileSystem.h"
+#include "FileTLSSessionStore.h"
+#include "mbedtls/certs.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ssl_cache.h"
+#include "mbedtls/ssl_ticket.h"
+
+#if !defined(MBEDTLS_SSL_CLI_C) || !defined(MBEDTLS_SSL_SRV_C) || !defined(MBEDTLS_SSL_CACHE_C) || \
+    !defined(MBEDTLS_SSL_TICKET_C) || !defined(MBEDTLS_GCM_C) || !defined(MBEDTLS_CERTS_C) || !defined(MBEDTLS_ECDSA_C)
+    #error [NOT_SUPPORTED] TLS client, server, session cache, tickets and ECDSA required
+#endif
+
+using namespace utest::v1;
+
+
+#ifndef MBED_CFG_TLS_SESSION_RESUME_HOST
+#define MBED_CFG_TLS_SESSION_RESUME_HOST "localhost"
+#endif
+
+#ifndef MBED_CFG_TLS_SESSION_RESUME_COUNT
+#define MBED_CFG_TLS_SESSION_RESUME_COUNT 4
+#endif
+
+#define BLOCK_SIZE 512
+HeapBlockDevice bd(64 * BLOCK_SIZE, BLOCK_SIZE);
+LittleFileSystem fs("fs");
+
+// Client and server talk through a pair of memory pipes
+struct pipe_t {
+    unsigned char buf[4096];
+    size_t len;
+};
+
+struct end_t {
+    pipe_t *in;
+    pipe_t *out;
+};
+
+pipe_t c2s, s2c;
+end_t client_end = {&s2c, &c2s};
+end_t server_end = {&c2s, &s2c};
+
+mbedtls_entropy_context entropy;
+mbedtls_ctr_drbg_context drbg;
+mbedtls_x509_crt ca, srv_crt;
+mbedtls_pk_context srv_key;
+mbedtls_ssl_cache_context cache;
+mbedtls_ssl_ticket_context ticket;
+mbedtls_ssl_config client_conf, server_conf;
+
+const unsigned char store_key[16] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+    0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+int pipe_send(void *ctx, const unsigned char *buf, size_t len)
+{
+    pipe_t *pipe = ((end_t *)ctx)->out;
+    if (len > sizeof(pipe->buf) - pipe->len) {
+        len = sizeof(pipe->buf) - pipe->len;
+    }
+    if (len == 0) {
+        return MBEDTLS_ERR_SSL_WANT_WRITE;
+    }
+    memcpy(pipe->buf + pipe->len, buf, len);
+    pipe->len += len;
+    return len;
+}
+
+int pipe_recv(void *ctx, unsigned char *buf, size_t len)
+{
+    pipe_t *pipe = ((end_t *)ctx)->in;
+    if (pipe->len == 0) {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+    if (len > pipe->len) {
+        len = pipe->len;
+    }
+    memcpy(buf, pipe->buf, len);
+    memmove(pipe->buf, pipe->buf + len, pipe->len - len);
+    pipe->len -= len;
+    return len;
+}
+
+// Runs one handshake, optionally resuming from the store, and saves the
+// resulting session. Returns the result of resume and the handshake time.
+nsapi_error_t handshake(TLSSessionStore &store, unsigned char master[48], int &time_us)
+{
+    mbedtls_ssl_context client, server;
+    mbedtls_ssl_init(&client);
+    mbedtls_ssl_init(&server);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_setup(&client, &client_conf));
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_setup(&server, &server_conf));
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_set_hostname(&client, MBED_CFG_TLS_SESSION_RESUME_HOST));
+    mbedtls_ssl_set_bio(&client, &client_end, pipe_send, pipe_recv, NULL);
+    mbedtls_ssl_set_bio(&server, &server_end, pipe_send, pipe_recv, NULL);
+    c2s.len = 0;
+    s2c.len = 0;
+
+    Timer timer;
+    timer.start();
+    nsapi_error_t resumed = store.resume(MBED_CFG_TLS_SESSION_RESUME_HOST, &client);
+
+    int client_ret = MBEDTLS_ERR_SSL_WANT_READ;
+    int server_ret = MBEDTLS_ERR_SSL_WANT_READ;
+    while (client_ret == MBEDTLS_ERR_SSL_WANT_READ || server_ret == MBEDTLS_ERR_SSL_WANT_READ) {
+        if (client_ret) {
+            client_ret = mbedtls_ssl_handshake(&client);
+        }
+        if (server_ret) {
+            server_ret = mbedtls_ssl_handshake(&server);
+        }
+    }
+    time_us = timer.read_us();
+    TEST_ASSERT_EQUAL(0, client_ret);
+    TEST_ASSERT_EQUAL(0, server_ret);
+
+    memcpy(master, client.session->master, 48);
+    TEST_ASSERT_EQUAL(0, store.save(MBED_CFG_TLS_SESSION_RESUME_HOST, &client));
+
+    mbedtls_ssl_free(&client);
+    mbedtls_ssl_free(&server);
+    return resumed;
+}
+
+void setup_server(bool tickets)
+{
+    mbedtls_ssl_config_free(&server_conf);
+    mbedtls_ssl_config_init(&server_conf);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_config_defaults(&server_conf, MBEDTLS_SSL_IS_SERVER,
+                                                     MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT));
+    mbedtls_ssl_conf_rng(&server_conf, mbedtls_ctr_drbg_random, &drbg);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_conf_own_cert(&server_conf, &srv_crt, &srv_key));
+    mbedtls_ssl_conf_session_cache(&server_conf, &cache, mbedtls_ssl_cache_get, mbedtls_ssl_cache_set);
+    if (tickets) {
+        mbedtls_ssl_conf_session_tickets_cb(&server_conf, mbedtls_ssl_ticket_write,
+                                            mbedtls_ssl_ticket_parse, &ticket);
+    }
+}
+
+void test_setup_tls()
+{
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&drbg);
+    TEST_ASSERT_EQUAL(0, mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy, NULL, 0));
+
+    mbedtls_x509_crt_init(&ca);
+    mbedtls_x509_crt_init(&srv_crt);
+    mbedtls_pk_init(&srv_key);
+    // The RSA test certificates are signed with SHA-1, which is disabled by default
+    TEST_ASSERT_EQUAL(0, mbedtls_x509_crt_parse(&ca, (const unsigned char *)mbedtls_test_cas_pem,
+                                                mbedtls_test_cas_pem_len));
+    TEST_ASSERT_EQUAL(0, mbedtls_x509_crt_parse(&srv_crt, (const unsigned char *)mbedtls_test_srv_crt_ec,
+                                                mbedtls_test_srv_crt_ec_len));
+    TEST_ASSERT_EQUAL(0, mbedtls_pk_parse_key(&srv_key, (const unsigned char *)mbedtls_test_srv_key_ec,
+                                              mbedtls_test_srv_key_ec_len, NULL, 0));
+
+    mbedtls_ssl_cache_init(&cache);
+    mbedtls_ssl_ticket_init(&ticket);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_ticket_setup(&ticket, mbedtls_ctr_drbg_random, &drbg,
+                                                  MBEDTLS_CIPHER_AES_128_GCM, 86400));
+
+    mbedtls_ssl_config_init(&client_conf);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_config_defaults(&client_conf, MBEDTLS_SSL_IS_CLIENT,
+                                                     MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT));
+    mbedtls_ssl_conf_rng(&client_conf, mbedtls_ctr_drbg_random, &drbg);
+    mbedtls_ssl_conf_ca_chain(&client_conf, &ca, NULL);
+    mbedtls_ssl_conf_authmode(&client_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+
+    mbedtls_ssl_config_init(&server_conf);
+
+    TEST_ASSERT_EQUAL(0, LittleFileSystem::format(&bd));
+    TEST_ASSERT_EQUAL(0, fs.mount(&bd));
+}
+
+template <bool TICKETS>
+void test_resume_after_reboot()
+{
+    unsigned char master[48];
+    unsigned char resumed_master[48];
+    int full_us = 0;
+    int resumed_us = 0;
+    int time_us;
+
+    setup_server(TICKETS);
+    for (int i = 0; i < MBED_CFG_TLS_SESSION_RESUME_COUNT; i++) {
+        {
+            FileTLSSessionStore store("/fs/tls");
+            TEST_ASSERT_EQUAL(0, store.setup(store_key, 128, mbedtls_ctr_drbg_random, &drbg));
+            TEST_ASSERT_EQUAL(0, store.remove(MBED_CFG_TLS_SESSION_RESUME_HOST));
+            TEST_ASSERT_EQUAL(NSAPI_ERROR_NO_ADDRESS, handshake(store, master, time_us));
+            full_us += time_us;
+        }
+
+        // Simulated reboot, only the file system survives
+        TEST_ASSERT_EQUAL(0, fs.unmount());
+        TEST_ASSERT_EQUAL(0, fs.mount(&bd));
+
+        FileTLSSessionStore store("/fs/tls");
+        TEST_ASSERT_EQUAL(0, store.setup(store_key, 128, mbedtls_ctr_drbg_random, &drbg));
+        TEST_ASSERT_EQUAL(0, handshake(store, resumed_master, time_us));
+        resumed_us += time_us;
+
+        // Only an abbreviated handshake keeps the master secret
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(master, resumed_master, 48);
+    }
+
+    printf("MBED: %s: full handshake %d us, resumed handshake %d us\r\n",
+           TICKETS ? "session ticket" : "session ID",
+           full_us / MBED_CFG_TLS_SESSION_RESUME_COUNT,
+           resumed_us / MBED_CFG_TLS_SESSION_RESUME_COUNT);
+}
+
+void test_resume_rejected()
+{
+    unsigned char master[48];
+    int time_us;
+
+    setup_server(true);
+    FileTLSSessionStore store("/fs/tls");
+    TEST_ASSERT_EQUAL(0, store.setup(store_key, 128, mbedtls_ctr_drbg_random, &drbg));
+    handshake(store, master, time_us);
+
+    mbedtls_ssl_context client;
+    mbedtls_ssl_init(&client);
+    TEST_ASSERT_EQUAL(0, mbedtls_ssl_setup(&client, &client_conf));
+
+    // Unknown host
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_NO_ADDRESS, store.resume("unknown.example", &client));
+
+    // Other key
+    unsigned char other_key[16] = {0};
+    FileTLSSessionStore other("/fs/tls");
+    TEST_ASSERT_EQUAL(0, other.setup(other_key, 128, mbedtls_ctr_drbg_random, &drbg));
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_NO_ADDRESS, other.resume(MBED_CFG_TLS_SESSION_RESUME_HOST, &client));
+
+    // Removed
+    TEST_ASSERT_EQUAL(0, store.remove(MBED_CFG_TLS_SESSION_RESUME_HOST));
+    TEST_ASSERT_EQUAL(NSAPI_ERROR_NO_ADDRESS, store.resume(MBED_CFG_TLS_SESSION_RESUME_HOST, &client));
+
+    mbedtls_ssl_free(&client);
+}
+
+
+// Test setup
+utest::v1::status_t test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(120, "default_auto");
+    return verbose_test_setup_handler(number_of_cases);
+}
+
+Case cases[] = {
+    Case("TLS session store setup", test_setup_tls),
+    Case("TLS session ticket resumed after reboot", test_resume_after_reboot<true>),
+    Case("TLS session ID resumed after reboot", test_resume_after_reboot<false>),
+    Case("TLS session resumption rejected", test_resume_rejected),
+};
+
+Specification specification(test_setup, cases);
+
+int main() {
+    return !Harness::run(specification);
+}
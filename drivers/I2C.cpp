@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 #include "drivers/I2C.h"
+#include "platform/mbed_critical.h"
+#include "platform/mbed_error.h"
 
 #if DEVICE_I2C
 
@@ -23,8 +25,7 @@
 
 namespace mbed {
 
-I2C *I2C::_owner = NULL;
-SingletonPtr<PlatformMutex> I2C::_mutex;
+I2C::i2c_peripheral_s I2C::_peripherals[I2C_PERIPHERALS_USED];
 
 I2C::I2C(PinName sda, PinName scl) :
 #if DEVICE_I2C_ASYNCH
@@ -32,44 +33,210 @@ I2C::I2C(PinName sda, PinName scl) :
 #endif
     _i2c(), _hz(100000)
 {
-    // No lock needed in the constructor
+#if DEVICE_I2C_COUNT
+    int name = i2c_get_peripheral_name(sda, scl);
+#else
+    // Objects on the same bus share the clock line
+    int name = scl;
+#endif
+
+    core_util_critical_section_enter();
+    _peripheral = _lookup_peripheral(name);
+    if (_peripheral) {
+        _peripheral->users++;
+    }
+    core_util_critical_section_exit();
+
+    if (!_peripheral) {
+        error("I2C: more buses in use than drivers.i2c-count-max\r\n");
+    }
+
+#if DEVICE_I2C_ASYNCH && TRANSACTION_QUEUE_SIZE_I2C
+    // Create the queue up front, it is also used from interrupt context
+    _peripheral->transaction_buffer.get();
+#endif
+#if DEVICE_I2C_ASYNCH && defined(MBED_CONF_RTOS_PRESENT)
+    // Same for the semaphore released by the transfer interrupt
+    _peripheral->bus_free.get();
+#endif
 
     // The init function also set the frequency to 100000
     i2c_init(&_i2c, sda, scl);
 
-    // Used to avoid unnecessary frequency updates
-    _owner = this;
+    // Used to avoid unnecessary frequency updates. A transfer in flight keeps
+    // the bus, the next user then sets its frequency again.
+    lock();
+    if (_try_claim_bus()) {
+        _peripheral->owner = this;
+        _release_bus();
+    } else {
+        _peripheral->owner = NULL;
+    }
+    unlock();
+}
+
+I2C::~I2C()
+{
+#if DEVICE_I2C_ASYNCH
+    // A transfer left in flight would keep the bus busy for good
+    abort_transfer();
+#endif
+
+    lock();
+    if (_peripheral->owner == this) {
+        _peripheral->owner = NULL;
+    }
+    unlock();
+
+    core_util_critical_section_enter();
+    _peripheral->users--;
+    core_util_critical_section_exit();
+}
+
+// Note: Must be called from within a critical section
+I2C::i2c_peripheral_s *I2C::_lookup_peripheral(int name)
+{
+    i2c_peripheral_s *free_slot = NULL;
+
+    for (int i = 0; i < I2C_PERIPHERALS_USED; i++) {
+        if (_peripherals[i].users > 0 && _peripherals[i].name == name) {
+            return &_peripherals[i];
+        }
+        if (free_slot == NULL && _peripherals[i].users == 0) {
+            free_slot = &_peripherals[i];
+        }
+    }
+
+    if (free_slot == NULL) {
+        return NULL;
+    }
+
+    free_slot->name = name;
+    free_slot->owner = NULL;
+#if DEVICE_I2C_ASYNCH
+    free_slot->active = NULL;
+    free_slot->held = 0;
+    free_slot->started = false;
+#if defined(MBED_CONF_RTOS_PRESENT)
+    free_slot->waiting = 0;
+#endif
+#endif
+    return free_slot;
 }
 
 void I2C::frequency(int hz) {
     lock();
     _hz = hz;
 
-    // We want to update the frequency even if we are already the bus owners
-    i2c_frequency(&_i2c, _hz);
+    // We want to update the frequency even if we are already the bus owners,
+    // but not under a transfer in flight: the bus is then set up again on
+    // the next use of this object
+    if (_try_claim_bus()) {
+        i2c_frequency(&_i2c, _hz);
 
-    // Updating the frequency of the bus we become the owners of it
-    _owner = this;
+        // Updating the frequency of the bus we become the owners of it
+        _peripheral->owner = this;
+        _release_bus();
+    } else if (_peripheral->owner == this) {
+        _peripheral->owner = NULL;
+    }
     unlock();
 }
 
 void I2C::aquire() {
     lock();
-    if (_owner != this) {
-        i2c_frequency(&_i2c, _hz);
-        _owner = this;
+    if (_claim_bus()) {
+        _acquire();
+        _release_bus();
     }
     unlock();
 }
 
+// Note: Private function with no locking
+void I2C::_acquire() {
+    if (_peripheral->owner != this) {
+        i2c_frequency(&_i2c, _hz);
+        _peripheral->owner = this;
+    }
+}
+
+// Note: Private function with no locking
+bool I2C::_try_claim_bus() {
+#if DEVICE_I2C_ASYNCH
+    bool claimed = false;
+    core_util_critical_section_enter();
+    // Blocking transfers are serialized by the mutex, they only wait for
+    // an asynchronous transfer
+    if (_peripheral->active == NULL) {
+        _peripheral->held++;
+        claimed = true;
+    }
+    core_util_critical_section_exit();
+    return claimed;
+#else
+    return true;
+#endif
+}
+
+// Note: Private function with no locking
+bool I2C::_claim_bus() {
+#if DEVICE_I2C_ASYNCH && defined(MBED_CONF_RTOS_PRESENT)
+    // Sleep until the interrupt of the transfer in flight frees the bus
+    while (true) {
+        core_util_critical_section_enter();
+        bool claimed = _try_claim_bus();
+        if (!claimed) {
+            _peripheral->waiting++;
+        }
+        core_util_critical_section_exit();
+
+        if (claimed) {
+            return true;
+        }
+
+        int32_t tokens = _peripheral->bus_free->wait(MBED_CONF_DRIVERS_I2C_BUS_WAIT_TIMEOUT);
+
+        core_util_critical_section_enter();
+        _peripheral->waiting--;
+        core_util_critical_section_exit();
+
+        if (tokens <= 0) {
+            return false;
+        }
+    }
+#else
+    // Without an RTOS the transfer in flight was started by this context,
+    // which must wait for its callback rather than spin here
+    return _try_claim_bus();
+#endif
+}
+
+// Note: Private function with no locking
+void I2C::_release_bus() {
+#if DEVICE_I2C_ASYNCH
+    core_util_critical_section_enter();
+    _peripheral->held--;
+#if TRANSACTION_QUEUE_SIZE_I2C
+    dequeue_transaction();
+#endif
+    _wake_bus_waiter();
+    core_util_critical_section_exit();
+#endif
+}
+
 // write - Master Transmitter Mode
 int I2C::write(int address, const char* data, int length, bool repeated) {
     lock();
-    aquire();
+    if (!_claim_bus()) {
+        unlock();
+        return -1;
+    }
+    _acquire();
 
     int stop = (repeated) ? 0 : 1;
     int written = i2c_write(&_i2c, address, data, length, stop);
 
+    _release_bus();
     unlock();
     return length != written;
 }
@@ -84,11 +251,16 @@ int I2C::write(int data) {
 // read - Master Receiver Mode
 int I2C::read(int address, char* data, int length, bool repeated) {
     lock();
-    aquire();
+    if (!_claim_bus()) {
+        unlock();
+        return -1;
+    }
+    _acquire();
 
     int stop = (repeated) ? 0 : 1;
     int read = i2c_read(&_i2c, address, data, length, stop);
 
+    _release_bus();
     unlock();
     return length != read;
 }
@@ -107,6 +279,18 @@ int I2C::read(int ack) {
 
 void I2C::start(void) {
     lock();
+#if DEVICE_I2C_ASYNCH
+    // The transaction holds the bus until stop(), a repeated start does
+    // not claim it again
+    if (!_peripheral->started) {
+        if (!_claim_bus()) {
+            unlock();
+            return;
+        }
+        _peripheral->started = true;
+    }
+#endif
+    _acquire();
     i2c_start(&_i2c);
     unlock();
 }
@@ -114,53 +298,171 @@ void I2C::start(void) {
 void I2C::stop(void) {
     lock();
     i2c_stop(&_i2c);
+#if DEVICE_I2C_ASYNCH
+    if (_peripheral->started) {
+        _peripheral->started = false;
+        _release_bus();
+    }
+#endif
     unlock();
 }
 
 void I2C::lock() {
-    _mutex->lock();
+    _peripheral->mutex->lock();
 }
 
 void I2C::unlock() {
-    _mutex->unlock();
+    _peripheral->mutex->unlock();
 }
 
 #if DEVICE_I2C_ASYNCH
 
 int I2C::transfer(int address, const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length, const event_callback_t& callback, int event, bool repeated)
 {
+    i2c_transaction_t t;
+
+    t.address = address;
+    t.tx_buffer = tx_buffer;
+    t.tx_length = tx_length;
+    t.rx_buffer = rx_buffer;
+    t.rx_length = rx_length;
+    t.callback = callback;
+    t.event = event;
+    t.repeated = repeated;
+
     lock();
-    if (i2c_active(&_i2c)) {
+    core_util_critical_section_enter();
+    if (bus_active()) {
+        core_util_critical_section_exit();
+#if TRANSACTION_QUEUE_SIZE_I2C
+        int ret = queue_transfer(t);
+        unlock();
+        return ret;
+#else
         unlock();
         return -1; // transaction ongoing
+#endif
     }
-    lock_deep_sleep();
-    aquire();
+    // Claim the bus before leaving the critical section, a transfer
+    // dequeued from an interrupt could start on it otherwise
+    _peripheral->active = this;
+    core_util_critical_section_exit();
 
-    _callback = callback;
-    int stop = (repeated) ? 0 : 1;
-    _irq.callback(&I2C::irq_handler_asynch);
-    i2c_transfer_asynch(&_i2c, (void *)tx_buffer, tx_length, (void *)rx_buffer, rx_length, address, stop, _irq.entry(), event, _usage);
+    start_transfer(&t);
     unlock();
     return 0;
 }
 
+void I2C::start_transfer(const i2c_transaction_t *data)
+{
+    lock_deep_sleep();
+    _peripheral->active = this;
+    _acquire();
+
+    _callback = data->callback;
+    int stop = (data->repeated) ? 0 : 1;
+    _irq.callback(&I2C::irq_handler_asynch);
+    i2c_transfer_asynch(&_i2c, (void *)data->tx_buffer, data->tx_length, (void *)data->rx_buffer, data->rx_length, data->address, stop, _irq.entry(), data->event, _usage);
+}
+
+bool I2C::bus_active()
+{
+    return _peripheral->active != NULL || _peripheral->held > 0;
+}
+
+// Note: Must be called from a critical section or interrupt context
+void I2C::_wake_bus_waiter()
+{
+#if defined(MBED_CONF_RTOS_PRESENT)
+    // Blocking calls only wait for the asynchronous transfers
+    if (_peripheral->waiting > 0 && _peripheral->active == NULL) {
+        _peripheral->bus_free->release();
+    }
+#endif
+}
+
 void I2C::abort_transfer(void)
 {
     lock();
-    i2c_abort_asynch(&_i2c);
+    core_util_critical_section_enter();
+    if (_peripheral->active == this) {
+        i2c_abort_asynch(&_i2c);
+        _peripheral->active = NULL;
+#if TRANSACTION_QUEUE_SIZE_I2C
+        dequeue_transaction();
+#endif
+        _wake_bus_waiter();
+    }
+    core_util_critical_section_exit();
     unlock_deep_sleep();
     unlock();
 }
 
+void I2C::clear_transfer_buffer()
+{
+#if TRANSACTION_QUEUE_SIZE_I2C
+    _peripheral->transaction_buffer->reset();
+#endif
+}
+
+void I2C::abort_all_transfers()
+{
+    clear_transfer_buffer();
+    abort_transfer();
+}
+
+#if TRANSACTION_QUEUE_SIZE_I2C
+
+int I2C::queue_transfer(const i2c_transaction_t &data)
+{
+    Transaction<I2C, i2c_transaction_t> transaction(this, data);
+    if (_peripheral->transaction_buffer->full()) {
+        return -1; // the buffer is full
+    }
+
+    core_util_critical_section_enter();
+    _peripheral->transaction_buffer->push(transaction);
+    // The transfer ahead of us may have completed in the meantime
+    if (!bus_active()) {
+        dequeue_transaction();
+    }
+    core_util_critical_section_exit();
+    return 0;
+}
+
+// Note: Must be called from a critical section or interrupt context
+void I2C::dequeue_transaction()
+{
+    if (bus_active()) {
+        return;
+    }
+
+    Transaction<I2C, i2c_transaction_t> t;
+    if (_peripheral->transaction_buffer->pop(t)) {
+        I2C *obj = t.get_object();
+        obj->start_transfer(t.get_transaction());
+    }
+}
+
+#endif
+
 void I2C::irq_handler_asynch(void)
 {
     int event = i2c_irq_handler_asynch(&_i2c);
+    if (event) {
+        // The transfer is over, the callback may already start the next one
+        _peripheral->active = NULL;
+    }
     if (_callback && event) {
         _callback.call(event);
     }
     if (event) {
         unlock_deep_sleep();
+#if TRANSACTION_QUEUE_SIZE_I2C
+        // Chain the next transfer on this bus straight from the interrupt
+        dequeue_transaction();
+#endif
+        _wake_bus_waiter();
     }
 
 }
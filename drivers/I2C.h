@@ -28,13 +28,42 @@
 #if DEVICE_I2C_ASYNCH
 #include "platform/CThunk.h"
 #include "hal/dma_api.h"
+#include "platform/CircularBuffer.h"
 #include "platform/FunctionPointer.h"
+#include "platform/Transaction.h"
+#endif
+
+#if DEVICE_I2C_ASYNCH && defined(MBED_CONF_RTOS_PRESENT)
+#include "rtos/Semaphore.h"
+#endif
+
+#if defined (DEVICE_I2C_COUNT)
+#define I2C_PERIPHERALS_USED DEVICE_I2C_COUNT
+#elif defined (MBED_CONF_DRIVERS_I2C_COUNT_MAX)
+#define I2C_PERIPHERALS_USED MBED_CONF_DRIVERS_I2C_COUNT_MAX
+#else
+#define I2C_PERIPHERALS_USED 2
+#endif
+
+#if !defined (MBED_CONF_DRIVERS_I2C_BUS_WAIT_TIMEOUT)
+#define MBED_CONF_DRIVERS_I2C_BUS_WAIT_TIMEOUT 5000
+#endif
+
+#if !defined (TRANSACTION_QUEUE_SIZE_I2C)
+#if defined (MBED_CONF_DRIVERS_I2C_TRANSACTION_QUEUE_SIZE)
+#define TRANSACTION_QUEUE_SIZE_I2C MBED_CONF_DRIVERS_I2C_TRANSACTION_QUEUE_SIZE
+#else
+#define TRANSACTION_QUEUE_SIZE_I2C 0
+#endif
 #endif
 
 namespace mbed {
 /** \addtogroup drivers */
 
 /** An I2C Master, used for communicating with I2C slave devices
+ *
+ * I2C objects on the same bus share its lock and its queue of pending
+ * asynchronous transfers. Objects on different buses do not block each other.
  *
  * @note Synchronization level: Thread safe
  *
@@ -92,9 +121,13 @@ public:
      *  @param length Number of bytes to read
      *  @param repeated Repeated start, true - don't send stop at end
      *
+     *  Waits for the asynchronous transfers on the bus to complete, up to
+     *  drivers.i2c-bus-wait-timeout milliseconds. Without an RTOS it does
+     *  not wait.
+     *
      *  @returns
      *       0 on success (ack),
-     *   non-0 on failure (nack)
+     *   non-0 on failure (nack) or if the bus stayed busy
      */
     int read(int address, char *data, int length, bool repeated = false);
 
@@ -117,9 +150,11 @@ public:
      *  @param length Number of bytes to send
      *  @param repeated Repeated start, true - do not send stop at end
      *
+     *  Waits for the bus as read() does.
+     *
      *  @returns
      *       0 on success (ack),
-     *   non-0 on failure (nack)
+     *   non-0 on failure (nack) or if the bus stayed busy
      */
     int write(int address, const char *data, int length, bool repeated = false);
 
@@ -135,6 +170,9 @@ public:
     int write(int data);
 
     /** Creates a start condition on the I2C bus
+     *
+     *  Waits for the bus as read() does, and creates no start condition
+     *  if the bus stayed busy.
      */
 
     void start(void);
@@ -151,16 +189,17 @@ public:
      */
     virtual void unlock(void);
 
-    virtual ~I2C() {
-        // Do nothing
-    }
+    virtual ~I2C();
 
 #if DEVICE_I2C_ASYNCH
 
     /** Start non-blocking I2C transfer.
      *
      * This function locks the deep sleep until any event has occurred
-     * 
+     *
+     * If the bus is busy the transfer is queued, and started from the
+     * completion interrupt of the transfers ahead of it.
+     *
      * @param address   8/10 bit I2C slave address
      * @param tx_buffer The TX buffer with data to be transfered
      * @param tx_length The length of TX buffer in bytes
@@ -169,15 +208,56 @@ public:
      * @param event     The logical OR of events to modify
      * @param callback  The event callback function
      * @param repeated Repeated start, true - do not send stop at end
-     * @return Zero if the transfer has started, or -1 if I2C peripheral is busy
+     * @return Zero if the transfer has started or was queued, or -1 if I2C peripheral is busy and the queue is full
      */
     int transfer(int address, const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length, const event_callback_t& callback, int event = I2C_EVENT_TRANSFER_COMPLETE, bool repeated = false);
 
-    /** Abort the on-going I2C transfer
+    /** Abort the on-going I2C transfer, and continue with transfers in the queue if any
      */
     void abort_transfer();
 
+    /** Clear the transaction buffer of the bus this I2C is on
+     */
+    void clear_transfer_buffer();
+
+    /** Clear the transaction buffer and abort on-going transfer.
+     */
+    void abort_all_transfers();
+
   protected:
+    /** Asynchronous transfer, as stored in the transaction queue */
+    typedef struct {
+        int address;
+        const char *tx_buffer;
+        int tx_length;
+        char *rx_buffer;
+        int rx_length;
+        event_callback_t callback;
+        int event;
+        bool repeated;
+    } i2c_transaction_t;
+
+    /** Configures the callback and starts a transfer, without locking
+     *
+     * @param data The transfer to start
+     */
+    void start_transfer(const i2c_transaction_t *data);
+
+#if TRANSACTION_QUEUE_SIZE_I2C
+    /** Queue a transfer until the bus is free
+     *
+     * @param data The transfer to queue
+     * @return Zero if the transfer was queued, or -1 if the queue is full
+     */
+    int queue_transfer(const i2c_transaction_t &data);
+
+    /** Start the next queued transfer of the bus, if any, unless the bus is busy */
+    void dequeue_transaction();
+#endif
+
+    /** Check if a transfer is ongoing on the bus, asynchronous or blocking */
+    bool bus_active();
+
     /** Lock deep sleep only if it is not yet locked */
     void lock_deep_sleep();
 
@@ -192,12 +272,73 @@ public:
 #endif
 
 protected:
+    /** State of one physical I2C bus, shared by all objects using it */
+    struct i2c_peripheral_s {
+        /* Peripheral name where the HAL provides it, SCL pin otherwise */
+        int name;
+        /* Number of I2C objects on this bus */
+        int users;
+        /* Object the bus is currently configured for */
+        I2C *owner;
+        /* Used by lock and unlock for thread safety */
+        SingletonPtr<PlatformMutex> mutex;
+#if DEVICE_I2C_ASYNCH
+        /* Object whose asynchronous transfer is in flight, cleared by its interrupt */
+        I2C *active;
+        /* Number of blocking transfers using the bus */
+        int held;
+        /* Set between start() and stop(), the transaction holds the bus */
+        bool started;
+#if defined(MBED_CONF_RTOS_PRESENT)
+        /* Blocking calls waiting for the bus, woken when it becomes free */
+        int waiting;
+        SingletonPtr<rtos::Semaphore> bus_free;
+#endif
+#endif
+#if DEVICE_I2C_ASYNCH && TRANSACTION_QUEUE_SIZE_I2C
+        /* Transfers waiting for the bus */
+        SingletonPtr<CircularBuffer<Transaction<I2C, i2c_transaction_t>, TRANSACTION_QUEUE_SIZE_I2C> > transaction_buffer;
+#endif
+    };
+
     void aquire();
 
     i2c_t _i2c;
-    static I2C  *_owner;
+    static i2c_peripheral_s _peripherals[I2C_PERIPHERALS_USED];
+    i2c_peripheral_s *_peripheral;
     int         _hz;
-    static SingletonPtr<PlatformMutex> _mutex;
+
+private:
+    /* Private acquire function without locking/unlocking */
+    void _acquire();
+
+    /* Hold the bus for a blocking transfer, waiting for the asynchronous
+     * transfers on it with an RTOS. Returns false if the bus stayed busy.
+     * Must be called with the mutex held.
+     */
+    bool _claim_bus();
+
+    /* Hold the bus if no transfer is in flight on it, without waiting.
+     * Must be called with the mutex held.
+     */
+    bool _try_claim_bus();
+
+    /* Release the bus held by _claim_bus or _try_claim_bus and start the
+     * transfers queued meanwhile
+     */
+    void _release_bus();
+
+#if DEVICE_I2C_ASYNCH
+    /* Wake a blocking call waiting for the bus if it is free.
+     * Must be called from a critical section or interrupt context.
+     */
+    void _wake_bus_waiter();
+#endif
+
+    /* Find the state of the given bus, or claim a free slot for it.
+     * Returns NULL if more than I2C_PERIPHERALS_USED buses are in use.
+     */
+    static i2c_peripheral_s *_lookup_peripheral(int name);
 };
 
 } // namespace mbed
@@ -15,6 +15,7 @@
  */
 #include "drivers/SPI.h"
 #include "platform/mbed_critical.h"
+#include "platform/mbed_error.h"
 
 #if DEVICE_SPI_ASYNCH
 #include "platform/mbed_power_mgmt.h"
@@ -24,9 +25,7 @@
 
 namespace mbed {
 
-#if DEVICE_SPI_ASYNCH && TRANSACTION_QUEUE_SIZE_SPI
-CircularBuffer<Transaction<SPI>, TRANSACTION_QUEUE_SIZE_SPI> SPI::_transaction_buffer;
-#endif
+SPI::spi_peripheral_s SPI::_peripherals[SPI_PERIPHERALS_USED];
 
 SPI::SPI(PinName mosi, PinName miso, PinName sclk, PinName ssel) :
         _spi(),
@@ -39,10 +38,89 @@ SPI::SPI(PinName mosi, PinName miso, PinName sclk, PinName ssel) :
         _mode(0),
         _hz(1000000),
         _write_fill(SPI_FILL_CHAR) {
-    // No lock needed in the constructor
+#if DEVICE_SPI_COUNT
+    int name = spi_get_peripheral_name(mosi, miso, sclk);
+#else
+    // Objects on the same bus share the clock line
+    int name = sclk;
+#endif
+
+    core_util_critical_section_enter();
+    _peripheral = _lookup_peripheral(name);
+    if (_peripheral) {
+        _peripheral->users++;
+    }
+    core_util_critical_section_exit();
+
+    if (!_peripheral) {
+        error("SPI: more buses in use than drivers.spi-count-max\r\n");
+    }
+
+#if DEVICE_SPI_ASYNCH && TRANSACTION_QUEUE_SIZE_SPI
+    // Create the queue up front, it is also used from interrupt context
+    _peripheral->transaction_buffer.get();
+#endif
+#if DEVICE_SPI_ASYNCH && defined(MBED_CONF_RTOS_PRESENT)
+    // Same for the semaphore released by the transfer interrupt
+    _peripheral->bus_free.get();
+#endif
 
     spi_init(&_spi, mosi, miso, sclk, ssel);
-    _acquire();
+
+    // Configure the bus now unless a transfer is in flight on it, this
+    // object then configures it on its first use
+    lock();
+    if (_try_claim_bus()) {
+        _acquire();
+        _release_bus();
+    }
+    unlock();
+}
+
+SPI::~SPI() {
+#if DEVICE_SPI_ASYNCH
+    // A transfer left in flight would keep the bus busy for good
+    abort_transfer();
+#endif
+
+    lock();
+    if (_peripheral->owner == this) {
+        _peripheral->owner = NULL;
+    }
+    unlock();
+
+    core_util_critical_section_enter();
+    _peripheral->users--;
+    core_util_critical_section_exit();
+}
+
+// Note: Must be called from within a critical section
+SPI::spi_peripheral_s *SPI::_lookup_peripheral(int name) {
+    spi_peripheral_s *free_slot = NULL;
+
+    for (int i = 0; i < SPI_PERIPHERALS_USED; i++) {
+        if (_peripherals[i].users > 0 && _peripherals[i].name == name) {
+            return &_peripherals[i];
+        }
+        if (free_slot == NULL && _peripherals[i].users == 0) {
+            free_slot = &_peripherals[i];
+        }
+    }
+
+    if (free_slot == NULL) {
+        return NULL;
+    }
+
+    free_slot->name = name;
+    free_slot->owner = NULL;
+#if DEVICE_SPI_ASYNCH
+    free_slot->active = NULL;
+    free_slot->held = false;
+#if defined(MBED_CONF_RTOS_PRESENT)
+    free_slot->waiting = 0;
+#endif
+#endif
+    return free_slot;
 }
 
 void SPI::format(int bits, int mode) {
@@ -51,11 +129,17 @@ void SPI::format(int bits, int mode) {
     _mode = mode;
     // If changing format while you are the owner then just
     // update format, but if owner is changed then even frequency should be
-    // updated which is done by acquire.
-    if (_owner == this) {
-        spi_format(&_spi, _bits, _mode, 0);
-    } else {
-        _acquire();
+    // updated which is done by acquire. A transfer in flight keeps its
+    // format, the bus is then reconfigured on the next use of this object.
+    if (_try_claim_bus()) {
+        if (_peripheral->owner == this) {
+            spi_format(&_spi, _bits, _mode, 0);
+        } else {
+            _acquire();
+        }
+        _release_bus();
+    } else if (_peripheral->owner == this) {
+        _peripheral->owner = NULL;
     }
     unlock();
 }
@@ -65,60 +149,134 @@ void SPI::frequency(int hz) {
     _hz = hz;
     // If changing format while you are the owner then just
     // update frequency, but if owner is changed then even frequency should be
-    // updated which is done by acquire.
-    if (_owner == this) {
-        spi_frequency(&_spi, _hz);
-    } else {
-        _acquire();
+    // updated which is done by acquire. A transfer in flight keeps its
+    // frequency, the bus is then reconfigured on the next use of this object.
+    if (_try_claim_bus()) {
+        if (_peripheral->owner == this) {
+            spi_frequency(&_spi, _hz);
+        } else {
+            _acquire();
+        }
+        _release_bus();
+    } else if (_peripheral->owner == this) {
+        _peripheral->owner = NULL;
     }
     unlock();
 }
 
-SPI* SPI::_owner = NULL;
-SingletonPtr<PlatformMutex> SPI::_mutex;
-
-// ignore the fact there are multiple physical spis, and always update if it wasn't us last
+// only reconfigure if another object used this bus last
 void SPI::aquire() {
     lock();
-     if (_owner != this) {
-        spi_format(&_spi, _bits, _mode, 0);
-        spi_frequency(&_spi, _hz);
-        _owner = this;
+    if (_claim_bus()) {
+        _acquire();
+        _release_bus();
     }
     unlock();
 }
 
 // Note: Private function with no locking
 void SPI::_acquire() {
-     if (_owner != this) {
+     if (_peripheral->owner != this) {
         spi_format(&_spi, _bits, _mode, 0);
         spi_frequency(&_spi, _hz);
-        _owner = this;
+        _peripheral->owner = this;
+    }
+}
+
+// Note: Private function with no locking
+bool SPI::_try_claim_bus() {
+#if DEVICE_SPI_ASYNCH
+    bool claimed = false;
+    core_util_critical_section_enter();
+    if (!bus_active()) {
+        _peripheral->held = true;
+        claimed = true;
+    }
+    core_util_critical_section_exit();
+    return claimed;
+#else
+    return true;
+#endif
+}
+
+// Note: Private function with no locking
+bool SPI::_claim_bus() {
+#if DEVICE_SPI_ASYNCH && defined(MBED_CONF_RTOS_PRESENT)
+    // Sleep until the interrupt of the transfer in flight frees the bus
+    while (true) {
+        core_util_critical_section_enter();
+        bool claimed = _try_claim_bus();
+        if (!claimed) {
+            _peripheral->waiting++;
+        }
+        core_util_critical_section_exit();
+
+        if (claimed) {
+            return true;
+        }
+
+        int32_t tokens = _peripheral->bus_free->wait(MBED_CONF_DRIVERS_SPI_BUS_WAIT_TIMEOUT);
+
+        core_util_critical_section_enter();
+        _peripheral->waiting--;
+        core_util_critical_section_exit();
+
+        if (tokens <= 0) {
+            return false;
+        }
     }
+#else
+    // Without an RTOS the transfer in flight was started by this context,
+    // which must wait for its callback rather than spin here
+    return _try_claim_bus();
+#endif
+}
+
+// Note: Private function with no locking
+void SPI::_release_bus() {
+#if DEVICE_SPI_ASYNCH
+    core_util_critical_section_enter();
+    _peripheral->held = false;
+#if TRANSACTION_QUEUE_SIZE_SPI
+    dequeue_transaction();
+#endif
+    _wake_bus_waiter();
+    core_util_critical_section_exit();
+#endif
 }
 
 int SPI::write(int value) {
     lock();
+    if (!_claim_bus()) {
+        unlock();
+        return -1;
+    }
     _acquire();
     int ret = spi_master_write(&_spi, value);
+    _release_bus();
     unlock();
     return ret;
 }
 
 int SPI::write(const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length) {
     lock();
+    if (!_claim_bus()) {
+        unlock();
+        return -1;
+    }
     _acquire();
     int ret = spi_master_block_write(&_spi, tx_buffer, tx_length, rx_buffer, rx_length, _write_fill);
+    _release_bus();
     unlock();
     return ret;
 }
 
 void SPI::lock() {
-    _mutex->lock();
+    _peripheral->mutex->lock();
 }
 
 void SPI::unlock() {
-    _mutex->unlock();
+    _peripheral->mutex->unlock();
 }
 
 void SPI::set_default_write_value(char data) {
@@ -131,27 +289,40 @@ void SPI::set_default_write_value(char data) {
 
 int SPI::transfer(const void *tx_buffer, int tx_length, void *rx_buffer, int rx_length, unsigned char bit_width, const event_callback_t& callback, int event)
 {
-    if (spi_active(&_spi)) {
+    core_util_critical_section_enter();
+    if (bus_active()) {
+        core_util_critical_section_exit();
         return queue_transfer(tx_buffer, tx_length, rx_buffer, rx_length, bit_width, callback, event);
     }
+    // Claim the bus before leaving the critical section, a transfer
+    // dequeued from an interrupt could start on it otherwise
+    _peripheral->active = this;
+    core_util_critical_section_exit();
+
     start_transfer(tx_buffer, tx_length, rx_buffer, rx_length, bit_width, callback, event);
     return 0;
 }
 
 void SPI::abort_transfer()
 {
-    spi_abort_asynch(&_spi);
-    unlock_deep_sleep();
+    core_util_critical_section_enter();
+    if (_peripheral->active == this) {
+        spi_abort_asynch(&_spi);
+        _peripheral->active = NULL;
 #if TRANSACTION_QUEUE_SIZE_SPI
-    dequeue_transaction();
+        dequeue_transaction();
 #endif
+        _wake_bus_waiter();
+    }
+    core_util_critical_section_exit();
+    unlock_deep_sleep();
 }
 
 
 void SPI::clear_transfer_buffer()
 {
 #if TRANSACTION_QUEUE_SIZE_SPI
-    _transaction_buffer.reset();
+    _peripheral->transaction_buffer->reset();
 #endif
 }
 
@@ -183,12 +354,12 @@ int SPI::queue_transfer(const void *tx_buffer, int tx_length, void *rx_buffer, i
     t.callback = callback;
     t.width = bit_width;
     Transaction<SPI> transaction(this, t);
-    if (_transaction_buffer.full()) {
+    if (_peripheral->transaction_buffer->full()) {
         return -1; // the buffer is full
     } else {
         core_util_critical_section_enter();
-        _transaction_buffer.push(transaction);
-        if (!spi_active(&_spi)) {
+        _peripheral->transaction_buffer->push(transaction);
+        if (!bus_active()) {
             dequeue_transaction();
         }
         core_util_critical_section_exit();
@@ -202,12 +373,28 @@ int SPI::queue_transfer(const void *tx_buffer, int tx_length, void *rx_buffer, i
 void SPI::start_transfer(const void *tx_buffer, int tx_length, void *rx_buffer, int rx_length, unsigned char bit_width, const event_callback_t& callback, int event)
 {
     lock_deep_sleep();
+    _peripheral->active = this;
     _acquire();
     _callback = callback;
     _irq.callback(&SPI::irq_handler_asynch);
     spi_master_transfer(&_spi, tx_buffer, tx_length, rx_buffer, rx_length, bit_width, _irq.entry(), event , _usage);
 }
 
+bool SPI::bus_active()
+{
+    return _peripheral->active != NULL || _peripheral->held;
+}
+
+// Note: Must be called from a critical section or interrupt context
+void SPI::_wake_bus_waiter()
+{
+#if defined(MBED_CONF_RTOS_PRESENT)
+    if (_peripheral->waiting > 0 && !bus_active()) {
+        _peripheral->bus_free->release();
+    }
+#endif
+}
+
 void SPI::lock_deep_sleep()
 {
     if (_deep_sleep_locked == false) {
@@ -231,10 +418,15 @@ void SPI::start_transaction(transaction_t *data)
     start_transfer(data->tx_buffer, data->tx_length, data->rx_buffer, data->rx_length, data->width, data->callback, data->event);
 }
 
+// Note: Must be called from a critical section or interrupt context
 void SPI::dequeue_transaction()
 {
+    if (bus_active()) {
+        return;
+    }
+
     Transaction<SPI> t;
-    if (_transaction_buffer.pop(t)) {
+    if (_peripheral->transaction_buffer->pop(t)) {
         SPI* obj = t.get_object();
         transaction_t* data = t.get_transaction();
         obj->start_transaction(data);
@@ -246,16 +438,21 @@ void SPI::dequeue_transaction()
 void SPI::irq_handler_asynch(void)
 {
     int event = spi_irq_handler_asynch(&_spi);
+    if (event & (SPI_EVENT_ALL | SPI_EVENT_INTERNAL_TRANSFER_COMPLETE)) {
+        // The transfer is over, the callback may already start the next one
+        _peripheral->active = NULL;
+    }
     if (_callback && (event & SPI_EVENT_ALL)) {
         unlock_deep_sleep();
         _callback.call(event & SPI_EVENT_ALL);
     }
-#if TRANSACTION_QUEUE_SIZE_SPI
     if (event & (SPI_EVENT_ALL | SPI_EVENT_INTERNAL_TRANSFER_COMPLETE)) {
+#if TRANSACTION_QUEUE_SIZE_SPI
         // SPI peripheral is free (event happened), dequeue transaction
         dequeue_transaction();
-    }
 #endif
+        _wake_bus_waiter();
+    }
 }
 
 #endif
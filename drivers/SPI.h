@@ -33,6 +33,22 @@
 #include "platform/Transaction.h"
 #endif
 
+#if DEVICE_SPI_ASYNCH && defined(MBED_CONF_RTOS_PRESENT)
+#include "rtos/Semaphore.h"
+#endif
+
+#if defined (DEVICE_SPI_COUNT)
+#define SPI_PERIPHERALS_USED DEVICE_SPI_COUNT
+#elif defined (MBED_CONF_DRIVERS_SPI_COUNT_MAX)
+#define SPI_PERIPHERALS_USED MBED_CONF_DRIVERS_SPI_COUNT_MAX
+#else
+#define SPI_PERIPHERALS_USED 2
+#endif
+
+#if !defined (MBED_CONF_DRIVERS_SPI_BUS_WAIT_TIMEOUT)
+#define MBED_CONF_DRIVERS_SPI_BUS_WAIT_TIMEOUT 5000
+#endif
+
 namespace mbed {
 /** \addtogroup drivers */
 
@@ -43,6 +59,10 @@ namespace mbed {
  * Most SPI devices will also require Chip Select and Reset signals. These
  * can be controlled using DigitalOut pins
  *
+ * SPI objects sharing a bus share its lock and its transfer queue, and the
+ * bus is only reconfigured when it switches from one object to another.
+ * Objects on different buses do not block each other.
+ *
  * @note Synchronization level: Thread safe
  *
  * Example:
@@ -114,8 +134,12 @@ public:
      *
      *  @param value Data to be sent to the SPI slave
      *
+     *  Waits for the asynchronous transfers on the bus to complete, up to
+     *  drivers.spi-bus-wait-timeout milliseconds. Without an RTOS it does
+     *  not wait.
+     *
      *  @returns
-     *    Response from the SPI slave
+     *    Response from the SPI slave, or -1 if the bus stayed busy
      */
     virtual int write(int value);
 
@@ -125,13 +149,15 @@ public:
      *  tx_length and rx_length. The bytes written will be padded with the
      *  value 0xff.
      *
+     *  Waits for the bus as write(int) does.
+     *
      *  @param tx_buffer Pointer to the byte-array of data to write to the device
      *  @param tx_length Number of bytes to write, may be zero
      *  @param rx_buffer Pointer to the byte-array of data to read from the device
      *  @param rx_length Number of bytes to read, may be zero
      *  @returns
      *      The number of bytes written and read from the device. This is
-     *      maximum of tx_length and rx_length.
+     *      maximum of tx_length and rx_length. -1 if the bus stayed busy.
      */
     virtual int write(const char *tx_buffer, int tx_length, char *rx_buffer, int rx_length);
 
@@ -170,18 +196,14 @@ public:
      */
     template<typename Type>
     int transfer(const Type *tx_buffer, int tx_length, Type *rx_buffer, int rx_length, const event_callback_t& callback, int event = SPI_EVENT_COMPLETE) {
-        if (spi_active(&_spi)) {
-            return queue_transfer(tx_buffer, tx_length, rx_buffer, rx_length, sizeof(Type)*8, callback, event);
-        }
-        start_transfer(tx_buffer, tx_length, rx_buffer, rx_length, sizeof(Type)*8, callback, event);
-        return 0;
+        return transfer((const void *)tx_buffer, tx_length, (void *)rx_buffer, rx_length, sizeof(Type)*8, callback, event);
     }
 
     /** Abort the on-going SPI transfer, and continue with transfer's in the queue if any.
      */
     void abort_transfer();
 
-    /** Clear the transaction buffer
+    /** Clear the transaction buffer of the bus this SPI is on
      */
     void clear_transfer_buffer();
 
@@ -266,16 +288,44 @@ private:
      *
     */
     void dequeue_transaction();
-    static CircularBuffer<Transaction<SPI>, TRANSACTION_QUEUE_SIZE_SPI> _transaction_buffer;
 #endif
 
+    /** Check if a transfer is ongoing on the bus, asynchronous or blocking */
+    bool bus_active();
+
 #endif
 
 public:
-    virtual ~SPI() {
-    }
+    virtual ~SPI();
 
 protected:
+    /** State of one physical SPI bus, shared by all objects using it */
+    struct spi_peripheral_s {
+        /* Peripheral name where the HAL provides it, SCLK pin otherwise */
+        int name;
+        /* Number of SPI objects on this bus */
+        int users;
+        /* Object the bus is currently configured for */
+        SPI *owner;
+        /* Used by lock and unlock for thread safety */
+        SingletonPtr<PlatformMutex> mutex;
+#if DEVICE_SPI_ASYNCH
+        /* Object whose asynchronous transfer is in flight, cleared by its interrupt */
+        SPI *active;
+        /* Set while a blocking transfer or a reconfiguration uses the bus */
+        bool held;
+#if defined(MBED_CONF_RTOS_PRESENT)
+        /* Blocking calls waiting for the bus, woken when it becomes free */
+        int waiting;
+        SingletonPtr<rtos::Semaphore> bus_free;
+#endif
+#endif
+#if DEVICE_SPI_ASYNCH && TRANSACTION_QUEUE_SIZE_SPI
+        /* Transfers waiting for the bus */
+        SingletonPtr<CircularBuffer<Transaction<SPI>, TRANSACTION_QUEUE_SIZE_SPI> > transaction_buffer;
+#endif
+    };
+
     spi_t _spi;
 
 #if DEVICE_SPI_ASYNCH
@@ -286,8 +336,8 @@ protected:
 #endif
 
     void aquire(void);
-    static SPI *_owner;
-    static SingletonPtr<PlatformMutex> _mutex;
+    static spi_peripheral_s _peripherals[SPI_PERIPHERALS_USED];
+    spi_peripheral_s *_peripheral;
     int _bits;
     int _mode;
     int _hz;
@@ -298,6 +348,34 @@ private:
      * Implemented in order to avoid duplicate locking and boost performance
      */
     void _acquire(void);
+
+    /* Hold the bus for a blocking transfer or a reconfiguration, waiting for
+     * the asynchronous transfers on it with an RTOS. Returns false if the bus
+     * stayed busy. Must be called with the mutex held.
+     */
+    bool _claim_bus(void);
+
+    /* Hold the bus if no transfer is in flight on it, without waiting.
+     * Must be called with the mutex held.
+     */
+    bool _try_claim_bus(void);
+
+    /* Release the bus held by _claim_bus or _try_claim_bus and start the
+     * transfers queued meanwhile
+     */
+    void _release_bus(void);
+
+#if DEVICE_SPI_ASYNCH
+    /* Wake a blocking call waiting for the bus if it is free.
+     * Must be called from a critical section or interrupt context.
+     */
+    void _wake_bus_waiter(void);
+#endif
+
+    /* Find the state of the given bus, or claim a free slot for it.
+     * Returns NULL if more than SPI_PERIPHERALS_USED buses are in use.
+     */
+    static spi_peripheral_s *_lookup_peripheral(int name);
 };
 
 } // namespace mbed
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_i2c.h"
+
+TEST_GROUP(I2C)
+{
+    Test_I2C* unit;
+
+    void setup()
+    {
+        unit = new Test_I2C();
+    }
+
+    void teardown()
+    {
+        delete unit;
+    }
+};
+
+TEST(I2C, Create)
+{
+    CHECK(unit != NULL);
+}
+
+TEST(I2C, test_I2C_acquire_per_bus)
+{
+    unit->test_I2C_acquire_per_bus();
+}
+
+TEST(I2C, test_I2C_lock_per_bus)
+{
+    unit->test_I2C_lock_per_bus();
+}
+
+TEST(I2C, test_I2C_transfer_queue)
+{
+    unit->test_I2C_transfer_queue();
+}
+
+TEST(I2C, test_I2C_transfer_queue_per_bus)
+{
+    unit->test_I2C_transfer_queue_per_bus();
+}
+
+TEST(I2C, test_I2C_abort_transfer)
+{
+    unit->test_I2C_abort_transfer();
+}
+
+TEST(I2C, test_I2C_frequency_during_transfer)
+{
+    unit->test_I2C_frequency_during_transfer();
+}
+
+TEST(I2C, test_I2C_blocking_holds_bus)
+{
+    unit->test_I2C_blocking_holds_bus();
+}
+
+TEST(I2C, test_I2C_bus_slots_exhausted)
+{
+    unit->test_I2C_bus_slots_exhausted();
+}
+
+TEST(I2C, test_I2C_blocking_bus_busy)
+{
+    unit->test_I2C_blocking_bus_busy();
+}
@@ -0,0 +1,289 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_i2c.h"
+#include "drivers/I2C.h"
+#include "i2c_api_stub.h"
+#include "mbed_error_stub.h"
+
+using namespace mbed;
+
+class I2CTest : public I2C {
+public:
+    I2CTest(PinName sda, PinName scl) : I2C(sda, scl)
+    {
+    }
+
+    bool bus_locked()
+    {
+        return _peripheral->mutex->locked();
+    }
+
+    bool shares_bus_with(const I2CTest &other) const
+    {
+        return _peripheral == other._peripheral;
+    }
+
+    i2c_t *hal()
+    {
+        return &_i2c;
+    }
+};
+
+static int completed;
+static int last_event;
+
+static void on_transfer(int event)
+{
+    completed++;
+    last_event = event;
+}
+
+static I2CTest *concurrent_i2c;
+static char concurrent_rx[2];
+
+// Stands for a transfer started by another thread during a blocking write
+static void start_concurrent_transfer()
+{
+    static char reg = 0x0F;
+    LONGS_EQUAL(0, concurrent_i2c->transfer(0x30, &reg, 1, concurrent_rx, 2, on_transfer));
+    LONGS_EQUAL(0, i2c_api_stub::transfer_count);
+}
+
+Test_I2C::Test_I2C()
+{
+    i2c_api_stub::reset();
+    completed = 0;
+    last_event = 0;
+}
+
+Test_I2C::~Test_I2C()
+{
+}
+
+void Test_I2C::test_I2C_acquire_per_bus()
+{
+    char data[2] = { 0x01, 0x02 };
+    I2CTest temp(I2C1_SDA, I2C1_SCL);
+    I2CTest accel(I2C1_SDA, I2C1_SCL);
+    I2CTest pmic(I2C2_SDA, I2C2_SCL);
+
+    CHECK(temp.shares_bus_with(accel));
+    CHECK(!temp.shares_bus_with(pmic));
+
+    temp.frequency(400000);
+    accel.frequency(100000);
+    pmic.frequency(1000000);
+
+    // accel set I2C1 up last, pmic still owns I2C2
+    i2c_api_stub::reset();
+    LONGS_EQUAL(0, pmic.write(0x90, data, sizeof(data)));
+    LONGS_EQUAL(0, accel.write(0x30, data, sizeof(data)));
+    LONGS_EQUAL(0, i2c_api_stub::frequency_count);
+
+    LONGS_EQUAL(0, temp.read(0x48, data, sizeof(data)));
+    LONGS_EQUAL(1, i2c_api_stub::frequency_count);
+    LONGS_EQUAL(400000, temp.hal()->i2c.hz);
+}
+
+void Test_I2C::test_I2C_lock_per_bus()
+{
+    I2CTest temp(I2C1_SDA, I2C1_SCL);
+    I2CTest accel(I2C1_SDA, I2C1_SCL);
+    I2CTest pmic(I2C2_SDA, I2C2_SCL);
+
+    temp.lock();
+    CHECK(accel.bus_locked());
+    CHECK(!pmic.bus_locked());
+    temp.unlock();
+    CHECK(!accel.bus_locked());
+}
+
+void Test_I2C::test_I2C_transfer_queue()
+{
+    char reg = 0x0F;
+    char rx[3][2];
+    I2CTest temp(I2C1_SDA, I2C1_SCL);
+    I2CTest accel(I2C1_SDA, I2C1_SCL);
+
+    LONGS_EQUAL(0, temp.transfer(0x48, &reg, 1, rx[0], 2, on_transfer));
+    LONGS_EQUAL(0, accel.transfer(0x30, &reg, 1, rx[1], 2, on_transfer, I2C_EVENT_ALL, true));
+    LONGS_EQUAL(0, temp.transfer(0x4A, &reg, 1, rx[2], 2, on_transfer));
+    LONGS_EQUAL(-1, accel.transfer(0x32, &reg, 1, rx[2], 2, on_transfer));
+    LONGS_EQUAL(1, i2c_api_stub::transfer_count);
+
+    // Each completion starts the next transfer, in order
+    i2c_api_stub::complete_transfer(temp.hal(), I2C_EVENT_TRANSFER_COMPLETE);
+    LONGS_EQUAL(1, completed);
+    LONGS_EQUAL(I2C_EVENT_TRANSFER_COMPLETE, last_event);
+    LONGS_EQUAL(2, i2c_api_stub::transfer_count);
+    POINTERS_EQUAL(accel.hal(), i2c_api_stub::last_transfer);
+    LONGS_EQUAL(0x30, accel.hal()->i2c.address);
+
+    i2c_api_stub::complete_transfer(accel.hal(), I2C_EVENT_ERROR_NO_SLAVE);
+    LONGS_EQUAL(2, completed);
+    LONGS_EQUAL(I2C_EVENT_ERROR_NO_SLAVE, last_event);
+    LONGS_EQUAL(3, i2c_api_stub::transfer_count);
+    POINTERS_EQUAL(temp.hal(), i2c_api_stub::last_transfer);
+    LONGS_EQUAL(0x4A, temp.hal()->i2c.address);
+
+    i2c_api_stub::complete_transfer(temp.hal(), I2C_EVENT_TRANSFER_COMPLETE);
+    LONGS_EQUAL(3, completed);
+    LONGS_EQUAL(3, i2c_api_stub::transfer_count);
+
+    // The bus is idle again
+    LONGS_EQUAL(0, accel.transfer(0x32, &reg, 1, rx[2], 2, on_transfer));
+    LONGS_EQUAL(4, i2c_api_stub::transfer_count);
+    i2c_api_stub::complete_transfer(accel.hal(), I2C_EVENT_TRANSFER_COMPLETE);
+}
+
+void Test_I2C::test_I2C_transfer_queue_per_bus()
+{
+    char reg = 0x0F;
+    char rx[2];
+    I2CTest temp(I2C1_SDA, I2C1_SCL);
+    I2CTest pmic(I2C2_SDA, I2C2_SCL);
+
+    LONGS_EQUAL(0, temp.transfer(0x48, &reg, 1, rx, 2, on_transfer));
+    LONGS_EQUAL(0, pmic.transfer(0x90, &reg, 1, rx, 2, on_transfer));
+    LONGS_EQUAL(2, i2c_api_stub::transfer_count);
+    POINTERS_EQUAL(pmic.hal(), i2c_api_stub::last_transfer);
+
+    i2c_api_stub::complete_transfer(pmic.hal(), I2C_EVENT_TRANSFER_COMPLETE);
+    i2c_api_stub::complete_transfer(temp.hal(), I2C_EVENT_TRANSFER_COMPLETE);
+    LONGS_EQUAL(2, completed);
+}
+
+void Test_I2C::test_I2C_abort_transfer()
+{
+    char reg = 0x0F;
+    char rx[2];
+    I2CTest temp(I2C1_SDA, I2C1_SCL);
+    I2CTest accel(I2C1_SDA, I2C1_SCL);
+
+    LONGS_EQUAL(0, temp.transfer(0x48, &reg, 1, rx, 2, on_transfer));
+    LONGS_EQUAL(0, accel.transfer(0x30, &reg, 1, rx, 2, on_transfer));
+
+    // Aborting moves on to the queued transfer
+    temp.abort_transfer();
+    LONGS_EQUAL(2, i2c_api_stub::transfer_count);
+    POINTERS_EQUAL(accel.hal(), i2c_api_stub::last_transfer);
+
+    LONGS_EQUAL(0, temp.transfer(0x48, &reg, 1, rx, 2, on_transfer));
+    accel.abort_all_transfers();
+    LONGS_EQUAL(2, i2c_api_stub::transfer_count);
+    LONGS_EQUAL(0, completed);
+}
+
+void Test_I2C::test_I2C_frequency_during_transfer()
+{
+    char reg = 0x0F;
+    char rx[2];
+    I2CTest temp(I2C1_SDA, I2C1_SCL);
+
+    LONGS_EQUAL(0, temp.transfer(0x48, &reg, 1, rx, 2, on_transfer));
+
+    // Neither a new object nor a frequency change takes the busy bus
+    I2CTest accel(I2C1_SDA, I2C1_SCL);
+    accel.frequency(400000);
+    temp.frequency(1000000);
+    LONGS_EQUAL(0, i2c_api_stub::frequency_count);
+
+    LONGS_EQUAL(0, accel.transfer(0x30, &reg, 1, rx, 2, on_transfer));
+    LONGS_EQUAL(1, i2c_api_stub::transfer_count);
+
+    // The queued transfer runs at the frequency set meanwhile
+    i2c_api_stub::complete_transfer(temp.hal(), I2C_EVENT_TRANSFER_COMPLETE);
+    LONGS_EQUAL(2, i2c_api_stub::transfer_count);
+    LONGS_EQUAL(1, i2c_api_stub::frequency_count);
+    LONGS_EQUAL(400000, accel.hal()->i2c.hz);
+    i2c_api_stub::complete_transfer(accel.hal(), I2C_EVENT_TRANSFER_COMPLETE);
+    LONGS_EQUAL(2, completed);
+
+    LONGS_EQUAL(0, temp.read(0x48, rx, sizeof(rx)));
+    LONGS_EQUAL(1000000, temp.hal()->i2c.hz);
+}
+
+void Test_I2C::test_I2C_blocking_holds_bus()
+{
+    char data[2] = { 0x01, 0x02 };
+    I2CTest temp(I2C1_SDA, I2C1_SCL);
+    I2CTest accel(I2C1_SDA, I2C1_SCL);
+
+    // A transfer requested during a blocking write waits for it to finish
+    concurrent_i2c = &accel;
+    i2c_api_stub::on_write = start_concurrent_transfer;
+    LONGS_EQUAL(0, temp.write(0x48, data, sizeof(data)));
+    i2c_api_stub::on_write = NULL;
+    LONGS_EQUAL(1, i2c_api_stub::transfer_count);
+    POINTERS_EQUAL(accel.hal(), i2c_api_stub::last_transfer);
+    i2c_api_stub::complete_transfer(accel.hal(), I2C_EVENT_TRANSFER_COMPLETE);
+
+    // So does one requested between start() and stop(), repeated starts
+    // included
+    i2c_api_stub::reset();
+    temp.start();
+    temp.write(0x90);
+    temp.start();
+    start_concurrent_transfer();
+    temp.stop();
+    LONGS_EQUAL(1, i2c_api_stub::transfer_count);
+    i2c_api_stub::complete_transfer(accel.hal(), I2C_EVENT_TRANSFER_COMPLETE);
+    LONGS_EQUAL(2, completed);
+}
+
+void Test_I2C::test_I2C_bus_slots_exhausted()
+{
+    I2CTest temp(I2C1_SDA, I2C1_SCL);
+    I2CTest pmic(I2C2_SDA, I2C2_SCL);
+
+    // More buses than slots is a configuration error
+    mbed_error_stub::count = 0;
+    CHECK_THROWS(mbed_error_stub::fatal_error, I2CTest extra(I2C3_SDA, I2C3_SCL));
+    LONGS_EQUAL(1, mbed_error_stub::count);
+
+    // Slots are released with their last user
+    {
+        I2CTest pmic2(I2C2_SDA, I2C2_SCL);
+        CHECK(pmic2.shares_bus_with(pmic));
+    }
+}
+
+void Test_I2C::test_I2C_blocking_bus_busy()
+{
+    char reg = 0x0F;
+    char rx[2];
+    I2CTest temp(I2C1_SDA, I2C1_SCL);
+    I2CTest accel(I2C1_SDA, I2C1_SCL);
+
+    LONGS_EQUAL(0, accel.transfer(0x30, &reg, 1, rx, 2, on_transfer));
+
+    // Without an RTOS nothing can free the bus while the caller waits
+    LONGS_EQUAL(-1, temp.write(0x48, &reg, 1));
+    LONGS_EQUAL(-1, temp.read(0x48, rx, sizeof(rx)));
+    LONGS_EQUAL(0, i2c_api_stub::frequency_count);
+    CHECK(!temp.bus_locked());
+
+    // No start condition, so stop() does not release a bus it never held
+    temp.start();
+    temp.stop();
+
+    i2c_api_stub::complete_transfer(accel.hal(), I2C_EVENT_TRANSFER_COMPLETE);
+    LONGS_EQUAL(1, completed);
+    LONGS_EQUAL(0, temp.write(0x48, &reg, 1));
+    LONGS_EQUAL(0, temp.read(0x48, rx, sizeof(rx)));
+}
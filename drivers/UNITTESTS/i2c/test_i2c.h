@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TEST_I2C_H
+#define TEST_I2C_H
+
+class Test_I2C
+{
+public:
+    Test_I2C();
+
+    virtual ~Test_I2C();
+
+    void test_I2C_acquire_per_bus();
+
+    void test_I2C_lock_per_bus();
+
+    void test_I2C_transfer_queue();
+
+    void test_I2C_transfer_queue_per_bus();
+
+    void test_I2C_abort_transfer();
+
+    void test_I2C_frequency_during_transfer();
+
+    void test_I2C_blocking_holds_bus();
+
+    void test_I2C_bus_slots_exhausted();
+
+    void test_I2C_blocking_bus_busy();
+};
+
+#endif // TEST_I2C_H
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_spi.h"
+
+TEST_GROUP(SPI)
+{
+    Test_SPI* unit;
+
+    void setup()
+    {
+        unit = new Test_SPI();
+    }
+
+    void teardown()
+    {
+        delete unit;
+    }
+};
+
+TEST(SPI, Create)
+{
+    CHECK(unit != NULL);
+}
+
+TEST(SPI, test_SPI_acquire_per_bus)
+{
+    unit->test_SPI_acquire_per_bus();
+}
+
+TEST(SPI, test_SPI_format_owner)
+{
+    unit->test_SPI_format_owner();
+}
+
+TEST(SPI, test_SPI_lock_per_bus)
+{
+    unit->test_SPI_lock_per_bus();
+}
+
+TEST(SPI, test_SPI_transfer_queue_per_bus)
+{
+    unit->test_SPI_transfer_queue_per_bus();
+}
+
+TEST(SPI, test_SPI_bus_slots_exhausted)
+{
+    unit->test_SPI_bus_slots_exhausted();
+}
+
+TEST(SPI, test_SPI_format_during_transfer)
+{
+    unit->test_SPI_format_during_transfer();
+}
+
+TEST(SPI, test_SPI_blocking_write_holds_bus)
+{
+    unit->test_SPI_blocking_write_holds_bus();
+}
+
+TEST(SPI, test_SPI_blocking_write_bus_busy)
+{
+    unit->test_SPI_blocking_write_bus_busy();
+}
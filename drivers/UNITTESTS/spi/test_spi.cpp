@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_spi.h"
+#include "drivers/SPI.h"
+#include "spi_api_stub.h"
+#include "mbed_error_stub.h"
+
+using namespace mbed;
+
+class SPITest : public SPI {
+public:
+    SPITest(PinName mosi, PinName miso, PinName sclk) : SPI(mosi, miso, sclk)
+    {
+    }
+
+    bool bus_locked()
+    {
+        return _peripheral->mutex->locked();
+    }
+
+    bool shares_bus_with(const SPITest &other) const
+    {
+        return _peripheral == other._peripheral;
+    }
+
+    spi_t *hal()
+    {
+        return &_spi;
+    }
+};
+
+static int callback_events[2];
+
+static void on_transfer_0(int event)
+{
+    callback_events[0] = event;
+}
+
+static void on_transfer_1(int event)
+{
+    callback_events[1] = event;
+}
+
+static SPITest *concurrent_spi;
+static uint8_t concurrent_buffer[4];
+
+// Stands for a transfer started by another thread during a blocking write
+static void start_concurrent_transfer()
+{
+    LONGS_EQUAL(0, concurrent_spi->transfer(concurrent_buffer, sizeof(concurrent_buffer),
+                                            concurrent_buffer, sizeof(concurrent_buffer),
+                                            on_transfer_1));
+    LONGS_EQUAL(0, spi_api_stub::transfer_count);
+}
+
+Test_SPI::Test_SPI()
+{
+    spi_api_stub::reset();
+    callback_events[0] = 0;
+    callback_events[1] = 0;
+}
+
+Test_SPI::~Test_SPI()
+{
+}
+
+void Test_SPI::test_SPI_acquire_per_bus()
+{
+    SPITest sd(SPI1_MOSI, SPI1_MISO, SPI1_SCLK);
+    SPITest flash(SPI1_MOSI, SPI1_MISO, SPI1_SCLK);
+    SPITest radio(SPI2_MOSI, SPI2_MISO, SPI2_SCLK);
+
+    CHECK(sd.shares_bus_with(flash));
+    CHECK(!sd.shares_bus_with(radio));
+
+    // flash was the last one configured on SPI1
+    spi_api_stub::reset();
+    sd.write(0x55);
+    LONGS_EQUAL(1, spi_api_stub::format_count);
+    LONGS_EQUAL(1, spi_api_stub::frequency_count);
+
+    // radio still owns SPI2, SD card traffic on SPI1 does not change that
+    spi_api_stub::reset();
+    radio.write(0x55);
+    sd.write(0x55);
+    radio.write(0x55);
+    LONGS_EQUAL(0, spi_api_stub::format_count);
+    LONGS_EQUAL(0, spi_api_stub::frequency_count);
+
+    spi_api_stub::reset();
+    flash.write(0x55);
+    LONGS_EQUAL(1, spi_api_stub::format_count);
+    LONGS_EQUAL(1, spi_api_stub::frequency_count);
+}
+
+void Test_SPI::test_SPI_format_owner()
+{
+    SPITest sd(SPI1_MOSI, SPI1_MISO, SPI1_SCLK);
+    SPITest radio(SPI2_MOSI, SPI2_MISO, SPI2_SCLK);
+
+    spi_api_stub::reset();
+    sd.frequency(8000000);
+    LONGS_EQUAL(0, spi_api_stub::format_count);
+    LONGS_EQUAL(1, spi_api_stub::frequency_count);
+    LONGS_EQUAL(8000000, sd.hal()->spi.hz);
+
+    radio.format(16, 3);
+    LONGS_EQUAL(1, spi_api_stub::format_count);
+    LONGS_EQUAL(16, radio.hal()->spi.bits);
+    LONGS_EQUAL(3, radio.hal()->spi.mode);
+}
+
+void Test_SPI::test_SPI_lock_per_bus()
+{
+    SPITest sd(SPI1_MOSI, SPI1_MISO, SPI1_SCLK);
+    SPITest flash(SPI1_MOSI, SPI1_MISO, SPI1_SCLK);
+    SPITest radio(SPI2_MOSI, SPI2_MISO, SPI2_SCLK);
+
+    sd.lock();
+    CHECK(sd.bus_locked());
+    CHECK(flash.bus_locked());
+    CHECK(!radio.bus_locked());
+    sd.unlock();
+
+    radio.lock();
+    CHECK(!sd.bus_locked());
+    CHECK(radio.bus_locked());
+    radio.unlock();
+}
+
+void Test_SPI::test_SPI_transfer_queue_per_bus()
+{
+    uint8_t tx[4] = { 1, 2, 3, 4 };
+    uint8_t rx[4];
+    SPITest sd(SPI1_MOSI, SPI1_MISO, SPI1_SCLK);
+    SPITest flash(SPI1_MOSI, SPI1_MISO, SPI1_SCLK);
+    SPITest radio(SPI2_MOSI, SPI2_MISO, SPI2_SCLK);
+
+    LONGS_EQUAL(0, sd.transfer(tx, sizeof(tx), rx, sizeof(rx), on_transfer_0));
+    LONGS_EQUAL(1, spi_api_stub::transfer_count);
+
+    // SPI1 is busy, flash waits in the SPI1 queue
+    LONGS_EQUAL(0, flash.transfer(tx, sizeof(tx), rx, sizeof(rx), on_transfer_1));
+    LONGS_EQUAL(1, spi_api_stub::transfer_count);
+
+    // SPI2 is idle, the radio goes straight through
+    LONGS_EQUAL(0, radio.transfer(tx, sizeof(tx), rx, sizeof(rx), on_transfer_1));
+    LONGS_EQUAL(2, spi_api_stub::transfer_count);
+    POINTERS_EQUAL(radio.hal(), spi_api_stub::last_transfer);
+
+    // Fill up the SPI1 queue
+    LONGS_EQUAL(0, sd.transfer(tx, sizeof(tx), rx, sizeof(rx), on_transfer_0));
+    LONGS_EQUAL(-1, sd.transfer(tx, sizeof(tx), rx, sizeof(rx), on_transfer_0));
+
+    // Completing the SD transfer starts the queued flash transfer
+    spi_api_stub::complete_transfer(sd.hal(), SPI_EVENT_COMPLETE);
+    LONGS_EQUAL(SPI_EVENT_COMPLETE, callback_events[0]);
+    LONGS_EQUAL(3, spi_api_stub::transfer_count);
+    POINTERS_EQUAL(flash.hal(), spi_api_stub::last_transfer);
+
+    spi_api_stub::complete_transfer(radio.hal(), SPI_EVENT_COMPLETE);
+    LONGS_EQUAL(SPI_EVENT_COMPLETE, callback_events[1]);
+    LONGS_EQUAL(3, spi_api_stub::transfer_count);
+
+    spi_api_stub::complete_transfer(flash.hal(), SPI_EVENT_COMPLETE);
+    LONGS_EQUAL(4, spi_api_stub::transfer_count);
+    POINTERS_EQUAL(sd.hal(), spi_api_stub::last_transfer);
+
+    spi_api_stub::complete_transfer(sd.hal(), SPI_EVENT_COMPLETE);
+    LONGS_EQUAL(4, spi_api_stub::transfer_count);
+}
+
+void Test_SPI::test_SPI_bus_slots_exhausted()
+{
+    SPITest sd(SPI1_MOSI, SPI1_MISO, SPI1_SCLK);
+    SPITest radio(SPI2_MOSI, SPI2_MISO, SPI2_SCLK);
+
+    // More buses than slots is a configuration error
+    mbed_error_stub::count = 0;
+    CHECK_THROWS(mbed_error_stub::fatal_error, SPITest extra(SPI3_MOSI, SPI3_MISO, SPI3_SCLK));
+    LONGS_EQUAL(1, mbed_error_stub::count);
+
+    // Slots are released with their last user
+    {
+        SPITest radio2(SPI2_MOSI, SPI2_MISO, SPI2_SCLK);
+        CHECK(radio2.shares_bus_with(radio));
+    }
+}
+
+void Test_SPI::test_SPI_format_during_transfer()
+{
+    uint8_t tx[4] = { 1, 2, 3, 4 };
+    uint8_t rx[4];
+    SPITest sd(SPI1_MOSI, SPI1_MISO, SPI1_SCLK);
+    SPITest flash(SPI1_MOSI, SPI1_MISO, SPI1_SCLK);
+
+    LONGS_EQUAL(0, sd.transfer(tx, sizeof(tx), rx, sizeof(rx), on_transfer_0));
+
+    // Neither object may reconfigure SPI1 under the transfer in flight
+    spi_api_stub::reset();
+    flash.format(16, 1);
+    flash.frequency(2000000);
+    sd.frequency(4000000);
+    LONGS_EQUAL(0, spi_api_stub::format_count);
+    LONGS_EQUAL(0, spi_api_stub::frequency_count);
+
+    spi_api_stub::complete_transfer(sd.hal(), SPI_EVENT_COMPLETE);
+    LONGS_EQUAL(SPI_EVENT_COMPLETE, callback_events[0]);
+
+    // The new settings apply on the next use of each object
+    flash.write(0x55);
+    LONGS_EQUAL(16, flash.hal()->spi.bits);
+    LONGS_EQUAL(1, flash.hal()->spi.mode);
+    LONGS_EQUAL(2000000, flash.hal()->spi.hz);
+
+    spi_api_stub::reset();
+    sd.write(0x55);
+    LONGS_EQUAL(1, spi_api_stub::frequency_count);
+    LONGS_EQUAL(4000000, sd.hal()->spi.hz);
+
+    // The owner of an idle bus still reconfigures it right away
+    spi_api_stub::reset();
+    sd.frequency(8000000);
+    LONGS_EQUAL(0, spi_api_stub::format_count);
+    LONGS_EQUAL(1, spi_api_stub::frequency_count);
+}
+
+void Test_SPI::test_SPI_blocking_write_holds_bus()
+{
+    char tx[4] = { 1, 2, 3, 4 };
+    char rx[4];
+    SPITest sd(SPI1_MOSI, SPI1_MISO, SPI1_SCLK);
+    SPITest flash(SPI1_MOSI, SPI1_MISO, SPI1_SCLK);
+
+    // A transfer requested during a blocking write waits for it to finish
+    concurrent_spi = &sd;
+    spi_api_stub::on_block_write = start_concurrent_transfer;
+    LONGS_EQUAL(4, flash.write(tx, sizeof(tx), rx, sizeof(rx)));
+    spi_api_stub::on_block_write = NULL;
+    LONGS_EQUAL(1, spi_api_stub::transfer_count);
+    POINTERS_EQUAL(sd.hal(), spi_api_stub::last_transfer);
+
+    // Aborting the transfer frees the bus
+    sd.abort_transfer();
+    spi_api_stub::reset();
+    LONGS_EQUAL(0, flash.transfer(tx, sizeof(tx), rx, sizeof(rx), on_transfer_1));
+    LONGS_EQUAL(1, spi_api_stub::transfer_count);
+    POINTERS_EQUAL(flash.hal(), spi_api_stub::last_transfer);
+    spi_api_stub::complete_transfer(flash.hal(), SPI_EVENT_COMPLETE);
+}
+
+void Test_SPI::test_SPI_blocking_write_bus_busy()
+{
+    char tx[4] = { 1, 2, 3, 4 };
+    char rx[4];
+    SPITest sd(SPI1_MOSI, SPI1_MISO, SPI1_SCLK);
+    SPITest flash(SPI1_MOSI, SPI1_MISO, SPI1_SCLK);
+
+    LONGS_EQUAL(0, sd.transfer(tx, sizeof(tx), rx, sizeof(rx), on_transfer_0));
+
+    // Without an RTOS nothing can free the bus while the caller waits
+    spi_api_stub::reset();
+    LONGS_EQUAL(-1, flash.write(0x55));
+    LONGS_EQUAL(-1, flash.write(tx, sizeof(tx), rx, sizeof(rx)));
+    LONGS_EQUAL(0, spi_api_stub::format_count);
+    CHECK(!flash.bus_locked());
+
+    spi_api_stub::complete_transfer(sd.hal(), SPI_EVENT_COMPLETE);
+    LONGS_EQUAL(0x55, flash.write(0x55));
+    LONGS_EQUAL(4, flash.write(tx, sizeof(tx), rx, sizeof(rx)));
+}
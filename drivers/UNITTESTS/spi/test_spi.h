@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TEST_SPI_H
+#define TEST_SPI_H
+
+class Test_SPI
+{
+public:
+    Test_SPI();
+
+    virtual ~Test_SPI();
+
+    void test_SPI_acquire_per_bus();
+
+    void test_SPI_format_owner();
+
+    void test_SPI_lock_per_bus();
+
+    void test_SPI_transfer_queue_per_bus();
+
+    void test_SPI_bus_slots_exhausted();
+
+    void test_SPI_format_during_transfer();
+
+    void test_SPI_blocking_write_holds_bus();
+
+    void test_SPI_blocking_write_bus_busy();
+};
+
+#endif // TEST_SPI_H
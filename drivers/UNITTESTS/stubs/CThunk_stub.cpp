@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "platform/CThunk.h"
+
+#define CTHUNK_STUB_MAX 16
+
+static CThunkBase *thunks[CTHUNK_STUB_MAX];
+
+uint32_t CThunk_stub::add(CThunkBase *thunk)
+{
+    for (uint32_t i = 0; i < CTHUNK_STUB_MAX; i++) {
+        if (thunks[i] == thunk || thunks[i] == 0) {
+            thunks[i] = thunk;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+void CThunk_stub::call(uint32_t entry)
+{
+    if (entry > 0 && entry <= CTHUNK_STUB_MAX && thunks[entry - 1]) {
+        thunks[entry - 1]->call();
+    }
+}
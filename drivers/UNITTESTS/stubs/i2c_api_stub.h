@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef I2C_API_STUB_H
+#define I2C_API_STUB_H
+
+#include "hal/i2c_api.h"
+
+namespace i2c_api_stub {
+    extern int frequency_count;
+    extern int transfer_count;
+    extern i2c_t *last_transfer;
+
+    /** Called in the middle of a blocking write when set */
+    extern void (*on_write)();
+
+    /** Clear the call counters */
+    void reset();
+
+    /** Finish the transfer running on obj and run its interrupt handler */
+    void complete_transfer(i2c_t *obj, int event);
+}
+
+#endif // I2C_API_STUB_H
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "spi_api_stub.h"
+#include "platform/CThunk.h"
+
+int spi_api_stub::format_count = 0;
+int spi_api_stub::frequency_count = 0;
+int spi_api_stub::transfer_count = 0;
+spi_t *spi_api_stub::last_transfer = NULL;
+void (*spi_api_stub::on_block_write)() = NULL;
+
+void spi_api_stub::reset()
+{
+    format_count = 0;
+    frequency_count = 0;
+    transfer_count = 0;
+    last_transfer = NULL;
+    on_block_write = NULL;
+}
+
+void spi_api_stub::complete_transfer(spi_t *obj, int event)
+{
+    obj->spi.event = event;
+    CThunk_stub::call(obj->spi.handler);
+}
+
+void spi_init(spi_t *obj, PinName mosi, PinName miso, PinName sclk, PinName ssel)
+{
+    obj->spi.sclk = sclk;
+    obj->spi.active = 0;
+    obj->spi.event = 0;
+}
+
+void spi_free(spi_t *obj)
+{
+}
+
+void spi_format(spi_t *obj, int bits, int mode, int slave)
+{
+    obj->spi.bits = bits;
+    obj->spi.mode = mode;
+    spi_api_stub::format_count++;
+}
+
+void spi_frequency(spi_t *obj, int hz)
+{
+    obj->spi.hz = hz;
+    spi_api_stub::frequency_count++;
+}
+
+int spi_master_write(spi_t *obj, int value)
+{
+    return value;
+}
+
+int spi_master_block_write(spi_t *obj, const char *tx_buffer, int tx_length,
+                           char *rx_buffer, int rx_length, char write_fill)
+{
+    if (spi_api_stub::on_block_write) {
+        spi_api_stub::on_block_write();
+    }
+    return tx_length > rx_length ? tx_length : rx_length;
+}
+
+int spi_busy(spi_t *obj)
+{
+    return obj->spi.active;
+}
+
+uint8_t spi_active(spi_t *obj)
+{
+    return obj->spi.active;
+}
+
+void spi_master_transfer(spi_t *obj, const void *tx, size_t tx_length, void *rx, size_t rx_length,
+                         uint8_t bit_width, uint32_t handler, uint32_t event, DMAUsage hint)
+{
+    obj->spi.active = 1;
+    obj->spi.handler = handler;
+    spi_api_stub::transfer_count++;
+    spi_api_stub::last_transfer = obj;
+}
+
+uint32_t spi_irq_handler_asynch(spi_t *obj)
+{
+    obj->spi.active = 0;
+    return obj->spi.event;
+}
+
+void spi_abort_asynch(spi_t *obj)
+{
+    obj->spi.active = 0;
+}
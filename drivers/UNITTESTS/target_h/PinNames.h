@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __PINNAMES_H__
+#define __PINNAMES_H__
+
+typedef enum {
+    SPI1_MOSI = 0,
+    SPI1_MISO,
+    SPI1_SCLK,
+    SPI2_MOSI,
+    SPI2_MISO,
+    SPI2_SCLK,
+    SPI3_MOSI,
+    SPI3_MISO,
+    SPI3_SCLK,
+    I2C1_SDA,
+    I2C1_SCL,
+    I2C2_SDA,
+    I2C2_SCL,
+    I2C3_SDA,
+    I2C3_SCL,
+
+    NC = (int)0xFFFFFFFF
+} PinName;
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_OBJECTS_H
+#define MBED_OBJECTS_H
+
+#include <stdint.h>
+#include "PinNames.h"
+
+struct spi_s {
+    PinName sclk;
+    int bits;
+    int mode;
+    int hz;
+    int active;
+    int event;
+    uint32_t handler;
+};
+
+struct i2c_s {
+    PinName scl;
+    int hz;
+    int active;
+    int event;
+    int address;
+    uint32_t handler;
+};
+
+#endif
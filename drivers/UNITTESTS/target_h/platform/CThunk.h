@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __CTHUNK_H__
+#define __CTHUNK_H__
+
+#include <stdint.h>
+
+/** Host replacement for the interrupt thunk
+ *
+ * entry() hands out a token instead of a code address, CThunk_stub::call()
+ * turns the token back into the member function call.
+ */
+class CThunkBase {
+public:
+    virtual void call() = 0;
+};
+
+namespace CThunk_stub {
+    uint32_t add(CThunkBase *thunk);
+    void call(uint32_t entry);
+}
+
+template<class T>
+class CThunk : public CThunkBase {
+public:
+    typedef void (T::*CCallbackSimple)(void);
+
+    CThunk(T *instance) : _instance(instance), _callback(0) {
+    }
+
+    void callback(CCallbackSimple callback) {
+        _callback = callback;
+    }
+
+    uint32_t entry(void) {
+        return CThunk_stub::add(this);
+    }
+
+    virtual void call() {
+        (_instance->*_callback)();
+    }
+
+private:
+    T *_instance;
+    CCallbackSimple _callback;
+};
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PLATFORM_MUTEX_H
+#define PLATFORM_MUTEX_H
+
+/** Mutex stub recording its lock depth, so tests can tell which bus is held
+ */
+class PlatformMutex {
+public:
+    PlatformMutex() : _count(0) {
+    }
+
+    void lock() {
+        _count++;
+    }
+
+    void unlock() {
+        _count--;
+    }
+
+    bool locked() const {
+        return _count > 0;
+    }
+
+private:
+    int _count;
+};
+
+#endif
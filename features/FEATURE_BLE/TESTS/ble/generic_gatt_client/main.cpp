@@ -0,0 +1,356 @@
+/*
+* Copyright (c) 2018 ARM Limited. All rights reserved.
+* SPDX-License-Identifier: Apache-2.0
+* Licensed under the Apache License, Version 2.0 (the License); you may
+* not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an AS IS BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+#include "ble/generic/GenericGattClient.h"
+#include "ble/pal/PalGattClient.h"
+
+using namespace utest::v1;
+using namespace ble;
+using ble::generic::GenericGattClient;
+
+namespace {
+
+/*
+ * PAL mock which records the requests sent and lets the test answer them.
+ * Requests are not answered synchronously, as with a real stack.
+ */
+class MockPalGattClient : public pal::GattClient {
+public:
+    enum request_t {
+        NONE,
+        READ,
+        READ_BLOB,
+        READ_MULTIPLE,
+        WRITE,
+        WRITE_COMMAND
+    };
+
+    MockPalGattClient() : mtu(23), outstanding(0), max_outstanding(0),
+        last_request(NONE), last_handle(0), requests(0), commands(0) { }
+
+    void reset_counters() {
+        outstanding = 0;
+        max_outstanding = 0;
+        requests = 0;
+        commands = 0;
+        last_request = NONE;
+    }
+
+    void respond_read(const uint8_t* value, size_t len) {
+        outstanding--;
+        pal::AttReadResponse response(make_const_ArrayView(value, len));
+        on_server_event(CONNECTION, response);
+    }
+
+    void respond_read_multiple(const uint8_t* value, size_t len) {
+        outstanding--;
+        pal::AttReadMultipleResponse response(make_const_ArrayView(value, len));
+        on_server_event(CONNECTION, response);
+    }
+
+    void respond_write() {
+        outstanding--;
+        pal::AttWriteResponse response;
+        on_server_event(CONNECTION, response);
+    }
+
+    void timeout() {
+        outstanding--;
+        on_transaction_timeout(CONNECTION);
+    }
+
+    virtual ble_error_t initialize() { return BLE_ERROR_NONE; }
+    virtual ble_error_t terminate() { return BLE_ERROR_NONE; }
+    virtual ble_error_t exchange_mtu(connection_handle_t) { return BLE_ERROR_NOT_IMPLEMENTED; }
+
+    virtual ble_error_t get_mtu_size(connection_handle_t, uint16_t& mtu_size) {
+        mtu_size = mtu;
+        return BLE_ERROR_NONE;
+    }
+
+    virtual ble_error_t discover_primary_service(connection_handle_t, attribute_handle_t) {
+        return BLE_ERROR_NOT_IMPLEMENTED;
+    }
+
+    virtual ble_error_t discover_primary_service_by_service_uuid(
+        connection_handle_t, attribute_handle_t, const UUID&
+    ) {
+        return BLE_ERROR_NOT_IMPLEMENTED;
+    }
+
+    virtual ble_error_t find_included_service(connection_handle_t, attribute_handle_range_t) {
+        return BLE_ERROR_NOT_IMPLEMENTED;
+    }
+
+    virtual ble_error_t discover_characteristics_of_a_service(
+        connection_handle_t, attribute_handle_range_t
+    ) {
+        return BLE_ERROR_NOT_IMPLEMENTED;
+    }
+
+    virtual ble_error_t discover_characteristics_descriptors(
+        connection_handle_t, attribute_handle_range_t
+    ) {
+        return BLE_ERROR_NOT_IMPLEMENTED;
+    }
+
+    virtual ble_error_t read_attribute_value(connection_handle_t, attribute_handle_t handle) {
+        return request(READ, handle);
+    }
+
+    virtual ble_error_t read_using_characteristic_uuid(
+        connection_handle_t, attribute_handle_range_t, const UUID&
+    ) {
+        return BLE_ERROR_NOT_IMPLEMENTED;
+    }
+
+    virtual ble_error_t read_attribute_blob(connection_handle_t, attribute_handle_t handle, uint16_t) {
+        return request(READ_BLOB, handle);
+    }
+
+    virtual ble_error_t read_multiple_characteristic_values(
+        connection_handle_t, const ArrayView<const attribute_handle_t>& handles
+    ) {
+        return request(READ_MULTIPLE, handles[0]);
+    }
+
+    virtual ble_error_t write_without_response(
+        connection_handle_t, attribute_handle_t handle, const ArrayView<const uint8_t>&
+    ) {
+        last_request = WRITE_COMMAND;
+        last_handle = handle;
+        commands++;
+        return BLE_ERROR_NONE;
+    }
+
+    virtual ble_error_t signed_write_without_response(
+        connection_handle_t, attribute_handle_t, const ArrayView<const uint8_t>&
+    ) {
+        return BLE_ERROR_NOT_IMPLEMENTED;
+    }
+
+    virtual ble_error_t write_attribute(
+        connection_handle_t, attribute_handle_t handle, const ArrayView<const uint8_t>& value
+    ) {
+        last_value = value.size() ? value[0] : 0;
+        return request(WRITE, handle);
+    }
+
+    virtual ble_error_t queue_prepare_write(
+        connection_handle_t, attribute_handle_t, const ArrayView<const uint8_t>&, uint16_t
+    ) {
+        return BLE_ERROR_NOT_IMPLEMENTED;
+    }
+
+    virtual ble_error_t execute_write_queue(connection_handle_t, bool) {
+        return BLE_ERROR_NOT_IMPLEMENTED;
+    }
+
+    static const connection_handle_t CONNECTION = 1;
+
+    uint16_t mtu;
+    int outstanding;
+    int max_outstanding;
+    request_t last_request;
+    attribute_handle_t last_handle;
+    uint8_t last_value;
+    int requests;
+    int commands;
+
+private:
+    ble_error_t request(request_t type, attribute_handle_t handle) {
+        last_request = type;
+        last_handle = handle;
+        requests++;
+        outstanding++;
+        if (outstanding > max_outstanding) {
+            max_outstanding = outstanding;
+        }
+        return BLE_ERROR_NONE;
+    }
+};
+
+MockPalGattClient pal_client;
+GenericGattClient client(&pal_client);
+
+const size_t max_reads = 20;
+GattReadCallbackParams reads[max_reads];
+uint8_t first_bytes[max_reads];
+size_t read_count;
+size_t write_count;
+
+void on_read(const GattReadCallbackParams* params) {
+    if (read_count < max_reads) {
+        reads[read_count] = *params;
+        first_bytes[read_count] = (params->status == BLE_ERROR_NONE) ? params->data[0] : 0;
+    }
+    read_count++;
+}
+
+void on_write(const GattWriteCallbackParams* params) {
+    write_count++;
+}
+
+void setup_client() {
+    client.reset();
+    pal_client.reset_counters();
+    read_count = 0;
+    write_count = 0;
+}
+
+}
+
+static void test_reads_are_queued()
+{
+    setup_client();
+
+    for (size_t i = 0; i < max_reads; ++i) {
+        TEST_ASSERT_EQUAL(BLE_ERROR_NONE, client.read(MockPalGattClient::CONNECTION, 0x10 + i, 0));
+    }
+
+    // only the first read is sent, the others wait for its completion
+    TEST_ASSERT_EQUAL(1, pal_client.requests);
+
+    for (size_t i = 0; i < max_reads; ++i) {
+        TEST_ASSERT_EQUAL(MockPalGattClient::READ, pal_client.last_request);
+        TEST_ASSERT_EQUAL(0x10 + i, pal_client.last_handle);
+        uint8_t value = i;
+        pal_client.respond_read(&value, sizeof(value));
+    }
+
+    TEST_ASSERT_EQUAL(max_reads, read_count);
+    TEST_ASSERT_EQUAL(max_reads, pal_client.requests);
+    TEST_ASSERT_EQUAL(1, pal_client.max_outstanding);
+
+    for (size_t i = 0; i < max_reads; ++i) {
+        TEST_ASSERT_EQUAL(BLE_ERROR_NONE, reads[i].status);
+        TEST_ASSERT_EQUAL(0x10 + i, reads[i].handle);
+        TEST_ASSERT_EQUAL(1, reads[i].len);
+        TEST_ASSERT_EQUAL(i, first_bytes[i]);
+    }
+}
+
+static void test_queued_write_copies_value()
+{
+    setup_client();
+
+    TEST_ASSERT_EQUAL(BLE_ERROR_NONE, client.read(MockPalGattClient::CONNECTION, 0x20, 0));
+
+    uint8_t value = 0xAA;
+    TEST_ASSERT_EQUAL(BLE_ERROR_NONE, client.write(
+        GattClient::GATT_OP_WRITE_REQ, MockPalGattClient::CONNECTION, 0x21, sizeof(value), &value
+    ));
+    value = 0x55;
+
+    pal_client.respond_read(&value, sizeof(value));
+
+    TEST_ASSERT_EQUAL(MockPalGattClient::WRITE, pal_client.last_request);
+    TEST_ASSERT_EQUAL(0x21, pal_client.last_handle);
+    TEST_ASSERT_EQUAL(0xAA, pal_client.last_value);
+
+    pal_client.respond_write();
+    TEST_ASSERT_EQUAL(1, write_count);
+}
+
+static void test_write_commands_bypass_queue()
+{
+    setup_client();
+
+    TEST_ASSERT_EQUAL(BLE_ERROR_NONE, client.read(MockPalGattClient::CONNECTION, 0x30, 0));
+
+    uint8_t value = 0;
+    for (int i = 0; i < 5; ++i) {
+        TEST_ASSERT_EQUAL(BLE_ERROR_NONE, client.write(
+            GattClient::GATT_OP_WRITE_CMD, MockPalGattClient::CONNECTION, 0x31, sizeof(value), &value
+        ));
+    }
+
+    TEST_ASSERT_EQUAL(5, pal_client.commands);
+    TEST_ASSERT_EQUAL(1, pal_client.requests);
+
+    pal_client.respond_read(&value, sizeof(value));
+    TEST_ASSERT_EQUAL(1, read_count);
+}
+
+static void test_read_multiple()
+{
+    setup_client();
+
+    const GattAttribute::Handle_t handles[] = { 0x40, 0x42, 0x44 };
+    TEST_ASSERT_EQUAL(BLE_ERROR_INVALID_PARAM, client.readMultiple(MockPalGattClient::CONNECTION, handles, 1));
+    TEST_ASSERT_EQUAL(BLE_ERROR_NONE, client.readMultiple(MockPalGattClient::CONNECTION, handles, 3));
+
+    TEST_ASSERT_EQUAL(1, pal_client.requests);
+    TEST_ASSERT_EQUAL(MockPalGattClient::READ_MULTIPLE, pal_client.last_request);
+
+    const uint8_t values[] = { 1, 2, 3, 4, 5, 6 };
+    pal_client.respond_read_multiple(values, sizeof(values));
+
+    TEST_ASSERT_EQUAL(1, read_count);
+    TEST_ASSERT_EQUAL(BLE_ERROR_NONE, reads[0].status);
+    TEST_ASSERT_EQUAL(0x40, reads[0].handle);
+    TEST_ASSERT_EQUAL(sizeof(values), reads[0].len);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(values, reads[0].data, sizeof(values));
+}
+
+static void test_timeout_aborts_queue()
+{
+    setup_client();
+
+    for (int i = 0; i < 3; ++i) {
+        TEST_ASSERT_EQUAL(BLE_ERROR_NONE, client.read(MockPalGattClient::CONNECTION, 0x50 + i, 0));
+    }
+
+    pal_client.timeout();
+
+    // every procedure terminates and no new request is sent
+    TEST_ASSERT_EQUAL(3, read_count);
+    TEST_ASSERT_EQUAL(1, pal_client.requests);
+}
+
+utest::v1::status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("GenericGattClient: reads are queued",          test_reads_are_queued,            greentea_failure_handler),
+    Case("GenericGattClient: queued write copies value", test_queued_write_copies_value,   greentea_failure_handler),
+    Case("GenericGattClient: write commands bypass queue", test_write_commands_bypass_queue, greentea_failure_handler),
+    Case("GenericGattClient: read multiple",             test_read_multiple,               greentea_failure_handler),
+    Case("GenericGattClient: timeout aborts queue",      test_timeout_aborts_queue,        greentea_failure_handler),
+};
+
+utest::v1::status_t greentea_test_setup(const size_t number_of_cases)
+{
+    client.onDataRead(on_read);
+    client.onDataWritten(on_write);
+
+    GREENTEA_SETUP(20, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+int main()
+{
+    return !Harness::run(specification);
+}
@@ -0,0 +1,270 @@
+/*
+* Copyright (c) 2018 ARM Limited. All rights reserved.
+* SPDX-License-Identifier: Apache-2.0
+* Licensed under the Apache License, Version 2.0 (the License); you may
+* not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an AS IS BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "mbed.h"
+#include "nvstore.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+#if !NVSTORE_ENABLED
+#error [NOT_SUPPORTED] NVSTORE needs to be enabled for this test
+#endif
+
+#include "ble/pal/NVStoreSecurityDb.h"
+#include "mbedtls/aes.h"
+
+#if !defined(MBEDTLS_AES_C)
+#error [NOT_SUPPORTED] AES required
+#endif
+
+using namespace utest::v1;
+using ble::address_t;
+using ble::irk_t;
+using ble::ltk_t;
+using ble::pal::NVStoreSecurityDb;
+using ble::pal::SecurityDb;
+
+static const size_t lookup_iterations = 1000;
+
+static address_t make_address(uint8_t seed)
+{
+    uint8_t bytes[6] = { 0xC0, 0x01, 0x02, 0x03, 0x04, seed };
+    return address_t(bytes);
+}
+
+static irk_t make_irk(uint8_t seed)
+{
+    uint8_t bytes[16];
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        bytes[i] = seed + i;
+    }
+    return irk_t(bytes);
+}
+
+/* resolvable private address of an IRK, see Core spec Vol 3, Part H, 2.2.2 */
+static address_t make_resolvable_address(const irk_t &irk, uint8_t seed)
+{
+    uint8_t key[16];
+    uint8_t block[16] = { 0 };
+    uint8_t hash[16];
+    uint8_t bytes[6];
+
+    for (size_t i = 0; i < sizeof(key); i++) {
+        key[i] = irk.data()[sizeof(key) - 1 - i];
+    }
+    block[13] = 0x40 | (seed & 0x3F);
+    block[14] = seed;
+    block[15] = 0x5A;
+
+    mbedtls_aes_context aes;
+    mbedtls_aes_init(&aes);
+    mbedtls_aes_setkey_enc(&aes, key, 128);
+    mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_ENCRYPT, block, hash);
+    mbedtls_aes_free(&aes);
+
+    /* least significant byte first */
+    bytes[0] = hash[15];
+    bytes[1] = hash[14];
+    bytes[2] = hash[13];
+    bytes[3] = block[15];
+    bytes[4] = block[14];
+    bytes[5] = block[13];
+    return address_t(bytes);
+}
+
+static void bond(NVStoreSecurityDb &db, uint8_t seed)
+{
+    address_t address = make_address(seed);
+    SecurityDb::entry_handle_t entry =
+        db.open_entry(BLEProtocol::AddressType::RANDOM_STATIC, address);
+    TEST_ASSERT_NOT_NULL(entry);
+
+    db.set_entry_peer_bdaddr(entry, false, address);
+    db.set_entry_peer_irk(entry, make_irk(seed));
+    db.set_entry_peer_ltk(entry, ltk_t(make_irk(seed + 1).data()));
+    db.close_entry(entry);
+}
+
+static void whitelist_cb(::Gap::Whitelist_t *whitelist)
+{
+}
+
+static void test_persistence()
+{
+    TEST_ASSERT_EQUAL(NVSTORE_SUCCESS, NVStore::get_instance().reset());
+
+    {
+        NVStoreSecurityDb db;
+        db.restore();
+        for (size_t i = 0; i < NVStoreSecurityDb::MAX_ENTRIES; i++) {
+            bond(db, i);
+        }
+        db.sync();
+    }
+
+    /* a new instance stands in for a reboot */
+    NVStoreSecurityDb db;
+    db.restore();
+
+    for (size_t i = 0; i < NVStoreSecurityDb::MAX_ENTRIES; i++) {
+        SecurityDb::entry_handle_t by_address = db.find_entry_by_identity(false, make_address(i));
+        SecurityDb::entry_handle_t by_irk = db.find_entry_by_irk(make_irk(i));
+        TEST_ASSERT_NOT_NULL(by_address);
+        TEST_ASSERT_EQUAL_PTR(by_address, by_irk);
+        TEST_ASSERT_EQUAL_PTR(
+            by_address,
+            db.open_entry(BLEProtocol::AddressType::RANDOM_STATIC, make_address(i))
+        );
+    }
+
+    db.remove_entry(make_address(0));
+    TEST_ASSERT_NULL(db.find_entry_by_identity(false, make_address(0)));
+    TEST_ASSERT_NULL(db.find_entry_by_irk(make_irk(0)));
+    TEST_ASSERT_NOT_NULL(db.find_entry_by_identity(false, make_address(1)));
+
+    db.clear_entries();
+    db.sync();
+}
+
+static void test_resolvable_address()
+{
+    NVStoreSecurityDb db;
+    for (size_t i = 0; i < NVStoreSecurityDb::MAX_ENTRIES; i++) {
+        bond(db, i);
+    }
+
+    /* a bonded peer reconnecting with a fresh private address finds its bond */
+    for (size_t i = 0; i < NVStoreSecurityDb::MAX_ENTRIES; i++) {
+        address_t rpa = make_resolvable_address(make_irk(i), 0x10 + i);
+        TEST_ASSERT_EQUAL_PTR(
+            db.find_entry_by_identity(false, make_address(i)),
+            db.open_entry(BLEProtocol::AddressType::RANDOM_PRIVATE_RESOLVABLE, rpa)
+        );
+    }
+
+    /* the table is full, an address of an unknown IRK gets no entry */
+    address_t unknown = make_resolvable_address(make_irk(0xF0), 0x20);
+    TEST_ASSERT_NULL(db.open_entry(BLEProtocol::AddressType::RANDOM_PRIVATE_RESOLVABLE, unknown));
+
+    /* it gets a new entry once a bond is removed */
+    db.remove_entry(make_address(0));
+    SecurityDb::entry_handle_t entry =
+        db.open_entry(BLEProtocol::AddressType::RANDOM_PRIVATE_RESOLVABLE, unknown);
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_NULL(db.find_entry_by_identity(false, unknown));
+    db.close_entry(entry);
+}
+
+static void test_pair_again()
+{
+    NVStoreSecurityDb db;
+    bond(db, 1);
+
+    /* the same device pairs from a new address, only the new bond remains */
+    address_t rpa = make_resolvable_address(make_irk(0x30), 0x01);
+    SecurityDb::entry_handle_t old_entry = db.find_entry_by_identity(false, make_address(1));
+    SecurityDb::entry_handle_t new_entry =
+        db.open_entry(BLEProtocol::AddressType::RANDOM_PRIVATE_RESOLVABLE, rpa);
+    TEST_ASSERT_NOT_NULL(new_entry);
+    TEST_ASSERT_NOT_EQUAL(old_entry, new_entry);
+
+    db.set_entry_peer_bdaddr(new_entry, false, make_address(2));
+    db.set_entry_peer_irk(new_entry, make_irk(1));
+    db.close_entry(new_entry);
+
+    TEST_ASSERT_NULL(db.find_entry_by_identity(false, make_address(1)));
+    TEST_ASSERT_EQUAL_PTR(new_entry, db.find_entry_by_irk(make_irk(1)));
+
+    /* the whitelist holds the identity of each bond */
+    BLEProtocol::Address_t addresses[NVStoreSecurityDb::MAX_ENTRIES];
+    ::Gap::Whitelist_t whitelist;
+    whitelist.addresses = addresses;
+    whitelist.size = 0;
+    whitelist.capacity = NVStoreSecurityDb::MAX_ENTRIES;
+    db.get_whitelist(whitelist_cb, &whitelist);
+
+    TEST_ASSERT_EQUAL(1, whitelist.size);
+    TEST_ASSERT_EQUAL(BLEProtocol::AddressType::RANDOM_STATIC, addresses[0].type);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(make_address(2).data(), addresses[0].address, 6);
+}
+
+static void test_restore_disabled()
+{
+    TEST_ASSERT_EQUAL(NVSTORE_SUCCESS, NVStore::get_instance().reset());
+
+    {
+        NVStoreSecurityDb db;
+        db.restore();
+        bond(db, 1);
+        db.set_restore(false);
+        db.sync();
+    }
+
+    NVStoreSecurityDb db;
+    db.restore();
+    TEST_ASSERT_NULL(db.find_entry_by_identity(false, make_address(1)));
+}
+
+static void test_lookup_benchmark()
+{
+    NVStoreSecurityDb db;
+    for (size_t i = 0; i < NVStoreSecurityDb::MAX_ENTRIES; i++) {
+        bond(db, i);
+    }
+
+    /* worst case for a linear scan: the last entry and a missing peer */
+    address_t last = make_address(NVStoreSecurityDb::MAX_ENTRIES - 1);
+    address_t missing = make_address(0xFF);
+
+    Timer timer;
+    timer.start();
+    for (size_t i = 0; i < lookup_iterations; i++) {
+        TEST_ASSERT_NOT_NULL(db.find_entry_by_identity(false, last));
+        TEST_ASSERT_NULL(db.find_entry_by_identity(false, missing));
+    }
+    timer.stop();
+
+    printf("%u bonds: %u us per identity lookup pair\r\n",
+           (unsigned) NVStoreSecurityDb::MAX_ENTRIES,
+           (unsigned) (timer.read_us() / lookup_iterations));
+}
+
+utest::v1::status_t greentea_failure_handler(const Case *const source, const failure_t reason) {
+    greentea_case_failure_abort_handler(source, reason);
+    return STATUS_CONTINUE;
+}
+
+Case cases[] = {
+    Case("NVStoreSecurityDb: persistence and lookup", test_persistence,       greentea_failure_handler),
+    Case("NVStoreSecurityDb: resolvable address",     test_resolvable_address, greentea_failure_handler),
+    Case("NVStoreSecurityDb: pair again",             test_pair_again,        greentea_failure_handler),
+    Case("NVStoreSecurityDb: restore disabled",       test_restore_disabled,  greentea_failure_handler),
+    Case("NVStoreSecurityDb: lookup benchmark",       test_lookup_benchmark,  greentea_failure_handler),
+};
+
+utest::v1::status_t greentea_test_setup(const size_t number_of_cases)
+{
+    GREENTEA_SETUP(60, "default_auto");
+    return greentea_test_setup_handler(number_of_cases);
+}
+
+Specification specification(greentea_test_setup, cases, greentea_test_teardown_handler);
+
+int main()
+{
+    return !Harness::run(specification);
+}
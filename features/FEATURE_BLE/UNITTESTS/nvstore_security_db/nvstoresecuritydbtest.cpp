@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_nvstoresecuritydb.h"
+
+TEST_GROUP(NVStoreSecurityDb)
+{
+    Test_NVStoreSecurityDb* unit;
+
+    void setup()
+    {
+        unit = new Test_NVStoreSecurityDb();
+    }
+
+    void teardown()
+    {
+        delete unit;
+    }
+};
+
+TEST(NVStoreSecurityDb, Create)
+{
+    CHECK(unit != NULL);
+}
+
+TEST(NVStoreSecurityDb, test_NVStoreSecurityDb_persistence)
+{
+    unit->test_NVStoreSecurityDb_persistence();
+}
+
+TEST(NVStoreSecurityDb, test_NVStoreSecurityDb_resolvable_address)
+{
+    unit->test_NVStoreSecurityDb_resolvable_address();
+}
+
+TEST(NVStoreSecurityDb, test_NVStoreSecurityDb_table_full)
+{
+    unit->test_NVStoreSecurityDb_table_full();
+}
+
+TEST(NVStoreSecurityDb, test_NVStoreSecurityDb_pair_again)
+{
+    unit->test_NVStoreSecurityDb_pair_again();
+}
+
+TEST(NVStoreSecurityDb, test_NVStoreSecurityDb_restore_disabled)
+{
+    unit->test_NVStoreSecurityDb_restore_disabled();
+}
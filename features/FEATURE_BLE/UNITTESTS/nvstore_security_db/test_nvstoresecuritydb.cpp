@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_nvstoresecuritydb.h"
+#include "ble/pal/NVStoreSecurityDb.h"
+
+using ble::address_t;
+using ble::irk_t;
+using ble::ltk_t;
+using ble::pal::NVStoreSecurityDb;
+using ble::pal::SecurityDb;
+
+static address_t make_address(uint8_t seed)
+{
+    uint8_t bytes[6] = { 0xC0, 0x01, 0x02, 0x03, 0x04, seed };
+    return address_t(bytes);
+}
+
+static irk_t make_irk(uint8_t seed)
+{
+    uint8_t bytes[16];
+    for (size_t i = 0; i < sizeof(bytes); i++) {
+        bytes[i] = seed + i;
+    }
+    return irk_t(bytes);
+}
+
+// Resolvable private address of an IRK, see Core spec Vol 3, Part H, 2.2.2
+static address_t make_resolvable_address(const irk_t &irk, uint8_t seed)
+{
+    uint8_t key[16];
+    uint8_t block[16] = { 0 };
+    uint8_t hash[16];
+    uint8_t bytes[6];
+
+    for (size_t i = 0; i < sizeof(key); i++) {
+        key[i] = irk.data()[sizeof(key) - 1 - i];
+    }
+    block[13] = 0x40 | (seed & 0x3F);
+    block[14] = seed;
+    block[15] = 0x5A;
+
+    mbedtls_aes_context aes;
+    mbedtls_aes_init(&aes);
+    mbedtls_aes_setkey_enc(&aes, key, 128);
+    mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_ENCRYPT, block, hash);
+    mbedtls_aes_free(&aes);
+
+    // Least significant byte first
+    bytes[0] = hash[15];
+    bytes[1] = hash[14];
+    bytes[2] = hash[13];
+    bytes[3] = block[15];
+    bytes[4] = block[14];
+    bytes[5] = block[13];
+    return address_t(bytes);
+}
+
+static void bond(NVStoreSecurityDb &db, uint8_t seed)
+{
+    address_t address = make_address(seed);
+    SecurityDb::entry_handle_t entry =
+        db.open_entry(BLEProtocol::AddressType::RANDOM_STATIC, address);
+    CHECK(entry != NULL);
+
+    db.set_entry_peer_bdaddr(entry, false, address);
+    db.set_entry_peer_irk(entry, make_irk(seed));
+    db.set_entry_peer_ltk(entry, ltk_t(make_irk(seed + 1).data()));
+    db.close_entry(entry);
+}
+
+static void whitelist_cb(::Gap::Whitelist_t *whitelist)
+{
+}
+
+Test_NVStoreSecurityDb::Test_NVStoreSecurityDb()
+{
+    NVStore::get_instance().reset();
+}
+
+Test_NVStoreSecurityDb::~Test_NVStoreSecurityDb()
+{
+}
+
+void Test_NVStoreSecurityDb::test_NVStoreSecurityDb_persistence()
+{
+    {
+        NVStoreSecurityDb db;
+        db.restore();
+        for (size_t i = 0; i < NVStoreSecurityDb::MAX_ENTRIES; i++) {
+            bond(db, i);
+        }
+        db.sync();
+    }
+
+    // A new instance stands in for a reboot
+    NVStoreSecurityDb db;
+    db.restore();
+
+    for (size_t i = 0; i < NVStoreSecurityDb::MAX_ENTRIES; i++) {
+        SecurityDb::entry_handle_t by_address = db.find_entry_by_identity(false, make_address(i));
+        CHECK(by_address != NULL);
+        POINTERS_EQUAL(by_address, db.find_entry_by_irk(make_irk(i)));
+        POINTERS_EQUAL(by_address, db.open_entry(BLEProtocol::AddressType::RANDOM_STATIC, make_address(i)));
+    }
+
+    db.remove_entry(make_address(0));
+    POINTERS_EQUAL(NULL, db.find_entry_by_identity(false, make_address(0)));
+    POINTERS_EQUAL(NULL, db.find_entry_by_irk(make_irk(0)));
+    CHECK(db.find_entry_by_identity(false, make_address(1)) != NULL);
+
+    // The removed bond stays removed after the next reboot
+    db.sync();
+    NVStoreSecurityDb rebooted;
+    rebooted.restore();
+    POINTERS_EQUAL(NULL, rebooted.find_entry_by_identity(false, make_address(0)));
+    CHECK(rebooted.find_entry_by_identity(false, make_address(1)) != NULL);
+}
+
+void Test_NVStoreSecurityDb::test_NVStoreSecurityDb_resolvable_address()
+{
+    NVStoreSecurityDb db;
+    for (size_t i = 0; i < NVStoreSecurityDb::MAX_ENTRIES; i++) {
+        bond(db, i);
+    }
+
+    // A bonded peer reconnecting with a fresh private address finds its bond
+    for (size_t i = 0; i < NVStoreSecurityDb::MAX_ENTRIES; i++) {
+        address_t rpa = make_resolvable_address(make_irk(i), 0x10 + i);
+        POINTERS_EQUAL(
+            db.find_entry_by_identity(false, make_address(i)),
+            db.open_entry(BLEProtocol::AddressType::RANDOM_PRIVATE_RESOLVABLE, rpa)
+        );
+    }
+}
+
+void Test_NVStoreSecurityDb::test_NVStoreSecurityDb_table_full()
+{
+    NVStoreSecurityDb db;
+    for (size_t i = 0; i < NVStoreSecurityDb::MAX_ENTRIES; i++) {
+        bond(db, i);
+    }
+
+    // The table is full, an address of an unknown IRK gets no entry
+    address_t unknown = make_resolvable_address(make_irk(0xF0), 0x20);
+    POINTERS_EQUAL(NULL, db.open_entry(BLEProtocol::AddressType::RANDOM_PRIVATE_RESOLVABLE, unknown));
+    POINTERS_EQUAL(NULL, db.open_entry(BLEProtocol::AddressType::RANDOM_STATIC, make_address(0xF0)));
+
+    // It gets a new entry once a bond is removed
+    db.remove_entry(make_address(0));
+    SecurityDb::entry_handle_t entry =
+        db.open_entry(BLEProtocol::AddressType::RANDOM_PRIVATE_RESOLVABLE, unknown);
+    CHECK(entry != NULL);
+    POINTERS_EQUAL(NULL, db.find_entry_by_identity(false, unknown));
+
+    // A reserved entry that is closed is free again
+    db.close_entry(entry);
+    POINTERS_EQUAL(entry, db.open_entry(BLEProtocol::AddressType::RANDOM_STATIC, make_address(0xF1)));
+}
+
+void Test_NVStoreSecurityDb::test_NVStoreSecurityDb_pair_again()
+{
+    NVStoreSecurityDb db;
+    bond(db, 1);
+
+    // The same device pairs from a new address, only the new bond remains
+    address_t rpa = make_resolvable_address(make_irk(0x30), 0x01);
+    SecurityDb::entry_handle_t old_entry = db.find_entry_by_identity(false, make_address(1));
+    SecurityDb::entry_handle_t new_entry =
+        db.open_entry(BLEProtocol::AddressType::RANDOM_PRIVATE_RESOLVABLE, rpa);
+    CHECK(new_entry != NULL);
+    CHECK(old_entry != new_entry);
+
+    db.set_entry_peer_bdaddr(new_entry, false, make_address(2));
+    db.set_entry_peer_irk(new_entry, make_irk(1));
+    db.close_entry(new_entry);
+
+    POINTERS_EQUAL(NULL, db.find_entry_by_identity(false, make_address(1)));
+    POINTERS_EQUAL(new_entry, db.find_entry_by_irk(make_irk(1)));
+
+    // The whitelist holds the identity of each bond
+    BLEProtocol::Address_t addresses[NVStoreSecurityDb::MAX_ENTRIES];
+    ::Gap::Whitelist_t whitelist;
+    whitelist.addresses = addresses;
+    whitelist.size = 0;
+    whitelist.capacity = NVStoreSecurityDb::MAX_ENTRIES;
+    db.get_whitelist(whitelist_cb, &whitelist);
+
+    LONGS_EQUAL(1, whitelist.size);
+    LONGS_EQUAL(BLEProtocol::AddressType::RANDOM_STATIC, addresses[0].type);
+    MEMCMP_EQUAL(make_address(2).data(), addresses[0].address, 6);
+}
+
+void Test_NVStoreSecurityDb::test_NVStoreSecurityDb_restore_disabled()
+{
+    {
+        NVStoreSecurityDb db;
+        db.restore();
+        bond(db, 1);
+        db.set_restore(false);
+        db.sync();
+    }
+
+    NVStoreSecurityDb db;
+    db.restore();
+    POINTERS_EQUAL(NULL, db.find_entry_by_identity(false, make_address(1)));
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TEST_NVSTORESECURITYDB_H
+#define TEST_NVSTORESECURITYDB_H
+
+class Test_NVStoreSecurityDb
+{
+public:
+    Test_NVStoreSecurityDb();
+
+    virtual ~Test_NVStoreSecurityDb();
+
+    void test_NVStoreSecurityDb_persistence();
+
+    void test_NVStoreSecurityDb_resolvable_address();
+
+    void test_NVStoreSecurityDb_table_full();
+
+    void test_NVStoreSecurityDb_pair_again();
+
+    void test_NVStoreSecurityDb_restore_disabled();
+};
+
+#endif // TEST_NVSTORESECURITYDB_H
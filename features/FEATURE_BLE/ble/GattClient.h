@@ -402,6 +402,41 @@ public:
         return BLE_ERROR_NOT_IMPLEMENTED;
     }
 
+    /**
+     * Initiate the read of several attribute values in a single request.
+     *
+     * The values are read atomically with an ATT Read Multiple request. The
+     * server returns their concatenation, truncated to the MTU size - 1, in a
+     * single response. The result is passed to the handlers registered by
+     * onDataRead with the handle set to the first handle in @p
+     * attributeHandles and the data set to the concatenated values.
+     *
+     * @note Only the last attribute may have a variable length; the
+     * application must know the size of the other values to split the result.
+     *
+     * @param[in] connHandle Handle of the connection used to send the read
+     * request.
+     * @param[in] attributeHandles Handles of the attributes to read. The
+     * array is copied and does not need to outlive the call.
+     * @param[in] count Number of handles in @p attributeHandles, at least 2.
+     *
+     * @return BLE_ERROR_NONE if the read procedure successfully started.
+     */
+    virtual ble_error_t readMultiple(
+        Gap::Handle_t connHandle,
+        const GattAttribute::Handle_t *attributeHandles,
+        size_t count
+    ) const {
+        /* Avoid compiler warnings about unused variables. */
+        (void)connHandle;
+        (void)attributeHandles;
+        (void)count;
+
+        /* Requesting action from porters: override this API if this capability
+           is supported. */
+        return BLE_ERROR_NOT_IMPLEMENTED;
+    }
+
     /**
      * Initiate a write procedure on an attribute value.
      *
@@ -21,6 +21,11 @@
 #include "ble/GattClient.h"
 #include "ble/pal/PalGattClient.h"
 
+/* set by ble.gatt-client-max-connections */
+#ifndef BLE_GATT_CLIENT_MAX_CONNECTIONS
+#define BLE_GATT_CLIENT_MAX_CONNECTIONS 4
+#endif
+
 // IMPORTANT: private header. Not part of the public interface.
 
 namespace ble {
@@ -29,6 +34,10 @@ namespace generic {
 /**
  * Generic implementation of the GattClient.
  * It requires a pal::GattClient injected at construction site.
+ *
+ * Procedures launched while another one is running on the same connection are
+ * queued and started in order once the running procedure completes. Write
+ * commands are not procedures and are sent immediately.
  * @attention: Not part of the public interface of BLE API.
  */
 class GenericGattClient : public GattClient {
@@ -68,6 +77,15 @@ public:
         uint16_t offset
     ) const;
 
+	/**
+	 * @see GattClient::readMultiple
+	 */
+    virtual ble_error_t readMultiple(
+        Gap::Handle_t connection_handle,
+        const GattAttribute::Handle_t *attribute_handles,
+        size_t count
+    ) const;
+
 	/**
 	 * @see GattClient::write
 	 */
@@ -114,10 +132,17 @@ public:
 	 */
     virtual ble_error_t reset(void);
 
+	/**
+	 * Forget the transaction timeout of a closed connection. Every BLE
+	 * instance using this client must register it with Gap::onDisconnection.
+	 */
+    void on_disconnection(const Gap::DisconnectionCallbackParams_t* params);
+
 private:
     struct ProcedureControlBlock;
     struct DiscoveryControlBlock;
     struct ReadControlBlock;
+    struct ReadMultipleControlBlock;
     struct WriteControlBlock;
     struct DescriptorDiscoveryControlBlock;
 
@@ -125,6 +150,8 @@ private:
     const ProcedureControlBlock* get_control_block(Gap::Handle_t connection) const;
     void insert_control_block(ProcedureControlBlock* cb) const;
     void remove_control_block(ProcedureControlBlock* cb) const;
+    ble_error_t launch_procedure(ProcedureControlBlock* cb) const;
+    void start_next_procedure(Gap::Handle_t connection);
 
     void on_termination(Gap::Handle_t connection_handle);
     void on_server_message_received(connection_handle_t, const pal::AttServerMessage&);
@@ -134,10 +161,19 @@ private:
 
     uint16_t get_mtu(Gap::Handle_t connection) const;
 
+    bool is_timed_out(Gap::Handle_t connection) const;
+    void set_timed_out(Gap::Handle_t connection, bool timed_out);
+
     pal::GattClient* const _pal_client;
     ServiceDiscovery::TerminationCallback_t _termination_callback;
     mutable ProcedureControlBlock* control_blocks;
     bool _is_reseting;
+
+    // ATT forbids new requests on a connection whose transaction timed out,
+    // until it is closed. Every connection of the stack can be in that state.
+    static const size_t MAX_TIMED_OUT_CONNECTIONS = BLE_GATT_CLIENT_MAX_CONNECTIONS;
+    Gap::Handle_t _timed_out[MAX_TIMED_OUT_CONNECTIONS];
+    size_t _timed_out_count;
 };
 
 }
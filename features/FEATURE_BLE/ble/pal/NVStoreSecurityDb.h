@@ -0,0 +1,740 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PAL_NVSTORE_SECURITY_DB_H_
+#define PAL_NVSTORE_SECURITY_DB_H_
+
+#include "SecurityDb.h"
+#include "nvstore.h"
+
+#if NVSTORE_ENABLED
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_AES_C)
+#include "mbedtls/aes.h"
+#endif
+
+/* set by ble.security-db-max-entries */
+#ifndef BLE_SECURITY_DB_MAX_ENTRIES
+#define BLE_SECURITY_DB_MAX_ENTRIES 8
+#endif
+
+/* set by ble.security-db-nvstore-base-key */
+#ifndef BLE_SECURITY_DB_NVSTORE_BASE_KEY
+#define BLE_SECURITY_DB_NVSTORE_BASE_KEY 0
+#endif
+
+#if (BLE_SECURITY_DB_NVSTORE_BASE_KEY + 1 + BLE_SECURITY_DB_MAX_ENTRIES) > NVSTORE_MAX_KEYS
+#error "nvstore.max_keys is too small to hold the BLE security database"
+#endif
+
+#if BLE_SECURITY_DB_MAX_ENTRIES > 127
+#error "ble.security-db-max-entries must not exceed 127"
+#endif
+
+#if defined(MBED_CONF_NSAPI_TLS_SESSION_STORE_BASE_KEY) && \
+    (BLE_SECURITY_DB_NVSTORE_BASE_KEY < MBED_CONF_NSAPI_TLS_SESSION_STORE_BASE_KEY + MBED_CONF_NSAPI_TLS_SESSION_STORE_SLOTS) && \
+    (MBED_CONF_NSAPI_TLS_SESSION_STORE_BASE_KEY < BLE_SECURITY_DB_NVSTORE_BASE_KEY + 1 + BLE_SECURITY_DB_MAX_ENTRIES)
+#error "ble.security-db-nvstore-base-key and nsapi.tls-session-store-base-key use the same NVStore keys"
+#endif
+
+namespace ble {
+namespace pal {
+
+/**
+ * Security database persisted in NVStore.
+ *
+ * Bonds are kept in RAM in a fixed size table and written to NVStore, one key
+ * per entry, when sync() is called. Entries are indexed by identity address and
+ * by IRK in open addressed hash tables so reconnecting peers can be matched to
+ * their bond without scanning the table. Peers connecting with a resolvable
+ * private address are matched by resolving it with the stored IRKs.
+ *
+ * The keys used are ble.security-db-nvstore-base-key and the
+ * ble.security-db-max-entries keys following it.
+ */
+class NVStoreSecurityDb : public SecurityDb {
+public:
+    static const size_t MAX_ENTRIES = BLE_SECURITY_DB_MAX_ENTRIES;
+
+private:
+    enum state_t {
+        ENTRY_FREE,
+        ENTRY_RESERVED,
+        ENTRY_WRITTEN
+    };
+
+    /* stored as is in NVStore, bump DB_VERSION when the layout changes */
+    struct entry_t {
+        entry_t() : state(ENTRY_FREE), irk_stored(false) { };
+        SecurityDistributionFlags_t flags;
+        SecurityEntryKeys_t peer_keys;
+        SecurityEntryKeys_t local_keys;
+        SecurityEntryIdentity_t peer_identity;
+        csrk_t csrk;
+        uint8_t state;
+        bool irk_stored;
+    };
+
+    struct local_t {
+        local_t() : version(DB_VERSION), restore(true) { };
+        uint32_t version;
+        bool restore;
+        csrk_t csrk;
+        public_key_coord_t public_key_x;
+        public_key_coord_t public_key_y;
+    };
+
+    static const uint32_t DB_VERSION = 1;
+    static const uint16_t LOCAL_KEY = BLE_SECURITY_DB_NVSTORE_BASE_KEY;
+    static const uint16_t FIRST_ENTRY_KEY = BLE_SECURITY_DB_NVSTORE_BASE_KEY + 1;
+
+    /* index slots hold entry index + 1, 0 marks an empty slot */
+    static const size_t INDEX_SIZE = 2 * MAX_ENTRIES;
+    static const uint8_t INDEX_EMPTY = 0;
+
+    entry_t* as_entry(entry_handle_t entry_handle)
+    {
+        return reinterpret_cast<entry_t*>(entry_handle);
+    }
+
+    size_t index_of(const entry_t *entry) const
+    {
+        return entry - _entries;
+    }
+
+    void mark_written(entry_t *entry)
+    {
+        entry->state = ENTRY_WRITTEN;
+        _dirty[index_of(entry)] = true;
+    }
+
+public:
+    /* the local record is written on the first sync, restore() needs it */
+    NVStoreSecurityDb() : _nvstore(NVStore::get_instance()), _local_dirty(true)
+    {
+        memset(_dirty, 0, sizeof(_dirty));
+        rebuild_index();
+    };
+
+    virtual ~NVStoreSecurityDb() { };
+
+    /**
+     * Find the bond of a peer from its identity address.
+     *
+     * @param[in] address_is_public true if the identity address is public.
+     * @param[in] identity_address identity address of the peer.
+     *
+     * @return handle of the entry or NULL if the peer is not bonded.
+     */
+    entry_handle_t find_entry_by_identity(
+        bool address_is_public,
+        const address_t &identity_address
+    ) {
+        size_t slot = hash(identity_address.data(), identity_address.size(), address_is_public);
+
+        for (size_t probe = 0; probe < INDEX_SIZE; probe++) {
+            uint8_t entry_index = _identity_index[slot];
+            if (entry_index == INDEX_EMPTY) {
+                return NULL;
+            }
+
+            entry_t &entry = _entries[entry_index - 1];
+            if (entry.peer_identity.identity_address == identity_address &&
+                entry.flags.peer_address_is_public == address_is_public) {
+                return &entry;
+            }
+
+            slot = (slot + 1) % INDEX_SIZE;
+        }
+
+        return NULL;
+    }
+
+    /**
+     * Find the bond of a peer from its Identity Resolving Key.
+     *
+     * @param[in] irk IRK distributed by the peer during pairing.
+     *
+     * @return handle of the entry or NULL if no bond holds this IRK.
+     */
+    entry_handle_t find_entry_by_irk(const irk_t &irk)
+    {
+        size_t slot = hash(irk.data(), irk.size(), false);
+
+        for (size_t probe = 0; probe < INDEX_SIZE; probe++) {
+            uint8_t entry_index = _irk_index[slot];
+            if (entry_index == INDEX_EMPTY) {
+                return NULL;
+            }
+
+            entry_t &entry = _entries[entry_index - 1];
+            if (entry.peer_identity.irk == irk) {
+                return &entry;
+            }
+
+            slot = (slot + 1) % INDEX_SIZE;
+        }
+
+        return NULL;
+    }
+
+    virtual const SecurityDistributionFlags_t* get_distribution_flags(
+        entry_handle_t entry_handle
+    ) {
+        entry_t* entry = as_entry(entry_handle);
+        if (!entry) {
+            return NULL;
+        }
+
+        return &entry->flags;
+    }
+
+    virtual void set_distribution_flags(
+        entry_handle_t entry_handle,
+        const SecurityDistributionFlags_t& flags
+    ) {
+        entry_t* entry = as_entry(entry_handle);
+        if (!entry) {
+            return;
+        }
+
+        bool reindex = (entry->flags.peer_address_is_public != flags.peer_address_is_public);
+        mark_written(entry);
+        entry->flags = flags;
+
+        if (reindex) {
+            rebuild_index();
+        }
+    }
+
+    /* local keys */
+
+    /* get */
+    virtual void get_entry_local_keys(
+        SecurityEntryKeysDbCb_t cb,
+        entry_handle_t entry_handle,
+        const ediv_t &ediv,
+        const rand_t &rand
+    ) {
+        entry_t* entry = as_entry(entry_handle);
+        if (!entry) {
+            return;
+        }
+
+        /* validate we have the correct key */
+        if (ediv == entry->local_keys.ediv && rand == entry->local_keys.rand) {
+            cb(entry_handle, &entry->local_keys);
+        } else {
+            cb(entry_handle, NULL);
+        }
+    }
+
+    virtual void get_entry_local_keys(
+        SecurityEntryKeysDbCb_t cb,
+        entry_handle_t entry_handle
+    ) {
+        entry_t* entry = as_entry(entry_handle);
+        if (!entry) {
+            return;
+        }
+
+        /* validate we have the correct key */
+        if (entry->flags.secure_connections_paired) {
+            cb(entry_handle, &entry->local_keys);
+        } else {
+            cb(entry_handle, NULL);
+        }
+    }
+
+    /* set */
+    virtual void set_entry_local_ltk(
+        entry_handle_t entry_handle,
+        const ltk_t &ltk
+    ) {
+        entry_t *entry = as_entry(entry_handle);
+        if (entry) {
+            mark_written(entry);
+            entry->local_keys.ltk = ltk;
+        }
+    }
+
+    virtual void set_entry_local_ediv_rand(
+        entry_handle_t entry_handle,
+        const ediv_t &ediv,
+        const rand_t &rand
+    ) {
+        entry_t *entry = as_entry(entry_handle);
+        if (entry) {
+            mark_written(entry);
+            entry->local_keys.ediv = ediv;
+            entry->local_keys.rand = rand;
+        }
+    }
+
+    /* peer's keys */
+
+    /* get */
+    virtual void get_entry_peer_csrk(
+        SecurityEntryCsrkDbCb_t cb,
+        entry_handle_t entry_handle
+    ) {
+        csrk_t csrk;
+        entry_t *entry = as_entry(entry_handle);
+        if (entry) {
+            csrk = entry->csrk;
+        }
+        cb(entry_handle, &csrk);
+    }
+
+    virtual void get_entry_peer_keys(
+        SecurityEntryKeysDbCb_t cb,
+        entry_handle_t entry_handle
+    ) {
+        SecurityEntryKeys_t *key = NULL;
+        entry_t *entry = as_entry(entry_handle);
+        if (entry) {
+            key = &entry->peer_keys;
+        }
+        cb(entry_handle, key);
+    }
+
+    /* set */
+
+    virtual void set_entry_peer_ltk(
+        entry_handle_t entry_handle,
+        const ltk_t &ltk
+    ) {
+        entry_t *entry = as_entry(entry_handle);
+        if (entry) {
+            mark_written(entry);
+            entry->peer_keys.ltk = ltk;
+        }
+    }
+
+    virtual void set_entry_peer_ediv_rand(
+        entry_handle_t entry_handle,
+        const ediv_t &ediv,
+        const rand_t &rand
+    ) {
+        entry_t *entry = as_entry(entry_handle);
+        if (entry) {
+            mark_written(entry);
+            entry->peer_keys.ediv = ediv;
+            entry->peer_keys.rand = rand;
+        }
+    }
+
+    virtual void set_entry_peer_irk(
+        entry_handle_t entry_handle,
+        const irk_t &irk
+    ) {
+        entry_t *entry = as_entry(entry_handle);
+        if (!entry) {
+            return;
+        }
+
+        /* a bonded device pairing again gets a new entry, drop the old one */
+        entry_t *previous = as_entry(find_entry_by_irk(irk));
+        if (previous && previous != entry) {
+            *previous = entry_t();
+            _dirty[index_of(previous)] = true;
+        }
+
+        mark_written(entry);
+        entry->peer_identity.irk = irk;
+        entry->irk_stored = true;
+        rebuild_index();
+    }
+
+    virtual void set_entry_peer_bdaddr(
+        entry_handle_t entry_handle,
+        bool address_is_public,
+        const address_t &peer_address
+    ) {
+        entry_t *entry = as_entry(entry_handle);
+        if (entry) {
+            mark_written(entry);
+            entry->peer_identity.identity_address = peer_address;
+            rebuild_index();
+        }
+    }
+
+    virtual void set_entry_peer_csrk(
+        entry_handle_t entry_handle,
+        const csrk_t &csrk
+    ) {
+        entry_t *entry = as_entry(entry_handle);
+        if (entry) {
+            mark_written(entry);
+            entry->csrk = csrk;
+        }
+    }
+
+    /* local csrk */
+
+    virtual const csrk_t* get_local_csrk() {
+        return &_local.csrk;
+    }
+
+    virtual void set_local_csrk(const csrk_t &csrk) {
+        _local.csrk = csrk;
+        _local_dirty = true;
+    }
+
+    /* public key */
+
+    virtual const public_key_coord_t& get_public_key_x() {
+        return _local.public_key_x;
+    }
+
+    virtual const public_key_coord_t& get_public_key_y() {
+        return _local.public_key_y;
+    }
+
+    virtual void set_public_key(
+        const public_key_coord_t &public_key_x,
+        const public_key_coord_t &public_key_y
+    ) {
+        _local.public_key_x = public_key_x;
+        _local.public_key_y = public_key_y;
+        _local_dirty = true;
+    }
+
+    /* list management */
+
+    virtual entry_handle_t open_entry(
+        BLEProtocol::AddressType_t peer_address_type,
+        const address_t &peer_address
+    ) {
+        const bool peer_address_public =
+            (peer_address_type == BLEProtocol::AddressType::PUBLIC);
+
+        entry_handle_t found = find_entry_by_identity(peer_address_public, peer_address);
+        if (found) {
+            return found;
+        }
+
+        if (!peer_address_public && is_resolvable(peer_address)) {
+            found = find_entry_by_resolvable_address(peer_address);
+            if (found) {
+                return found;
+            }
+        }
+
+        /* if we din't find one grab the first free slot */
+        for (size_t i = 0; i < MAX_ENTRIES; i++) {
+            if (_entries[i].state == ENTRY_FREE) {
+                _entries[i] = entry_t();
+                _entries[i].flags.peer_address = peer_address;
+                _entries[i].flags.peer_address_is_public = peer_address_public;
+                _entries[i].state = ENTRY_RESERVED;
+                return &_entries[i];
+            }
+        }
+
+        return NULL;
+    }
+
+    virtual void close_entry(entry_handle_t entry_handle)
+    {
+        entry_t *entry = as_entry(entry_handle);
+        if (entry && entry->state == ENTRY_RESERVED) {
+            entry->state = ENTRY_FREE;
+        }
+    }
+
+    virtual void remove_entry(const address_t peer_identity_address)
+    {
+        for (size_t i = 0; i < MAX_ENTRIES; i++) {
+            if (_entries[i].state == ENTRY_FREE) {
+                continue;
+            } else if (peer_identity_address == _entries[i].peer_identity.identity_address) {
+                _entries[i] = entry_t();
+                _dirty[i] = true;
+                rebuild_index();
+                return;
+            }
+        }
+    }
+
+    virtual void clear_entries() {
+        for (size_t i = 0; i < MAX_ENTRIES; i++) {
+            _entries[i] = entry_t();
+            _dirty[i] = true;
+        }
+        _local_identity = SecurityEntryIdentity_t();
+        _local.csrk = csrk_t();
+        _local_dirty = true;
+        rebuild_index();
+    }
+
+    virtual void get_whitelist(WhitelistDbCb_t cb, ::Gap::Whitelist_t *whitelist) {
+        /* the whitelist is not stored separately, it is made of the bonds */
+        fill_whitelist(whitelist);
+        cb(whitelist);
+    }
+
+    virtual void generate_whitelist_from_bond_table(WhitelistDbCb_t cb, ::Gap::Whitelist_t *whitelist) {
+        fill_whitelist(whitelist);
+        cb(whitelist);
+    }
+
+    virtual void set_whitelist(const ::Gap::Whitelist_t &whitelist) { };
+
+    virtual void add_whitelist_entry(const address_t &address) { }
+
+    virtual void remove_whitelist_entry(const address_t &address) { }
+
+    virtual void clear_whitelist() { }
+
+    /* saving and loading from nvm */
+
+    virtual void restore()
+    {
+        if (_nvstore.init() != NVSTORE_SUCCESS) {
+            return;
+        }
+
+        local_t local;
+        uint16_t actual_size = 0;
+        int ret = _nvstore.get(LOCAL_KEY, sizeof(local), &local, actual_size);
+        if (ret != NVSTORE_SUCCESS || actual_size != sizeof(local) ||
+            local.version != DB_VERSION) {
+            return;
+        }
+
+        _local = local;
+        _local_dirty = false;
+        if (!_local.restore) {
+            return;
+        }
+
+        for (size_t i = 0; i < MAX_ENTRIES; i++) {
+            entry_t entry;
+            ret = _nvstore.get(FIRST_ENTRY_KEY + i, sizeof(entry), &entry, actual_size);
+            if (ret == NVSTORE_SUCCESS && actual_size == sizeof(entry) &&
+                entry.state == ENTRY_WRITTEN) {
+                _entries[i] = entry;
+            } else {
+                _entries[i] = entry_t();
+            }
+            _dirty[i] = false;
+        }
+
+        rebuild_index();
+    }
+
+    virtual void sync()
+    {
+        if (_nvstore.init() != NVSTORE_SUCCESS) {
+            return;
+        }
+
+        if (_local_dirty) {
+            if (_nvstore.set(LOCAL_KEY, sizeof(_local), &_local) == NVSTORE_SUCCESS) {
+                _local_dirty = false;
+            }
+        }
+
+        for (size_t i = 0; i < MAX_ENTRIES; i++) {
+            if (!_dirty[i]) {
+                continue;
+            }
+
+            int ret;
+            if (_local.restore && _entries[i].state == ENTRY_WRITTEN) {
+                ret = _nvstore.set(FIRST_ENTRY_KEY + i, sizeof(entry_t), &_entries[i]);
+            } else {
+                ret = _nvstore.remove(FIRST_ENTRY_KEY + i);
+                if (ret == NVSTORE_NOT_FOUND) {
+                    ret = NVSTORE_SUCCESS;
+                }
+            }
+
+            if (ret == NVSTORE_SUCCESS) {
+                _dirty[i] = false;
+            }
+        }
+    }
+
+    virtual void set_restore(bool reload)
+    {
+        if (_local.restore == reload) {
+            return;
+        }
+
+        _local.restore = reload;
+        _local_dirty = true;
+
+        /* stored entries follow the new setting on the next sync */
+        for (size_t i = 0; i < MAX_ENTRIES; i++) {
+            _dirty[i] = true;
+        }
+    }
+
+private:
+    void fill_whitelist(::Gap::Whitelist_t *whitelist)
+    {
+        whitelist->size = 0;
+
+        for (size_t i = 0; i < MAX_ENTRIES && whitelist->size < whitelist->capacity; i++) {
+            if (_entries[i].state != ENTRY_WRITTEN) {
+                continue;
+            }
+
+            BLEProtocol::Address_t &address = whitelist->addresses[whitelist->size];
+            if (_entries[i].flags.peer_address_is_public) {
+                address.type = BLEProtocol::AddressType::PUBLIC;
+            } else {
+                address.type = BLEProtocol::AddressType::RANDOM_STATIC;
+            }
+
+            memcpy(
+                address.address,
+                _entries[i].peer_identity.identity_address.data(),
+                sizeof(BLEProtocol::AddressBytes_t)
+            );
+            whitelist->size++;
+        }
+    }
+
+    /* the two most significant bits of a resolvable private address are 01 */
+    static bool is_resolvable(const address_t &address)
+    {
+        return (address.data()[5] & 0xC0) == 0x40;
+    }
+
+    /**
+     * Find the bond of a peer from its resolvable private address.
+     *
+     * Tries the IRK of every bond with the random address hash function ah
+     * (Core spec Vol 3, Part H, 2.2.2), keys and addresses are stored least
+     * significant byte first.
+     */
+    entry_handle_t find_entry_by_resolvable_address(const address_t &address)
+    {
+#if defined(MBEDTLS_AES_C)
+        const uint8_t *rpa = address.data();
+        uint8_t plaintext[16] = { 0 };
+        uint8_t key[16];
+        uint8_t ciphertext[16];
+        entry_handle_t found = NULL;
+
+        /* prand is the upper half of the address, hash the lower half */
+        plaintext[13] = rpa[5];
+        plaintext[14] = rpa[4];
+        plaintext[15] = rpa[3];
+
+        mbedtls_aes_context aes;
+        mbedtls_aes_init(&aes);
+
+        for (size_t i = 0; i < MAX_ENTRIES && !found; i++) {
+            const entry_t &entry = _entries[i];
+            if (entry.state != ENTRY_WRITTEN || !entry.irk_stored) {
+                continue;
+            }
+
+            for (size_t j = 0; j < sizeof(key); j++) {
+                key[j] = entry.peer_identity.irk.data()[sizeof(key) - 1 - j];
+            }
+
+            if (mbedtls_aes_setkey_enc(&aes, key, 128) != 0 ||
+                mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_ENCRYPT, plaintext, ciphertext) != 0) {
+                break;
+            }
+
+            if (ciphertext[13] == rpa[2] &&
+                ciphertext[14] == rpa[1] &&
+                ciphertext[15] == rpa[0]) {
+                found = &_entries[i];
+            }
+        }
+
+        mbedtls_aes_free(&aes);
+        memset(key, 0, sizeof(key));
+        return found;
+#else
+        return NULL;
+#endif
+    }
+
+    /* FNV-1a, the public flag keeps public and random identities apart */
+    static size_t hash(const uint8_t *data, size_t size, bool is_public)
+    {
+        uint32_t h = 2166136261UL;
+        for (size_t i = 0; i < size; i++) {
+            h = (h ^ data[i]) * 16777619UL;
+        }
+        h = (h ^ (is_public ? 1 : 0)) * 16777619UL;
+        return h % INDEX_SIZE;
+    }
+
+    static void index_insert(uint8_t *index, size_t slot, size_t entry_index)
+    {
+        while (index[slot] != INDEX_EMPTY) {
+            slot = (slot + 1) % INDEX_SIZE;
+        }
+        index[slot] = entry_index + 1;
+    }
+
+    /* the table is small and only changes on pairing, so rebuild on update */
+    void rebuild_index()
+    {
+        memset(_identity_index, INDEX_EMPTY, sizeof(_identity_index));
+        memset(_irk_index, INDEX_EMPTY, sizeof(_irk_index));
+
+        for (size_t i = 0; i < MAX_ENTRIES; i++) {
+            const entry_t &entry = _entries[i];
+            if (entry.state == ENTRY_FREE) {
+                continue;
+            }
+
+            const address_t &address = entry.peer_identity.identity_address;
+            index_insert(
+                _identity_index,
+                hash(address.data(), address.size(), entry.flags.peer_address_is_public),
+                i
+            );
+
+            if (entry.irk_stored) {
+                const irk_t &irk = entry.peer_identity.irk;
+                index_insert(_irk_index, hash(irk.data(), irk.size(), false), i);
+            }
+        }
+    }
+
+    NVStore &_nvstore;
+    entry_t _entries[MAX_ENTRIES];
+    bool _dirty[MAX_ENTRIES];
+    uint8_t _identity_index[INDEX_SIZE];
+    uint8_t _irk_index[INDEX_SIZE];
+    SecurityEntryIdentity_t _local_identity;
+    local_t _local;
+    bool _local_dirty;
+};
+
+} /* namespace pal */
+} /* namespace ble */
+
+#endif /* NVSTORE_ENABLED */
+
+#endif /*PAL_NVSTORE_SECURITY_DB_H_*/
@@ -26,6 +26,7 @@
 using ble::pal::AttServerMessage;
 using ble::pal::AttReadResponse;
 using ble::pal::AttReadBlobResponse;
+using ble::pal::AttReadMultipleResponse;
 using ble::pal::AttReadByTypeResponse;
 using ble::pal::AttReadByGroupTypeResponse;
 using ble::pal::AttFindByTypeValueResponse;
@@ -47,6 +48,7 @@ namespace generic {
 enum procedure_type_t {
 	COMPLETE_DISCOVERY_PROCEDURE,
 	READ_PROCEDURE,
+	READ_MULTIPLE_PROCEDURE,
 	WRITE_PROCEDURE,
 	DESCRIPTOR_DISCOVERY_PROCEDURE
 };
@@ -60,10 +62,15 @@ struct GenericGattClient::ProcedureControlBlock {
 	 * Base constructor for procedure control block.
 	 */
 	ProcedureControlBlock(procedure_type_t type, Gap::Handle_t handle) :
-		type(type), connection_handle(handle), next(NULL) { }
+		type(type), connection_handle(handle), started(false), next(NULL) { }
 
 	virtual ~ProcedureControlBlock() { }
 
+	/*
+	 * Send the first request of the procedure.
+	 */
+	virtual ble_error_t start(const GenericGattClient* client) = 0;
+
 	/*
 	 * Entry point of the control block stack machine.
 	 */
@@ -81,6 +88,7 @@ struct GenericGattClient::ProcedureControlBlock {
 
 	procedure_type_t type;
 	Gap::Handle_t connection_handle;
+	bool started;
 	ProcedureControlBlock* next;
 };
 
@@ -112,6 +120,21 @@ struct GenericGattClient::DiscoveryControlBlock : public ProcedureControlBlock {
 		}
 	}
 
+	virtual ble_error_t start(const GenericGattClient* client) {
+		if (matching_service_uuid == UUID()) {
+			return client->_pal_client->discover_primary_service(
+				connection_handle,
+				0x0001
+			);
+		} else {
+			return client->_pal_client->discover_primary_service_by_service_uuid(
+				connection_handle,
+				0x0001,
+				matching_service_uuid
+			);
+		}
+	}
+
 	virtual void handle_timeout_error(GenericGattClient* client) {
 		terminate(client);
 	}
@@ -302,6 +325,7 @@ struct GenericGattClient::DiscoveryControlBlock : public ProcedureControlBlock {
 		Gap::Handle_t handle = connection_handle;
 		delete this;
 		client->on_termination(handle);
+		client->start_next_procedure(handle);
 	}
 
 	uint16_t get_start_handle(const AttReadByGroupTypeResponse::attribute_data_t& data) {
@@ -432,6 +456,18 @@ struct GenericGattClient::ReadControlBlock : public ProcedureControlBlock {
 		}
 	}
 
+	virtual ble_error_t start(const GenericGattClient* client) {
+		if (offset == 0) {
+			return client->_pal_client->read_attribute_value(
+				connection_handle, attribute_handle
+			);
+		} else {
+			return client->_pal_client->read_attribute_blob(
+				connection_handle, attribute_handle, offset
+			);
+		}
+	}
+
 	virtual void handle_timeout_error(GenericGattClient* client) {
 		GattReadCallbackParams response = {
 			connection_handle,
@@ -461,7 +497,9 @@ struct GenericGattClient::ReadControlBlock : public ProcedureControlBlock {
 	void terminate(GenericGattClient* client, const GattReadCallbackParams& response) {
 		client->remove_control_block(this);
 		client->processReadResponse(&response);
+		Gap::Handle_t handle = connection_handle;
 		delete this;
+		client->start_next_procedure(handle);
 	}
 
 	virtual void handle(GenericGattClient* client, const AttServerMessage& message) {
@@ -612,15 +650,120 @@ struct GenericGattClient::ReadControlBlock : public ProcedureControlBlock {
 	uint8_t* data;
 };
 
+/*
+ * Control block for the read multiple process
+ */
+struct GenericGattClient::ReadMultipleControlBlock : public ProcedureControlBlock {
+	ReadMultipleControlBlock(
+		Gap::Handle_t connection_handle, attribute_handle_t* handles, size_t count
+	) : ProcedureControlBlock(READ_MULTIPLE_PROCEDURE, connection_handle),
+		handles(handles), count(count) {
+	}
+
+	virtual ~ReadMultipleControlBlock() {
+		free(handles);
+	}
+
+	virtual ble_error_t start(const GenericGattClient* client) {
+		return client->_pal_client->read_multiple_characteristic_values(
+			connection_handle,
+			make_const_ArrayView(handles, count)
+		);
+	}
+
+	virtual void handle_timeout_error(GenericGattClient* client) {
+		GattReadCallbackParams response = {
+			connection_handle,
+			handles[0],
+			/* offset */ 0,
+			0, // size of 0
+			NULL, // no data
+			BLE_ERROR_UNSPECIFIED,
+		};
+		terminate(client, response);
+	}
+
+	virtual void abort(GenericGattClient *client) {
+		GattReadCallbackParams response = {
+			connection_handle,
+			handles[0],
+			/* offset */ 0,
+			0, // size of 0
+			NULL, // no data
+			BLE_ERROR_INVALID_STATE,
+		};
+		terminate(client, response);
+	}
+
+	void terminate(GenericGattClient* client, const GattReadCallbackParams& response) {
+		client->remove_control_block(this);
+		client->processReadResponse(&response);
+		Gap::Handle_t handle = connection_handle;
+		delete this;
+		client->start_next_procedure(handle);
+	}
+
+	virtual void handle(GenericGattClient* client, const AttServerMessage& message) {
+		switch(message.opcode) {
+			case AttributeOpcode::ERROR_RESPONSE: {
+				const AttErrorResponse& error =
+					static_cast<const AttErrorResponse&>(message);
+				GattReadCallbackParams response = {
+					connection_handle,
+					handles[0],
+					/* offset */ 0,
+					error.error_code,
+					/* data */ NULL,
+					error.error_code == AttErrorResponse::READ_NOT_PERMITTED ?
+						BLE_ERROR_OPERATION_NOT_PERMITTED : BLE_ERROR_UNSPECIFIED
+				};
+				terminate(client, response);
+			}	break;
+
+			case AttributeOpcode::READ_MULTIPLE_RESPONSE: {
+				const AttReadMultipleResponse& read_response =
+					static_cast<const AttReadMultipleResponse&>(message);
+				GattReadCallbackParams response = {
+					connection_handle,
+					handles[0],
+					/* offset */ 0,
+					(uint16_t) read_response.size(),
+					read_response.data(),
+					BLE_ERROR_NONE,
+				};
+				terminate(client, response);
+			}	break;
+
+			default: {
+				// should not happen, terminate the procedure and notify client with an error
+				// in such case.
+				GattReadCallbackParams response = {
+					connection_handle,
+					handles[0],
+					/* offset */ 0,
+					AttErrorResponse::UNLIKELY_ERROR,
+					/* data */ NULL,
+					BLE_ERROR_UNSPECIFIED,
+				};
+				terminate(client, response);
+			}	break;
+		}
+	}
+
+	attribute_handle_t* handles;
+	size_t count;
+};
+
 /*
  * Control block for the write process
  */
 struct GenericGattClient::WriteControlBlock : public ProcedureControlBlock {
 	WriteControlBlock(
 		Gap::Handle_t connection_handle, uint16_t attribute_handle,
-		uint8_t* data, uint16_t len
+		const uint8_t* value, uint8_t* data, uint16_t len
 	) : ProcedureControlBlock(WRITE_PROCEDURE, connection_handle),
-		attribute_handle(attribute_handle), len(len), offset(0), data(data),
+		attribute_handle(attribute_handle), len(len), offset(0),
+		value(data ? data : value), data(data),
 		prepare_success(false), status(BLE_ERROR_UNSPECIFIED), error_code(0xFF) {
 	}
 
@@ -628,6 +771,30 @@ struct GenericGattClient::WriteControlBlock : public ProcedureControlBlock {
 		free(data);
 	}
 
+	virtual ble_error_t start(const GenericGattClient* client) {
+		uint16_t mtu = client->get_mtu(connection_handle);
+
+		if (len > (uint16_t)(mtu - 3)) {
+			// long writes need the copy of the value to send the next chunks
+			if (data == NULL) {
+				return BLE_ERROR_INVALID_STATE;
+			}
+
+			return client->_pal_client->queue_prepare_write(
+				connection_handle,
+				attribute_handle,
+				make_const_ArrayView(value, mtu - 5),
+				/* offset */ 0
+			);
+		} else {
+			return client->_pal_client->write_attribute(
+				connection_handle,
+				attribute_handle,
+				make_const_ArrayView(value, len)
+			);
+		}
+	}
+
 	virtual void handle_timeout_error(GenericGattClient* client) {
 		GattWriteCallbackParams response = {
 			connection_handle,
@@ -653,7 +820,9 @@ struct GenericGattClient::WriteControlBlock : public ProcedureControlBlock {
 	void terminate(GenericGattClient* client, const GattWriteCallbackParams& response) {
 		client->remove_control_block(this);
 		client->processWriteResponse(&response);
+		Gap::Handle_t handle = connection_handle;
 		delete this;
+		client->start_next_procedure(handle);
 	}
 
 	virtual void handle(GenericGattClient* client, const AttServerMessage& message) {
@@ -809,6 +978,7 @@ struct GenericGattClient::WriteControlBlock : public ProcedureControlBlock {
 	uint16_t attribute_handle;
 	uint16_t len;
 	uint16_t offset;
+	const uint8_t* value;
 	uint8_t* data;
 	bool prepare_success;
 	ble_error_t status;
@@ -833,7 +1003,7 @@ struct GenericGattClient::DescriptorDiscoveryControlBlock : public ProcedureCont
 
 	virtual ~DescriptorDiscoveryControlBlock() { }
 
-	ble_error_t start(GenericGattClient* client) {
+	virtual ble_error_t start(const GenericGattClient* client) {
 		return client->_pal_client->discover_characteristics_descriptors(
 			connection_handle,
 			attribute_handle_range(
@@ -915,7 +1085,9 @@ struct GenericGattClient::DescriptorDiscoveryControlBlock : public ProcedureCont
 			error_code
 		};
 		termination_cb(&params);
+		Gap::Handle_t handle = connection_handle;
 		delete this;
+		client->start_next_procedure(handle);
 	}
 
 	DiscoveredCharacteristic characteristic;
@@ -930,7 +1102,8 @@ GenericGattClient::GenericGattClient(pal::GattClient* pal_client) :
 	_pal_client(pal_client),
 	_termination_callback(),
 	 control_blocks(NULL),
-	_is_reseting(false) {
+	_is_reseting(false),
+	_timed_out_count(0) {
 	_pal_client->when_server_message_received(
 		mbed::callback(this, &GenericGattClient::on_server_message_received)
 	);
@@ -946,8 +1119,7 @@ ble_error_t GenericGattClient::launchServiceDiscovery(
 	const UUID& matching_service_uuid,
 	const UUID& matching_characteristic_uuid
 ) {
-	// verify that there is no other procedures going on this connection
-	if (_is_reseting || get_control_block(connection_handle)) {
+	if (_is_reseting) {
 		return BLE_ERROR_INVALID_STATE;
 	}
 
@@ -969,31 +1141,7 @@ ble_error_t GenericGattClient::launchServiceDiscovery(
 		return BLE_ERROR_NO_MEM;
 	}
 
-	// note: control block inserted prior the request because they are part of
-	// of the transaction and the callback can be call synchronously
-	insert_control_block(discovery_pcb);
-
-	// launch the request
-	ble_error_t err = BLE_ERROR_UNSPECIFIED;
-	if (matching_service_uuid == UUID()) {
-		err = _pal_client->discover_primary_service(
-			connection_handle,
-			0x0001
-		);
-	} else {
-		err = _pal_client->discover_primary_service_by_service_uuid(
-			connection_handle,
-			0x0001,
-			matching_service_uuid
-		);
-	}
-
-	if (err) {
-		remove_control_block(discovery_pcb);
-		delete discovery_pcb;
-	}
-
-	return err;
+	return launch_procedure(discovery_pcb);
 }
 
 bool GenericGattClient::isServiceDiscoveryActive() const {
@@ -1025,8 +1173,7 @@ ble_error_t GenericGattClient::read(
 	GattAttribute::Handle_t attribute_handle,
 	uint16_t offset) const
 {
-	// verify that there is no other procedures going on this connection
-	if (_is_reseting || get_control_block(connection_handle)) {
+	if (_is_reseting) {
 		return BLE_ERROR_INVALID_STATE;
 	}
 
@@ -1040,26 +1187,49 @@ ble_error_t GenericGattClient::read(
 		return BLE_ERROR_NO_MEM;
 	}
 
-	insert_control_block(read_pcb);
+	return launch_procedure(read_pcb);
+}
+
+ble_error_t GenericGattClient::readMultiple(
+	Gap::Handle_t connection_handle,
+	const GattAttribute::Handle_t *attribute_handles,
+	size_t count
+) const {
+	if (_is_reseting) {
+		return BLE_ERROR_INVALID_STATE;
+	}
+
+	if (attribute_handles == NULL || count < 2) {
+		return BLE_ERROR_INVALID_PARAM;
+	}
 
-	ble_error_t err = BLE_ERROR_NONE;
+	// each handle takes two octets in the request, after the opcode
+	if (count > (size_t)((get_mtu(connection_handle) - 1) / 2)) {
+		return BLE_ERROR_PARAM_OUT_OF_RANGE;
+	}
 
-	if (offset == 0) {
-		err = _pal_client->read_attribute_value(
-			connection_handle, attribute_handle
-		);
-	} else {
-		err = _pal_client->read_attribute_blob(
-			connection_handle, attribute_handle, offset
-		);
+	attribute_handle_t* handles =
+		(attribute_handle_t*) malloc(count * sizeof(attribute_handle_t));
+	if (handles == NULL) {
+		return BLE_ERROR_NO_MEM;
 	}
 
-	if (err) {
-		remove_control_block(read_pcb);
-		delete read_pcb;
+	for (size_t i = 0; i < count; ++i) {
+		handles[i] = attribute_handles[i];
 	}
 
-	return err;
+	ReadMultipleControlBlock* read_pcb = new(std::nothrow) ReadMultipleControlBlock(
+		connection_handle,
+		handles,
+		count
+	);
+
+	if (read_pcb == NULL) {
+		free(handles);
+		return BLE_ERROR_NO_MEM;
+	}
+
+	return launch_procedure(read_pcb);
 }
 
 ble_error_t GenericGattClient::write(
@@ -1069,14 +1239,15 @@ ble_error_t GenericGattClient::write(
 	size_t length,
 	const uint8_t* value
 ) const {
-	// verify that there is no other procedures going on this connection
-	if (_is_reseting || get_control_block(connection_handle)) {
+	if (_is_reseting) {
 		return BLE_ERROR_INVALID_STATE;
 	}
 
 	uint16_t mtu = get_mtu(connection_handle);
 
 	if (cmd == GattClient::GATT_OP_WRITE_CMD) {
+		// commands do not expect a response from the server, they can be
+		// sent while a procedure is running on the connection.
 		if (length > (uint16_t)(mtu - 3)) {
 			return BLE_ERROR_PARAM_OUT_OF_RANGE;
 		}
@@ -1088,7 +1259,9 @@ ble_error_t GenericGattClient::write(
 	} else {
 		uint8_t* data = NULL;
 
-		if (length > (uint16_t)(mtu - 3)) {
+		// The value is copied if it is sent in several chunks or if the
+		// procedure is queued, the caller's buffer may not outlive the call.
+		if (length > (uint16_t)(mtu - 3) || get_control_block(connection_handle)) {
 			data = (uint8_t*) malloc(length);
 			if (data == NULL) {
 				return BLE_ERROR_NO_MEM;
@@ -1099,6 +1272,7 @@ ble_error_t GenericGattClient::write(
 		WriteControlBlock* write_pcb = new(std::nothrow) WriteControlBlock(
 			connection_handle,
 			attribute_handle,
+			value,
 			data,
 			length
 		);
@@ -1108,30 +1282,7 @@ ble_error_t GenericGattClient::write(
 			return BLE_ERROR_NO_MEM;
 		}
 
-		insert_control_block(write_pcb);
-
-		ble_error_t err = BLE_ERROR_UNSPECIFIED;
-		if (data) {
-			err = _pal_client->queue_prepare_write(
-				connection_handle,
-				attribute_handle,
-				make_const_ArrayView(value, mtu - 5),
-				/* offset */ 0
-			);
-		} else {
-			err = _pal_client->write_attribute(
-				connection_handle,
-				attribute_handle,
-				make_const_ArrayView(value, length)
-			);
-		}
-
-		if (err) {
-			remove_control_block(write_pcb);
-			delete write_pcb;
-		}
-
-		return err;
+		return launch_procedure(write_pcb);
 	}
 
 	return BLE_ERROR_NOT_IMPLEMENTED;
@@ -1148,8 +1299,7 @@ ble_error_t GenericGattClient::discoverCharacteristicDescriptors(
 	const CharacteristicDescriptorDiscovery::DiscoveryCallback_t& discoveryCallback,
 	const CharacteristicDescriptorDiscovery::TerminationCallback_t& terminationCallback
 ) {
-	// verify that there is no other procedures going on this connection
-	if (_is_reseting || get_control_block(characteristic.getConnectionHandle())) {
+	if (_is_reseting) {
 		return BLE_ERROR_INVALID_STATE;
 	}
 
@@ -1175,16 +1325,7 @@ ble_error_t GenericGattClient::discoverCharacteristicDescriptors(
 		return BLE_ERROR_NO_MEM;
 	}
 
-	insert_control_block(discovery_pcb);
-
-	ble_error_t err = discovery_pcb->start(this);
-
-	if (err) {
-		remove_control_block(discovery_pcb);
-		delete discovery_pcb;
-	}
-
-	return err;
+	return launch_procedure(discovery_pcb);
 }
 
 bool GenericGattClient::isCharacteristicDescriptorDiscoveryActive(
@@ -1232,6 +1373,7 @@ ble_error_t GenericGattClient::reset(void) {
 	while (control_blocks) {
 		control_blocks->abort(this);
 	}
+	_timed_out_count = 0;
 	_is_reseting = false;
 
 	return BLE_ERROR_NONE;
@@ -1279,7 +1421,7 @@ void GenericGattClient::on_server_response(
 	const AttServerMessage& message
 ) {
 	ProcedureControlBlock* pcb = get_control_block(connection);
-	if (pcb == NULL) {
+	if (pcb == NULL || !pcb->started) {
 		return;
 	}
 
@@ -1319,10 +1461,35 @@ void GenericGattClient::on_server_event(connection_handle_t connection, const At
 
 void GenericGattClient::on_transaction_timeout(connection_handle_t connection) {
 	ProcedureControlBlock* pcb = get_control_block(connection);
-	if (pcb == NULL) {
+	if (pcb == NULL || !pcb->started) {
 		return;
 	}
 
+	// No more requests can be sent on this connection. Detach the procedures
+	// queued behind the one that timed out before aborting them, procedures
+	// launched from their termination callbacks are rejected.
+	set_timed_out(connection, true);
+
+	ProcedureControlBlock* aborted = NULL;
+	ProcedureControlBlock** aborted_tail = &aborted;
+	ProcedureControlBlock* it = pcb->next;
+	while (it) {
+		ProcedureControlBlock* next = it->next;
+		if (it->connection_handle == connection) {
+			remove_control_block(it);
+			*aborted_tail = it;
+			aborted_tail = &it->next;
+		}
+		it = next;
+	}
+
+	while (aborted) {
+		ProcedureControlBlock* queued = aborted;
+		aborted = aborted->next;
+		queued->next = NULL;
+		queued->abort(this);
+	}
+
 	pcb->handle_timeout_error(this);
 }
 
@@ -1378,6 +1545,89 @@ void GenericGattClient::remove_control_block(ProcedureControlBlock* cb) const {
 	cb->next = NULL;
 }
 
+ble_error_t GenericGattClient::launch_procedure(ProcedureControlBlock* cb) const {
+	if (is_timed_out(cb->connection_handle)) {
+		delete cb;
+		return BLE_ERROR_INVALID_STATE;
+	}
+
+	// procedures on a connection run one after the other, queue this one if
+	// another procedure is in progress.
+	bool busy = get_control_block(cb->connection_handle) != NULL;
+
+	// note: control block inserted prior the request because they are part of
+	// of the transaction and the callback can be call synchronously
+	insert_control_block(cb);
+
+	if (busy) {
+		return BLE_ERROR_NONE;
+	}
+
+	cb->started = true;
+	ble_error_t err = cb->start(this);
+
+	if (err) {
+		remove_control_block(cb);
+		delete cb;
+	}
+
+	return err;
+}
+
+void GenericGattClient::start_next_procedure(Gap::Handle_t connection) {
+	if (_is_reseting) {
+		return;
+	}
+
+	ProcedureControlBlock* pcb = get_control_block(connection);
+	if (pcb == NULL || pcb->started) {
+		return;
+	}
+
+	pcb->started = true;
+	if (pcb->start(this)) {
+		// report the failure to the application; the termination of the
+		// procedure starts the next one.
+		pcb->abort(this);
+	}
+}
+
+void GenericGattClient::on_disconnection(const Gap::DisconnectionCallbackParams_t* params) {
+	set_timed_out(params->handle, false);
+}
+
+bool GenericGattClient::is_timed_out(Gap::Handle_t connection) const {
+	for (size_t i = 0; i < _timed_out_count; ++i) {
+		if (_timed_out[i] == connection) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void GenericGattClient::set_timed_out(Gap::Handle_t connection, bool timed_out) {
+	for (size_t i = 0; i < _timed_out_count; ++i) {
+		if (_timed_out[i] == connection) {
+			if (!timed_out) {
+				_timed_out[i] = _timed_out[--_timed_out_count];
+			}
+			return;
+		}
+	}
+
+	if (!timed_out) {
+		return;
+	}
+
+	// only if ble.gatt-client-max-connections is below the connection count
+	// of the stack: forget the oldest
+	if (_timed_out_count == MAX_TIMED_OUT_CONNECTIONS) {
+		std::copy(_timed_out + 1, _timed_out + _timed_out_count, _timed_out);
+		--_timed_out_count;
+	}
+	_timed_out[_timed_out_count++] = connection;
+}
+
 uint16_t GenericGattClient::get_mtu(Gap::Handle_t connection) const {
 	uint16_t result = 23;
 	if(_pal_client->get_mtu_size((connection_handle_t) connection, result) != BLE_ERROR_NONE) {
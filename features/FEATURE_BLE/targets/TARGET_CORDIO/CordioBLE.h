@@ -31,6 +31,9 @@
 #include "ble/generic/GenericGap.h"
 #include "ble/generic/GenericSecurityManager.h"
 #include "ble/pal/MemorySecurityDB.h"
+#if BLE_SECURITY_DB_NVSTORE
+#include "ble/pal/NVStoreSecurityDb.h"
+#endif
 #include "ble/pal/SimpleEventQueue.h"
 
 namespace ble {
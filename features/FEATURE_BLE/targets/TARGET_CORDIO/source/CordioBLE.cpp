@@ -217,7 +217,11 @@ SecurityManager& BLE::getSecurityManager()
 
 const SecurityManager& BLE::getSecurityManager() const
 {
+#if BLE_SECURITY_DB_NVSTORE
+    static pal::NVStoreSecurityDb m_db;
+#else
     static pal::MemorySecurityDb m_db;
+#endif
     pal::vendor::cordio::CordioSecurityManager &m_pal = pal::vendor::cordio::CordioSecurityManager::get_security_manager();
     static generic::GenericSecurityManager m_instance(
         m_pal,
@@ -267,6 +271,10 @@ void BLE::processEvents()
                 BLE_ERROR_NONE
             };
             deviceInstance().getGattServer().initialize();
+            deviceInstance().getGap().onDisconnection(
+                &static_cast<generic::GenericGattClient&>(deviceInstance().getGattClient()),
+                &generic::GenericGattClient::on_disconnection
+            );
             deviceInstance().initialization_status = INITIALIZED;
             _init_callback.call(&context);
         }   break;
@@ -27,6 +27,8 @@
 #undef NS_EVENTLOOP_USE_TICK_TIMER
 /* Exclude high resolution timer from build (removes need for "platform_timer" API) */
 #undef NS_EXCLUDE_HIGHRES_TIMER
+/* Run the system timer from one-shot high resolution timeouts instead of a periodic tick */
+#undef NS_EVENTLOOP_TICKLESS_TIMER
 
 /*
  * mbedOS 5 specific configuration flag mapping to internal flags
@@ -39,6 +41,10 @@
 #define NS_EXCLUDE_HIGHRES_TIMER        1
 #endif
 
+#ifdef MBED_CONF_NANOSTACK_EVENTLOOP_USE_TICKLESS_TIMER
+#define NS_EVENTLOOP_TICKLESS_TIMER     1
+#endif
+
 /*
  * For mbedOS 3 and minar use platform tick timer by default, highres timers should come from eventloop adaptor
  */
@@ -53,4 +59,8 @@
 #include NS_EVENTLOOP_USER_CONFIG_FILE
 #endif
 
+#if defined NS_EVENTLOOP_TICKLESS_TIMER && (defined NS_EVENTLOOP_USE_TICK_TIMER || defined NS_EXCLUDE_HIGHRES_TIMER)
+#error "Tickless system timer needs the high resolution timer and no platform tick timer"
+#endif
+
 #endif /* EVENTLOOP_CONFIG_H_ */
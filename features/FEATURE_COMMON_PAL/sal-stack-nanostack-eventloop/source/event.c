@@ -31,10 +31,33 @@ typedef struct arm_core_tasklet {
     ns_list_link_t link;
 } arm_core_tasklet_t;
 
+/* Active events are kept in one FIFO per priority level, with a bitmap of
+ * the non-empty levels, so that queueing and picking the next event take
+ * constant time however many events are pending. Bit 0 is the highest
+ * priority. Out of range priorities share an extra level after the lowest
+ * one. An event must not change priority while it is queued.
+ */
+#define EVENT_PRIORITY_LEVELS (ARM_LIB_LOW_PRIORITY_EVENT + 2)
+
+typedef NS_LIST_HEAD(arm_event_storage_t, link) event_queue_t;
+
 static NS_LIST_DEFINE(arm_core_tasklet_list, arm_core_tasklet_t, link);
-static NS_LIST_DEFINE(event_queue_active, arm_event_storage_t, link);
+static event_queue_t event_queue_active[EVENT_PRIORITY_LEVELS] = {
+    NS_LIST_INIT(event_queue_active[ARM_LIB_HIGH_PRIORITY_EVENT]),
+    NS_LIST_INIT(event_queue_active[ARM_LIB_MED_PRIORITY_EVENT]),
+    NS_LIST_INIT(event_queue_active[ARM_LIB_LOW_PRIORITY_EVENT]),
+    NS_LIST_INIT(event_queue_active[ARM_LIB_LOW_PRIORITY_EVENT + 1]),
+};
+static uint8_t event_queue_pending;
 static NS_LIST_DEFINE(free_event_entry, arm_event_storage_t, link);
 
+NS_STATIC_ASSERT(EVENT_PRIORITY_LEVELS == 4, "event_queue_active initialiser out of date")
+
+/* Lowest set bit of the pending mask, i.e. highest pending priority */
+static const int8_t event_queue_first_pending[1 << EVENT_PRIORITY_LEVELS] = {
+    -1, 0, 1, 0, 2, 0, 1, 0, 3, 0, 1, 0, 2, 0, 1, 0
+};
+
 // Statically allocate initial pool of events.
 #define STARTUP_EVENT_POOL_SIZE 10
 static arm_event_storage_t startup_event_pool[STARTUP_EVENT_POOL_SIZE];
@@ -140,9 +163,21 @@ void eventOS_event_send_timer_allocated(arm_event_storage_t *event)
     event_core_write(event);
 }
 
+static uint8_t event_priority_level(const arm_event_storage_t *event)
+{
+    if ((unsigned) event->data.priority > ARM_LIB_LOW_PRIORITY_EVENT) {
+        return ARM_LIB_LOW_PRIORITY_EVENT + 1;
+    }
+    return event->data.priority;
+}
+
 void eventOS_event_cancel_critical(arm_event_storage_t *event)
 {
-    ns_list_remove(&event_queue_active, event);
+    uint8_t level = event_priority_level(event);
+    ns_list_remove(&event_queue_active[level], event);
+    if (ns_list_is_empty(&event_queue_active[level])) {
+        event_queue_pending &= ~(1u << level);
+    }
 }
 
 static arm_event_storage_t *event_dynamically_allocate(void)
@@ -204,11 +239,16 @@ void event_core_free_push(arm_event_storage_t *free)
 
 static arm_event_storage_t *event_core_read(void)
 {
+    arm_event_storage_t *event = NULL;
     platform_enter_critical();
-    arm_event_storage_t *event = ns_list_get_first(&event_queue_active);
-    if (event) {
+    int8_t level = event_queue_first_pending[event_queue_pending];
+    if (level >= 0) {
+        event = ns_list_get_first(&event_queue_active[level]);
         event->state = ARM_LIB_EVENT_RUNNING;
-        ns_list_remove(&event_queue_active, event);
+        ns_list_remove(&event_queue_active[level], event);
+        if (ns_list_is_empty(&event_queue_active[level])) {
+            event_queue_pending &= ~(1u << level);
+        }
     }
     platform_exit_critical();
     return event;
@@ -216,19 +256,12 @@ static arm_event_storage_t *event_core_read(void)
 
 void event_core_write(arm_event_storage_t *event)
 {
+    uint8_t level = event_priority_level(event);
+
     platform_enter_critical();
-    bool added = false;
-    ns_list_foreach(arm_event_storage_t, event_tmp, &event_queue_active) {
-        // note enum ordering means we're checking if event_tmp is LOWER priority than event
-        if (event_tmp->data.priority > event->data.priority) {
-            ns_list_add_before(&event_queue_active, event_tmp, event);
-            added = true;
-            break;
-        }
-    }
-    if (!added) {
-        ns_list_add_to_end(&event_queue_active, event);
-    }
+    // Events of equal priority are handled in the order they were sent
+    ns_list_add_to_end(&event_queue_active[level], event);
+    event_queue_pending |= 1u << level;
     event->state = ARM_LIB_EVENT_QUEUED;
 
     /* Wake From Idle */
@@ -239,9 +272,11 @@ void event_core_write(arm_event_storage_t *event)
 // Requires lock to be held
 arm_event_storage_t *eventOS_event_find_by_id_critical(uint8_t tasklet_id, uint8_t event_id)
 {
-    ns_list_foreach(arm_event_storage_t, cur, &event_queue_active) {
-        if (cur->data.receiver == tasklet_id && cur->data.event_id == event_id) {
-            return cur;
+    for (uint8_t level = 0; level < EVENT_PRIORITY_LEVELS; level++) {
+        ns_list_foreach(arm_event_storage_t, cur, &event_queue_active[level]) {
+            if (cur->data.receiver == tasklet_id && cur->data.event_id == event_id) {
+                return cur;
+            }
         }
     }
 
@@ -259,7 +294,10 @@ void eventOS_scheduler_init(void)
 {
     /* Reset Event List variables */
     ns_list_init(&free_event_entry);
-    ns_list_init(&event_queue_active);
+    for (uint8_t level = 0; level < EVENT_PRIORITY_LEVELS; level++) {
+        ns_list_init(&event_queue_active[level]);
+    }
+    event_queue_pending = 0;
     ns_list_init(&arm_core_tasklet_list);
 
     //Add first 10 entries to "free" list
@@ -320,6 +320,37 @@ static void ns_timer_interrupt_handler(void)
     platform_exit_critical();
 }
 
+/* Slots until the timer expires, 0 if it is not running, -1 if it doesn't exist */
+int32_t ns_timer_get_remaining_slots(int8_t ns_timer_id)
+{
+    int32_t ret_val = -1;
+    uint16_t pl_timer_remaining_slots = 0;
+    ns_timer_struct *timer;
+
+    platform_enter_critical();
+    timer = ns_timer_get_pointer_to_timer_struct(ns_timer_id);
+    if (!timer) {
+        goto exit;
+    }
+
+    if (ns_timer_state & NS_TIMER_RUNNING) {
+        pl_timer_remaining_slots = platform_timer_get_remaining_slots();
+    }
+
+    if (timer->timer_state == NS_TIMER_ACTIVE) {
+        ret_val = pl_timer_remaining_slots;
+    } else if (timer->timer_state == NS_TIMER_HOLD) {
+        /* Hold-labelled timers count from the end of the current timeout */
+        ret_val = timer->remaining_slots + pl_timer_remaining_slots;
+    } else {
+        ret_val = 0;
+    }
+
+exit:
+    platform_exit_critical();
+    return ret_val;
+}
+
 int8_t eventOS_callback_timer_stop(int8_t ns_timer_id)
 {
     uint16_t pl_timer_remaining_slots;
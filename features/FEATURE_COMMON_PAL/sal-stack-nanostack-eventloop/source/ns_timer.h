@@ -24,6 +24,7 @@ extern "C" {
 
 #ifndef NS_EXCLUDE_HIGHRES_TIMER
 extern int8_t ns_timer_sleep(void);
+extern int32_t ns_timer_get_remaining_slots(int8_t ns_timer_id);
 #else
 #define ns_timer_sleep() ((int8_t) 0)
 #endif
@@ -32,6 +32,11 @@
 
 static sys_timer_struct_s startup_sys_timer_pool[ST_MAX];
 
+#ifndef TIMER_SYS_WHEEL_SIZE
+#define TIMER_SYS_WHEEL_SIZE 32
+#endif
+NS_STATIC_ASSERT((TIMER_SYS_WHEEL_SIZE & (TIMER_SYS_WHEEL_SIZE - 1)) == 0, "Timer wheel size must be a power of two")
+
 #define TIMER_SLOTS_PER_MS          20
 NS_STATIC_ASSERT(1000 % EVENTOS_EVENT_TIMER_HZ == 0, "Need whole number of ms per tick")
 #define TIMER_SYS_TICK_PERIOD       (1000 / EVENTOS_EVENT_TIMER_HZ) // milliseconds
@@ -40,15 +45,115 @@ NS_STATIC_ASSERT(1000 % EVENTOS_EVENT_TIMER_HZ == 0, "Need whole number of ms pe
 // atomicity on 16-bit platforms
 static volatile uint32_t timer_sys_ticks;
 
+typedef NS_LIST_HEAD(sys_timer_struct_s, event.link) sys_timer_list_t;
+
 static NS_LIST_DEFINE(system_timer_free, sys_timer_struct_s, event.link);
-static NS_LIST_DEFINE(system_timer_list, sys_timer_struct_s, event.link);
+
+/* Pending timers are kept in a hashed timing wheel: each slot lists the
+ * timers launching on the ticks that map to it, in order of request.
+ * Adding or removing a timer is constant time, and a tick only looks at
+ * the timers of its own slot. The slots are set up by timer_sys_init().
+ */
+static sys_timer_list_t system_timer_wheel[TIMER_SYS_WHEEL_SIZE];
+
+#define TIMER_SYS_WHEEL_SLOT(ticks) (&system_timer_wheel[(ticks) & (TIMER_SYS_WHEEL_SIZE - 1)])
 
 
 static sys_timer_struct_s *sys_timer_dynamically_allocate(void);
-static void timer_sys_interrupt(void);
 static void timer_sys_add(sys_timer_struct_s *timer);
+static bool timer_sys_next_launch(uint32_t *ticks);
+
+#ifdef NS_EVENTLOOP_TICKLESS_TIMER
+/* Tickless system timer
+ *
+ * Instead of a periodic tick, a one-shot eventOS timer is armed for the
+ * tick of the earliest pending timer. timer_sys_ticks is brought up to date
+ * from the remaining time of the one-shot whenever it is read. With no
+ * timers pending the one-shot still runs with its longest period to keep
+ * the tick count going.
+ */
+#define TIMER_SLOTS_PER_TICK        (TIMER_SLOTS_PER_MS * TIMER_SYS_TICK_PERIOD)
+#define TIMER_SYS_MAX_SLEEP_TICKS   (UINT16_MAX / TIMER_SLOTS_PER_TICK)
+
+static int8_t tick_timer_id = -1;       // eventOS timer id for the one-shot
+static bool tick_timer_enabled;         // false between timer_sys_disable() and timer_sys_wakeup()
+static uint16_t tick_timer_slots;       // slots the one-shot was started with, 0 if stopped
+static uint16_t tick_timer_offset;      // slots into the current tick when it was started
+static uint16_t tick_timer_credited;    // ticks of it already added to timer_sys_ticks
+static uint32_t tick_timer_expiry;      // tick at which it expires
+
+/* Called with lock held. Credits the ticks elapsed on the running one-shot
+ * and returns the slots since the tick boundary it was started from.
+ */
+static uint32_t timer_sys_sync(void)
+{
+    if (!tick_timer_slots) {
+        return 0;
+    }
+
+    uint32_t elapsed = tick_timer_slots;
+    int32_t remaining = ns_timer_get_remaining_slots(tick_timer_id);
+    if (remaining > 0) {
+        elapsed = remaining < tick_timer_slots ? tick_timer_slots - remaining : 0;
+    }
+
+    uint32_t position = tick_timer_offset + elapsed;
+    uint16_t ticks = position / TIMER_SLOTS_PER_TICK;
+    if (ticks > tick_timer_credited) {
+        uint16_t new_ticks = ticks - tick_timer_credited;
+        tick_timer_credited = ticks;
+        system_timer_tick_update(new_ticks);
+    }
+    return position;
+}
+
+/* Called with lock held. (Re)starts the one-shot for the earliest timer,
+ * keeping the phase of the tick in progress.
+ */
+static void timer_sys_tick_timer_arm(void)
+{
+    uint16_t phase = 0;
+    if (tick_timer_slots) {
+        phase = timer_sys_sync() % TIMER_SLOTS_PER_TICK;
+        eventOS_callback_timer_stop(tick_timer_id);
+    }
+
+    uint32_t ticks;
+    if (!timer_sys_next_launch(&ticks) || ticks > TIMER_SYS_MAX_SLEEP_TICKS) {
+        ticks = TIMER_SYS_MAX_SLEEP_TICKS;
+    } else if (ticks == 0) {
+        ticks = 1;
+    }
+
+    tick_timer_slots = ticks * TIMER_SLOTS_PER_TICK - phase;
+    tick_timer_offset = phase;
+    tick_timer_credited = 0;
+    tick_timer_expiry = timer_sys_ticks + ticks;
+    eventOS_callback_timer_start(tick_timer_id, tick_timer_slots);
+}
+
+// EventOS timer callback function
+static void tick_timer_eventOS_callback(int8_t timer_id, uint16_t slots)
+{
+    // Not interested in slots
+    (void)slots;
+    if (timer_id != tick_timer_id) {
+        return;
+    }
+
+    platform_enter_critical();
+    uint16_t ticks = (tick_timer_offset + tick_timer_slots) / TIMER_SLOTS_PER_TICK;
+    tick_timer_slots = 0;
+    if (ticks > tick_timer_credited) {
+        system_timer_tick_update(ticks - tick_timer_credited);
+    }
+    if (tick_timer_enabled) {
+        timer_sys_tick_timer_arm();
+    }
+    platform_exit_critical();
+}
 
-#ifndef NS_EVENTLOOP_USE_TICK_TIMER
+#elif !defined NS_EVENTLOOP_USE_TICK_TIMER
 static int8_t platform_tick_timer_start(uint32_t period_ms);
 /* Implement platform tick timer using eventOS timer */
 // platform tick timer callback function
@@ -83,7 +188,23 @@ static int8_t platform_tick_timer_stop(void)
 {
     return eventOS_callback_timer_stop(tick_timer_id);
 }
-#endif // !NS_EVENTLOOP_USE_TICK_TIMER
+#endif // NS_EVENTLOOP_TICKLESS_TIMER
+
+#ifndef NS_EVENTLOOP_TICKLESS_TIMER
+static void timer_sys_interrupt(void)
+{
+    system_timer_tick_update(1);
+}
+#endif
+
+/* Called with lock held */
+static uint32_t timer_sys_now(void)
+{
+#ifdef NS_EVENTLOOP_TICKLESS_TIMER
+    timer_sys_sync();
+#endif
+    return timer_sys_ticks;
+}
 
 /*
  * Initializes timers and starts system timer
@@ -93,9 +214,21 @@ void timer_sys_init(void)
     for (uint8_t i = 0; i < ST_MAX; i++) {
         ns_list_add_to_start(&system_timer_free, &startup_sys_timer_pool[i]);
     }
+    for (uint8_t i = 0; i < TIMER_SYS_WHEEL_SIZE; i++) {
+        ns_list_init(&system_timer_wheel[i]);
+    }
 
+#ifdef NS_EVENTLOOP_TICKLESS_TIMER
+    tick_timer_id = eventOS_callback_timer_register(tick_timer_eventOS_callback);
+    platform_enter_critical();
+    tick_timer_slots = 0;
+    tick_timer_enabled = true;
+    timer_sys_tick_timer_arm();
+    platform_exit_critical();
+#else
     platform_tick_timer_register(timer_sys_interrupt);
     platform_tick_timer_start(TIMER_SYS_TICK_PERIOD);
+#endif
 }
 
 
@@ -103,21 +236,35 @@ void timer_sys_init(void)
 /*-------------------SYSTEM TIMER FUNCTIONS--------------------------*/
 void timer_sys_disable(void)
 {
+#ifdef NS_EVENTLOOP_TICKLESS_TIMER
+    platform_enter_critical();
+    if (tick_timer_slots) {
+        timer_sys_sync();
+        eventOS_callback_timer_stop(tick_timer_id);
+        tick_timer_slots = 0;
+    }
+    tick_timer_enabled = false;
+    platform_exit_critical();
+#else
     platform_tick_timer_stop();
+#endif
 }
 
 /*
- * Starts ticking system timer interrupts every 10ms
+ * Starts ticking system timer interrupts every 10ms, or in tickless mode
+ * arms the system timer for the next pending timer
  */
 int8_t timer_sys_wakeup(void)
 {
+#ifdef NS_EVENTLOOP_TICKLESS_TIMER
+    platform_enter_critical();
+    tick_timer_enabled = true;
+    timer_sys_tick_timer_arm();
+    platform_exit_critical();
+    return 0;
+#else
     return platform_tick_timer_start(TIMER_SYS_TICK_PERIOD);
-}
-
-
-static void timer_sys_interrupt(void)
-{
-    system_timer_tick_update(1);
+#endif
 }
 
 
@@ -153,7 +300,7 @@ void timer_sys_event_free(arm_event_storage_t *event)
     } else {
         // Periodic - check due time of next launch
         timer->launch_time += timer->period;
-        if (TICKS_BEFORE_OR_AT(timer->launch_time, timer_sys_ticks)) {
+        if (TICKS_BEFORE_OR_AT(timer->launch_time, timer_sys_now())) {
             // next event is overdue - queue event now
             eventOS_event_send_timer_allocated(&timer->event);
         } else {
@@ -170,7 +317,7 @@ void timer_sys_event_cancel_critical(struct arm_event_storage *event)
     timer->period = 0;
     // If its unqueued it is on my timer list, otherwise it is in event-loop.
     if (event->state == ARM_LIB_EVENT_UNQUEUED) {
-        ns_list_remove(&system_timer_list, timer);
+        ns_list_remove(TIMER_SYS_WHEEL_SLOT(timer->launch_time), timer);
     }
 }
 
@@ -180,7 +327,7 @@ uint32_t eventOS_event_timer_ticks(void)
     // Enter/exit critical is a bit clunky, but necessary on 16-bit platforms,
     // which won't be able to do an atomic 32-bit read.
     platform_enter_critical();
-    ret_val = timer_sys_ticks;
+    ret_val = timer_sys_now();
     platform_exit_critical();
     return ret_val;
 }
@@ -188,19 +335,42 @@ uint32_t eventOS_event_timer_ticks(void)
 /* Called internally with lock held */
 static void timer_sys_add(sys_timer_struct_s *timer)
 {
-    uint32_t at = timer->launch_time;
-
-    // Find first timer scheduled to run after us, and insert before it.
-    // (This means timers scheduled for same time run in order of request)
-    ns_list_foreach(sys_timer_struct_s, t, &system_timer_list) {
-        if (TICKS_BEFORE(at, t->launch_time)) {
-            ns_list_add_before(&system_timer_list, t, timer);
-            return;
+    // Adding to the end of the slot means timers scheduled for the same
+    // time run in order of request
+    ns_list_add_to_end(TIMER_SYS_WHEEL_SLOT(timer->launch_time), timer);
+
+#ifdef NS_EVENTLOOP_TICKLESS_TIMER
+    if (tick_timer_enabled && (!tick_timer_slots || TICKS_BEFORE(timer->launch_time, tick_timer_expiry))) {
+        timer_sys_tick_timer_arm();
+    }
+#endif
+}
+
+/* Called internally with lock held. Finds the ticks until the earliest
+ * pending timer, 0 if it is overdue. Returns false if there are none.
+ */
+static bool timer_sys_next_launch(uint32_t *ticks)
+{
+    bool found = false;
+
+    for (uint32_t i = 1; i <= TIMER_SYS_WHEEL_SIZE; i++) {
+        ns_list_foreach(sys_timer_struct_s, cur, TIMER_SYS_WHEEL_SLOT(timer_sys_ticks + i)) {
+            uint32_t in = 0;
+            if (TICKS_AFTER(cur->launch_time, timer_sys_ticks)) {
+                in = cur->launch_time - timer_sys_ticks;
+            }
+            if (!found || in < *ticks) {
+                *ticks = in;
+                found = true;
+            }
+        }
+        // Timers in the remaining slots launch at least i + 1 ticks away
+        if (found && *ticks <= i) {
+            break;
         }
     }
 
-    // Didn't insert before another timer, so must be last.
-    ns_list_add_to_end(&system_timer_list, timer);
+    return found;
 }
 
 /* Called internally with lock held */
@@ -224,7 +394,7 @@ static arm_event_storage_t *eventOS_event_timer_request_at_(const arm_event_t *e
     timer->launch_time = at;
     timer->period = period;
 
-    if (TICKS_BEFORE_OR_AT(at, timer_sys_ticks)) {
+    if (TICKS_BEFORE_OR_AT(at, timer_sys_now())) {
         eventOS_event_send_timer_allocated(&timer->event);
     } else {
         timer_sys_add(timer);
@@ -248,7 +418,7 @@ arm_event_storage_t *eventOS_event_timer_request_in(const arm_event_t *event, in
 {
     platform_enter_critical();
 
-    arm_event_storage_t *ret = eventOS_event_timer_request_at_(event, timer_sys_ticks + in, 0);
+    arm_event_storage_t *ret = eventOS_event_timer_request_at_(event, timer_sys_now() + in, 0);
 
     platform_exit_critical();
 
@@ -264,7 +434,7 @@ arm_event_storage_t *eventOS_event_timer_request_every(const arm_event_t *event,
 
     platform_enter_critical();
 
-    arm_event_storage_t *ret = eventOS_event_timer_request_at_(event, timer_sys_ticks + period, period);
+    arm_event_storage_t *ret = eventOS_event_timer_request_at_(event, timer_sys_now() + period, period);
 
     platform_exit_critical();
 
@@ -297,7 +467,7 @@ int8_t eventOS_event_timer_request(uint8_t event_id, uint8_t event_type, int8_t
     }
 
     platform_enter_critical();
-    arm_event_storage_t *ret = eventOS_event_timer_request_at_(&event, timer_sys_ticks + time, 0);
+    arm_event_storage_t *ret = eventOS_event_timer_request_at_(&event, timer_sys_now() + time, 0);
     platform_exit_critical();
     return ret?0:-1;
 }
@@ -307,10 +477,12 @@ int8_t eventOS_event_timer_cancel(uint8_t event_id, int8_t tasklet_id)
     platform_enter_critical();
 
     /* First check pending timers */
-    ns_list_foreach(sys_timer_struct_s, cur, &system_timer_list) {
-        if (cur->event.data.receiver == tasklet_id && cur->event.data.event_id == event_id) {
-            eventOS_cancel(&cur->event);
-            goto done;
+    for (uint8_t i = 0; i < TIMER_SYS_WHEEL_SIZE; i++) {
+        ns_list_foreach(sys_timer_struct_s, cur, &system_timer_wheel[i]) {
+            if (cur->event.data.receiver == tasklet_id && cur->event.data.event_id == event_id) {
+                eventOS_cancel(&cur->event);
+                goto done;
+            }
         }
     }
 
@@ -335,15 +507,13 @@ uint32_t eventOS_event_timer_shortest_active_timer(void)
     uint32_t ret_val = 0;
 
     platform_enter_critical();
-    sys_timer_struct_s *first = ns_list_get_first(&system_timer_list);
-    if (first == NULL) {
+    timer_sys_now();
+    if (!timer_sys_next_launch(&ret_val)) {
         // Weird API has 0 for "no events"
         ret_val = 0;
-    } else if (TICKS_BEFORE_OR_AT(first->launch_time, timer_sys_ticks)) {
+    } else if (ret_val == 0) {
         // Which means an immediate/overdue event has to be 1
         ret_val = 1;
-    } else {
-        ret_val = first->launch_time - timer_sys_ticks;
     }
 
     platform_exit_critical();
@@ -353,18 +523,26 @@ uint32_t eventOS_event_timer_shortest_active_timer(void)
 void system_timer_tick_update(uint32_t ticks)
 {
     platform_enter_critical();
+    uint32_t first_tick = timer_sys_ticks + 1;
     //Keep runtime time
     timer_sys_ticks += ticks;
-    ns_list_foreach_safe(sys_timer_struct_s, cur, &system_timer_list) {
-        if (TICKS_BEFORE_OR_AT(cur->launch_time, timer_sys_ticks)) {
-            // Unthread from our list
-            ns_list_remove(&system_timer_list, cur);
-            // Make it an event (can't fail - no allocation)
-            // event system will call our timer_sys_event_free on event delivery.
-            eventOS_event_send_timer_allocated(&cur->event);
-        } else {
-            // List is ordered, so as soon as we see a later event, we're done.
-            break;
+
+    // Visit the slot of every tick that passed, each slot at most once.
+    // After a jump of more than a full turn of the wheel, overdue timers
+    // are delivered in slot order rather than strictly by launch time.
+    if (ticks > TIMER_SYS_WHEEL_SIZE) {
+        ticks = TIMER_SYS_WHEEL_SIZE;
+    }
+    for (uint32_t i = 0; i < ticks; i++) {
+        sys_timer_list_t *slot = TIMER_SYS_WHEEL_SLOT(first_tick + i);
+        ns_list_foreach_safe(sys_timer_struct_s, cur, slot) {
+            if (TICKS_BEFORE_OR_AT(cur->launch_time, timer_sys_ticks)) {
+                // Unthread from our list
+                ns_list_remove(slot, cur);
+                // Make it an event (can't fail - no allocation)
+                // event system will call our timer_sys_event_free on event delivery.
+                eventOS_event_send_timer_allocated(&cur->event);
+            }
         }
     }
 
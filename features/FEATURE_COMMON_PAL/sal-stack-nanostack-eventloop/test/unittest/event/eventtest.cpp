@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2018 ARM Limited. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "eventOS_event.h"
+#include "eventOS_scheduler.h"
+#include "event.h"
+
+#define INIT_EVENT 0xff
+#define MAX_RECORDED 16
+
+// Events kept queued while measuring throughput
+#define BENCHMARK_BACKLOG 64
+#define BENCHMARK_EVENTS 1000000
+
+static uint8_t recorded[MAX_RECORDED];
+static int recorded_count;
+
+static void record_handler(arm_event_s *event)
+{
+    if (event->event_type != INIT_EVENT && recorded_count < MAX_RECORDED) {
+        recorded[recorded_count++] = event->event_id;
+    }
+}
+
+static unsigned handled_count;
+
+static void count_handler(arm_event_s *event)
+{
+    handled_count++;
+}
+
+static int8_t send_event(int8_t tasklet, uint8_t event_id, arm_library_event_priority_e priority)
+{
+    arm_event_t event = {
+        .receiver = tasklet,
+        .sender = 0,
+        .event_type = 1,
+        .event_id = event_id,
+        .data_ptr = NULL,
+        .priority = priority,
+        .event_data = 0,
+    };
+    return eventOS_event_send(&event);
+}
+
+static void check_recorded(const uint8_t *expected, int count)
+{
+    LONGS_EQUAL(count, recorded_count);
+    for (int i = 0; i < count; i++) {
+        LONGS_EQUAL(expected[i], recorded[i]);
+    }
+}
+
+TEST_GROUP(event)
+{
+    int8_t tasklet;
+
+    void setup() {
+        eventOS_scheduler_init();
+        tasklet = eventOS_event_handler_create(record_handler, INIT_EVENT);
+        CHECK(tasklet >= 0);
+        eventOS_scheduler_run_until_idle();
+        recorded_count = 0;
+    }
+
+    void teardown() {
+        eventOS_scheduler_run_until_idle();
+    }
+};
+
+TEST(event, priority_order)
+{
+    send_event(tasklet, 1, ARM_LIB_LOW_PRIORITY_EVENT);
+    send_event(tasklet, 2, ARM_LIB_MED_PRIORITY_EVENT);
+    send_event(tasklet, 3, ARM_LIB_HIGH_PRIORITY_EVENT);
+    send_event(tasklet, 4, ARM_LIB_MED_PRIORITY_EVENT);
+
+    eventOS_scheduler_run_until_idle();
+
+    const uint8_t expected[] = { 3, 2, 4, 1 };
+    check_recorded(expected, 4);
+}
+
+TEST(event, fifo_within_priority)
+{
+    for (uint8_t i = 1; i <= 12; i++) {
+        send_event(tasklet, i, ARM_LIB_LOW_PRIORITY_EVENT);
+    }
+    CHECK(eventOS_scheduler_dispatch_event());
+
+    // Higher priority events queued later still go first
+    send_event(tasklet, 13, ARM_LIB_HIGH_PRIORITY_EVENT);
+    eventOS_scheduler_run_until_idle();
+
+    const uint8_t expected[] = { 1, 13, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+    check_recorded(expected, 13);
+    CHECK(!eventOS_scheduler_dispatch_event());
+}
+
+TEST(event, out_of_range_priority)
+{
+    send_event(tasklet, 1, (arm_library_event_priority_e) 7);
+    send_event(tasklet, 2, ARM_LIB_LOW_PRIORITY_EVENT);
+    send_event(tasklet, 3, ARM_LIB_MED_PRIORITY_EVENT);
+
+    eventOS_scheduler_run_until_idle();
+
+    const uint8_t expected[] = { 3, 2, 1 };
+    check_recorded(expected, 3);
+}
+
+TEST(event, cancel)
+{
+    arm_event_storage_t events[3];
+
+    for (uint8_t i = 0; i < 3; i++) {
+        memset(&events[i], 0, sizeof(events[i]));
+        events[i].data.receiver = tasklet;
+        events[i].data.event_id = i + 1;
+        events[i].data.priority = i == 1 ? ARM_LIB_HIGH_PRIORITY_EVENT : ARM_LIB_LOW_PRIORITY_EVENT;
+        eventOS_event_send_user_allocated(&events[i]);
+    }
+
+    POINTERS_EQUAL(&events[1], eventOS_event_find_by_id_critical(tasklet, 2));
+    POINTERS_EQUAL(&events[2], eventOS_event_find_by_id_critical(tasklet, 3));
+    POINTERS_EQUAL(NULL, eventOS_event_find_by_id_critical(tasklet, 4));
+
+    // Emptying the high priority queue must not hide the low priority one
+    eventOS_cancel(&events[1]);
+    LONGS_EQUAL(arm_event_storage_t::ARM_LIB_EVENT_UNQUEUED, events[1].state);
+    POINTERS_EQUAL(NULL, eventOS_event_find_by_id_critical(tasklet, 2));
+    eventOS_cancel(&events[2]);
+
+    eventOS_scheduler_run_until_idle();
+
+    const uint8_t expected[] = { 1 };
+    check_recorded(expected, 1);
+}
+
+TEST(event, throughput)
+{
+    static const arm_library_event_priority_e priorities[] = {
+        ARM_LIB_LOW_PRIORITY_EVENT,
+        ARM_LIB_MED_PRIORITY_EVENT,
+        ARM_LIB_LOW_PRIORITY_EVENT,
+        ARM_LIB_HIGH_PRIORITY_EVENT,
+    };
+    int8_t counter = eventOS_event_handler_create(count_handler, INIT_EVENT);
+    CHECK(counter >= 0);
+    eventOS_scheduler_run_until_idle();
+
+    for (int i = 0; i < BENCHMARK_BACKLOG; i++) {
+        send_event(counter, 0, priorities[i % 4]);
+    }
+
+    // Keep the backlog at a constant depth: one event out, one event in
+    handled_count = 0;
+    clock_t start = clock();
+    for (int i = 0; i < BENCHMARK_EVENTS; i++) {
+        eventOS_scheduler_dispatch_event();
+        send_event(counter, 0, priorities[i % 4]);
+    }
+    clock_t elapsed = clock() - start;
+    eventOS_scheduler_run_until_idle();
+
+    LONGS_EQUAL(BENCHMARK_EVENTS + BENCHMARK_BACKLOG, handled_count);
+
+    double seconds = (double) elapsed / CLOCKS_PER_SEC;
+    printf("\nevent loop: %d events with %d queued in %.3f s, %.0f events/s\n",
+           BENCHMARK_EVENTS, BENCHMARK_BACKLOG, seconds,
+           seconds > 0 ? BENCHMARK_EVENTS / seconds : 0.0);
+}
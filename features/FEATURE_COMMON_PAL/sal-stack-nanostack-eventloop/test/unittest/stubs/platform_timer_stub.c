@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2018 ARM Limited. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ns_types.h"
+#include "platform/arm_hal_timer.h"
+#include "platform_timer_stub.h"
+
+platform_timer_stub_data_t platform_timer_stub;
+
+static platform_timer_cb timer_cb;
+static bool running;
+static uint32_t due;
+
+void platform_timer_enable(void)
+{
+}
+
+void platform_timer_set_cb(platform_timer_cb new_fp)
+{
+    timer_cb = new_fp;
+}
+
+void platform_timer_start(uint16_t slots)
+{
+    running = true;
+    due = platform_timer_stub.now + slots;
+}
+
+void platform_timer_disable(void)
+{
+    running = false;
+}
+
+uint16_t platform_timer_get_remaining_slots(void)
+{
+    if (!running || due <= platform_timer_stub.now) {
+        return 0;
+    }
+    return due - platform_timer_stub.now;
+}
+
+void platform_timer_stub_advance(uint32_t slots)
+{
+    uint32_t end = platform_timer_stub.now + slots;
+
+    while (running && due <= end) {
+        platform_timer_stub.now = due;
+        running = false;
+        platform_timer_stub.interrupts++;
+        timer_cb();
+    }
+    platform_timer_stub.now = end;
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2018 ARM Limited. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef PLATFORM_TIMER_STUB_H
+#define PLATFORM_TIMER_STUB_H
+
+#include "ns_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Simulated high resolution timer, time counts in 50us slots */
+typedef struct {
+    uint32_t now;
+    unsigned interrupts;
+} platform_timer_stub_data_t;
+
+extern platform_timer_stub_data_t platform_timer_stub;
+
+/* Let time pass, running the timer interrupt whenever it expires */
+void platform_timer_stub_advance(uint32_t slots);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
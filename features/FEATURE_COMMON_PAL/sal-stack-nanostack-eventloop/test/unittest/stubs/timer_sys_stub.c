@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2018 ARM Limited. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "ns_types.h"
+#include "timer_sys.h"
+#include "ns_timer.h"
+
+void timer_sys_init(void)
+{
+}
+
+int8_t timer_sys_wakeup(void)
+{
+    return 0;
+}
+
+void timer_sys_disable(void)
+{
+}
+
+void timer_sys_event_free(struct arm_event_storage *event)
+{
+}
+
+void timer_sys_event_cancel_critical(struct arm_event_storage *event)
+{
+}
+
+void system_timer_tick_update(uint32_t ticks)
+{
+}
+
+int8_t ns_timer_sleep(void)
+{
+    return 0;
+}
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2018 ARM Limited. All rights reserved.
+ * SPDX-License-Identifier: Apache-2.0
+ * Licensed under the Apache License, Version 2.0 (the License); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an AS IS BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include <string.h>
+#include "eventOS_event.h"
+#include "eventOS_event_timer.h"
+#include "eventOS_scheduler.h"
+#include "platform_timer_stub.h"
+
+#define INIT_EVENT 0xff
+#define MAX_RECORDED 8
+
+// 50us slots in one 10ms system timer tick
+#define SLOTS_PER_TICK 200
+
+typedef struct {
+    uint8_t event_id;
+    uint32_t tick;
+} record_t;
+
+static record_t recorded[MAX_RECORDED];
+static int recorded_count;
+static int8_t tasklet = -1;
+
+static void record_handler(arm_event_s *event)
+{
+    if (event->event_type != INIT_EVENT && recorded_count < MAX_RECORDED) {
+        recorded[recorded_count].event_id = event->event_id;
+        recorded[recorded_count].tick = eventOS_event_timer_ticks();
+        recorded_count++;
+    }
+}
+
+static arm_event_t timer_event(uint8_t event_id)
+{
+    arm_event_t event = {
+        .receiver = tasklet,
+        .sender = 0,
+        .event_type = 1,
+        .event_id = event_id,
+        .data_ptr = NULL,
+        .priority = ARM_LIB_MED_PRIORITY_EVENT,
+        .event_data = 0,
+    };
+    return event;
+}
+
+static void request_in(uint8_t event_id, int32_t ticks)
+{
+    arm_event_t event = timer_event(event_id);
+    CHECK(eventOS_event_timer_request_in(&event, ticks) != NULL);
+}
+
+// Dispatch after every tick, so events record the tick they fired on
+static void advance_ticks(uint32_t ticks)
+{
+    for (uint32_t i = 0; i < ticks; i++) {
+        platform_timer_stub_advance(SLOTS_PER_TICK);
+        eventOS_scheduler_run_until_idle();
+    }
+}
+
+static void check_recorded(int index, uint8_t event_id, uint32_t tick)
+{
+    CHECK(index < recorded_count);
+    LONGS_EQUAL(event_id, recorded[index].event_id);
+    LONGS_EQUAL(tick, recorded[index].tick);
+}
+
+TEST_GROUP(system_timer)
+{
+    void setup() {
+        if (tasklet < 0) {
+            eventOS_scheduler_init();
+            tasklet = eventOS_event_handler_create(record_handler, INIT_EVENT);
+            eventOS_scheduler_run_until_idle();
+        }
+        recorded_count = 0;
+        platform_timer_stub.interrupts = 0;
+    }
+
+    void teardown() {
+        // Leave no timers behind for the next test
+        LONGS_EQUAL(0, eventOS_event_timer_shortest_active_timer());
+    }
+};
+
+TEST(system_timer, one_shot_timers)
+{
+    uint32_t start = eventOS_event_timer_ticks();
+    request_in(3, 400);
+    request_in(1, 5);
+    request_in(2, 50);
+
+    advance_ticks(400);
+
+    LONGS_EQUAL(3, recorded_count);
+    check_recorded(0, 1, start + 5);
+    check_recorded(1, 2, start + 50);
+    check_recorded(2, 3, start + 400);
+}
+
+TEST(system_timer, same_tick_in_request_order)
+{
+    uint32_t start = eventOS_event_timer_ticks();
+    request_in(1, 40);
+    request_in(2, 8);
+    request_in(3, 40);
+
+    advance_ticks(40);
+
+    LONGS_EQUAL(3, recorded_count);
+    check_recorded(0, 2, start + 8);
+    check_recorded(1, 1, start + 40);
+    check_recorded(2, 3, start + 40);
+}
+
+TEST(system_timer, wakes_only_for_timers)
+{
+    uint32_t start = eventOS_event_timer_ticks();
+    advance_ticks(1);
+    request_in(1, 100);
+    platform_timer_stub.interrupts = 0;
+
+    advance_ticks(100);
+    LONGS_EQUAL(1, platform_timer_stub.interrupts);
+    check_recorded(0, 1, start + 101);
+
+    // With nothing pending the tick count is kept with rare wakeups
+    platform_timer_stub.interrupts = 0;
+    advance_ticks(1000);
+    CHECK(platform_timer_stub.interrupts <= 4);
+    LONGS_EQUAL(start + 1101, eventOS_event_timer_ticks());
+}
+
+TEST(system_timer, earlier_timer_rearms)
+{
+    uint32_t start = eventOS_event_timer_ticks();
+    request_in(1, 100);
+
+    advance_ticks(30);
+    platform_timer_stub_advance(SLOTS_PER_TICK / 2);
+    LONGS_EQUAL(start + 30, eventOS_event_timer_ticks());
+
+    // Requested half way through a tick, due on the tick boundary
+    request_in(2, 10);
+    platform_timer_stub_advance(SLOTS_PER_TICK / 2);
+    LONGS_EQUAL(start + 31, eventOS_event_timer_ticks());
+    advance_ticks(69);
+
+    LONGS_EQUAL(2, recorded_count);
+    check_recorded(0, 2, start + 40);
+    check_recorded(1, 1, start + 100);
+}
+
+TEST(system_timer, periodic_and_cancel)
+{
+    uint32_t start = eventOS_event_timer_ticks();
+    arm_event_t event = timer_event(1);
+    CHECK(eventOS_event_timer_request_every(&event, 7) != NULL);
+
+    advance_ticks(21);
+    LONGS_EQUAL(3, recorded_count);
+    check_recorded(0, 1, start + 7);
+    check_recorded(1, 1, start + 14);
+    check_recorded(2, 1, start + 21);
+
+    LONGS_EQUAL(0, eventOS_event_timer_cancel(1, tasklet));
+    advance_ticks(14);
+    LONGS_EQUAL(3, recorded_count);
+    LONGS_EQUAL(-1, eventOS_event_timer_cancel(1, tasklet));
+}
+
+TEST(system_timer, shortest_active_timer)
+{
+    request_in(1, 60);
+    request_in(2, 25);
+    LONGS_EQUAL(250, eventOS_event_timer_shortest_active_timer());
+
+    LONGS_EQUAL(0, eventOS_event_timer_cancel(2, tasklet));
+    LONGS_EQUAL(600, eventOS_event_timer_shortest_active_timer());
+    LONGS_EQUAL(0, eventOS_event_timer_cancel(1, tasklet));
+}
+
+TEST(system_timer, synch_after_sleep)
+{
+    uint32_t start = eventOS_event_timer_ticks();
+    request_in(1, 100);
+
+    LONGS_EQUAL(0, eventOS_scheduler_timer_stop());
+    platform_timer_stub.interrupts = 0;
+    platform_timer_stub_advance(50 * SLOTS_PER_TICK);
+    LONGS_EQUAL(0, platform_timer_stub.interrupts);
+    LONGS_EQUAL(start, eventOS_event_timer_ticks());
+
+    // Sleep is rounded up to the next tick
+    LONGS_EQUAL(0, eventOS_scheduler_timer_synch_after_sleep(500));
+    LONGS_EQUAL(start + 51, eventOS_event_timer_ticks());
+
+    advance_ticks(49);
+    LONGS_EQUAL(1, recorded_count);
+    check_recorded(0, 1, start + 100);
+}
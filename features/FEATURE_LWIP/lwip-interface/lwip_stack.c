@@ -29,6 +29,7 @@
 #include "lwip/netif.h"
 #include "lwip/dhcp.h"
 #include "lwip/tcpip.h"
+#include "lwip/priv/tcpip_priv.h"
 #include "lwip/tcp.h"
 #include "lwip/ip.h"
 #include "lwip/mld6.h"
@@ -1290,6 +1291,120 @@ static nsapi_size_or_error_t mbed_lwip_socket_recvfrom(nsapi_stack_t *stack, nsa
     return recv;
 }
 
+#if LWIP_UDP
+/* Batched sendto, runs with the core locked or in the tcpip thread */
+struct mbed_lwip_sendto_batch_call {
+    struct tcpip_api_call_data call;
+    struct lwip_socket *s;
+    nsapi_dgram_t *msgs;
+    unsigned count;
+    unsigned sent;
+};
+
+static err_t mbed_lwip_do_sendto_batch(struct tcpip_api_call_data *m)
+{
+    struct mbed_lwip_sendto_batch_call *b = (struct mbed_lwip_sendto_batch_call *)m;
+    struct udp_pcb *pcb = b->s->conn->pcb.udp;
+
+    if (!pcb) {
+        return ERR_CLSD;
+    }
+
+    for (b->sent = 0; b->sent < b->count; b->sent++) {
+        nsapi_dgram_t *msg = &b->msgs[b->sent];
+        ip_addr_t ip_addr;
+
+        /* A pbuf length is 16 bits, a larger datagram would be truncated */
+        if (msg->size > 0xFFFF || !convert_mbed_addr_to_lwip(&ip_addr, &msg->addr)) {
+            msg->result = NSAPI_ERROR_PARAMETER;
+            break;
+        }
+
+        /* Reference the caller's buffer, the same as netbuf_ref */
+        struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, 0, PBUF_REF);
+        if (!p) {
+            msg->result = NSAPI_ERROR_NO_MEMORY;
+            break;
+        }
+        p->payload = msg->data;
+        p->len = p->tot_len = (u16_t)msg->size;
+
+        err_t err = udp_sendto(pcb, p, &ip_addr, msg->port);
+        pbuf_free(p);
+        if (err != ERR_OK) {
+            msg->result = mbed_lwip_err_remap(err);
+            break;
+        }
+
+        msg->result = msg->size;
+    }
+
+    return ERR_OK;
+}
+
+static nsapi_size_or_error_t mbed_lwip_socket_sendto_batch(nsapi_stack_t *stack, nsapi_socket_t handle, nsapi_dgram_t *msgs, unsigned count)
+{
+    struct lwip_socket *s = (struct lwip_socket *)handle;
+    struct mbed_lwip_sendto_batch_call b;
+
+    if (NETCONNTYPE_GROUP(s->conn->type) != NETCONN_UDP) {
+        return NSAPI_ERROR_UNSUPPORTED;
+    }
+
+    b.s = s;
+    b.msgs = msgs;
+    b.count = count;
+    b.sent = 0;
+
+    /* One stack handoff for the whole batch instead of one per datagram */
+    err_t err = tcpip_api_call(mbed_lwip_do_sendto_batch, &b.call);
+    if (err != ERR_OK) {
+        return mbed_lwip_err_remap(err);
+    }
+
+    if (b.sent == 0 && count > 0) {
+        return msgs[0].result;
+    }
+
+    return b.sent;
+}
+
+static nsapi_size_or_error_t mbed_lwip_socket_recvfrom_batch(nsapi_stack_t *stack, nsapi_socket_t handle, nsapi_dgram_t *msgs, unsigned count)
+{
+    struct lwip_socket *s = (struct lwip_socket *)handle;
+    unsigned received;
+
+    /* UDP receives only fetch from the netconn mailbox, so the batch just
+     * drains it without a round trip through the stack per datagram */
+    for (received = 0; received < count; received++) {
+        nsapi_dgram_t *msg = &msgs[received];
+        struct netbuf *buf;
+
+        if (msg->size > 0xFFFF) {
+            msg->result = NSAPI_ERROR_PARAMETER;
+            break;
+        }
+
+        err_t err = netconn_recv(s->conn, &buf);
+        if (err != ERR_OK) {
+            msg->result = mbed_lwip_err_remap(err);
+            break;
+        }
+
+        convert_lwip_addr_to_mbed(&msg->addr, netbuf_fromaddr(buf));
+        msg->port = netbuf_fromport(buf);
+        msg->result = netbuf_copy(buf, msg->data, (u16_t)msg->size);
+        netbuf_delete(buf);
+    }
+
+    if (received == 0 && count > 0) {
+        return msgs[0].result;
+    }
+
+    return received;
+}
+#endif
+
 static int32_t find_multicast_member(const struct lwip_socket *s, const nsapi_ip_mreq_t *imr) {
     uint32_t count = 0;
     uint32_t index = 0;
@@ -1477,6 +1592,10 @@ const nsapi_stack_api_t lwip_stack_api = {
     .socket_recvfrom    = mbed_lwip_socket_recvfrom,
     .setsockopt         = mbed_lwip_setsockopt,
     .socket_attach      = mbed_lwip_socket_attach,
+#if LWIP_UDP
+    .socket_sendto_batch    = mbed_lwip_socket_sendto_batch,
+    .socket_recvfrom_batch  = mbed_lwip_socket_recvfrom_batch,
+#endif
 };
 
 nsapi_stack_t lwip_stack = {
@@ -216,3 +216,18 @@ TEST(ATHandler, test_ATHandler_get_3gpp_error)
 {
     unit->test_ATHandler_get_3gpp_error();
 }
+
+TEST(ATHandler, test_ATHandler_urc_prefix_trie)
+{
+    unit->test_ATHandler_urc_prefix_trie();
+}
+
+TEST(ATHandler, test_ATHandler_read_bytes_bulk)
+{
+    unit->test_ATHandler_read_bytes_bulk();
+}
+
+TEST(ATHandler, test_ATHandler_receive_benchmark)
+{
+    unit->test_ATHandler_receive_benchmark();
+}
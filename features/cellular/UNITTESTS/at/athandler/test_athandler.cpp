@@ -26,6 +26,7 @@
 #include "mbed_poll_stub.h"
 
 #include "Timer_stub.h"
+#include <time.h>
 
 using namespace mbed;
 using namespace events;
@@ -34,6 +35,25 @@ void urc_callback()
 {
 }
 
+static int urc_cmt_count;
+static int urc_cmti_count;
+static int urc_creg_count;
+
+static void urc_cmt_callback()
+{
+    urc_cmt_count++;
+}
+
+static void urc_cmti_callback()
+{
+    urc_cmti_count++;
+}
+
+static void urc_creg_callback()
+{
+    urc_creg_count++;
+}
+
 Test_ATHandler::Test_ATHandler()
 {
 
@@ -404,7 +424,8 @@ void Test_ATHandler::test_ATHandler_skip_param()
     ATHandler at(&fh1, que, 0, ",");
     at.skip_param();
 
-    char table[] = "ssssssssssssssssssssssssssssOK\r\n\0";
+    // No delimiter and no stop tag before the data runs out
+    char table[] = "ssssssssssssssssssssssssssss\0";
     filehandle_stub_table = table;
     filehandle_stub_table_pos = 0;
 
@@ -467,6 +488,8 @@ void Test_ATHandler::test_ATHandler_read_bytes()
     EventQueue que;
     FileHandle_stub fh1;
 
+    filehandle_stub_table = NULL;
+
     ATHandler at(&fh1, que, 0, ",");
     uint8_t buf[5];
     CHECK(-1 == at.read_bytes(buf, 25));
@@ -771,3 +794,146 @@ void Test_ATHandler::test_ATHandler_get_3gpp_error()
     ATHandler at(&fh1, que, 0, ",");
     int ret = at.get_3gpp_error();
 }
+
+void Test_ATHandler::test_ATHandler_urc_prefix_trie()
+{
+    EventQueue que;
+    FileHandle_stub fh1;
+
+    urc_cmt_count = 0;
+    urc_cmti_count = 0;
+    urc_creg_count = 0;
+
+    ATHandler at(&fh1, que, 0, ",");
+    at.set_urc_handler("+CMT:", &urc_callback);
+    at.set_urc_handler("+CMTI:", &urc_cmti_callback);
+    at.set_urc_handler("+CREG:", &urc_creg_callback);
+    // replaces the previous callback of the prefix
+    at.set_urc_handler("+CMT:", &urc_cmt_callback);
+
+    char table[] = "+CMTI: \"SM\",1\r\n+CMT: ,24\r\n+CREG: 1\r\n+CMTX: 2\r\n+CSQ: 21,99\r\nOK\r\n\0";
+    filehandle_stub_table = table;
+    filehandle_stub_table_pos = 0;
+
+    at.clear_error();
+    at.resp_start("+CSQ:");
+    CHECK(at.info_resp());
+    CHECK(21 == at.read_int());
+    CHECK(99 == at.read_int());
+    at.resp_stop();
+    CHECK(at.get_last_error() == NSAPI_ERROR_OK);
+
+    CHECK(1 == urc_cmt_count);
+    CHECK(1 == urc_cmti_count);
+    CHECK(1 == urc_creg_count);
+
+    filehandle_stub_table = NULL;
+    filehandle_stub_table_pos = 0;
+}
+
+void Test_ATHandler::test_ATHandler_read_bytes_bulk()
+{
+    EventQueue que;
+    FileHandle_stub fh1;
+
+    // payload longer than the receive buffer
+    const size_t payload_len = 3 * MBED_CONF_CELLULAR_AT_HANDLER_BUFFER_SIZE + 7;
+    char table[payload_len + 1];
+    for (size_t i = 0; i < payload_len; i++) {
+        table[i] = 'a' + (i % 26);
+    }
+    table[payload_len] = '\0';
+    filehandle_stub_table = table;
+    filehandle_stub_table_pos = 0;
+
+    ATHandler at(&fh1, que, 0, ",");
+    uint8_t buf[payload_len];
+
+    CHECK(10 == at.read_bytes(buf, 10));
+    CHECK(memcmp(buf, table, 10) == 0);
+    CHECK((ssize_t)(payload_len - 30) == at.read_bytes(buf, payload_len - 30));
+    CHECK(memcmp(buf, table + 10, payload_len - 30) == 0);
+
+    at.resp_start();
+    at.skip_param(10, 1);
+    CHECK(10 == at.read_bytes(buf, 10));
+    CHECK(memcmp(buf, table + payload_len - 10, 10) == 0);
+    CHECK(at.get_last_error() == NSAPI_ERROR_OK);
+
+    // no more data
+    CHECK(-1 == at.read_bytes(buf, 1));
+
+    filehandle_stub_table = NULL;
+    filehandle_stub_table_pos = 0;
+}
+
+#define BENCHMARK_RESPONSES 50
+#define BENCHMARK_CONTEXTS 20
+
+void Test_ATHandler::test_ATHandler_receive_benchmark()
+{
+    EventQueue que;
+    FileHandle_stub fh1;
+
+    static const char urcs[] = "+CREG: 1\r\n+CMTI: \"SM\",3\r\n";
+    static const char context[] = "+CGDCONT: 1,\"IPV4V6\",\"internet.operator.example.com\"\r\n";
+    static char table[BENCHMARK_RESPONSES * (sizeof(urcs) + BENCHMARK_CONTEXTS * sizeof(context) + sizeof("OK\r\n"))];
+    table[0] = '\0';
+    for (int i = 0; i < BENCHMARK_RESPONSES; i++) {
+        strcat(table, urcs);
+        for (int j = 0; j < BENCHMARK_CONTEXTS; j++) {
+            strcat(table, context);
+        }
+        strcat(table, "OK\r\n");
+    }
+    filehandle_stub_table = table;
+    filehandle_stub_table_pos = 0;
+
+    urc_cmti_count = 0;
+    urc_creg_count = 0;
+
+    ATHandler at(&fh1, que, 0, ",");
+    at.set_urc_handler("+CREG:", &urc_creg_callback);
+    at.set_urc_handler("+CGREG:", &urc_callback);
+    at.set_urc_handler("+CEREG:", &urc_callback);
+    at.set_urc_handler("+CMTI:", &urc_cmti_callback);
+    at.set_urc_handler("+CMT:", &urc_callback);
+    at.set_urc_handler("+QIURC:", &urc_callback);
+    at.set_urc_handler("+NSONMI:", &urc_callback);
+    at.set_urc_handler("NO CARRIER", &urc_callback);
+
+    int contexts = 0;
+    int32_t cid = 0;
+    char type[8];
+    char apn[40];
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCHMARK_RESPONSES; i++) {
+        at.clear_error();
+        at.resp_start("+CGDCONT:");
+        while (at.info_resp()) {
+            cid = at.read_int();
+            at.read_string(type, sizeof(type));
+            at.read_string(apn, sizeof(apn));
+            contexts++;
+        }
+        at.resp_stop();
+        CHECK(at.get_last_error() == NSAPI_ERROR_OK);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    CHECK(BENCHMARK_RESPONSES * BENCHMARK_CONTEXTS == contexts);
+    CHECK(BENCHMARK_RESPONSES == urc_creg_count);
+    CHECK(BENCHMARK_RESPONSES == urc_cmti_count);
+    CHECK(1 == cid);
+    CHECK(strcmp("IPV4V6", type) == 0);
+    CHECK(strcmp("internet.operator.example.com", apn) == 0);
+
+    double elapsed_ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+    printf("\nATHandler receive (%d byte buffer): %.1f ns per received byte\n",
+           MBED_CONF_CELLULAR_AT_HANDLER_BUFFER_SIZE, elapsed_ns / strlen(table));
+
+    filehandle_stub_table = NULL;
+    filehandle_stub_table_pos = 0;
+}
@@ -95,6 +95,12 @@ public:
     void test_ATHandler_enable_debug();
 
     void test_ATHandler_get_3gpp_error();
+
+    void test_ATHandler_urc_prefix_trie();
+
+    void test_ATHandler_read_bytes_bulk();
+
+    void test_ATHandler_receive_benchmark();
 };
 
 #endif // TEST_ATHANDLER_H
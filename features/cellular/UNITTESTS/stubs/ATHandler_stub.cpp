@@ -70,6 +70,11 @@ int ATHandler::get_ref_count()
     return ATHandler_stub::int_value;
 }
 
+EventQueue &ATHandler::get_event_queue()
+{
+    return _queue;
+}
+
 FileHandle *ATHandler::get_file_handle()
 {
     return ATHandler_stub::fh_value;
@@ -24,7 +24,7 @@ namespace mbed {
 
 static uint8_t filehandle_stub_short_value_counter = 0;
 static char *filehandle_stub_table = NULL;
-static uint8_t filehandle_stub_table_pos = 0;
+static size_t filehandle_stub_table_pos = 0;
 
 class FileHandle_stub : public FileHandle
 {
@@ -39,7 +39,7 @@ public:
             if (size < ret) {
                 ret = size;
             }
-            memcpy(buffer, filehandle_stub_table, ret);
+            memcpy(buffer, filehandle_stub_table + filehandle_stub_table_pos, ret);
             filehandle_stub_table_pos += ret;
             return ret;
         }
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+#include "USBDevice.h"
+#include "USBDevice_stub.h"
+
+// Command status wrappers are 13 bytes long and start with "USBS"
+#define CSW_SIZE 13
+
+const uint8_t *USBDevice_stub::out_data = NULL;
+uint32_t USBDevice_stub::out_size = 0;
+const uint32_t USBDevice_stub::in_capacity = 16 * 1024;
+uint8_t USBDevice_stub::in_data[USBDevice_stub::in_capacity];
+uint32_t USBDevice_stub::in_size = 0;
+uint8_t USBDevice_stub::csw[CSW_SIZE];
+bool USBDevice_stub::csw_sent = false;
+int USBDevice_stub::stall_count = 0;
+
+void USBDevice_stub::reset()
+{
+    out_data = NULL;
+    out_size = 0;
+    in_size = 0;
+    csw_sent = false;
+    stall_count = 0;
+}
+
+USBHAL::USBHAL()
+{
+}
+
+USBHAL::~USBHAL()
+{
+}
+
+void USBHAL::stallEndpoint(uint8_t endpoint)
+{
+    USBDevice_stub::stall_count++;
+}
+
+USBDevice::USBDevice(uint16_t vendor_id, uint16_t product_id, uint16_t product_release)
+{
+    VENDOR_ID = vendor_id;
+    PRODUCT_ID = product_id;
+    PRODUCT_RELEASE = product_release;
+    memset(&transfer, 0, sizeof(transfer));
+}
+
+bool USBDevice::configured(void)
+{
+    return true;
+}
+
+void USBDevice::connect(bool blocking)
+{
+}
+
+void USBDevice::disconnect(void)
+{
+}
+
+bool USBDevice::addEndpoint(uint8_t endpoint, uint32_t maxPacket)
+{
+    return true;
+}
+
+bool USBDevice::readStart(uint8_t endpoint, uint32_t maxSize)
+{
+    return true;
+}
+
+bool USBDevice::readEP(uint8_t endpoint, uint8_t *buffer, uint32_t *size, uint32_t maxSize)
+{
+    uint32_t n = USBDevice_stub::out_size < maxSize ? USBDevice_stub::out_size : maxSize;
+    memcpy(buffer, USBDevice_stub::out_data, n);
+    *size = n;
+    return true;
+}
+
+bool USBDevice::readEP_NB(uint8_t endpoint, uint8_t *buffer, uint32_t *size, uint32_t maxSize)
+{
+    return readEP(endpoint, buffer, size, maxSize);
+}
+
+bool USBDevice::write(uint8_t endpoint, uint8_t *buffer, uint32_t size, uint32_t maxSize)
+{
+    return writeNB(endpoint, buffer, size, maxSize);
+}
+
+bool USBDevice::writeNB(uint8_t endpoint, uint8_t *buffer, uint32_t size, uint32_t maxSize)
+{
+    if (size > maxSize) {
+        return false;
+    }
+    if (size == CSW_SIZE && memcmp(buffer, "USBS", 4) == 0) {
+        memcpy(USBDevice_stub::csw, buffer, CSW_SIZE);
+        USBDevice_stub::csw_sent = true;
+        return true;
+    }
+    if (USBDevice_stub::in_size + size > USBDevice_stub::in_capacity) {
+        return false;
+    }
+    memcpy(USBDevice_stub::in_data + USBDevice_stub::in_size, buffer, size);
+    USBDevice_stub::in_size += size;
+    return true;
+}
+
+CONTROL_TRANSFER *USBDevice::getTransferPtr(void)
+{
+    return &transfer;
+}
+
+const uint8_t *USBDevice::deviceDesc()
+{
+    return NULL;
+}
+
+const uint8_t *USBDevice::stringLangidDesc()
+{
+    return NULL;
+}
+
+const uint8_t *USBDevice::stringImanufacturerDesc()
+{
+    return NULL;
+}
+
+const uint8_t *USBDevice::stringIproductDesc()
+{
+    return NULL;
+}
+
+const uint8_t *USBDevice::stringIserialDesc()
+{
+    return NULL;
+}
+
+const uint8_t *USBDevice::stringIConfigurationDesc()
+{
+    return NULL;
+}
+
+const uint8_t *USBDevice::stringIinterfaceDesc()
+{
+    return NULL;
+}
+
+void USBDevice::busReset(void)
+{
+}
+
+void USBDevice::EP0setupCallback(void)
+{
+}
+
+void USBDevice::EP0out(void)
+{
+}
+
+void USBDevice::EP0in(void)
+{
+}
+
+void USBDevice::connectStateChanged(unsigned int connected)
+{
+}
+
+void USBDevice::suspendStateChanged(unsigned int suspended)
+{
+}
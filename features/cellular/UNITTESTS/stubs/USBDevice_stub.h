@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __USBDEVICE_STUB_H__
+#define __USBDEVICE_STUB_H__
+
+#include <stdint.h>
+
+namespace USBDevice_stub {
+    /** Packet returned by the next readEP() */
+    extern const uint8_t *out_data;
+    extern uint32_t out_size;
+
+    /** Data packets passed to writeNB(), appended */
+    extern uint8_t in_data[];
+    extern uint32_t in_size;
+    extern const uint32_t in_capacity;
+
+    /** Last command status wrapper passed to writeNB() */
+    extern uint8_t csw[13];
+    extern bool csw_sent;
+
+    /** Number of stallEndpoint() calls */
+    extern int stall_count;
+
+    void reset();
+}
+
+#endif
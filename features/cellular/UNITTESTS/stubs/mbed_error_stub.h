@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef __MBED_ERROR_STUB_H__
+#define __MBED_ERROR_STUB_H__
+
+namespace mbed_error_stub {
+    /** Number of error() calls */
+    extern int count;
+
+    /** Thrown by error(), which does not return on a target */
+    struct fatal_error {
+    };
+}
+
+#endif
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "nvstore.h"
+#include <string.h>
+#include <stdlib.h>
+
+// In-memory store, one item per key
+
+static void *items[NVSTORE_MAX_KEYS];
+static uint16_t item_sizes[NVSTORE_MAX_KEYS];
+
+NVStore::NVStore() : _init_done(0), _init_attempts(0), _active_area(0), _max_keys(NVSTORE_MAX_KEYS),
+    _active_area_version(0), _free_space_offset(0), _size(0), _mutex(NULL), _offset_by_key(NULL),
+    _flash(NULL), _min_prog_size(0), _page_buf(NULL)
+{
+}
+
+NVStore::~NVStore()
+{
+    reset();
+}
+
+uint16_t NVStore::get_max_keys() const
+{
+    return _max_keys;
+}
+
+void NVStore::set_max_keys(uint16_t num_keys)
+{
+    _max_keys = num_keys;
+}
+
+uint16_t NVStore::get_max_possible_keys()
+{
+    return NVSTORE_MAX_KEYS;
+}
+
+int NVStore::get(uint16_t key, uint16_t buf_size, void *buf, uint16_t &actual_size)
+{
+    if (key >= _max_keys) {
+        return NVSTORE_BAD_VALUE;
+    }
+    if (!items[key]) {
+        return NVSTORE_NOT_FOUND;
+    }
+    actual_size = item_sizes[key];
+    if (buf_size < actual_size) {
+        return NVSTORE_BUFF_TOO_SMALL;
+    }
+    memcpy(buf, items[key], actual_size);
+    return NVSTORE_SUCCESS;
+}
+
+int NVStore::get_item_size(uint16_t key, uint16_t &actual_size)
+{
+    if (key >= _max_keys) {
+        return NVSTORE_BAD_VALUE;
+    }
+    if (!items[key]) {
+        return NVSTORE_NOT_FOUND;
+    }
+    actual_size = item_sizes[key];
+    return NVSTORE_SUCCESS;
+}
+
+int NVStore::set(uint16_t key, uint16_t buf_size, const void *buf)
+{
+    if (key >= _max_keys) {
+        return NVSTORE_BAD_VALUE;
+    }
+    void *item = malloc(buf_size ? buf_size : 1);
+    if (!item) {
+        return NVSTORE_OS_ERROR;
+    }
+    memcpy(item, buf, buf_size);
+    free(items[key]);
+    items[key] = item;
+    item_sizes[key] = buf_size;
+    return NVSTORE_SUCCESS;
+}
+
+int NVStore::set_once(uint16_t key, uint16_t buf_size, const void *buf)
+{
+    if (key < _max_keys && items[key]) {
+        return NVSTORE_ALREADY_EXISTS;
+    }
+    return set(key, buf_size, buf);
+}
+
+int NVStore::remove(uint16_t key)
+{
+    if (key >= _max_keys) {
+        return NVSTORE_BAD_VALUE;
+    }
+    if (!items[key]) {
+        return NVSTORE_NOT_FOUND;
+    }
+    free(items[key]);
+    items[key] = NULL;
+    return NVSTORE_SUCCESS;
+}
+
+int NVStore::init()
+{
+    _init_done = 1;
+    return NVSTORE_SUCCESS;
+}
+
+int NVStore::deinit()
+{
+    _init_done = 0;
+    return NVSTORE_SUCCESS;
+}
+
+int NVStore::reset()
+{
+    for (int i = 0; i < NVSTORE_MAX_KEYS; i++) {
+        free(items[i]);
+        items[i] = NULL;
+    }
+    return NVSTORE_SUCCESS;
+}
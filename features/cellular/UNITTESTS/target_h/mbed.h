@@ -18,7 +18,15 @@
 #define MBED_H
 
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include "platform/mbed_assert.h"
+#include "platform/mbed_toolchain.h"
+#include "platform/NonCopyable.h"
+#include "platform/Callback.h"
+#include "platform/FileHandle.h"
+
+using namespace mbed;
 
 #endif // MBED_H
 
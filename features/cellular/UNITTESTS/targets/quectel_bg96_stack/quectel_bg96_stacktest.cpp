@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2015, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_quectel_bg96_stack.h"
+
+TEST_GROUP(QUECTEL_BG96_CellularStack)
+{
+    Test_QUECTEL_BG96_CellularStack* unit;
+
+    void setup()
+    {
+        unit = new Test_QUECTEL_BG96_CellularStack();
+    }
+
+    void teardown()
+    {
+        delete unit;
+    }
+};
+
+TEST(QUECTEL_BG96_CellularStack, Create)
+{
+    CHECK(unit != NULL);
+}
+
+TEST(QUECTEL_BG96_CellularStack, test_QUECTEL_BG96_CellularStack_recvfrom_prefetch)
+{
+    unit->test_QUECTEL_BG96_CellularStack_recvfrom_prefetch();
+}
+
+TEST(QUECTEL_BG96_CellularStack, test_QUECTEL_BG96_CellularStack_recvfrom_truncate)
+{
+    unit->test_QUECTEL_BG96_CellularStack_recvfrom_truncate();
+}
+
+TEST(QUECTEL_BG96_CellularStack, test_QUECTEL_BG96_CellularStack_recvfrom_urc)
+{
+    unit->test_QUECTEL_BG96_CellularStack_recvfrom_urc();
+}
+
+TEST(QUECTEL_BG96_CellularStack, test_QUECTEL_BG96_CellularStack_recv_stream)
+{
+    unit->test_QUECTEL_BG96_CellularStack_recv_stream();
+}
+
+TEST(QUECTEL_BG96_CellularStack, test_QUECTEL_BG96_CellularStack_send_coalescing)
+{
+    unit->test_QUECTEL_BG96_CellularStack_send_coalescing();
+}
+
+TEST(QUECTEL_BG96_CellularStack, test_QUECTEL_BG96_CellularStack_send_flush_timeout)
+{
+    unit->test_QUECTEL_BG96_CellularStack_send_flush_timeout();
+}
+
@@ -0,0 +1,468 @@
+/*
+ * Copyright (c) 2015, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_quectel_bg96_stack.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include "EventQueue.h"
+#include "ATHandler.h"
+#include "QUECTEL/BG96/QUECTEL_BG96_CellularStack.h"
+#include "FileHandle_stub.h"
+#include "mbed_poll_stub.h"
+#include "SocketAddress.h"
+
+using namespace mbed;
+using namespace events;
+
+#define MODEM_MAX_PACKETS 8
+
+// Simulates the socket commands of a BG96 modem behind a FileHandle
+class ModemFileHandle : public FileHandle {
+public:
+    int commands;
+    int read_commands;
+    int send_commands;
+    char sent[256];
+    size_t sent_len;
+
+    ModemFileHandle() : commands(0), read_commands(0), send_commands(0), sent_len(0),
+        _cmd_len(0), _out_pos(0), _out_len(0), _send_len(0), _break_count(0), _packet_count(0)
+    {
+    }
+
+    // Queue data that the modem returns for AT+QIRD
+    void add_packet(const char *data, size_t len)
+    {
+        memcpy(_packets[_packet_count].data, data, len);
+        _packets[_packet_count].len = len;
+        _packet_count++;
+    }
+
+    // Modem output that is not a response to a command
+    void urc(const char *str)
+    {
+        output(str, strlen(str));
+    }
+
+    // Each response line group is returned by a separate read, like from a real modem
+    virtual ssize_t read(void *buffer, size_t size)
+    {
+        size_t end = _out_len;
+        for (int i = 0; i < _break_count; i++) {
+            if (_breaks[i] > _out_pos) {
+                end = _breaks[i];
+                break;
+            }
+        }
+        if (size > end - _out_pos) {
+            size = end - _out_pos;
+        }
+        memcpy(buffer, _out + _out_pos, size);
+        _out_pos += size;
+        if (_out_pos == _out_len) {
+            _out_pos = _out_len = 0;
+            _break_count = 0;
+        }
+        return size;
+    }
+
+    virtual ssize_t write(const void *buffer, size_t size)
+    {
+        const char *data = (const char *)buffer;
+        for (size_t i = 0; i < size; i++) {
+            if (_send_len) {
+                sent[sent_len++] = data[i];
+                if (!--_send_len) {
+                    output_break();
+                    output("\r\nSEND OK\r\n");
+                }
+            } else if (data[i] == '\r') {
+                _cmd[_cmd_len] = '\0';
+                _cmd_len = 0;
+                command(_cmd);
+            } else if (_cmd_len < sizeof(_cmd) - 1) {
+                _cmd[_cmd_len++] = data[i];
+            }
+        }
+        return size;
+    }
+
+    virtual off_t seek(off_t offset, int whence = SEEK_SET)
+    {
+        return -ESPIPE;
+    }
+
+    virtual int close()
+    {
+        return 0;
+    }
+
+    virtual short poll(short events) const
+    {
+        return (_out_len > _out_pos) ? (POLLIN | POLLOUT) : POLLOUT;
+    }
+
+private:
+    struct packet_t {
+        char data[BG96_MAX_PACKET_SIZE];
+        size_t len;
+    };
+
+    char _cmd[128];
+    size_t _cmd_len;
+    char _out[2 * BG96_MAX_PACKET_SIZE];
+    size_t _out_pos;
+    size_t _out_len;
+    size_t _send_len;
+    size_t _breaks[4];
+    int _break_count;
+    packet_t _packets[MODEM_MAX_PACKETS];
+    int _packet_count;
+
+    void output(const char *data, size_t len)
+    {
+        memcpy(_out + _out_len, data, len);
+        _out_len += len;
+    }
+
+    void output(const char *str)
+    {
+        output(str, strlen(str));
+    }
+
+    void output_break()
+    {
+        _breaks[_break_count++] = _out_len;
+    }
+
+    void command(const char *cmd)
+    {
+        int id, len;
+        char buf[64];
+
+        commands++;
+        if (sscanf(cmd, "AT+QIOPEN=%*d,%d", &id) == 1) {
+            output("\r\nOK\r\n");
+            output_break();
+            sprintf(buf, "\r\n+QIOPEN: %d,0\r\n", id);
+            output(buf);
+        } else if (sscanf(cmd, "AT+QISEND=%d,%d", &id, &len) == 2) {
+            if (len) {
+                send_commands++;
+                _send_len = len;
+                output("\r\n> ");
+            } else {
+                sprintf(buf, "\r\n+QISEND: %d,%d,0\r\n\r\nOK\r\n", (int)sent_len, (int)sent_len);
+                output(buf);
+            }
+        } else if (sscanf(cmd, "AT+QIRD=%d,%d", &id, &len) == 2) {
+            read_commands++;
+            if (_packet_count) {
+                size_t packet_len = _packets[0].len;
+                if (packet_len > (size_t)len) {
+                    packet_len = len;
+                }
+                sprintf(buf, "\r\n+QIRD: %d,\"10.0.0.1\",5683\r\n", (int)packet_len);
+                output(buf);
+                output(_packets[0].data, packet_len);
+                output("\r\n\r\nOK\r\n");
+                _packet_count--;
+                memmove(&_packets[0], &_packets[1], _packet_count * sizeof(packet_t));
+            } else {
+                output("\r\n+QIRD: 0\r\n\r\nOK\r\n");
+            }
+        } else if (strcmp(cmd, "AT") == 0 || strncmp(cmd, "AT+QICLOSE=", 11) == 0) {
+            output("\r\nOK\r\n");
+        } else {
+            output("\r\nERROR\r\n");
+        }
+    }
+};
+
+// BG96 stack that can also open TCP client sockets
+class TestStack : public QUECTEL_BG96_CellularStack {
+public:
+    TestStack(ATHandler &at) : QUECTEL_BG96_CellularStack(at, 1, IPV4_STACK)
+    {
+    }
+
+    // What the event queue runs when the flush timeout of the socket expires
+    void expire_flush_timeout(nsapi_socket_t handle)
+    {
+        flush_socket_timeout((CellularSocket *)handle);
+    }
+
+    virtual bool is_protocol_supported(nsapi_protocol_t protocol)
+    {
+        return true;
+    }
+
+    virtual nsapi_error_t create_socket_impl(CellularSocket *socket)
+    {
+        if (socket->proto != NSAPI_TCP) {
+            return QUECTEL_BG96_CellularStack::create_socket_impl(socket);
+        }
+        _at.cmd_start("AT+QIOPEN=");
+        _at.write_int(_cid);
+        _at.write_int(socket->id);
+        _at.write_string("TCP");
+        _at.write_string(socket->remoteAddress.get_ip_address());
+        _at.write_int(socket->remoteAddress.get_port());
+        _at.cmd_stop();
+        _at.resp_start();
+        _at.resp_stop();
+        _at.resp_start("+QIOPEN:");
+        _at.read_int();
+        _at.read_int();
+        socket->created = (_at.get_last_error() == NSAPI_ERROR_OK);
+        return _at.get_last_error();
+    }
+
+    using QUECTEL_BG96_CellularStack::socket_open;
+    using QUECTEL_BG96_CellularStack::socket_attach;
+    using QUECTEL_BG96_CellularStack::socket_close;
+    using QUECTEL_BG96_CellularStack::socket_connect;
+    using QUECTEL_BG96_CellularStack::socket_send;
+    using QUECTEL_BG96_CellularStack::socket_recv;
+    using QUECTEL_BG96_CellularStack::socket_sendto;
+    using QUECTEL_BG96_CellularStack::socket_recvfrom;
+};
+
+Test_QUECTEL_BG96_CellularStack::Test_QUECTEL_BG96_CellularStack()
+{
+    mbed_poll_stub::revents_value = POLLOUT;
+    mbed_poll_stub::int_value = 1;
+}
+
+Test_QUECTEL_BG96_CellularStack::~Test_QUECTEL_BG96_CellularStack()
+{
+    mbed_poll_stub::int_value = 0;
+}
+
+void Test_QUECTEL_BG96_CellularStack::test_QUECTEL_BG96_CellularStack_recvfrom_prefetch()
+{
+    EventQueue que;
+    ModemFileHandle modem;
+    ATHandler at(&modem, que, 1000, "\r");
+    TestStack stack(at);
+
+    nsapi_socket_t sock;
+    CHECK(NSAPI_ERROR_OK == stack.socket_open(&sock, NSAPI_UDP));
+    CHECK(NSAPI_ERROR_OK == stack.socket_connect(sock, SocketAddress("10.0.0.1", 5683)));
+
+    modem.add_packet("first", 5);
+    modem.add_packet("second", 6);
+
+    // Both packets are read with the first call, and the modem is found empty
+    char buf[16];
+    SocketAddress address;
+    LONGS_EQUAL(5, stack.socket_recvfrom(sock, &address, buf, sizeof(buf)));
+    CHECK(memcmp(buf, "first", 5) == 0);
+    STRCMP_EQUAL("10.0.0.1", address.get_ip_address());
+    LONGS_EQUAL(5683, address.get_port());
+    LONGS_EQUAL(3, modem.read_commands);
+
+    int commands = modem.commands;
+    LONGS_EQUAL(6, stack.socket_recv(sock, buf, sizeof(buf)));
+    CHECK(memcmp(buf, "second", 6) == 0);
+
+    // The modem has not reported new data, so it is not polled
+    for (int i = 0; i < 10; i++) {
+        LONGS_EQUAL(NSAPI_ERROR_WOULD_BLOCK, stack.socket_recv(sock, buf, sizeof(buf)));
+    }
+    LONGS_EQUAL(commands, modem.commands);
+
+    CHECK(NSAPI_ERROR_OK == stack.socket_close(sock));
+}
+
+void Test_QUECTEL_BG96_CellularStack::test_QUECTEL_BG96_CellularStack_recvfrom_truncate()
+{
+    EventQueue que;
+    ModemFileHandle modem;
+    ATHandler at(&modem, que, 1000, "\r");
+    TestStack stack(at);
+
+    nsapi_socket_t sock;
+    CHECK(NSAPI_ERROR_OK == stack.socket_open(&sock, NSAPI_UDP));
+    CHECK(NSAPI_ERROR_OK == stack.socket_connect(sock, SocketAddress("10.0.0.1", 5683)));
+
+    char packet[BG96_MAX_PACKET_SIZE];
+    for (size_t i = 0; i < sizeof(packet); i++) {
+        packet[i] = i;
+    }
+    modem.add_packet(packet, sizeof(packet));
+
+    // Rest of a datagram that does not fit is discarded
+    char buf[10];
+    LONGS_EQUAL(sizeof(buf), stack.socket_recv(sock, buf, sizeof(buf)));
+    CHECK(memcmp(buf, packet, sizeof(buf)) == 0);
+    LONGS_EQUAL(NSAPI_ERROR_WOULD_BLOCK, stack.socket_recv(sock, buf, sizeof(buf)));
+
+    CHECK(NSAPI_ERROR_OK == stack.socket_close(sock));
+}
+
+static int socket_callback_count;
+
+static void socket_callback(void *data)
+{
+    socket_callback_count++;
+}
+
+void Test_QUECTEL_BG96_CellularStack::test_QUECTEL_BG96_CellularStack_recvfrom_urc()
+{
+    EventQueue que;
+    ModemFileHandle modem;
+    ATHandler at(&modem, que, 1000, "\r");
+    TestStack stack(at);
+
+    nsapi_socket_t sock;
+    CHECK(NSAPI_ERROR_OK == stack.socket_open(&sock, NSAPI_UDP));
+    CHECK(NSAPI_ERROR_OK == stack.socket_connect(sock, SocketAddress("10.0.0.1", 5683)));
+    socket_callback_count = 0;
+    stack.socket_attach(sock, socket_callback, NULL);
+
+    char buf[16];
+    LONGS_EQUAL(NSAPI_ERROR_WOULD_BLOCK, stack.socket_recv(sock, buf, sizeof(buf)));
+    LONGS_EQUAL(1, modem.read_commands);
+
+    // Data is not read before the modem reports it
+    modem.add_packet("data", 4);
+    LONGS_EQUAL(NSAPI_ERROR_WOULD_BLOCK, stack.socket_recv(sock, buf, sizeof(buf)));
+    LONGS_EQUAL(1, modem.read_commands);
+
+    // URC arrives while the application runs some other command
+    modem.urc("\r\n+QIURC: \"recv\",0\r\n");
+    at.lock();
+    at.cmd_start("AT");
+    at.cmd_stop();
+    at.resp_start();
+    at.resp_stop();
+    CHECK(NSAPI_ERROR_OK == at.unlock_return_error());
+    LONGS_EQUAL(1, socket_callback_count);
+
+    LONGS_EQUAL(4, stack.socket_recv(sock, buf, sizeof(buf)));
+    CHECK(memcmp(buf, "data", 4) == 0);
+    LONGS_EQUAL(3, modem.read_commands);
+
+    CHECK(NSAPI_ERROR_OK == stack.socket_close(sock));
+}
+
+void Test_QUECTEL_BG96_CellularStack::test_QUECTEL_BG96_CellularStack_recv_stream()
+{
+    EventQueue que;
+    ModemFileHandle modem;
+    ATHandler at(&modem, que, 1000, "\r");
+    TestStack stack(at);
+
+    nsapi_socket_t sock;
+    CHECK(NSAPI_ERROR_OK == stack.socket_open(&sock, NSAPI_TCP));
+    CHECK(NSAPI_ERROR_OK == stack.socket_connect(sock, SocketAddress("10.0.0.1", 443)));
+
+    char record[600];
+    for (size_t i = 0; i < sizeof(record); i++) {
+        record[i] = 'a' + (i % 26);
+    }
+    modem.add_packet(record, sizeof(record));
+
+    // Stream is read a few bytes at a time, like a TLS record header and body
+    char buf[sizeof(record)];
+    size_t len = 0;
+    while (len < sizeof(record)) {
+        nsapi_size_or_error_t ret = stack.socket_recv(sock, buf + len, 5);
+        CHECK(ret == 5);
+        if (ret <= 0) {
+            break;
+        }
+        len += ret;
+    }
+    CHECK(memcmp(buf, record, sizeof(record)) == 0);
+    LONGS_EQUAL(2, modem.read_commands);
+    LONGS_EQUAL(NSAPI_ERROR_WOULD_BLOCK, stack.socket_recv(sock, buf, 5));
+
+    CHECK(NSAPI_ERROR_OK == stack.socket_close(sock));
+}
+
+void Test_QUECTEL_BG96_CellularStack::test_QUECTEL_BG96_CellularStack_send_coalescing()
+{
+    EventQueue que;
+    ModemFileHandle modem;
+    ATHandler at(&modem, que, 1000, "\r");
+    TestStack stack(at);
+
+    nsapi_socket_t sock;
+    CHECK(NSAPI_ERROR_OK == stack.socket_open(&sock, NSAPI_TCP));
+    CHECK(NSAPI_ERROR_OK == stack.socket_connect(sock, SocketAddress("10.0.0.1", 443)));
+
+    // Small sends are buffered
+    for (int i = 0; i < 10; i++) {
+        LONGS_EQUAL(5, stack.socket_send(sock, "hello", 5));
+    }
+    LONGS_EQUAL(0, modem.send_commands);
+
+    // and sent when the buffer gets full
+    LONGS_EQUAL(20, stack.socket_send(sock, "01234567890123456789", 20));
+    LONGS_EQUAL(1, modem.send_commands);
+    LONGS_EQUAL(50, modem.sent_len);
+
+    // or before receiving
+    char buf[16];
+    LONGS_EQUAL(NSAPI_ERROR_WOULD_BLOCK, stack.socket_recv(sock, buf, sizeof(buf)));
+    LONGS_EQUAL(2, modem.send_commands);
+    LONGS_EQUAL(70, modem.sent_len);
+
+    // Sends larger than the buffer are not delayed
+    char data[100];
+    memset(data, 'x', sizeof(data));
+    LONGS_EQUAL(3, stack.socket_send(sock, "abc", 3));
+    LONGS_EQUAL(sizeof(data), stack.socket_send(sock, data, sizeof(data)));
+    LONGS_EQUAL(4, modem.send_commands);
+    LONGS_EQUAL(173, modem.sent_len);
+
+    // or when closing
+    LONGS_EQUAL(3, stack.socket_send(sock, "end", 3));
+    CHECK(NSAPI_ERROR_OK == stack.socket_close(sock));
+    LONGS_EQUAL(5, modem.send_commands);
+    CHECK(memcmp(modem.sent + modem.sent_len - 3, "end", 3) == 0);
+}
+
+void Test_QUECTEL_BG96_CellularStack::test_QUECTEL_BG96_CellularStack_send_flush_timeout()
+{
+    EventQueue que;
+    ModemFileHandle modem;
+    ATHandler at(&modem, que, 1000, "\r");
+    TestStack stack(at);
+
+    nsapi_socket_t sock;
+    CHECK(NSAPI_ERROR_OK == stack.socket_open(&sock, NSAPI_TCP));
+    CHECK(NSAPI_ERROR_OK == stack.socket_connect(sock, SocketAddress("10.0.0.1", 443)));
+
+    // Buffered data is sent when no more data comes in time
+    LONGS_EQUAL(5, stack.socket_send(sock, "hello", 5));
+    LONGS_EQUAL(0, modem.send_commands);
+    stack.expire_flush_timeout(sock);
+    LONGS_EQUAL(1, modem.send_commands);
+    LONGS_EQUAL(5, modem.sent_len);
+    CHECK(memcmp(modem.sent, "hello", 5) == 0);
+
+    // An empty buffer sends nothing
+    stack.expire_flush_timeout(sock);
+    LONGS_EQUAL(1, modem.send_commands);
+
+    CHECK(NSAPI_ERROR_OK == stack.socket_close(sock));
+    LONGS_EQUAL(1, modem.send_commands);
+}
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2015, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TEST_QUECTEL_BG96_STACK_H
+#define TEST_QUECTEL_BG96_STACK_H
+
+class Test_QUECTEL_BG96_CellularStack
+{
+public:
+    Test_QUECTEL_BG96_CellularStack();
+
+    virtual ~Test_QUECTEL_BG96_CellularStack();
+
+    void test_QUECTEL_BG96_CellularStack_recvfrom_prefetch();
+
+    void test_QUECTEL_BG96_CellularStack_recvfrom_truncate();
+
+    void test_QUECTEL_BG96_CellularStack_recvfrom_urc();
+
+    void test_QUECTEL_BG96_CellularStack_recv_stream();
+
+    void test_QUECTEL_BG96_CellularStack_send_coalescing();
+
+    void test_QUECTEL_BG96_CellularStack_send_flush_timeout();
+};
+
+#endif // TEST_QUECTEL_BG96_STACK_H
+
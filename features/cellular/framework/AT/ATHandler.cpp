@@ -66,6 +66,7 @@ ATHandler::ATHandler(FileHandle *fh, EventQueue &queue, int timeout, const char
     _last_3gpp_error(0),
     _oob_string_max_length(0),
     _oobs(NULL),
+    _urc_trie(NULL),
     _at_timeout(timeout),
     _previous_at_timeout(timeout),
     _fh_sigio_set(false),
@@ -115,6 +116,7 @@ void ATHandler::enable_debug(bool enable)
 
 ATHandler::~ATHandler()
 {
+    free_urc_trie(_urc_trie);
     while (_oobs) {
         struct oob_t *oob = _oobs;
         _oobs = oob->next;
@@ -140,6 +142,11 @@ int ATHandler::get_ref_count()
     return _ref_count;
 }
 
+EventQueue &ATHandler::get_event_queue()
+{
+    return _queue;
+}
+
 FileHandle *ATHandler::get_file_handle()
 {
     return _fileHandle;
@@ -150,11 +157,50 @@ void ATHandler::set_file_handle(FileHandle *fh)
     _fileHandle = fh;
 }
 
+void ATHandler::free_urc_trie(urc_node_t *node)
+{
+    while (node) {
+        urc_node_t *sibling = node->sibling;
+        free_urc_trie(node->child);
+        delete node;
+        node = sibling;
+    }
+}
+
 void ATHandler::set_urc_handler(const char *prefix, mbed::Callback<void()> callback)
 {
+    size_t prefix_len = strlen(prefix);
+    if (!prefix_len) {
+        return;
+    }
+
+    // Find or add the trie node for each prefix character
+    urc_node_t **level = &_urc_trie;
+    urc_node_t *node = NULL;
+    for (size_t i = 0; i < prefix_len; i++) {
+        node = *level;
+        while (node && node->c != prefix[i]) {
+            node = node->sibling;
+        }
+        if (!node) {
+            node = new urc_node_t;
+            node->c = prefix[i];
+            node->oob = NULL;
+            node->child = NULL;
+            node->sibling = *level;
+            *level = node;
+        }
+        level = &node->child;
+    }
+
+    if (node->oob) {
+        node->oob->prefix = prefix;
+        node->oob->cb = callback;
+        return;
+    }
+
     struct oob_t *oob = new struct oob_t;
     oob->matching_to_received = true;
-    size_t prefix_len = strlen(prefix);
     if (prefix_len > _oob_string_max_length) {
         _oob_string_max_length = prefix_len;
         if (_oob_string_max_length > _max_resp_length) {
@@ -165,6 +211,7 @@ void ATHandler::set_urc_handler(const char *prefix, mbed::Callback<void()> callb
     oob->cb = callback;
     oob->next = _oobs;
     _oobs = oob;
+    node->oob = oob;
 }
 
 void ATHandler::event()
@@ -237,7 +284,7 @@ void ATHandler::process_oob()
                 break;
             }
             // If no match found, look for CRLF and consume everything up to CRLF
-            if (mem_str(_recv_buff, _recv_len, CRLF, CRLF_LENGTH)) {
+            if (mem_str(_recv_buff + _recv_pos, _recv_len - _recv_pos, CRLF, CRLF_LENGTH)) {
                 consume_to_tag(CRLF, true);
             } else {
                 if (_fileHandle->readable()) {
@@ -287,9 +334,14 @@ void ATHandler::rewind_buffer()
 void ATHandler::fill_buffer()
 {
     tr_debug("%s", __func__);
-    // Reset buffer when full
-    if (sizeof(_recv_buff) == _recv_len) {
+    if (_recv_pos == _recv_len) {
         reset_buffer();
+    } else if (sizeof(_recv_buff) == _recv_len) {
+        // Make room by dropping the read content, reset buffer if it is full of unread content
+        rewind_buffer();
+        if (sizeof(_recv_buff) == _recv_len) {
+            reset_buffer();
+        }
     }
 
     Timer timer;
@@ -374,12 +426,20 @@ void ATHandler::skip_param(ssize_t len, uint32_t count)
     for (uint32_t i = 0; i < count; i++) {
         ssize_t read_len = 0;
         while (read_len < len) {
-            int c = get_char();
-            if (c == -1) {
-                set_error(NSAPI_ERROR_DEVICE_ERROR);
-                return;
+            if (_recv_pos == _recv_len) {
+                reset_buffer();
+                fill_buffer();
+                if (get_last_error()) {
+                    set_error(NSAPI_ERROR_DEVICE_ERROR);
+                    return;
+                }
+            }
+            size_t skip_len = _recv_len - _recv_pos;
+            if (skip_len > (size_t)(len - read_len)) {
+                skip_len = len - read_len;
             }
-            read_len++;
+            _recv_pos += skip_len;
+            read_len += skip_len;
         }
     }
     return;
@@ -392,14 +452,24 @@ ssize_t ATHandler::read_bytes(uint8_t *buf, size_t len)
         return -1;
     }
 
+    // Copy whole chunks of the receiving buffer instead of reading char by char
     size_t read_len = 0;
-    for (; read_len < len; read_len++) {
-        int c = get_char();
-        if (c == -1) {
-            set_error(NSAPI_ERROR_DEVICE_ERROR);
-            return -1;
+    while (read_len < len) {
+        if (_recv_pos == _recv_len) {
+            reset_buffer();
+            fill_buffer();
+            if (get_last_error()) {
+                set_error(NSAPI_ERROR_DEVICE_ERROR);
+                return -1;
+            }
+        }
+        size_t copy_len = _recv_len - _recv_pos;
+        if (copy_len > len - read_len) {
+            copy_len = len - read_len;
         }
-        buf[read_len] = c;
+        memcpy(buf + read_len, _recv_buff + _recv_pos, copy_len);
+        _recv_pos += copy_len;
+        read_len += copy_len;
     }
     return read_len;
 }
@@ -534,11 +604,9 @@ void ATHandler::set_scope(ScopeType scope_type)
     }
 }
 
-// should match from recv_pos?
 bool ATHandler::match(const char* str, size_t size)
 {
     tr_debug("%s: %s", __func__, str);
-    rewind_buffer();
 
     if ((_recv_len - _recv_pos) < size) {
         return false;
@@ -555,21 +623,27 @@ bool ATHandler::match(const char* str, size_t size)
 bool ATHandler::match_urc()
 {
     tr_debug("%s", __func__);
-    rewind_buffer();
-    size_t prefix_len = 0;
-    for (struct oob_t *oob = _oobs; oob; oob = oob->next) {
-        prefix_len = strlen(oob->prefix);
-        if (_recv_len >= prefix_len) {
-            if (match(oob->prefix, prefix_len)) {
-                tr_debug("URC! %s", oob->prefix);
-                set_scope(InfoType);
-                if (oob->cb) {
-                    oob->cb();
-                }
-                information_response_stop();
-                return true;
+    urc_node_t *level = _urc_trie;
+    for (size_t pos = _recv_pos; level && pos < _recv_len; pos++) {
+        while (level && level->c != _recv_buff[pos]) {
+            level = level->sibling;
+        }
+        if (!level) {
+            break;
+        }
+        struct oob_t *oob = level->oob;
+        if (oob) {
+            // consume matching prefix
+            _recv_pos = pos + 1;
+            tr_debug("URC! %s", oob->prefix);
+            set_scope(InfoType);
+            if (oob->cb) {
+                oob->cb();
             }
+            information_response_stop();
+            return true;
         }
+        level = level->child;
     }
     return false;
 }
@@ -703,10 +777,12 @@ void ATHandler::resp(const char *prefix, bool check_urc)
 
         if (check_urc && match_urc()) {
             _urc_matched = true;
+            // URC line is consumed, try matching the next line
+            continue;
         }
 
         // If no match found, look for CRLF and consume everything up to and including CRLF
-        if (mem_str(_recv_buff, _recv_len, CRLF, CRLF_LENGTH)) {
+        if (mem_str(_recv_buff + _recv_pos, _recv_len - _recv_pos, CRLF, CRLF_LENGTH)) {
             // If no prefix, return on CRLF - means data to read
             if (!prefix) {
                 return;
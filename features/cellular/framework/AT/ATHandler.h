@@ -46,6 +46,15 @@ extern const char *CRLF;
 
 #define BUFF_SIZE 16
 
+/**
+ * Size of the receive window. Whole response lines, URCs and binary payloads
+ * are read from the file handle in bulk into this buffer, so it should fit the
+ * longest line that needs to be matched.
+ */
+#ifndef MBED_CONF_CELLULAR_AT_HANDLER_BUFFER_SIZE
+#define MBED_CONF_CELLULAR_AT_HANDLER_BUFFER_SIZE 256
+#endif
+
 /* AT Error types enumeration */
 enum DeviceErrorType {
     DeviceErrorTypeNoError = 0,
@@ -84,6 +93,12 @@ public:
      */
     FileHandle *get_file_handle();
 
+    /** Return the event queue given in the constructor.
+     *
+     *  @return event queue that dispatches the events of this AT handler
+     */
+    events::EventQueue &get_event_queue();
+
     /** Set file handle, which is used for reading AT responses and writing AT commands
      *
      *  @param fh file handle used for reading AT responses and writing AT commands
@@ -105,6 +120,8 @@ public:
     nsapi_error_t unlock_return_error();
 
     /** Set the urc callback for urc. If urc is found when parsing AT responses, then call if called.
+     *  Setting a callback for an already registered prefix replaces the previous callback.
+     *  If registered prefixes overlap, then the shortest prefix found in the response is matched.
      *
      *  @param prefix   Register urc prefix for callback. Urc could be for example "+CMTI: "
      *  @param callback Callback, which is called if urc is found in AT response
@@ -192,6 +209,16 @@ private:
         oob_t *next;
     };
     oob_t *_oobs;
+
+    // URC prefixes stored as a character trie, so that the receiving buffer is walked only once
+    struct urc_node_t {
+        char c;
+        oob_t *oob;
+        urc_node_t *child;
+        urc_node_t *sibling;
+    };
+    urc_node_t *_urc_trie;
+    static void free_urc_trie(urc_node_t *node);
     bool _response_terminated;
     uint32_t _at_timeout;
     uint32_t _previous_at_timeout;
@@ -351,8 +378,8 @@ public:
 
 private:
 
-    // should fit any prefix and int
-    char _recv_buff[BUFF_SIZE];
+    // should fit any prefix and int, and preferably a whole response line
+    char _recv_buff[MBED_CONF_CELLULAR_AT_HANDLER_BUFFER_SIZE];
     // reading position
     size_t _recv_len;
     // reading length
@@ -405,15 +432,16 @@ private:
     void reset_buffer();
     // Reading position set to 0 and buffer's unread content moved to beginning
     void rewind_buffer();
-    // Reads from serial to receiving buffer.
+    // Reads from serial to receiving buffer as much as fits.
+    // Moves unread content to beginning of buffer only when there is no space left at the end.
     // Returns on first successful read OR on timeout.
     void fill_buffer();
 
     void set_tag(tag_t* tag_dest, const char *tag_seq);
 
-    // Rewinds the receiving buffer and compares it against given str.
+    // Compares the unread content of the receiving buffer against given str.
     bool match(const char* str, size_t size);
-    // Iterates URCs and checks if they match the receiving buffer content.
+    // Walks the URC trie and checks if a URC prefix matches the receiving buffer content.
     // If URC match sets the scope to information response and after urc's cb returns
     // finishes the information response scope(consumes to CRLF).
     bool match_urc();
@@ -22,6 +22,13 @@
 using namespace mbed_cellular_util;
 using namespace mbed;
 
+// Stored in the receive buffer in front of each received packet
+struct rx_header_t {
+    nsapi_addr_t addr;
+    uint16_t port;
+    uint16_t len;
+};
+
 AT_CellularStack::AT_CellularStack(ATHandler &at, int cid, nsapi_ip_stack_t stack_type) : AT_CellularBase(at), _socket(NULL),_socket_count(0),_cid(cid), _stack_type(stack_type)
 {
     memset(_ip,0, PDP_IPV6_SIZE);
@@ -31,6 +38,7 @@ AT_CellularStack::~AT_CellularStack()
 {
     for (int i = 0; i < _socket_count; i++) {
         if (_socket[i]) {
+            free_socket_buffers(_socket[i]);
             delete _socket[i];
             _socket[i] = NULL;
         }
@@ -41,6 +49,142 @@ AT_CellularStack::~AT_CellularStack()
     _socket = NULL;
 }
 
+bool AT_CellularStack::is_rx_urc_supported()
+{
+    return false;
+}
+
+void AT_CellularStack::free_socket_buffers(CellularSocket *socket)
+{
+    delete [] socket->rx_buffer;
+    socket->rx_buffer = NULL;
+    socket->rx_pos = 0;
+    socket->rx_len = 0;
+    delete [] socket->tx_buffer;
+    socket->tx_buffer = NULL;
+    socket->tx_len = 0;
+    if (socket->tx_flush_event) {
+        _at.get_event_queue().cancel(socket->tx_flush_event);
+        socket->tx_flush_event = 0;
+    }
+}
+
+nsapi_size_or_error_t AT_CellularStack::prefetch_socket_data(CellularSocket *socket)
+{
+    size_t max_packet_size = get_max_packet_size();
+    size_t buffer_size = MBED_CONF_CELLULAR_SOCKET_RX_BUFFER_SIZE;
+    if (buffer_size < sizeof(rx_header_t) + max_packet_size) {
+        buffer_size = sizeof(rx_header_t) + max_packet_size;
+    }
+
+    if (!socket->rx_buffer) {
+        socket->rx_buffer = new uint8_t[buffer_size];
+    }
+    socket->rx_pos = 0;
+    socket->rx_len = 0;
+
+    nsapi_size_or_error_t ret_val = NSAPI_ERROR_WOULD_BLOCK;
+
+    // Read maximal packets until the modem runs out of data or the buffer is full
+    while (buffer_size - socket->rx_len >= sizeof(rx_header_t) + max_packet_size) {
+        if (is_rx_urc_supported() && !socket->rx_avail) {
+            break;
+        }
+        // URC received during the read sets this again
+        socket->rx_avail = false;
+
+        SocketAddress address;
+        ret_val = socket_recvfrom_impl(socket, &address, socket->rx_buffer + socket->rx_len + sizeof(rx_header_t),
+                                       max_packet_size);
+        if (ret_val <= 0) {
+            break;
+        }
+        // modem may have more data
+        socket->rx_avail = true;
+
+        rx_header_t header;
+        header.addr = address.get_addr();
+        header.port = address.get_port();
+        header.len = ret_val;
+        memcpy(socket->rx_buffer + socket->rx_len, &header, sizeof(header));
+        socket->rx_len += sizeof(header) + ret_val;
+    }
+
+    return socket->rx_len ? NSAPI_ERROR_OK : ret_val;
+}
+
+nsapi_size_or_error_t AT_CellularStack::read_socket_data(CellularSocket *socket, SocketAddress *address,
+        void *buffer, nsapi_size_t size)
+{
+    rx_header_t header;
+    memcpy(&header, socket->rx_buffer + socket->rx_pos, sizeof(header));
+
+    nsapi_size_t read_len = header.len < size ? header.len : size;
+    memcpy(buffer, socket->rx_buffer + socket->rx_pos + sizeof(header), read_len);
+
+    if (address) {
+        address->set_addr(header.addr);
+        address->set_port(header.port);
+    }
+
+    if (socket->proto == NSAPI_TCP && read_len < header.len) {
+        // keep rest of the stream data for the next receive call
+        socket->rx_pos += read_len;
+        header.len -= read_len;
+        memcpy(socket->rx_buffer + socket->rx_pos, &header, sizeof(header));
+    } else {
+        // rest of a datagram is discarded
+        socket->rx_pos += sizeof(header) + header.len;
+    }
+
+    if (socket->rx_pos >= socket->rx_len) {
+        socket->rx_pos = 0;
+        socket->rx_len = 0;
+    }
+
+    return read_len;
+}
+
+nsapi_error_t AT_CellularStack::flush_socket_data(CellularSocket *socket)
+{
+    while (socket->tx_len) {
+        nsapi_size_or_error_t sent_len = socket_sendto_impl(socket, socket->remoteAddress, socket->tx_buffer,
+                                                            socket->tx_len);
+        if (sent_len <= 0) {
+            return sent_len < 0 ? sent_len : NSAPI_ERROR_DEVICE_ERROR;
+        }
+        socket->tx_len -= sent_len;
+        memmove(socket->tx_buffer, socket->tx_buffer + sent_len, socket->tx_len);
+    }
+
+    if (socket->tx_flush_event) {
+        _at.get_event_queue().cancel(socket->tx_flush_event);
+        socket->tx_flush_event = 0;
+    }
+
+    return NSAPI_ERROR_OK;
+}
+
+void AT_CellularStack::flush_socket_timeout(CellularSocket *socket)
+{
+    _at.lock();
+
+    // The socket may have been closed while the event was pending
+    for (int i = 0; i < _socket_count; i++) {
+        if (_socket[i] == socket) {
+            socket->tx_flush_event = 0;
+            if (flush_socket_data(socket) != NSAPI_ERROR_OK && socket->tx_len) {
+                // Try again later, the data is also sent before receiving and when closing
+                socket->tx_flush_event = _at.get_event_queue().call_in(MBED_CONF_CELLULAR_SOCKET_TX_FLUSH_TIMEOUT,
+                                         this, &AT_CellularStack::flush_socket_timeout, socket);
+            }
+            break;
+        }
+    }
+
+    _at.unlock();
+}
+
 /** NetworkStack
  */
 
@@ -121,6 +265,8 @@ nsapi_error_t AT_CellularStack::socket_open(nsapi_socket_t *handle, nsapi_protoc
     psock->id = index;
     psock->localAddress = addr;
     psock->proto = proto;
+    // nothing is known about data on modem until it has been read once
+    psock->rx_avail = true;
     *handle = psock;
 
     return NSAPI_ERROR_OK;
@@ -153,10 +299,15 @@ nsapi_error_t AT_CellularStack::socket_close(nsapi_socket_t handle)
 
     _at.lock();
 
+    if (socket->created) {
+        (void)flush_socket_data(socket);
+    }
+
     err = socket_close_impl(sock_id);
 
     _at.unlock();
 
+    free_socket_buffers(socket);
     delete socket;
     socket = NULL;
 
@@ -248,6 +399,36 @@ nsapi_size_or_error_t AT_CellularStack::socket_sendto(nsapi_socket_t handle, con
 
     _at.lock();
 
+    size_t tx_buffer_size = MBED_CONF_CELLULAR_SOCKET_TX_BUFFER_SIZE;
+    if (tx_buffer_size > max_packet_size) {
+        tx_buffer_size = max_packet_size;
+    }
+
+    if (tx_buffer_size && socket->proto == NSAPI_TCP) {
+        // Coalesce small stream sends, send when full
+        if (socket->tx_len + size > tx_buffer_size) {
+            ret_val = flush_socket_data(socket);
+            if (ret_val != NSAPI_ERROR_OK) {
+                _at.unlock();
+                return ret_val;
+            }
+        }
+        if (size < tx_buffer_size) {
+            if (!socket->tx_buffer) {
+                socket->tx_buffer = new uint8_t[tx_buffer_size];
+            }
+            memcpy(socket->tx_buffer + socket->tx_len, data, size);
+            socket->tx_len += size;
+            if (MBED_CONF_CELLULAR_SOCKET_TX_FLUSH_TIMEOUT && !socket->tx_flush_event) {
+                // Don't hold back data if no more comes
+                socket->tx_flush_event = _at.get_event_queue().call_in(MBED_CONF_CELLULAR_SOCKET_TX_FLUSH_TIMEOUT,
+                                         this, &AT_CellularStack::flush_socket_timeout, socket);
+            }
+            _at.unlock();
+            return size;
+        }
+    }
+
     ret_val = socket_sendto_impl(socket, addr, data, size);
 
     _at.unlock();
@@ -282,7 +463,21 @@ nsapi_size_or_error_t AT_CellularStack::socket_recvfrom(nsapi_socket_t handle, S
 
     _at.lock();
 
-    ret_val = socket_recvfrom_impl(socket, addr, buffer, size);
+    // Pending stream data might be what the remote end is waiting for
+    ret_val = flush_socket_data(socket);
+
+    if (ret_val == NSAPI_ERROR_OK) {
+        if (MBED_CONF_CELLULAR_SOCKET_RX_BUFFER_SIZE == 0) {
+            ret_val = socket_recvfrom_impl(socket, addr, buffer, size);
+        } else {
+            if (!socket->rx_len) {
+                ret_val = prefetch_socket_data(socket);
+            }
+            if (socket->rx_len) {
+                ret_val = read_socket_data(socket, addr, buffer, size);
+            }
+        }
+    }
 
     _at.unlock();
 
@@ -29,6 +29,34 @@ namespace mbed {
 // a1.a2.a3.a4.a5.a6.a7.a8.a9.a10.a11.a12.a13.a14.a15.a16 for IPv6.
 #define PDP_IPV6_SIZE 63+1
 
+/**
+ * Size of the per socket receive buffer. Received data is read from the modem with maximal reads into
+ * this buffer and receive calls are served from it. The buffer always fits at least one maximal packet.
+ * The default fits a 1460 byte BG96 packet with its header. 0 disables the buffering, so that every
+ * receive call reads from the modem.
+ */
+#ifndef MBED_CONF_CELLULAR_SOCKET_RX_BUFFER_SIZE
+#define MBED_CONF_CELLULAR_SOCKET_RX_BUFFER_SIZE 1536
+#endif
+
+/**
+ * Size of the per socket buffer that coalesces small sends of stream (TCP) sockets. Buffered data is sent
+ * when the buffer becomes full, before receiving from the socket, when the socket is closed and when
+ * MBED_CONF_CELLULAR_SOCKET_TX_FLUSH_TIMEOUT expires. 0 disables the coalescing.
+ */
+#ifndef MBED_CONF_CELLULAR_SOCKET_TX_BUFFER_SIZE
+#define MBED_CONF_CELLULAR_SOCKET_TX_BUFFER_SIZE 0
+#endif
+
+/**
+ * Time in milliseconds that coalesced send data waits for more data before it is sent. The flush runs
+ * in the event queue of the AT handler. 0 only sends the data when the buffer is full, before receiving
+ * and when the socket is closed.
+ */
+#ifndef MBED_CONF_CELLULAR_SOCKET_TX_FLUSH_TIMEOUT
+#define MBED_CONF_CELLULAR_SOCKET_TX_FLUSH_TIMEOUT 100
+#endif
+
 /**
  * Class AT_CellularStack.
  *
@@ -89,8 +117,26 @@ protected:
         void *_data;
         bool created;
         bool rx_avail; // used to synchronize reading from modem
+        // Received data, each packet stored after a header with its length and source address
+        uint8_t *rx_buffer;
+        // Read position and length of data in rx_buffer
+        size_t rx_pos;
+        size_t rx_len;
+        // Stream data waiting to be sent
+        uint8_t *tx_buffer;
+        size_t tx_len;
+        // Event that sends tx_buffer after MBED_CONF_CELLULAR_SOCKET_TX_FLUSH_TIMEOUT, 0 if none
+        int tx_flush_event;
     };
 
+    /**
+    * Tells if the modem reports received socket data with an URC. The URC handler must then set rx_avail
+    * of the socket, so that the modem is not polled for data when it has not reported any.
+    *
+    * @return true if the modem reports received data with an URC
+    */
+    virtual bool is_rx_urc_supported();
+
     /**
     * Gets maximum number of sockets modem supports
     */
@@ -148,6 +194,30 @@ protected:
     virtual nsapi_size_or_error_t socket_recvfrom_impl(CellularSocket *socket, SocketAddress *address,
             void *buffer, nsapi_size_t size) = 0;
 
+    /**
+    * Sends the coalesced data of a socket when its flush timeout expires. Called from the event queue
+    * of the AT handler.
+    *
+    * @param socket socket whose data is sent, ignored if it has been closed meanwhile
+    */
+    void flush_socket_timeout(CellularSocket *socket);
+
+private:
+    // Fills the empty receive buffer of the socket with maximal reads from the modem
+    nsapi_size_or_error_t prefetch_socket_data(CellularSocket *socket);
+
+    // Serves a receive call from the receive buffer of the socket
+    nsapi_size_or_error_t read_socket_data(CellularSocket *socket, SocketAddress *address,
+            void *buffer, nsapi_size_t size);
+
+    // Sends data coalesced in the send buffer of the socket
+    nsapi_error_t flush_socket_data(CellularSocket *socket);
+
+    // Frees the send and receive buffers of the socket
+    void free_socket_buffers(CellularSocket *socket);
+
+protected:
+
     // socket container
     CellularSocket **_socket;
 
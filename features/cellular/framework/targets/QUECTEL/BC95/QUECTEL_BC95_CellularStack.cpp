@@ -47,6 +47,7 @@ void QUECTEL_BC95_CellularStack::urc_nsonmi()
     for (int i = 0; i < get_max_socket_count(); i++) {
         CellularSocket *sock = _socket[i];
         if (sock && sock->id == sock_id) {
+            sock->rx_avail = true;
             if (sock->_cb) {
                 sock->_cb(sock->_data);
             }
@@ -70,6 +71,11 @@ bool QUECTEL_BC95_CellularStack::is_protocol_supported(nsapi_protocol_t protocol
     return (protocol == NSAPI_UDP);
 }
 
+bool QUECTEL_BC95_CellularStack::is_rx_urc_supported()
+{
+    return true;
+}
+
 nsapi_error_t QUECTEL_BC95_CellularStack::socket_close_impl(int sock_id)
 {
     _at.cmd_start("AT+NSOCL=");
@@ -51,6 +51,7 @@ void QUECTEL_BG96_CellularStack::urc_qiurc()
     for (int i = 0; i < get_max_socket_count(); i++) {
         CellularSocket *sock = _socket[i];
         if (sock && sock->id == sock_id) {
+            sock->rx_avail = true;
             if (sock->_cb) {
                 sock->_cb(sock->_data);
             }
@@ -74,6 +75,11 @@ bool QUECTEL_BG96_CellularStack::is_protocol_supported(nsapi_protocol_t protocol
     return (protocol == NSAPI_UDP);
 }
 
+bool QUECTEL_BG96_CellularStack::is_rx_urc_supported()
+{
+    return true;
+}
+
 nsapi_error_t QUECTEL_BG96_CellularStack::socket_close_impl(int sock_id)
 {
     _at.cmd_start("AT+QICLOSE=");
@@ -240,16 +246,19 @@ nsapi_size_or_error_t QUECTEL_BG96_CellularStack::socket_recvfrom_impl(CellularS
 
     _at.cmd_start("AT+QIRD=");
     _at.write_int(socket->id);
+    _at.write_int(size);
     _at.cmd_stop();
 
     _at.resp_start("+QIRD:");
     recv_len = _at.read_int();
     _at.read_string(ip_address, sizeof(ip_address));
     port = _at.read_int();
-    _at.read_bytes((uint8_t*)buffer, recv_len);
+    if (recv_len > 0 && (nsapi_size_t)recv_len <= size) {
+        _at.read_bytes((uint8_t*)buffer, recv_len);
+    }
     _at.resp_stop();
 
-    if (!recv_len || (_at.get_last_error() != NSAPI_ERROR_OK)) {
+    if (recv_len <= 0 || (nsapi_size_t)recv_len > size || (_at.get_last_error() != NSAPI_ERROR_OK)) {
         return NSAPI_ERROR_WOULD_BLOCK;
     }
 
@@ -0,0 +1,354 @@
+/* FirmwareVerifier
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FirmwareVerifier.h"
+
+#if defined(MBEDTLS_SHA256_C) && defined(MBEDTLS_PK_C)
+
+#include <stdlib.h>
+#include <string.h>
+
+#define MANIFEST_MAGIC      0x46574d46  // "FWMF"
+#define MANIFEST_VERSION    1
+
+static uint32_t get_be32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+FirmwareVerifier::FirmwareVerifier(BlockDevice *bd, bd_addr_t addr)
+    : _bd(bd)
+    , _addr(addr)
+    , _state(STATE_IDLE)
+    , _image_size(0)
+    , _written(0)
+    , _program_buffer(NULL)
+    , _buffered(0)
+    , _chunk_size(0)
+    , _chunk_count(0)
+    , _next_missing(0)
+    , _chunk_hashes(NULL)
+    , _received(NULL)
+{
+    mbedtls_sha256_init(&_sha);
+    memset(_hash, 0, sizeof(_hash));
+}
+
+FirmwareVerifier::~FirmwareVerifier()
+{
+    reset();
+}
+
+void FirmwareVerifier::reset()
+{
+    mbedtls_sha256_free(&_sha);
+    mbedtls_sha256_init(&_sha);
+    free(_program_buffer);
+    free(_chunk_hashes);
+    free(_received);
+    _program_buffer = NULL;
+    _chunk_hashes = NULL;
+    _received = NULL;
+    _state = STATE_IDLE;
+    _image_size = 0;
+    _written = 0;
+    _buffered = 0;
+    _chunk_size = 0;
+    _chunk_count = 0;
+    _next_missing = 0;
+    memset(_hash, 0, sizeof(_hash));
+}
+
+int FirmwareVerifier::erase_region(bd_size_t image_size)
+{
+    bd_size_t erase_size = _bd->get_erase_size();
+    bd_size_t size = (image_size + erase_size - 1) / erase_size * erase_size;
+
+    if (image_size == 0 || _addr % erase_size || _addr + size > _bd->size()) {
+        return FW_VERIFIER_ERROR_PARAMETER;
+    }
+
+    _program_buffer = (uint8_t *)malloc(_bd->get_program_size());
+    if (!_program_buffer) {
+        return FW_VERIFIER_ERROR_NO_MEMORY;
+    }
+
+    return _bd->erase(_addr, size);
+}
+
+int FirmwareVerifier::program_padded(const void *data, bd_addr_t offset, bd_size_t size)
+{
+    bd_size_t program_size = _bd->get_program_size();
+    bd_size_t aligned = size / program_size * program_size;
+    int erase_value = _bd->get_erase_value();
+
+    if (aligned) {
+        int err = _bd->program(data, _addr + offset, aligned);
+        if (err) {
+            return err;
+        }
+    }
+
+    if (aligned == size) {
+        return 0;
+    }
+
+    // Fill the rest of the last program unit as if it was left erased, the
+    // tail may already be in the program buffer
+    const uint8_t *tail = (const uint8_t *)data + aligned;
+    if (tail != _program_buffer) {
+        memcpy(_program_buffer, tail, size - aligned);
+    }
+    memset(_program_buffer + (size - aligned), erase_value == -1 ? 0xff : erase_value,
+           program_size - (size - aligned));
+    return _bd->program(_program_buffer, _addr + offset + aligned, program_size);
+}
+
+int FirmwareVerifier::start(bd_size_t image_size)
+{
+    reset();
+
+    int err = erase_region(image_size);
+    if (err) {
+        reset();
+        return err;
+    }
+
+    mbedtls_sha256_starts_ret(&_sha, 0);
+    _image_size = image_size;
+    _state = STATE_SEQUENTIAL;
+    return 0;
+}
+
+int FirmwareVerifier::start(const void *manifest, size_t size,
+                            const unsigned char *sig, size_t sig_len, mbedtls_pk_context *pk)
+{
+    const uint8_t *m = (const uint8_t *)manifest;
+    unsigned char hash[32];
+
+    reset();
+
+    if (!m || !sig || !pk || size < FW_VERIFIER_MANIFEST_HEADER_SIZE) {
+        return FW_VERIFIER_ERROR_PARAMETER;
+    }
+
+    // Nothing in the manifest is trusted before its signature is checked
+    mbedtls_sha256_ret(m, size, hash, 0);
+    if (mbedtls_pk_verify(pk, MBEDTLS_MD_SHA256, hash, sizeof(hash), sig, sig_len) != 0) {
+        return FW_VERIFIER_ERROR_SIGNATURE;
+    }
+
+    uint32_t image_size = get_be32(m + 8);
+    uint32_t chunk_size = get_be32(m + 12);
+    if (get_be32(m) != MANIFEST_MAGIC || get_be32(m + 4) != MANIFEST_VERSION ||
+            image_size == 0 || chunk_size == 0 || chunk_size % _bd->get_program_size()) {
+        return FW_VERIFIER_ERROR_MANIFEST;
+    }
+
+    // Bounded before the multiplication, it would wrap with a 32-bit size_t
+    uint32_t chunks = image_size / chunk_size + (image_size % chunk_size ? 1 : 0);
+    if (chunks > ((size_t)-1 - FW_VERIFIER_MANIFEST_HEADER_SIZE) / FW_VERIFIER_CHUNK_HASH_SIZE ||
+            size != FW_VERIFIER_MANIFEST_HEADER_SIZE + (size_t)chunks * FW_VERIFIER_CHUNK_HASH_SIZE) {
+        return FW_VERIFIER_ERROR_MANIFEST;
+    }
+
+    _chunk_hashes = (unsigned char *)malloc(chunks * FW_VERIFIER_CHUNK_HASH_SIZE);
+    _received = (uint32_t *)calloc((chunks + 31) / 32, sizeof(uint32_t));
+    if (!_chunk_hashes || !_received) {
+        reset();
+        return FW_VERIFIER_ERROR_NO_MEMORY;
+    }
+    memcpy(_chunk_hashes, m + FW_VERIFIER_MANIFEST_HEADER_SIZE, chunks * FW_VERIFIER_CHUNK_HASH_SIZE);
+
+    int err = erase_region(image_size);
+    if (err) {
+        reset();
+        return err;
+    }
+
+    _image_size = image_size;
+    _chunk_size = chunk_size;
+    _chunk_count = chunks;
+    _state = STATE_CHUNKED;
+    return 0;
+}
+
+int FirmwareVerifier::write(const void *data, bd_size_t size)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    bd_size_t program_size = _bd->get_program_size();
+    int err;
+
+    if (_state != STATE_SEQUENTIAL || size > _image_size - _written) {
+        return FW_VERIFIER_ERROR_PARAMETER;
+    }
+
+    mbedtls_sha256_update_ret(&_sha, p, size);
+    _written += size;
+
+    // Complete a partially filled program unit first
+    if (_buffered) {
+        bd_size_t n = program_size - _buffered;
+        if (n > size) {
+            n = size;
+        }
+        memcpy(_program_buffer + _buffered, p, n);
+        _buffered += n;
+        p += n;
+        size -= n;
+
+        if (_buffered < program_size) {
+            return 0;
+        }
+
+        err = _bd->program(_program_buffer, _addr + _written - size - program_size, program_size);
+        if (err) {
+            return err;
+        }
+        _buffered = 0;
+    }
+
+    // Program whole units straight from the caller's buffer
+    bd_size_t aligned = size / program_size * program_size;
+    if (aligned) {
+        err = _bd->program(p, _addr + _written - size, aligned);
+        if (err) {
+            return err;
+        }
+        p += aligned;
+        size -= aligned;
+    }
+
+    memcpy(_program_buffer, p, size);
+    _buffered = size;
+    return 0;
+}
+
+int FirmwareVerifier::write_chunk(uint32_t index, const void *data, bd_size_t size)
+{
+    unsigned char hash[32];
+
+    if (_state != STATE_CHUNKED || index >= _chunk_count) {
+        return FW_VERIFIER_ERROR_PARAMETER;
+    }
+
+    bd_size_t offset = (bd_size_t)index * _chunk_size;
+    bd_size_t expected = _image_size - offset < _chunk_size ? _image_size - offset : _chunk_size;
+    if (size != expected) {
+        return FW_VERIFIER_ERROR_PARAMETER;
+    }
+
+    if (chunk_received(index)) {
+        return 0;
+    }
+
+    // Check before programming, a corrupt chunk never reaches the storage
+    mbedtls_sha256_ret((const unsigned char *)data, size, hash, 0);
+    if (memcmp(hash, _chunk_hashes + index * FW_VERIFIER_CHUNK_HASH_SIZE, sizeof(hash)) != 0) {
+        return FW_VERIFIER_ERROR_CHUNK_HASH;
+    }
+
+    int err = program_padded(data, offset, size);
+    if (err) {
+        return err;
+    }
+
+    _received[index / 32] |= 1UL << (index % 32);
+    _written += size;
+    while (_next_missing < _chunk_count && chunk_received(_next_missing)) {
+        _next_missing++;
+    }
+    return 0;
+}
+
+int FirmwareVerifier::finish(const unsigned char *sig, size_t sig_len, mbedtls_pk_context *pk)
+{
+    if (_state != STATE_SEQUENTIAL || !sig || !pk) {
+        return FW_VERIFIER_ERROR_PARAMETER;
+    }
+
+    if (_written != _image_size) {
+        return FW_VERIFIER_ERROR_INCOMPLETE;
+    }
+
+    int err = program_padded(_program_buffer, _written - _buffered, _buffered);
+    if (err) {
+        return err;
+    }
+    _buffered = 0;
+
+    err = _bd->sync();
+    if (err) {
+        return err;
+    }
+
+    mbedtls_sha256_finish_ret(&_sha, _hash);
+    _state = STATE_FINISHED;
+
+    if (mbedtls_pk_verify(pk, MBEDTLS_MD_SHA256, _hash, sizeof(_hash), sig, sig_len) != 0) {
+        return FW_VERIFIER_ERROR_SIGNATURE;
+    }
+    return 0;
+}
+
+int FirmwareVerifier::finish()
+{
+    if (_state != STATE_CHUNKED) {
+        return FW_VERIFIER_ERROR_PARAMETER;
+    }
+
+    if (_next_missing < _chunk_count) {
+        return FW_VERIFIER_ERROR_INCOMPLETE;
+    }
+
+    int err = _bd->sync();
+    if (err) {
+        return err;
+    }
+
+    _state = STATE_FINISHED;
+    return 0;
+}
+
+uint32_t FirmwareVerifier::chunk_count() const
+{
+    return _chunk_count;
+}
+
+bool FirmwareVerifier::chunk_received(uint32_t index) const
+{
+    if (!_received || index >= _chunk_count) {
+        return false;
+    }
+    return (_received[index / 32] >> (index % 32)) & 1;
+}
+
+uint32_t FirmwareVerifier::next_missing_chunk() const
+{
+    return _next_missing;
+}
+
+int FirmwareVerifier::get_hash(unsigned char hash[32]) const
+{
+    if (_state != STATE_FINISHED || _chunk_count) {
+        return FW_VERIFIER_ERROR_PARAMETER;
+    }
+    memcpy(hash, _hash, sizeof(_hash));
+    return 0;
+}
+
+#endif /* MBEDTLS_SHA256_C && MBEDTLS_PK_C */
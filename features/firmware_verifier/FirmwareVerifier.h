@@ -0,0 +1,234 @@
+/* FirmwareVerifier
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRMWARE_VERIFIER_H
+#define FIRMWARE_VERIFIER_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_SHA256_C) && defined(MBEDTLS_PK_C)
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mbedtls/sha256.h"
+#include "mbedtls/pk.h"
+#include "BlockDevice.h"
+#include "platform/NonCopyable.h"
+
+/** Enum of FirmwareVerifier error codes
+ *
+ *  @enum fw_verifier_error
+ */
+enum fw_verifier_error {
+    FW_VERIFIER_ERROR_OK            = 0,     /*!< no error */
+    FW_VERIFIER_ERROR_PARAMETER     = -4101, /*!< invalid argument or call out of sequence */
+    FW_VERIFIER_ERROR_NO_MEMORY     = -4102, /*!< out of memory */
+    FW_VERIFIER_ERROR_MANIFEST      = -4103, /*!< malformed manifest */
+    FW_VERIFIER_ERROR_SIGNATURE     = -4104, /*!< signature does not verify */
+    FW_VERIFIER_ERROR_CHUNK_HASH    = -4105, /*!< chunk does not match its manifest hash */
+    FW_VERIFIER_ERROR_INCOMPLETE    = -4106, /*!< image not fully received */
+};
+
+/** Size of the manifest header in bytes */
+#define FW_VERIFIER_MANIFEST_HEADER_SIZE    16
+
+/** Size of a chunk hash in the manifest in bytes */
+#define FW_VERIFIER_CHUNK_HASH_SIZE         32
+
+/** Streaming verifier of firmware images written to a block device
+ *
+ *  Hashes an image with SHA-256 while it is programmed, so that it can be
+ *  authenticated as soon as the last byte is written, without reading it
+ *  back from storage. The image occupies the block device from the address
+ *  given to the constructor, and the region is erased when a transfer
+ *  starts.
+ *
+ *  There are two modes:
+ *  - Sequential: the image arrives in order, in writes of any size, and is
+ *    authenticated by a signature of its SHA-256 hash in finish().
+ *  - Chunked: a signed manifest listing the SHA-256 hash of every chunk of
+ *    the image is verified first. Chunks can then arrive in any order and
+ *    each one is checked against its hash before it is programmed, so a
+ *    corrupt chunk is rejected, and can be requested again, immediately
+ *    rather than after the whole transfer.
+ *
+ *  The manifest is big-endian:
+ *  @code
+ *  offset  size
+ *       0     4  magic "FWMF"
+ *       4     4  version, 1
+ *       8     4  image size in bytes
+ *      12     4  chunk size in bytes, a multiple of the program size
+ *      16  32*N  SHA-256 of each chunk, N = ceil(image size / chunk size)
+ *  @endcode
+ *  and its signature is made over its SHA-256 hash.
+ *
+ *  Usage in chunked mode:
+ *  @code
+ *  FirmwareVerifier verifier(&bd, SLOT_ADDRESS);
+ *  err = verifier.start(manifest, manifest_size, sig, sig_len, &pk);
+ *  while (!err && verifier.next_missing_chunk() < verifier.chunk_count()) {
+ *      size = download(verifier.next_missing_chunk(), buffer);
+ *      err = verifier.write_chunk(verifier.next_missing_chunk(), buffer, size);
+ *      if (err == FW_VERIFIER_ERROR_CHUNK_HASH) {
+ *          err = 0;            // retry the chunk
+ *      }
+ *  }
+ *  err = verifier.finish();
+ *  @endcode
+ *
+ *  The block device must be initialized by the caller.
+ */
+class FirmwareVerifier : private mbed::NonCopyable<FirmwareVerifier> {
+public:
+    /** Create a verifier
+     *
+     *  @param bd       Block device receiving the image
+     *  @param addr     Address of the image on the block device, must be
+     *                  aligned to its erase size
+     */
+    FirmwareVerifier(BlockDevice *bd, bd_addr_t addr = 0);
+    ~FirmwareVerifier();
+
+    /** Start a sequential transfer
+     *
+     *  Erases the region of the image.
+     *
+     *  @param image_size   Size of the image in bytes
+     *  @return             0 on success or a negative error code on failure
+     */
+    int start(bd_size_t image_size);
+
+    /** Start a chunked transfer
+     *
+     *  Checks the signature of the manifest, keeps a copy of its chunk
+     *  hashes and erases the region of the image.
+     *
+     *  @param manifest     Manifest of the image
+     *  @param size         Size of the manifest in bytes
+     *  @param sig          Signature of the SHA-256 hash of the manifest
+     *  @param sig_len      Size of the signature in bytes
+     *  @param pk           Public key checking the signature
+     *  @return             0 on success or a negative error code on failure
+     */
+    int start(const void *manifest, size_t size,
+              const unsigned char *sig, size_t sig_len, mbedtls_pk_context *pk);
+
+    /** Append data to the image in a sequential transfer
+     *
+     *  @param data     Data to append
+     *  @param size     Size of the data in bytes
+     *  @return         0 on success or a negative error code on failure
+     */
+    int write(const void *data, bd_size_t size);
+
+    /** Write a chunk of the image in a chunked transfer
+     *
+     *  The chunk is programmed only if it matches its hash in the manifest.
+     *  Writing a chunk that was already received has no effect.
+     *
+     *  @param index    Index of the chunk in the image
+     *  @param data     Data of the chunk
+     *  @param size     Size of the chunk in bytes, the chunk size of the
+     *                  manifest, or less for the last chunk
+     *  @return         0 on success, FW_VERIFIER_ERROR_CHUNK_HASH if the
+     *                  data is corrupt, or another negative error code
+     */
+    int write_chunk(uint32_t index, const void *data, bd_size_t size);
+
+    /** Finish a sequential transfer
+     *
+     *  Programs the tail of the image and checks its signature.
+     *
+     *  @param sig      Signature of the SHA-256 hash of the image
+     *  @param sig_len  Size of the signature in bytes
+     *  @param pk       Public key checking the signature
+     *  @return         0 if the image is complete and authentic, or a
+     *                  negative error code
+     */
+    int finish(const unsigned char *sig, size_t sig_len, mbedtls_pk_context *pk);
+
+    /** Finish a chunked transfer
+     *
+     *  @return         0 if every chunk was received, or a negative error code
+     */
+    int finish();
+
+    /** Number of chunks of the image in a chunked transfer
+     *
+     *  @return         Number of chunks, 0 in a sequential transfer
+     */
+    uint32_t chunk_count() const;
+
+    /** Check if a chunk was received
+     *
+     *  @param index    Index of the chunk
+     *  @return         True if the chunk was verified and programmed
+     */
+    bool chunk_received(uint32_t index) const;
+
+    /** Find the first chunk not received yet
+     *
+     *  @return         Index of the chunk, or chunk_count() if all were received
+     */
+    uint32_t next_missing_chunk() const;
+
+    /** Get the SHA-256 hash of the image of a finished sequential transfer
+     *
+     *  @param hash     Buffer for the hash
+     *  @return         0 on success or a negative error code on failure
+     */
+    int get_hash(unsigned char hash[32]) const;
+
+private:
+    enum state_t {
+        STATE_IDLE,
+        STATE_SEQUENTIAL,
+        STATE_CHUNKED,
+        STATE_FINISHED,
+    };
+
+    void reset();
+    int erase_region(bd_size_t image_size);
+    int program_padded(const void *data, bd_addr_t offset, bd_size_t size);
+
+    BlockDevice *_bd;
+    bd_addr_t _addr;
+    state_t _state;
+    bd_size_t _image_size;
+    bd_size_t _written;
+
+    // Sequential mode
+    mbedtls_sha256_context _sha;
+    uint8_t *_program_buffer;
+    bd_size_t _buffered;
+    unsigned char _hash[32];
+
+    // Chunked mode
+    bd_size_t _chunk_size;
+    uint32_t _chunk_count;
+    uint32_t _next_missing;
+    unsigned char *_chunk_hashes;
+    uint32_t *_received;
+};
+
+#endif /* MBEDTLS_SHA256_C && MBEDTLS_PK_C */
+
+#endif /* FIRMWARE_VERIFIER_H */
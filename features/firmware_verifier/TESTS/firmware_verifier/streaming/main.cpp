@@ -0,0 +1,255 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity.h"
+#include "utest.h"
+
+#include "HeapBlockDevice.h"
+#include "ProfilingBlockDevice.h"
+#include "FirmwareVerifier.h"
+#include "mbedtls/certs.h"
+#include <stdlib.h>
+
+using namespace utest::v1;
+
+#if !defined(MBEDTLS_SHA256_C) || !defined(MBEDTLS_PK_PARSE_C) || !defined(MBEDTLS_CERTS_C) || \
+    !defined(MBEDTLS_ECDSA_C) || !defined(MBEDTLS_ECDSA_DETERMINISTIC)
+    #error [NOT_SUPPORTED] SHA-256, key parsing and deterministic ECDSA required
+#endif
+
+// TODO HACK, replace with available ram/heap property
+#if defined(TARGET_MTB_MTS_XDOT)
+    #error [NOT_SUPPORTED] Insufficient heap for heap block device tests
+#endif
+
+#define TEST_BLOCK_SIZE 128
+#define TEST_BLOCK_DEVICE_SIZE 64*TEST_BLOCK_SIZE
+#define TEST_IMAGE_ADDR 2*TEST_BLOCK_SIZE
+#define TEST_IMAGE_SIZE 5000
+#define TEST_CHUNK_SIZE 1024
+#define TEST_CHUNK_COUNT ((TEST_IMAGE_SIZE + TEST_CHUNK_SIZE - 1) / TEST_CHUNK_SIZE)
+#define TEST_MANIFEST_SIZE (FW_VERIFIER_MANIFEST_HEADER_SIZE + TEST_CHUNK_COUNT*FW_VERIFIER_CHUNK_HASH_SIZE)
+
+static uint8_t image[TEST_IMAGE_SIZE];
+static uint8_t manifest[TEST_MANIFEST_SIZE];
+static mbedtls_pk_context pk;
+
+// Deterministic ECDSA does not use the random generator
+static int no_rng(void *ctx, unsigned char *buf, size_t len)
+{
+    return -1;
+}
+
+static size_t sign(const uint8_t *data, size_t size, unsigned char *sig)
+{
+    unsigned char hash[32];
+    size_t sig_len = 0;
+
+    mbedtls_sha256_ret(data, size, hash, 0);
+    int err = mbedtls_pk_sign(&pk, MBEDTLS_MD_SHA256, hash, sizeof(hash), sig, &sig_len, no_rng, NULL);
+    TEST_ASSERT_EQUAL(0, err);
+    return sig_len;
+}
+
+static void put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static void check_image(BlockDevice *bd)
+{
+    uint8_t block[TEST_BLOCK_SIZE];
+
+    for (bd_size_t off = 0; off < TEST_IMAGE_SIZE; off += TEST_BLOCK_SIZE) {
+        bd_size_t n = TEST_IMAGE_SIZE - off < TEST_BLOCK_SIZE ? TEST_IMAGE_SIZE - off : TEST_BLOCK_SIZE;
+        TEST_ASSERT_EQUAL(0, bd->read(block, TEST_IMAGE_ADDR + off, TEST_BLOCK_SIZE));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(image + off, block, n);
+    }
+}
+
+void test_sequential()
+{
+    HeapBlockDevice heap(TEST_BLOCK_DEVICE_SIZE, TEST_BLOCK_SIZE);
+    ProfilingBlockDevice bd(&heap);
+    unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];
+    unsigned char hash[32], expected[32];
+    size_t sig_len = sign(image, sizeof(image), sig);
+
+    TEST_ASSERT_EQUAL(0, bd.init());
+
+    FirmwareVerifier verifier(&bd, TEST_IMAGE_ADDR);
+    TEST_ASSERT_EQUAL(0, verifier.start(TEST_IMAGE_SIZE));
+
+    // Writes of every size, not aligned to the program size
+    size_t off = 0;
+    for (size_t n = 1; off < sizeof(image); n = n * 3 + 7) {
+        if (n > sizeof(image) - off) {
+            n = sizeof(image) - off;
+        }
+        TEST_ASSERT_EQUAL(0, verifier.write(image + off, n));
+        off += n;
+    }
+    TEST_ASSERT_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.write(image, 1));
+    TEST_ASSERT_EQUAL(0, verifier.finish(sig, sig_len, &pk));
+
+    // The image is authenticated without reading it back
+    TEST_ASSERT_EQUAL(0, bd.get_read_count());
+    TEST_ASSERT_EQUAL(TEST_IMAGE_SIZE + TEST_BLOCK_SIZE - TEST_IMAGE_SIZE % TEST_BLOCK_SIZE,
+                      bd.get_program_count());
+
+    TEST_ASSERT_EQUAL(0, verifier.get_hash(hash));
+    mbedtls_sha256_ret(image, sizeof(image), expected, 0);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, hash, sizeof(hash));
+    check_image(&bd);
+
+    TEST_ASSERT_EQUAL(0, bd.deinit());
+}
+
+void test_sequential_corrupt()
+{
+    HeapBlockDevice bd(TEST_BLOCK_DEVICE_SIZE, TEST_BLOCK_SIZE);
+    unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];
+    size_t sig_len = sign(image, sizeof(image), sig);
+
+    TEST_ASSERT_EQUAL(0, bd.init());
+
+    FirmwareVerifier verifier(&bd, TEST_IMAGE_ADDR);
+    TEST_ASSERT_EQUAL(0, verifier.start(TEST_IMAGE_SIZE));
+    TEST_ASSERT_EQUAL(0, verifier.write(image, 100));
+    TEST_ASSERT_EQUAL(FW_VERIFIER_ERROR_INCOMPLETE, verifier.finish(sig, sig_len, &pk));
+
+    uint8_t flipped = image[100] ^ 0x01;
+    TEST_ASSERT_EQUAL(0, verifier.write(&flipped, 1));
+    TEST_ASSERT_EQUAL(0, verifier.write(image + 101, sizeof(image) - 101));
+    TEST_ASSERT_EQUAL(FW_VERIFIER_ERROR_SIGNATURE, verifier.finish(sig, sig_len, &pk));
+
+    TEST_ASSERT_EQUAL(0, bd.deinit());
+}
+
+void test_chunked()
+{
+    HeapBlockDevice heap(TEST_BLOCK_DEVICE_SIZE, TEST_BLOCK_SIZE);
+    ProfilingBlockDevice bd(&heap);
+    unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];
+    uint8_t chunk[TEST_CHUNK_SIZE];
+    size_t sig_len = sign(manifest, sizeof(manifest), sig);
+
+    TEST_ASSERT_EQUAL(0, bd.init());
+
+    FirmwareVerifier verifier(&bd, TEST_IMAGE_ADDR);
+    TEST_ASSERT_EQUAL(0, verifier.start(manifest, sizeof(manifest), sig, sig_len, &pk));
+    TEST_ASSERT_EQUAL(TEST_CHUNK_COUNT, verifier.chunk_count());
+
+    // Chunks in reverse order, the corrupt one is rejected before programming
+    for (int i = TEST_CHUNK_COUNT - 1; i >= 0; i--) {
+        size_t off = i * TEST_CHUNK_SIZE;
+        size_t n = TEST_IMAGE_SIZE - off < TEST_CHUNK_SIZE ? TEST_IMAGE_SIZE - off : TEST_CHUNK_SIZE;
+        memcpy(chunk, image + off, n);
+
+        if (i == 1) {
+            chunk[17] ^= 0x80;
+            bd_size_t programmed = bd.get_program_count();
+            TEST_ASSERT_EQUAL(FW_VERIFIER_ERROR_CHUNK_HASH, verifier.write_chunk(i, chunk, n));
+            TEST_ASSERT_EQUAL(programmed, bd.get_program_count());
+            TEST_ASSERT_FALSE(verifier.chunk_received(i));
+            continue;
+        }
+        TEST_ASSERT_EQUAL(0, verifier.write_chunk(i, chunk, n));
+        TEST_ASSERT_TRUE(verifier.chunk_received(i));
+    }
+
+    // Only the corrupt chunk needs to be requested again
+    TEST_ASSERT_EQUAL(1, verifier.next_missing_chunk());
+    TEST_ASSERT_EQUAL(FW_VERIFIER_ERROR_INCOMPLETE, verifier.finish());
+    TEST_ASSERT_EQUAL(0, verifier.write_chunk(1, image + TEST_CHUNK_SIZE, TEST_CHUNK_SIZE));
+    TEST_ASSERT_EQUAL(TEST_CHUNK_COUNT, verifier.next_missing_chunk());
+    TEST_ASSERT_EQUAL(0, verifier.finish());
+
+    TEST_ASSERT_EQUAL(0, bd.get_read_count());
+    check_image(&bd);
+
+    TEST_ASSERT_EQUAL(0, bd.deinit());
+}
+
+void test_chunked_bad_manifest()
+{
+    HeapBlockDevice bd(TEST_BLOCK_DEVICE_SIZE, TEST_BLOCK_SIZE);
+    unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];
+    size_t sig_len = sign(manifest, sizeof(manifest), sig);
+
+    TEST_ASSERT_EQUAL(0, bd.init());
+
+    FirmwareVerifier verifier(&bd, TEST_IMAGE_ADDR);
+    manifest[FW_VERIFIER_MANIFEST_HEADER_SIZE] ^= 0x01;
+    TEST_ASSERT_EQUAL(FW_VERIFIER_ERROR_SIGNATURE,
+                      verifier.start(manifest, sizeof(manifest), sig, sig_len, &pk));
+    manifest[FW_VERIFIER_MANIFEST_HEADER_SIZE] ^= 0x01;
+    TEST_ASSERT_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.write_chunk(0, image, TEST_CHUNK_SIZE));
+
+    // A signed but truncated manifest is still rejected
+    sig_len = sign(manifest, sizeof(manifest) - 1, sig);
+    TEST_ASSERT_EQUAL(FW_VERIFIER_ERROR_MANIFEST,
+                      verifier.start(manifest, sizeof(manifest) - 1, sig, sig_len, &pk));
+
+    TEST_ASSERT_EQUAL(0, bd.deinit());
+}
+
+
+// Test setup
+utest::v1::status_t test_setup(const size_t number_of_cases) {
+    GREENTEA_SETUP(60, "default_auto");
+
+    srand(1);
+    for (size_t i = 0; i < sizeof(image); i++) {
+        image[i] = 0xff & rand();
+    }
+
+    memcpy(manifest, "FWMF", 4);
+    put_be32(manifest + 4, 1);
+    put_be32(manifest + 8, TEST_IMAGE_SIZE);
+    put_be32(manifest + 12, TEST_CHUNK_SIZE);
+    for (size_t i = 0; i < TEST_CHUNK_COUNT; i++) {
+        size_t off = i * TEST_CHUNK_SIZE;
+        size_t n = TEST_IMAGE_SIZE - off < TEST_CHUNK_SIZE ? TEST_IMAGE_SIZE - off : TEST_CHUNK_SIZE;
+        mbedtls_sha256_ret(image + off, n,
+                           manifest + FW_VERIFIER_MANIFEST_HEADER_SIZE + i * FW_VERIFIER_CHUNK_HASH_SIZE, 0);
+    }
+
+    mbedtls_pk_init(&pk);
+    if (mbedtls_pk_parse_key(&pk, (const unsigned char *)mbedtls_test_srv_key_ec,
+                             mbedtls_test_srv_key_ec_len, NULL, 0) != 0) {
+        return STATUS_ABORT;
+    }
+
+    return verbose_test_setup_handler(number_of_cases);
+}
+
+Case cases[] = {
+    Case("Sequential image, unaligned writes", test_sequential),
+    Case("Sequential image, corrupt data", test_sequential_corrupt),
+    Case("Chunked image, out of order with a corrupt chunk", test_chunked),
+    Case("Chunked image, bad manifest", test_chunked_bad_manifest),
+};
+
+Specification specification(test_setup, cases);
+
+int main() {
+    return !Harness::run(specification);
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_firmwareverifier.h"
+
+TEST_GROUP(FirmwareVerifier)
+{
+    Test_FirmwareVerifier* unit;
+
+    void setup()
+    {
+        unit = new Test_FirmwareVerifier();
+    }
+
+    void teardown()
+    {
+        delete unit;
+    }
+};
+
+TEST(FirmwareVerifier, Create)
+{
+    CHECK(unit != NULL);
+}
+
+TEST(FirmwareVerifier, test_FirmwareVerifier_sequential)
+{
+    unit->test_FirmwareVerifier_sequential();
+}
+
+TEST(FirmwareVerifier, test_FirmwareVerifier_sequential_corrupt)
+{
+    unit->test_FirmwareVerifier_sequential_corrupt();
+}
+
+TEST(FirmwareVerifier, test_FirmwareVerifier_sequential_out_of_order)
+{
+    unit->test_FirmwareVerifier_sequential_out_of_order();
+}
+
+TEST(FirmwareVerifier, test_FirmwareVerifier_chunked)
+{
+    unit->test_FirmwareVerifier_chunked();
+}
+
+TEST(FirmwareVerifier, test_FirmwareVerifier_chunked_bad_manifest)
+{
+    unit->test_FirmwareVerifier_chunked_bad_manifest();
+}
+
+TEST(FirmwareVerifier, test_FirmwareVerifier_chunked_count_overflow)
+{
+    unit->test_FirmwareVerifier_chunked_count_overflow();
+}
+
+TEST(FirmwareVerifier, test_FirmwareVerifier_unaligned_region)
+{
+    unit->test_FirmwareVerifier_unaligned_region();
+}
@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_firmwareverifier.h"
+#include "HeapBlockDevice.h"
+#include "ProfilingBlockDevice.h"
+#include "FirmwareVerifier.h"
+#include <stdlib.h>
+
+#define TEST_BLOCK_SIZE 128
+#define TEST_BLOCK_DEVICE_SIZE 64*TEST_BLOCK_SIZE
+#define TEST_IMAGE_ADDR 2*TEST_BLOCK_SIZE
+#define TEST_IMAGE_SIZE 5000
+#define TEST_CHUNK_SIZE 1024
+#define TEST_CHUNK_COUNT ((TEST_IMAGE_SIZE + TEST_CHUNK_SIZE - 1) / TEST_CHUNK_SIZE)
+#define TEST_MANIFEST_SIZE (FW_VERIFIER_MANIFEST_HEADER_SIZE + TEST_CHUNK_COUNT*FW_VERIFIER_CHUNK_HASH_SIZE)
+
+static uint8_t image[TEST_IMAGE_SIZE];
+static uint8_t manifest[TEST_MANIFEST_SIZE];
+static mbedtls_pk_context pk;
+
+// Deterministic ECDSA does not use the random generator
+static int no_rng(void *ctx, unsigned char *buf, size_t len)
+{
+    return -1;
+}
+
+// Only used to generate the test key
+static int test_rng(void *ctx, unsigned char *buf, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = 0xff & rand();
+    }
+    return 0;
+}
+
+static size_t sign(const uint8_t *data, size_t size, unsigned char *sig)
+{
+    unsigned char hash[32];
+    size_t sig_len = 0;
+
+    mbedtls_sha256_ret(data, size, hash, 0);
+    LONGS_EQUAL(0, mbedtls_pk_sign(&pk, MBEDTLS_MD_SHA256, hash, sizeof(hash), sig, &sig_len, no_rng, NULL));
+    return sig_len;
+}
+
+static void put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static void check_image(BlockDevice *bd)
+{
+    uint8_t block[TEST_BLOCK_SIZE];
+
+    for (bd_size_t off = 0; off < TEST_IMAGE_SIZE; off += TEST_BLOCK_SIZE) {
+        bd_size_t n = TEST_IMAGE_SIZE - off < TEST_BLOCK_SIZE ? TEST_IMAGE_SIZE - off : TEST_BLOCK_SIZE;
+        LONGS_EQUAL(0, bd->read(block, TEST_IMAGE_ADDR + off, TEST_BLOCK_SIZE));
+        MEMCMP_EQUAL(image + off, block, n);
+    }
+}
+
+Test_FirmwareVerifier::Test_FirmwareVerifier()
+{
+    srand(1);
+    for (size_t i = 0; i < sizeof(image); i++) {
+        image[i] = 0xff & rand();
+    }
+
+    memcpy(manifest, "FWMF", 4);
+    put_be32(manifest + 4, 1);
+    put_be32(manifest + 8, TEST_IMAGE_SIZE);
+    put_be32(manifest + 12, TEST_CHUNK_SIZE);
+    for (size_t i = 0; i < TEST_CHUNK_COUNT; i++) {
+        size_t off = i * TEST_CHUNK_SIZE;
+        size_t n = TEST_IMAGE_SIZE - off < TEST_CHUNK_SIZE ? TEST_IMAGE_SIZE - off : TEST_CHUNK_SIZE;
+        mbedtls_sha256_ret(image + off, n,
+                           manifest + FW_VERIFIER_MANIFEST_HEADER_SIZE + i * FW_VERIFIER_CHUNK_HASH_SIZE, 0);
+    }
+
+    mbedtls_pk_init(&pk);
+    LONGS_EQUAL(0, mbedtls_pk_setup(&pk, mbedtls_pk_info_from_type(MBEDTLS_PK_ECKEY)));
+    LONGS_EQUAL(0, mbedtls_ecp_gen_key(MBEDTLS_ECP_DP_SECP256R1, mbedtls_pk_ec(pk), test_rng, NULL));
+}
+
+Test_FirmwareVerifier::~Test_FirmwareVerifier()
+{
+    mbedtls_pk_free(&pk);
+}
+
+void Test_FirmwareVerifier::test_FirmwareVerifier_sequential()
+{
+    HeapBlockDevice heap(TEST_BLOCK_DEVICE_SIZE, TEST_BLOCK_SIZE);
+    ProfilingBlockDevice bd(&heap);
+    unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];
+    unsigned char hash[32], expected[32];
+    size_t sig_len = sign(image, sizeof(image), sig);
+
+    LONGS_EQUAL(0, bd.init());
+
+    FirmwareVerifier verifier(&bd, TEST_IMAGE_ADDR);
+    LONGS_EQUAL(0, verifier.start(TEST_IMAGE_SIZE));
+
+    // Writes of every size, not aligned to the program size
+    size_t off = 0;
+    for (size_t n = 1; off < sizeof(image); n = n * 3 + 7) {
+        if (n > sizeof(image) - off) {
+            n = sizeof(image) - off;
+        }
+        LONGS_EQUAL(0, verifier.write(image + off, n));
+        off += n;
+    }
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.write(image, 1));
+    LONGS_EQUAL(0, verifier.finish(sig, sig_len, &pk));
+
+    // The image is authenticated without reading it back
+    LONGS_EQUAL(0, bd.get_read_count());
+    LONGS_EQUAL(TEST_IMAGE_SIZE + TEST_BLOCK_SIZE - TEST_IMAGE_SIZE % TEST_BLOCK_SIZE,
+                bd.get_program_count());
+
+    LONGS_EQUAL(0, verifier.get_hash(hash));
+    mbedtls_sha256_ret(image, sizeof(image), expected, 0);
+    MEMCMP_EQUAL(expected, hash, sizeof(hash));
+    check_image(&bd);
+
+    // The rest of the last program unit reads as erased
+    uint8_t block[TEST_BLOCK_SIZE];
+    bd_size_t tail = TEST_IMAGE_SIZE / TEST_BLOCK_SIZE * TEST_BLOCK_SIZE;
+    LONGS_EQUAL(0, bd.read(block, TEST_IMAGE_ADDR + tail, TEST_BLOCK_SIZE));
+    for (size_t i = TEST_IMAGE_SIZE - tail; i < TEST_BLOCK_SIZE; i++) {
+        LONGS_EQUAL(0xff, block[i]);
+    }
+
+    LONGS_EQUAL(0, bd.deinit());
+}
+
+void Test_FirmwareVerifier::test_FirmwareVerifier_sequential_corrupt()
+{
+    HeapBlockDevice bd(TEST_BLOCK_DEVICE_SIZE, TEST_BLOCK_SIZE);
+    unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];
+    unsigned char hash[32];
+    size_t sig_len = sign(image, sizeof(image), sig);
+
+    LONGS_EQUAL(0, bd.init());
+
+    FirmwareVerifier verifier(&bd, TEST_IMAGE_ADDR);
+    LONGS_EQUAL(0, verifier.start(TEST_IMAGE_SIZE));
+    LONGS_EQUAL(0, verifier.write(image, 100));
+    LONGS_EQUAL(FW_VERIFIER_ERROR_INCOMPLETE, verifier.finish(sig, sig_len, &pk));
+
+    uint8_t flipped = image[100] ^ 0x01;
+    LONGS_EQUAL(0, verifier.write(&flipped, 1));
+    LONGS_EQUAL(0, verifier.write(image + 101, sizeof(image) - 101));
+    LONGS_EQUAL(FW_VERIFIER_ERROR_SIGNATURE, verifier.finish(sig, sig_len, &pk));
+
+    // A valid signature of other data does not verify either
+    sig_len = sign(image, sizeof(image) - 1, sig);
+    LONGS_EQUAL(0, verifier.start(TEST_IMAGE_SIZE));
+    LONGS_EQUAL(0, verifier.write(image, sizeof(image)));
+    LONGS_EQUAL(FW_VERIFIER_ERROR_SIGNATURE, verifier.finish(sig, sig_len, &pk));
+
+    // The hash is still available to tell what was received
+    LONGS_EQUAL(0, verifier.get_hash(hash));
+
+    LONGS_EQUAL(0, bd.deinit());
+}
+
+void Test_FirmwareVerifier::test_FirmwareVerifier_sequential_out_of_order()
+{
+    HeapBlockDevice bd(TEST_BLOCK_DEVICE_SIZE, TEST_BLOCK_SIZE);
+    unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];
+    unsigned char hash[32];
+    size_t sig_len = sign(image, sizeof(image), sig);
+
+    LONGS_EQUAL(0, bd.init());
+
+    FirmwareVerifier verifier(&bd, TEST_IMAGE_ADDR);
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.write(image, 1));
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.finish(sig, sig_len, &pk));
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.get_hash(hash));
+
+    // The image must fit the block device
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.start(TEST_BLOCK_DEVICE_SIZE));
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.start(0));
+
+    // Chunked calls are rejected in a sequential transfer
+    LONGS_EQUAL(0, verifier.start(TEST_IMAGE_SIZE));
+    LONGS_EQUAL(0, verifier.chunk_count());
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.write_chunk(0, image, TEST_CHUNK_SIZE));
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.finish());
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.get_hash(hash));
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.finish(NULL, 0, &pk));
+
+    LONGS_EQUAL(0, bd.deinit());
+}
+
+void Test_FirmwareVerifier::test_FirmwareVerifier_chunked()
+{
+    HeapBlockDevice heap(TEST_BLOCK_DEVICE_SIZE, TEST_BLOCK_SIZE);
+    ProfilingBlockDevice bd(&heap);
+    unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];
+    unsigned char hash[32];
+    uint8_t chunk[TEST_CHUNK_SIZE];
+    size_t sig_len = sign(manifest, sizeof(manifest), sig);
+
+    LONGS_EQUAL(0, bd.init());
+
+    FirmwareVerifier verifier(&bd, TEST_IMAGE_ADDR);
+    LONGS_EQUAL(0, verifier.start(manifest, sizeof(manifest), sig, sig_len, &pk));
+    LONGS_EQUAL(TEST_CHUNK_COUNT, verifier.chunk_count());
+    LONGS_EQUAL(0, verifier.next_missing_chunk());
+
+    // Chunks in reverse order, the corrupt one is rejected before programming
+    for (int i = TEST_CHUNK_COUNT - 1; i >= 0; i--) {
+        size_t off = i * TEST_CHUNK_SIZE;
+        size_t n = TEST_IMAGE_SIZE - off < TEST_CHUNK_SIZE ? TEST_IMAGE_SIZE - off : TEST_CHUNK_SIZE;
+        memcpy(chunk, image + off, n);
+
+        if (i == 1) {
+            chunk[17] ^= 0x80;
+            bd_size_t programmed = bd.get_program_count();
+            LONGS_EQUAL(FW_VERIFIER_ERROR_CHUNK_HASH, verifier.write_chunk(i, chunk, n));
+            LONGS_EQUAL(programmed, bd.get_program_count());
+            CHECK(!verifier.chunk_received(i));
+            continue;
+        }
+        LONGS_EQUAL(0, verifier.write_chunk(i, chunk, n));
+        CHECK(verifier.chunk_received(i));
+    }
+
+    // A chunk received twice is programmed once
+    bd_size_t programmed = bd.get_program_count();
+    LONGS_EQUAL(0, verifier.write_chunk(0, image, TEST_CHUNK_SIZE));
+    LONGS_EQUAL(programmed, bd.get_program_count());
+
+    // Chunks of the wrong size or index are rejected
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.write_chunk(1, image + TEST_CHUNK_SIZE, TEST_CHUNK_SIZE - 1));
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.write_chunk(TEST_CHUNK_COUNT, image, TEST_CHUNK_SIZE));
+
+    // Only the corrupt chunk needs to be requested again
+    LONGS_EQUAL(1, verifier.next_missing_chunk());
+    LONGS_EQUAL(FW_VERIFIER_ERROR_INCOMPLETE, verifier.finish());
+    LONGS_EQUAL(0, verifier.write_chunk(1, image + TEST_CHUNK_SIZE, TEST_CHUNK_SIZE));
+    LONGS_EQUAL(TEST_CHUNK_COUNT, verifier.next_missing_chunk());
+    LONGS_EQUAL(0, verifier.finish());
+
+    // There is no hash of the whole image in a chunked transfer
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.get_hash(hash));
+
+    LONGS_EQUAL(0, bd.get_read_count());
+    check_image(&bd);
+
+    LONGS_EQUAL(0, bd.deinit());
+}
+
+void Test_FirmwareVerifier::test_FirmwareVerifier_chunked_bad_manifest()
+{
+    HeapBlockDevice bd(TEST_BLOCK_DEVICE_SIZE, TEST_BLOCK_SIZE);
+    unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];
+    size_t sig_len = sign(manifest, sizeof(manifest), sig);
+
+    LONGS_EQUAL(0, bd.init());
+
+    FirmwareVerifier verifier(&bd, TEST_IMAGE_ADDR);
+    manifest[FW_VERIFIER_MANIFEST_HEADER_SIZE] ^= 0x01;
+    LONGS_EQUAL(FW_VERIFIER_ERROR_SIGNATURE,
+                verifier.start(manifest, sizeof(manifest), sig, sig_len, &pk));
+    manifest[FW_VERIFIER_MANIFEST_HEADER_SIZE] ^= 0x01;
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.write_chunk(0, image, TEST_CHUNK_SIZE));
+
+    // A signed but truncated manifest is still rejected
+    sig_len = sign(manifest, sizeof(manifest) - 1, sig);
+    LONGS_EQUAL(FW_VERIFIER_ERROR_MANIFEST,
+                verifier.start(manifest, sizeof(manifest) - 1, sig, sig_len, &pk));
+
+    // So is a signed manifest with a chunk size that is not a multiple of
+    // the program size
+    put_be32(manifest + 12, TEST_CHUNK_SIZE + 1);
+    sig_len = sign(manifest, sizeof(manifest), sig);
+    LONGS_EQUAL(FW_VERIFIER_ERROR_MANIFEST,
+                verifier.start(manifest, sizeof(manifest), sig, sig_len, &pk));
+    put_be32(manifest + 12, TEST_CHUNK_SIZE);
+
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER,
+                verifier.start(manifest, FW_VERIFIER_MANIFEST_HEADER_SIZE - 1, sig, sig_len, &pk));
+
+    LONGS_EQUAL(0, bd.deinit());
+}
+
+void Test_FirmwareVerifier::test_FirmwareVerifier_chunked_count_overflow()
+{
+    HeapBlockDevice bd(TEST_BLOCK_DEVICE_SIZE, 1, 1, TEST_BLOCK_SIZE);
+    unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];
+    uint8_t short_manifest[FW_VERIFIER_MANIFEST_HEADER_SIZE + FW_VERIFIER_CHUNK_HASH_SIZE];
+
+    LONGS_EQUAL(0, bd.init());
+
+    // 0x08000001 one byte chunks, whose hashes take 32 bytes once the
+    // size wraps at 32 bits, just what the manifest holds
+    memcpy(short_manifest, manifest, sizeof(short_manifest));
+    put_be32(short_manifest + 8, 0x08000001);
+    put_be32(short_manifest + 12, 1);
+    size_t sig_len = sign(short_manifest, sizeof(short_manifest), sig);
+
+    FirmwareVerifier verifier(&bd, TEST_IMAGE_ADDR);
+    LONGS_EQUAL(FW_VERIFIER_ERROR_MANIFEST,
+                verifier.start(short_manifest, sizeof(short_manifest), sig, sig_len, &pk));
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, verifier.write_chunk(0, image, 1));
+
+    LONGS_EQUAL(0, bd.deinit());
+}
+
+void Test_FirmwareVerifier::test_FirmwareVerifier_unaligned_region()
+{
+    HeapBlockDevice bd(TEST_BLOCK_DEVICE_SIZE, 1, 16, TEST_BLOCK_SIZE);
+    unsigned char sig[MBEDTLS_ECDSA_MAX_LEN];
+    size_t sig_len = sign(image, sizeof(image), sig);
+
+    LONGS_EQUAL(0, bd.init());
+
+    // The region of the image must start on an erase unit
+    FirmwareVerifier misplaced(&bd, TEST_IMAGE_ADDR + 16);
+    LONGS_EQUAL(FW_VERIFIER_ERROR_PARAMETER, misplaced.start(TEST_IMAGE_SIZE));
+
+    // Program units smaller than erase units
+    FirmwareVerifier verifier(&bd, TEST_IMAGE_ADDR);
+    LONGS_EQUAL(0, verifier.start(TEST_IMAGE_SIZE));
+    LONGS_EQUAL(0, verifier.write(image, 7));
+    LONGS_EQUAL(0, verifier.write(image + 7, sizeof(image) - 7));
+    LONGS_EQUAL(0, verifier.finish(sig, sig_len, &pk));
+    check_image(&bd);
+
+    LONGS_EQUAL(0, bd.deinit());
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TEST_FIRMWAREVERIFIER_H
+#define TEST_FIRMWAREVERIFIER_H
+
+class Test_FirmwareVerifier
+{
+public:
+    Test_FirmwareVerifier();
+
+    virtual ~Test_FirmwareVerifier();
+
+    void test_FirmwareVerifier_sequential();
+
+    void test_FirmwareVerifier_sequential_corrupt();
+
+    void test_FirmwareVerifier_sequential_out_of_order();
+
+    void test_FirmwareVerifier_chunked();
+
+    void test_FirmwareVerifier_chunked_bad_manifest();
+
+    void test_FirmwareVerifier_chunked_count_overflow();
+
+    void test_FirmwareVerifier_unaligned_region();
+};
+
+#endif // TEST_FIRMWAREVERIFIER_H
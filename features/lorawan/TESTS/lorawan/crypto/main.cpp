@@ -0,0 +1,284 @@
+/*
+* Copyright (c) 2018 ARM Limited. All rights reserved.
+* SPDX-License-Identifier: Apache-2.0
+* Licensed under the Apache License, Version 2.0 (the License); you may
+* not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an AS IS BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "mbed.h"
+#include "greentea-client/test_env.h"
+#include "unity/unity.h"
+#include "utest/utest.h"
+
+#include "mbedtls/aes.h"
+#include "mbedtls/cmac.h"
+#include "lorastack/mac/LoRaMacCrypto.h"
+
+#if !defined(MBEDTLS_CMAC_C) || !defined(MBEDTLS_AES_C) || !defined(MBEDTLS_CIPHER_C)
+#error [NOT_SUPPORTED] LoRaWAN crypto needs AES, CMAC and CIPHER from mbedTLS
+#endif
+
+using namespace utest::v1;
+
+static const size_t frame_iterations = 200;
+
+static const uint8_t nwk_skey[16] = {
+    0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6,
+    0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C
+};
+
+static const uint8_t app_skey[16] = {
+    0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+    0x88, 0x99, 0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF
+};
+
+static const uint32_t dev_addr = 0x26011BDA;
+
+/**
+ * Straightforward per-frame implementation, setting up the cipher from
+ * scratch every time, used as a reference and as the benchmark baseline.
+ */
+static int reference_mic(const uint8_t *buffer, uint16_t size,
+                         const uint8_t *key, uint32_t address, uint8_t dir,
+                         uint32_t seq_counter, uint32_t *mic)
+{
+    uint8_t b0[16] = { 0x49 };
+    uint8_t out[16];
+    mbedtls_cipher_context_t ctx;
+
+    b0[5] = dir;
+    b0[6] = address & 0xFF;
+    b0[7] = (address >> 8) & 0xFF;
+    b0[8] = (address >> 16) & 0xFF;
+    b0[9] = (address >> 24) & 0xFF;
+    b0[10] = seq_counter & 0xFF;
+    b0[11] = (seq_counter >> 8) & 0xFF;
+    b0[12] = (seq_counter >> 16) & 0xFF;
+    b0[13] = (seq_counter >> 24) & 0xFF;
+    b0[15] = size & 0xFF;
+
+    mbedtls_cipher_init(&ctx);
+    int ret = mbedtls_cipher_setup(&ctx,
+                                   mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_128_ECB));
+    if (0 == ret) {
+        ret = mbedtls_cipher_cmac_starts(&ctx, key, 128);
+    }
+    if (0 == ret) {
+        ret = mbedtls_cipher_cmac_update(&ctx, b0, sizeof(b0));
+    }
+    if (0 == ret) {
+        ret = mbedtls_cipher_cmac_update(&ctx, buffer, size);
+    }
+    if (0 == ret) {
+        ret = mbedtls_cipher_cmac_finish(&ctx, out);
+    }
+    mbedtls_cipher_free(&ctx);
+
+    *mic = (uint32_t) out[3] << 24 | (uint32_t) out[2] << 16
+            | (uint32_t) out[1] << 8 | (uint32_t) out[0];
+    return ret;
+}
+
+static int reference_encrypt(const uint8_t *buffer, uint16_t size,
+                             const uint8_t *key, uint32_t address, uint8_t dir,
+                             uint32_t seq_counter, uint8_t *enc_buffer)
+{
+    uint8_t a[16] = { 0x01 };
+    uint8_t s[16];
+    mbedtls_aes_context ctx;
+
+    a[5] = dir;
+    a[6] = address & 0xFF;
+    a[7] = (address >> 8) & 0xFF;
+    a[8] = (address >> 16) & 0xFF;
+    a[9] = (address >> 24) & 0xFF;
+    a[10] = seq_counter & 0xFF;
+    a[11] = (seq_counter >> 8) & 0xFF;
+    a[12] = (seq_counter >> 16) & 0xFF;
+    a[13] = (seq_counter >> 24) & 0xFF;
+
+    mbedtls_aes_init(&ctx);
+    int ret = mbedtls_aes_setkey_enc(&ctx, key, 128);
+    for (uint16_t i = 0; ret == 0 && i < size; i += 16) {
+        a[15] = (i / 16) + 1;
+        ret = mbedtls_aes_crypt_ecb(&ctx, MBEDTLS_AES_ENCRYPT, a, s);
+        for (uint16_t j = 0; j < 16 && i + j < size; j++) {
+            enc_buffer[i + j] = buffer[i + j] ^ s[j];
+        }
+    }
+    mbedtls_aes_free(&ctx);
+
+    return ret;
+}
+
+static void fill(uint8_t *buffer, size_t size, uint8_t seed)
+{
+    for (size_t i = 0; i < size; i++) {
+        buffer[i] = seed + i * 7;
+    }
+}
+
+static void test_cmac_vectors()
+{
+    // RFC 4493, section 4
+    static const uint8_t message[64] = {
+        0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+        0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+        0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+        0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+        0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11,
+        0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+        0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17,
+        0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+    };
+    static const uint16_t sizes[] = { 0, 16, 40, 64 };
+    static const uint32_t expected[] = {
+        0x29691dbb, 0xb4160a07, 0x4767a6df, 0xbfbef051
+    };
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        uint32_t mic = 0;
+        TEST_ASSERT_EQUAL(0, compute_join_frame_mic(message, sizes[i], nwk_skey, &mic));
+        TEST_ASSERT_EQUAL_UINT32(expected[i], mic);
+    }
+}
+
+static void test_frame_crypto_matches_reference()
+{
+    uint8_t payload[242];
+    uint8_t expected[242];
+    uint8_t actual[242];
+
+    for (uint16_t size = 1; size <= sizeof(payload); size += 13) {
+        fill(payload, size, size);
+
+        // alternate keys so that the schedule cache is exercised
+        const uint8_t *key = (size & 1) ? app_skey : nwk_skey;
+
+        TEST_ASSERT_EQUAL(0, reference_encrypt(payload, size, key, dev_addr, 0, size, expected));
+        TEST_ASSERT_EQUAL(0, encrypt_payload(payload, size, key, dev_addr, 0, size, actual));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, actual, size);
+
+        TEST_ASSERT_EQUAL(0, decrypt_payload(actual, size, key, dev_addr, 0, size, actual));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(payload, actual, size);
+
+        uint32_t expected_mic = 0;
+        uint32_t mic = 0;
+        TEST_ASSERT_EQUAL(0, reference_mic(payload, size, key, dev_addr, 1, size, &expected_mic));
+        TEST_ASSERT_EQUAL(0, compute_mic(payload, size, key, dev_addr, 1, size, &mic));
+        TEST_ASSERT_EQUAL_UINT32(expected_mic, mic);
+    }
+}
+
+static void test_single_pass_uplink()
+{
+    uint8_t payload[222];
+    uint8_t expected[255];
+    uint8_t frame[255];
+
+    for (uint16_t header_len = 8; header_len <= 23; header_len += 5) {
+        for (uint16_t size = 1; size <= sizeof(payload); size += 17) {
+            fill(frame, header_len, 0x40);
+            fill(expected, header_len, 0x40);
+            fill(payload, size, header_len + size);
+
+            uint32_t expected_mic = 0;
+            TEST_ASSERT_EQUAL(0, reference_encrypt(payload, size, app_skey, dev_addr, 0,
+                                                   42, expected + header_len));
+            TEST_ASSERT_EQUAL(0, reference_mic(expected, header_len + size, nwk_skey,
+                                               dev_addr, 0, 42, &expected_mic));
+
+            uint32_t mic = 0;
+            TEST_ASSERT_EQUAL(0, encrypt_payload_and_compute_mic(payload, size, app_skey,
+                                                                 nwk_skey, dev_addr, 0, 42,
+                                                                 frame, header_len, &mic));
+            TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, frame, header_len + size);
+            TEST_ASSERT_EQUAL_UINT32(expected_mic, mic);
+        }
+    }
+}
+
+static void test_key_change_refreshes_schedule()
+{
+    uint8_t key[16];
+    uint8_t payload[32];
+    uint32_t expected_mic = 0;
+    uint32_t mic = 0;
+
+    memcpy(key, nwk_skey, sizeof(key));
+    fill(payload, sizeof(payload), 3);
+    TEST_ASSERT_EQUAL(0, compute_mic(payload, sizeof(payload), key, dev_addr, 0, 1, &mic));
+
+    // same buffer, new content: a rejoin overwrites the session keys in place
+    key[0] ^= 0xFF;
+    TEST_ASSERT_EQUAL(0, reference_mic(payload, sizeof(payload), key, dev_addr, 0, 1, &expected_mic));
+    TEST_ASSERT_EQUAL(0, compute_mic(payload, sizeof(payload), key, dev_addr, 0, 1, &mic));
+    TEST_ASSERT_EQUAL_UINT32(expected_mic, mic);
+
+    flush_key_schedules();
+    TEST_ASSERT_EQUAL(0, compute_mic(payload, sizeof(payload), key, dev_addr, 0, 1, &mic));
+    TEST_ASSERT_EQUAL_UINT32(expected_mic, mic);
+}
+
+static void test_frame_crypto_benchmark()
+{
+    uint8_t payload[51];
+    uint8_t frame[64];
+    uint32_t mic;
+    Timer timer;
+
+    fill(payload, sizeof(payload), 9);
+    fill(frame, 13, 1);
+
+    timer.start();
+    for (size_t i = 0; i < frame_iterations; i++) {
+        reference_encrypt(payload, sizeof(payload), app_skey, dev_addr, 0, i, frame + 13);
+        reference_mic(frame, 13 + sizeof(payload), nwk_skey, dev_addr, 0, i, &mic);
+    }
+    timer.stop();
+    const int reference_us = timer.read_us();
+
+    timer.reset();
+    timer.start();
+    for (size_t i = 0; i < frame_iterations; i++) {
+        encrypt_payload_and_compute_mic(payload, sizeof(payload), app_skey, nwk_skey,
+                                        dev_addr, 0, i, frame, 13, &mic);
+    }
+    timer.stop();
+    const int cached_us = timer.read_us();
+
+    printf("51 byte uplink: %d us per frame with key setup, %d us per frame cached\r\n",
+           reference_us / (int) frame_iterations, cached_us / (int) frame_iterations);
+
+    TEST_ASSERT_TRUE(cached_us <= reference_us);
+}
+
+utest::v1::status_t test_setup(const size_t number_of_cases)
+{
+    GREENTEA_SETUP(60, "default_auto");
+    return verbose_test_setup_handler(number_of_cases);
+}
+
+Case cases[] = {
+    Case("LoRaMacCrypto - CMAC test vectors", test_cmac_vectors),
+    Case("LoRaMacCrypto - frame crypto matches reference", test_frame_crypto_matches_reference),
+    Case("LoRaMacCrypto - single pass uplink", test_single_pass_uplink),
+    Case("LoRaMacCrypto - key change refreshes schedule", test_key_change_refreshes_schedule),
+    Case("LoRaMacCrypto - per frame cost", test_frame_crypto_benchmark),
+};
+
+Specification specification(test_setup, cases);
+
+int main()
+{
+    return !Harness::run(specification);
+}
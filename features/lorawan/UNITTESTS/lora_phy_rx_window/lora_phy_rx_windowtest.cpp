@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_lora_phy_rx_window.h"
+
+TEST_GROUP(LoRaPHYRxWindow)
+{
+    Test_LoRaPHYRxWindow* unit;
+
+    void setup()
+    {
+        unit = new Test_LoRaPHYRxWindow();
+    }
+
+    void teardown()
+    {
+        delete unit;
+    }
+};
+
+TEST(LoRaPHYRxWindow, Create)
+{
+    CHECK(unit != NULL);
+}
+
+TEST(LoRaPHYRxWindow, test_LoRaPHYRxWindow_AS923)
+{
+    unit->test_LoRaPHYRxWindow_AS923();
+}
+
+TEST(LoRaPHYRxWindow, test_LoRaPHYRxWindow_AU915)
+{
+    unit->test_LoRaPHYRxWindow_AU915();
+}
+
+TEST(LoRaPHYRxWindow, test_LoRaPHYRxWindow_CN470)
+{
+    unit->test_LoRaPHYRxWindow_CN470();
+}
+
+TEST(LoRaPHYRxWindow, test_LoRaPHYRxWindow_CN779)
+{
+    unit->test_LoRaPHYRxWindow_CN779();
+}
+
+TEST(LoRaPHYRxWindow, test_LoRaPHYRxWindow_EU433)
+{
+    unit->test_LoRaPHYRxWindow_EU433();
+}
+
+TEST(LoRaPHYRxWindow, test_LoRaPHYRxWindow_EU868)
+{
+    unit->test_LoRaPHYRxWindow_EU868();
+}
+
+TEST(LoRaPHYRxWindow, test_LoRaPHYRxWindow_IN865)
+{
+    unit->test_LoRaPHYRxWindow_IN865();
+}
+
+TEST(LoRaPHYRxWindow, test_LoRaPHYRxWindow_KR920)
+{
+    unit->test_LoRaPHYRxWindow_KR920();
+}
+
+TEST(LoRaPHYRxWindow, test_LoRaPHYRxWindow_US915)
+{
+    unit->test_LoRaPHYRxWindow_US915();
+}
+
+TEST(LoRaPHYRxWindow, test_LoRaPHYRxWindow_US915Hybrid)
+{
+    unit->test_LoRaPHYRxWindow_US915Hybrid();
+}
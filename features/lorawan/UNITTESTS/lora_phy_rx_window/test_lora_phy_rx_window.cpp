@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_lora_phy_rx_window.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "lorawan/system/LoRaWANTimer.h"
+#include "lorawan/lorastack/phy/LoRaPHYAS923.h"
+#include "lorawan/lorastack/phy/LoRaPHYAU915.h"
+#include "lorawan/lorastack/phy/LoRaPHYCN470.h"
+#include "lorawan/lorastack/phy/LoRaPHYCN779.h"
+#include "lorawan/lorastack/phy/LoRaPHYEU433.h"
+#include "lorawan/lorastack/phy/LoRaPHYEU868.h"
+#include "lorawan/lorastack/phy/LoRaPHYIN865.h"
+#include "lorawan/lorastack/phy/LoRaPHYKR920.h"
+#include "lorawan/lorastack/phy/LoRaPHYUS915.h"
+#include "lorawan/lorastack/phy/LoRaPHYUS915Hybrid.h"
+
+static const uint8_t min_rx_symbols[] = { 4, 5, 6, 8, 12, 20 };
+static const uint32_t rx_errors[] = { 0, 1, 5, 10, 20, 50, 100, 1000 };
+
+/**
+ * Exposes the PHY parameters of a region so that the RX window timing can
+ * be recomputed with floating point math, the way it was originally done.
+ */
+template<typename PHY>
+class TestPHY : public PHY {
+public:
+    TestPHY(LoRaWANTimeHandler &lora_time) : PHY(lora_time) { }
+
+    uint8_t max_rx_datarate() const
+    {
+        return this->phy_params.max_rx_datarate;
+    }
+
+    bool is_rfu_datarate(int8_t datarate) const
+    {
+        return ((uint8_t *) this->phy_params.datarates.table)[datarate] == 0;
+    }
+
+    void reference_rx_win_params(int8_t datarate, uint8_t min_rx_symb,
+                                 uint32_t rx_error, uint32_t *window_timeout,
+                                 int32_t *window_offset)
+    {
+        const uint8_t dr = MIN(datarate, this->phy_params.max_rx_datarate);
+        const uint8_t phy_dr = ((uint8_t *) this->phy_params.datarates.table)[dr];
+        double t_symb;
+
+        if (this->phy_params.fsk_supported && dr == this->phy_params.max_rx_datarate) {
+            t_symb = (8.0 / (double) phy_dr);
+        } else {
+            const uint32_t bandwidth = ((uint32_t *) this->phy_params.bandwidths.table)[dr];
+            t_symb = ((double)(1 << phy_dr) / (double) bandwidth) * 1000;
+        }
+
+        *window_timeout = MAX((uint32_t) ceil(((2 * min_rx_symb - 8) * t_symb + 2 * rx_error) / t_symb), min_rx_symb);
+        *window_offset = (int32_t) ceil((4.0 * t_symb) - ((*window_timeout * t_symb) / 2.0) - RADIO_WAKEUP_TIME);
+    }
+};
+
+template<typename PHY>
+static void rx_window_matches_double_math()
+{
+    LoRaWANTimeHandler lora_time;
+    TestPHY<PHY> phy(lora_time);
+
+    for (int8_t dr = 0; dr <= phy.max_rx_datarate(); dr++) {
+        if (phy.is_rfu_datarate(dr)) {
+            continue;
+        }
+
+        for (size_t i = 0; i < sizeof(min_rx_symbols); i++) {
+            for (size_t j = 0; j < sizeof(rx_errors) / sizeof(rx_errors[0]); j++) {
+                rx_config_params_t params;
+                uint32_t expected_timeout;
+                int32_t expected_offset;
+
+                memset(&params, 0, sizeof(params));
+                phy.compute_rx_win_params(dr, min_rx_symbols[i], rx_errors[j], &params);
+                phy.reference_rx_win_params(dr, min_rx_symbols[i], rx_errors[j],
+                                            &expected_timeout, &expected_offset);
+
+                UNSIGNED_LONGS_EQUAL(expected_timeout, params.window_timeout);
+                LONGS_EQUAL(expected_offset, params.window_offset);
+            }
+        }
+    }
+}
+
+Test_LoRaPHYRxWindow::Test_LoRaPHYRxWindow()
+{
+}
+
+Test_LoRaPHYRxWindow::~Test_LoRaPHYRxWindow()
+{
+}
+
+void Test_LoRaPHYRxWindow::test_LoRaPHYRxWindow_AS923()
+{
+    rx_window_matches_double_math<LoRaPHYAS923>();
+}
+
+void Test_LoRaPHYRxWindow::test_LoRaPHYRxWindow_AU915()
+{
+    rx_window_matches_double_math<LoRaPHYAU915>();
+}
+
+void Test_LoRaPHYRxWindow::test_LoRaPHYRxWindow_CN470()
+{
+    rx_window_matches_double_math<LoRaPHYCN470>();
+}
+
+void Test_LoRaPHYRxWindow::test_LoRaPHYRxWindow_CN779()
+{
+    rx_window_matches_double_math<LoRaPHYCN779>();
+}
+
+void Test_LoRaPHYRxWindow::test_LoRaPHYRxWindow_EU433()
+{
+    rx_window_matches_double_math<LoRaPHYEU433>();
+}
+
+void Test_LoRaPHYRxWindow::test_LoRaPHYRxWindow_EU868()
+{
+    rx_window_matches_double_math<LoRaPHYEU868>();
+}
+
+void Test_LoRaPHYRxWindow::test_LoRaPHYRxWindow_IN865()
+{
+    rx_window_matches_double_math<LoRaPHYIN865>();
+}
+
+void Test_LoRaPHYRxWindow::test_LoRaPHYRxWindow_KR920()
+{
+    rx_window_matches_double_math<LoRaPHYKR920>();
+}
+
+void Test_LoRaPHYRxWindow::test_LoRaPHYRxWindow_US915()
+{
+    rx_window_matches_double_math<LoRaPHYUS915>();
+}
+
+void Test_LoRaPHYRxWindow::test_LoRaPHYRxWindow_US915Hybrid()
+{
+    rx_window_matches_double_math<LoRaPHYUS915Hybrid>();
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TEST_LORA_PHY_RX_WINDOW_H
+#define TEST_LORA_PHY_RX_WINDOW_H
+
+class Test_LoRaPHYRxWindow
+{
+public:
+    Test_LoRaPHYRxWindow();
+
+    virtual ~Test_LoRaPHYRxWindow();
+
+    void test_LoRaPHYRxWindow_AS923();
+
+    void test_LoRaPHYRxWindow_AU915();
+
+    void test_LoRaPHYRxWindow_CN470();
+
+    void test_LoRaPHYRxWindow_CN779();
+
+    void test_LoRaPHYRxWindow_EU433();
+
+    void test_LoRaPHYRxWindow_EU868();
+
+    void test_LoRaPHYRxWindow_IN865();
+
+    void test_LoRaPHYRxWindow_KR920();
+
+    void test_LoRaPHYRxWindow_US915();
+
+    void test_LoRaPHYRxWindow_US915Hybrid();
+};
+
+#endif // TEST_LORA_PHY_RX_WINDOW_H
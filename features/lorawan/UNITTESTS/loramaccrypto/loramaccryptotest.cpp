@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_loramaccrypto.h"
+
+TEST_GROUP(LoRaMacCrypto)
+{
+    Test_LoRaMacCrypto* unit;
+
+    void setup()
+    {
+        unit = new Test_LoRaMacCrypto();
+    }
+
+    void teardown()
+    {
+        delete unit;
+    }
+};
+
+TEST(LoRaMacCrypto, Create)
+{
+    CHECK(unit != NULL);
+}
+
+TEST(LoRaMacCrypto, test_LoRaMacCrypto_cmac_vectors)
+{
+    unit->test_LoRaMacCrypto_cmac_vectors();
+}
+
+TEST(LoRaMacCrypto, test_LoRaMacCrypto_frame_crypto_matches_reference)
+{
+    unit->test_LoRaMacCrypto_frame_crypto_matches_reference();
+}
+
+TEST(LoRaMacCrypto, test_LoRaMacCrypto_single_pass_uplink)
+{
+    unit->test_LoRaMacCrypto_single_pass_uplink();
+}
+
+TEST(LoRaMacCrypto, test_LoRaMacCrypto_key_change_refreshes_schedule)
+{
+    unit->test_LoRaMacCrypto_key_change_refreshes_schedule();
+}
+
+TEST(LoRaMacCrypto, test_LoRaMacCrypto_frame_crypto_benchmark)
+{
+    unit->test_LoRaMacCrypto_frame_crypto_benchmark();
+}
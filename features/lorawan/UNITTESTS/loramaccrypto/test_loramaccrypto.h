@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TEST_LORAMACCRYPTO_H
+#define TEST_LORAMACCRYPTO_H
+
+class Test_LoRaMacCrypto
+{
+public:
+    Test_LoRaMacCrypto();
+
+    virtual ~Test_LoRaMacCrypto();
+
+    void test_LoRaMacCrypto_cmac_vectors();
+
+    void test_LoRaMacCrypto_frame_crypto_matches_reference();
+
+    void test_LoRaMacCrypto_single_pass_uplink();
+
+    void test_LoRaMacCrypto_key_change_refreshes_schedule();
+
+    void test_LoRaMacCrypto_frame_crypto_benchmark();
+};
+
+#endif // TEST_LORAMACCRYPTO_H
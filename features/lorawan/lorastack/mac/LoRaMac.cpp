@@ -1440,35 +1440,38 @@ lorawan_status_t LoRaMac::prepare_frame(loramac_mhdr_t *machdr,
             if ((payload != NULL) && (_params.payload_length > 0)) {
                 _params.buffer[pkt_header_len++] = frame_port;
 
+                const uint8_t *enc_key = _params.keys.app_skey;
                 if (frame_port == 0) {
                     // Reset buffer index as the mac commands are being sent on port 0
                     mac_commands.clear_command_buffer();
-                    if (0 != encrypt_payload((uint8_t*) payload, _params.payload_length,
-                                                   _params.keys.nwk_skey, _params.dev_addr,
-                                                   UP_LINK,
-                                                   _params.ul_frame_counter,
-                                                   &_params.buffer[pkt_header_len])) {
-                        status = LORAWAN_STATUS_CRYPTO_FAIL;
-                    }
-                } else {
-                    if (0 != encrypt_payload((uint8_t*) payload, _params.payload_length,
-                                                   _params.keys.app_skey, _params.dev_addr,
-                                                   UP_LINK,
-                                                   _params.ul_frame_counter,
-                                                   &_params.buffer[pkt_header_len])) {
-                        status = LORAWAN_STATUS_CRYPTO_FAIL;
-                    }
+                    enc_key = _params.keys.nwk_skey;
                 }
-            }
 
-            _params.buffer_pkt_len = pkt_header_len + _params.payload_length;
+                // Payload encryption and MIC computation share a single pass
+                // over the frame
+                if (0 != encrypt_payload_and_compute_mic((uint8_t*) payload,
+                                                         _params.payload_length,
+                                                         enc_key,
+                                                         _params.keys.nwk_skey,
+                                                         _params.dev_addr,
+                                                         UP_LINK,
+                                                         _params.ul_frame_counter,
+                                                         _params.buffer,
+                                                         pkt_header_len, &mic)) {
+                    status = LORAWAN_STATUS_CRYPTO_FAIL;
+                }
 
-            if (0 != compute_mic(_params.buffer, _params.buffer_pkt_len,
-                                       _params.keys.nwk_skey,
-                                       _params.dev_addr,
-                                       UP_LINK,
-                                       _params.ul_frame_counter, &mic)) {
-                status = LORAWAN_STATUS_CRYPTO_FAIL;
+                _params.buffer_pkt_len = pkt_header_len + _params.payload_length;
+            } else {
+                _params.buffer_pkt_len = pkt_header_len + _params.payload_length;
+
+                if (0 != compute_mic(_params.buffer, _params.buffer_pkt_len,
+                                     _params.keys.nwk_skey,
+                                     _params.dev_addr,
+                                     UP_LINK,
+                                     _params.ul_frame_counter, &mic)) {
+                    status = LORAWAN_STATUS_CRYPTO_FAIL;
+                }
             }
 
             _params.buffer[_params.buffer_pkt_len + 0] = mic & 0xFF;
@@ -1678,6 +1681,9 @@ void LoRaMac::disconnect()
     mac_commands.clear_repeat_buffer();
     mac_commands.clear_mac_commands_in_next_tx();
 
+    // Drop expanded session keys
+    flush_key_schedules();
+
     // Set internal state to idle.
     _params.mac_state = LORAMAC_IDLE;
 }
@@ -25,11 +25,13 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include "lorastack/mac/LoRaMacCrypto.h"
 #include "lorawan/system/lorawan_data_structures.h"
 
 #include "mbedtls/aes.h"
 #include "mbedtls/cmac.h"
+#include "platform/mbed_assert.h"
 
 #if defined(MBEDTLS_CMAC_C) && defined(MBEDTLS_AES_C) && defined(MBEDTLS_CIPHER_C)
 
@@ -38,224 +40,390 @@
  */
 #define LORAMAC_MIC_BLOCK_B0_SIZE                   16
 
+#define AES_CMAC_KEY_LENGTH     16
+
 /**
- * MIC field computation initial data
+ * Number of expanded keys kept around. Two slots hold the unicast session
+ * keys, the third one is shared by the application key during join and
+ * multicast session keys.
  */
-static uint8_t mic_block_b0[] = {0x49, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                                0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+#ifdef MBED_CONF_LORA_CRYPTO_KEY_CACHE_SIZE
+#define LORAMAC_CRYPTO_KEY_CACHE_SIZE   MBED_CONF_LORA_CRYPTO_KEY_CACHE_SIZE
+#else
+#define LORAMAC_CRYPTO_KEY_CACHE_SIZE   3
+#endif
+
+// encrypt_payload_and_compute_mic() expands the encryption key while the
+// CMAC still uses the schedule of the MIC key, they need a slot each.
+MBED_STATIC_ASSERT(LORAMAC_CRYPTO_KEY_CACHE_SIZE >= 2,
+                   "lora.crypto-key-cache-size must be at least 2");
 
 /**
- * Contains the computed MIC field.
- *
- * \remark Only the 4 first bytes are used
+ * Expanded AES-128 key schedule and the matching CMAC subkeys
+ * (RFC 4493, section 2.3).
  */
-static uint8_t computed_mic[16];
+typedef struct {
+    uint8_t key[AES_CMAC_KEY_LENGTH];
+    uint8_t k1[16];
+    uint8_t k2[16];
+    mbedtls_aes_context aes;
+    uint32_t last_use;
+    bool valid;
+} key_schedule_t;
 
 /**
- * Encryption aBlock and sBlock
+ * Running CMAC computation
  */
-static uint8_t a_block[] = {0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-
-static uint8_t s_block[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-                            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+typedef struct {
+    const key_schedule_t *ks;
+    uint8_t x[16];
+    uint8_t block[16];
+    uint8_t len;
+} cmac_state_t;
 
 /**
- * AES computation context variable
+ * Key schedule cache. Session keys only change on join or when set through
+ * the MIB (ABP), so every other frame finds its key already expanded.
  */
-static mbedtls_aes_context aes_ctx;
+static key_schedule_t key_cache[LORAMAC_CRYPTO_KEY_CACHE_SIZE];
+static uint32_t key_cache_clock;
+
+static void shift_left_block(const uint8_t *in, uint8_t *out)
+{
+    const uint8_t msb = in[0] & 0x80;
+
+    for (uint8_t i = 0; i < 15; i++) {
+        out[i] = (in[i] << 1) | (in[i + 1] >> 7);
+    }
+    out[15] = in[15] << 1;
+
+    if (msb) {
+        out[15] ^= 0x87;
+    }
+}
 
 /**
- * CMAC computation context variable
+ * Returns the cached schedule for the given key, expanding it into the
+ * least recently used slot if it is not cached yet.
  */
-static mbedtls_cipher_context_t aes_cmac_ctx[1];
+static int get_key_schedule(const uint8_t *key, key_schedule_t **schedule)
+{
+    key_schedule_t *victim = &key_cache[0];
+    int ret;
+
+    for (uint8_t i = 0; i < LORAMAC_CRYPTO_KEY_CACHE_SIZE; i++) {
+        key_schedule_t *ks = &key_cache[i];
+        if (ks->valid && memcmp(ks->key, key, AES_CMAC_KEY_LENGTH) == 0) {
+            ks->last_use = ++key_cache_clock;
+            *schedule = ks;
+            return 0;
+        }
 
-#define AES_CMAC_KEY_LENGTH     16
+        if (victim->valid && (!ks->valid || ks->last_use < victim->last_use)) {
+            victim = ks;
+        }
+    }
 
-int compute_mic(const uint8_t *buffer, uint16_t size, const uint8_t *key,
-                uint32_t address, uint8_t dir, uint32_t seq_counter,
-                uint32_t *mic)
+    if (victim->valid) {
+        mbedtls_aes_free(&victim->aes);
+        victim->valid = false;
+    }
+
+    mbedtls_aes_init(&victim->aes);
+    ret = mbedtls_aes_setkey_enc(&victim->aes, key, AES_CMAC_KEY_LENGTH * 8);
+    if (0 != ret) {
+        goto fail;
+    }
+
+    // Subkey generation: L = AES-128(K, 0^128), K1 = L << 1, K2 = K1 << 1
+    memset(victim->k2, 0, sizeof(victim->k2));
+    ret = mbedtls_aes_crypt_ecb(&victim->aes, MBEDTLS_AES_ENCRYPT, victim->k2,
+                                victim->k2);
+    if (0 != ret) {
+        goto fail;
+    }
+    shift_left_block(victim->k2, victim->k1);
+    shift_left_block(victim->k1, victim->k2);
+
+    memcpy(victim->key, key, AES_CMAC_KEY_LENGTH);
+    victim->last_use = ++key_cache_clock;
+    victim->valid = true;
+    *schedule = victim;
+    return 0;
+
+fail:
+    mbedtls_aes_free(&victim->aes);
+    return ret;
+}
+
+static void cmac_start(cmac_state_t *state, const key_schedule_t *ks)
 {
+    state->ks = ks;
+    state->len = 0;
+    memset(state->x, 0, sizeof(state->x));
+}
 
-    int ret = 0;
+static int cmac_update(cmac_state_t *state, const uint8_t *input, uint16_t size)
+{
+    int ret;
+
+    while (size > 0) {
+        // The last block gets special treatment in cmac_finish(), so a full
+        // block is only chained once more input shows up.
+        if (state->len == 16) {
+            for (uint8_t i = 0; i < 16; i++) {
+                state->x[i] ^= state->block[i];
+            }
+            ret = mbedtls_aes_crypt_ecb((mbedtls_aes_context *) &state->ks->aes,
+                                        MBEDTLS_AES_ENCRYPT, state->x, state->x);
+            if (0 != ret) {
+                return ret;
+            }
+            state->len = 0;
+        }
 
-    mic_block_b0[5] = dir;
+        uint16_t chunk = 16 - state->len;
+        if (chunk > size) {
+            chunk = size;
+        }
+        memcpy(state->block + state->len, input, chunk);
+        state->len += chunk;
+        input += chunk;
+        size -= chunk;
+    }
 
-    mic_block_b0[6] = (address) & 0xFF;
-    mic_block_b0[7] = (address >> 8) & 0xFF;
-    mic_block_b0[8] = (address >> 16) & 0xFF;
-    mic_block_b0[9] = (address >> 24) & 0xFF;
+    return 0;
+}
 
-    mic_block_b0[10] = (seq_counter) & 0xFF;
-    mic_block_b0[11] = (seq_counter >> 8) & 0xFF;
-    mic_block_b0[12] = (seq_counter >> 16) & 0xFF;
-    mic_block_b0[13] = (seq_counter >> 24) & 0xFF;
+static int cmac_finish(cmac_state_t *state, uint32_t *mic)
+{
+    const uint8_t *subkey = state->ks->k1;
+    int ret;
 
-    mic_block_b0[15] = size & 0xFF;
+    if (state->len < 16) {
+        subkey = state->ks->k2;
+        state->block[state->len] = 0x80;
+        memset(state->block + state->len + 1, 0, 15 - state->len);
+    }
+
+    for (uint8_t i = 0; i < 16; i++) {
+        state->x[i] ^= state->block[i] ^ subkey[i];
+    }
+
+    ret = mbedtls_aes_crypt_ecb((mbedtls_aes_context *) &state->ks->aes,
+                                MBEDTLS_AES_ENCRYPT, state->x, state->x);
+    if (0 != ret) {
+        return ret;
+    }
 
-    mbedtls_cipher_init(aes_cmac_ctx);
+    *mic = (uint32_t) ((uint32_t) state->x[3] << 24
+            | (uint32_t) state->x[2] << 16
+            | (uint32_t) state->x[1] << 8 | (uint32_t) state->x[0]);
 
-    const mbedtls_cipher_info_t* cipher_info = mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_128_ECB);
+    return 0;
+}
 
-    if (NULL != cipher_info) {
-        ret = mbedtls_cipher_setup(aes_cmac_ctx, cipher_info);
-        if (0 != ret)
-            goto exit;
+/**
+ * Fills in the address, direction and sequence counter fields shared by
+ * the B0 and A blocks.
+ */
+static void prepare_block(uint8_t *block, uint8_t first, uint32_t address,
+                          uint8_t dir, uint32_t seq_counter)
+{
+    memset(block, 0, 16);
+    block[0] = first;
 
-        ret = mbedtls_cipher_cmac_starts(aes_cmac_ctx, key,
-                                         AES_CMAC_KEY_LENGTH * 8);
-        if (0 != ret)
-            goto exit;
+    block[5] = dir;
 
-        ret = mbedtls_cipher_cmac_update(aes_cmac_ctx, mic_block_b0,
-                                         LORAMAC_MIC_BLOCK_B0_SIZE);
-        if (0 != ret)
-            goto exit;
+    block[6] = (address) & 0xFF;
+    block[7] = (address >> 8) & 0xFF;
+    block[8] = (address >> 16) & 0xFF;
+    block[9] = (address >> 24) & 0xFF;
 
-        ret = mbedtls_cipher_cmac_update(aes_cmac_ctx, buffer, size & 0xFF);
-        if (0 != ret)
-            goto exit;
+    block[10] = (seq_counter) & 0xFF;
+    block[11] = (seq_counter >> 8) & 0xFF;
+    block[12] = (seq_counter >> 16) & 0xFF;
+    block[13] = (seq_counter >> 24) & 0xFF;
+}
 
-        ret = mbedtls_cipher_cmac_finish(aes_cmac_ctx, computed_mic);
-        if (0 != ret)
-            goto exit;
+static int start_frame_mic(cmac_state_t *state, const uint8_t *key,
+                           uint16_t size, uint32_t address, uint8_t dir,
+                           uint32_t seq_counter)
+{
+    key_schedule_t *ks;
+    uint8_t mic_block_b0[LORAMAC_MIC_BLOCK_B0_SIZE];
 
-        *mic = (uint32_t) ((uint32_t) computed_mic[3] << 24
-                | (uint32_t) computed_mic[2] << 16
-                | (uint32_t) computed_mic[1] << 8 | (uint32_t) computed_mic[0]);
-    } else {
-        ret = MBEDTLS_ERR_CIPHER_ALLOC_FAILED;
+    int ret = get_key_schedule(key, &ks);
+    if (0 != ret) {
+        return ret;
     }
 
-exit: mbedtls_cipher_free(aes_cmac_ctx);
-    return ret;
+    prepare_block(mic_block_b0, 0x49, address, dir, seq_counter);
+    mic_block_b0[15] = size & 0xFF;
+
+    cmac_start(state, ks);
+    return cmac_update(state, mic_block_b0, LORAMAC_MIC_BLOCK_B0_SIZE);
 }
 
-int encrypt_payload(const uint8_t *buffer, uint16_t size, const uint8_t *key,
-                    uint32_t address, uint8_t dir, uint32_t seq_counter,
-                    uint8_t *enc_buffer)
+/**
+ * Runs the payload through the CTR keystream. When a MIC state is given,
+ * every produced (or consumed) ciphertext block is fed into it while it is
+ * still hot, so the frame is only walked once.
+ */
+static int crypt_payload(const uint8_t *buffer, uint16_t size,
+                         const uint8_t *key, uint32_t address, uint8_t dir,
+                         uint32_t seq_counter, uint8_t *out_buffer,
+                         cmac_state_t *mic_state)
 {
-    uint16_t i;
-    uint8_t bufferIndex = 0;
+    key_schedule_t *ks;
+    uint8_t a_block[16];
+    uint8_t s_block[16];
+    uint16_t buffer_index = 0;
     uint16_t ctr = 1;
-    int ret = 0;
-
-    mbedtls_aes_init(&aes_ctx);
-    ret = mbedtls_aes_setkey_enc(&aes_ctx, key, 16 * 8);
-    if (0 != ret)
-        goto exit;
 
-    a_block[5] = dir;
+    int ret = get_key_schedule(key, &ks);
+    if (0 != ret) {
+        return ret;
+    }
 
-    a_block[6] = (address) & 0xFF;
-    a_block[7] = (address >> 8) & 0xFF;
-    a_block[8] = (address >> 16) & 0xFF;
-    a_block[9] = (address >> 24) & 0xFF;
+    prepare_block(a_block, 0x01, address, dir, seq_counter);
 
-    a_block[10] = (seq_counter) & 0xFF;
-    a_block[11] = (seq_counter >> 8) & 0xFF;
-    a_block[12] = (seq_counter >> 16) & 0xFF;
-    a_block[13] = (seq_counter >> 24) & 0xFF;
+    while (size > 0) {
+        const uint8_t chunk = size >= 16 ? 16 : size;
 
-    while (size >= 16) {
         a_block[15] = ((ctr) & 0xFF);
         ctr++;
-        ret = mbedtls_aes_crypt_ecb(&aes_ctx, MBEDTLS_AES_ENCRYPT, a_block,
+        ret = mbedtls_aes_crypt_ecb(&ks->aes, MBEDTLS_AES_ENCRYPT, a_block,
                                     s_block);
-        if (0 != ret)
-            goto exit;
+        if (0 != ret) {
+            return ret;
+        }
+
+        for (uint8_t i = 0; i < chunk; i++) {
+            out_buffer[buffer_index + i] = buffer[buffer_index + i] ^ s_block[i];
+        }
 
-        for (i = 0; i < 16; i++) {
-            enc_buffer[bufferIndex + i] = buffer[bufferIndex + i] ^ s_block[i];
+        if (mic_state) {
+            ret = cmac_update(mic_state, &out_buffer[buffer_index], chunk);
+            if (0 != ret) {
+                return ret;
+            }
         }
-        size -= 16;
-        bufferIndex += 16;
+
+        size -= chunk;
+        buffer_index += chunk;
     }
 
-    if (size > 0) {
-        a_block[15] = ((ctr) & 0xFF);
-        ret = mbedtls_aes_crypt_ecb(&aes_ctx, MBEDTLS_AES_ENCRYPT, a_block,
-                                    s_block);
-        if (0 != ret)
-            goto exit;
+    return 0;
+}
 
-        for (i = 0; i < size; i++) {
-            enc_buffer[bufferIndex + i] = buffer[bufferIndex + i] ^ s_block[i];
-        }
+int compute_mic(const uint8_t *buffer, uint16_t size, const uint8_t *key,
+                uint32_t address, uint8_t dir, uint32_t seq_counter,
+                uint32_t *mic)
+{
+    cmac_state_t state;
+
+    int ret = start_frame_mic(&state, key, size, address, dir, seq_counter);
+    if (0 != ret) {
+        return ret;
     }
 
-exit: mbedtls_aes_free(&aes_ctx);
-    return ret;
+    ret = cmac_update(&state, buffer, size & 0xFF);
+    if (0 != ret) {
+        return ret;
+    }
+
+    return cmac_finish(&state, mic);
+}
+
+int encrypt_payload(const uint8_t *buffer, uint16_t size, const uint8_t *key,
+                    uint32_t address, uint8_t dir, uint32_t seq_counter,
+                    uint8_t *enc_buffer)
+{
+    return crypt_payload(buffer, size, key, address, dir, seq_counter,
+                         enc_buffer, NULL);
 }
 
 int decrypt_payload(const uint8_t *buffer, uint16_t size, const uint8_t *key,
                     uint32_t address, uint8_t dir, uint32_t seq_counter,
                     uint8_t *dec_buffer)
 {
-    return encrypt_payload(buffer, size, key, address, dir, seq_counter,
-                           dec_buffer);
+    return crypt_payload(buffer, size, key, address, dir, seq_counter,
+                         dec_buffer, NULL);
+}
+
+int encrypt_payload_and_compute_mic(const uint8_t *payload, uint16_t size,
+                                    const uint8_t *enc_key,
+                                    const uint8_t *mic_key, uint32_t address,
+                                    uint8_t dir, uint32_t seq_counter,
+                                    uint8_t *frame, uint16_t header_len,
+                                    uint32_t *mic)
+{
+    cmac_state_t state;
+
+    int ret = start_frame_mic(&state, mic_key, header_len + size, address,
+                              dir, seq_counter);
+    if (0 != ret) {
+        return ret;
+    }
+
+    ret = cmac_update(&state, frame, header_len);
+    if (0 != ret) {
+        return ret;
+    }
+
+    ret = crypt_payload(payload, size, enc_key, address, dir, seq_counter,
+                        frame + header_len, &state);
+    if (0 != ret) {
+        return ret;
+    }
+
+    return cmac_finish(&state, mic);
 }
 
 int compute_join_frame_mic(const uint8_t *buffer, uint16_t size,
                            const uint8_t *key, uint32_t *mic)
 {
-    int ret = 0;
-
-    mbedtls_cipher_init(aes_cmac_ctx);
-    const mbedtls_cipher_info_t* cipher_info = mbedtls_cipher_info_from_type(MBEDTLS_CIPHER_AES_128_ECB);
-
-    if (NULL != cipher_info) {
-        ret = mbedtls_cipher_setup(aes_cmac_ctx, cipher_info);
-        if (0 != ret)
-            goto exit;
-
-        ret = mbedtls_cipher_cmac_starts(aes_cmac_ctx, key,
-                                         AES_CMAC_KEY_LENGTH * 8);
-        if (0 != ret)
-            goto exit;
-
-        ret = mbedtls_cipher_cmac_update(aes_cmac_ctx, buffer, size & 0xFF);
-        if (0 != ret)
-            goto exit;
-
-        ret = mbedtls_cipher_cmac_finish(aes_cmac_ctx, computed_mic);
-        if (0 != ret)
-            goto exit;
-
-        *mic = (uint32_t) ((uint32_t) computed_mic[3] << 24
-                | (uint32_t) computed_mic[2] << 16
-                | (uint32_t) computed_mic[1] << 8 | (uint32_t) computed_mic[0]);
-    } else {
-        ret = MBEDTLS_ERR_CIPHER_ALLOC_FAILED;
+    key_schedule_t *ks;
+    cmac_state_t state;
+
+    int ret = get_key_schedule(key, &ks);
+    if (0 != ret) {
+        return ret;
     }
 
-exit: mbedtls_cipher_free(aes_cmac_ctx);
-    return ret;
+    cmac_start(&state, ks);
+
+    ret = cmac_update(&state, buffer, size & 0xFF);
+    if (0 != ret) {
+        return ret;
+    }
+
+    return cmac_finish(&state, mic);
 }
 
 int decrypt_join_frame(const uint8_t *buffer, uint16_t size, const uint8_t *key,
                        uint8_t *dec_buffer)
 {
-    int ret = 0;
+    key_schedule_t *ks;
 
-    mbedtls_aes_init(&aes_ctx);
-
-    ret = mbedtls_aes_setkey_enc(&aes_ctx, key, 16 * 8);
-    if (0 != ret)
-        goto exit;
+    int ret = get_key_schedule(key, &ks);
+    if (0 != ret) {
+        return ret;
+    }
 
-    ret = mbedtls_aes_crypt_ecb(&aes_ctx, MBEDTLS_AES_ENCRYPT, buffer,
+    ret = mbedtls_aes_crypt_ecb(&ks->aes, MBEDTLS_AES_ENCRYPT, buffer,
                                 dec_buffer);
-    if (0 != ret)
-        goto exit;
+    if (0 != ret) {
+        return ret;
+    }
 
     // Check if optional CFList is included
     if (size >= 16) {
-        ret = mbedtls_aes_crypt_ecb(&aes_ctx, MBEDTLS_AES_ENCRYPT, buffer + 16,
+        ret = mbedtls_aes_crypt_ecb(&ks->aes, MBEDTLS_AES_ENCRYPT, buffer + 16,
                                     dec_buffer + 16);
     }
 
-exit: mbedtls_aes_free(&aes_ctx);
     return ret;
 }
 
@@ -263,32 +431,39 @@ int compute_skeys_for_join_frame(const uint8_t *key, const uint8_t *app_nonce,
                                  uint16_t dev_nonce, uint8_t *nwk_skey,
                                  uint8_t *app_skey)
 {
+    key_schedule_t *ks;
     uint8_t nonce[16];
     uint8_t *p_dev_nonce = (uint8_t *) &dev_nonce;
-    int ret = 0;
-
-    mbedtls_aes_init(&aes_ctx);
 
-    ret = mbedtls_aes_setkey_enc(&aes_ctx, key, 16 * 8);
-    if (0 != ret)
-        goto exit;
+    int ret = get_key_schedule(key, &ks);
+    if (0 != ret) {
+        return ret;
+    }
 
     memset(nonce, 0, sizeof(nonce));
     nonce[0] = 0x01;
     memcpy(nonce + 1, app_nonce, 6);
     memcpy(nonce + 7, p_dev_nonce, 2);
-    ret = mbedtls_aes_crypt_ecb(&aes_ctx, MBEDTLS_AES_ENCRYPT, nonce, nwk_skey);
-    if (0 != ret)
-        goto exit;
+    ret = mbedtls_aes_crypt_ecb(&ks->aes, MBEDTLS_AES_ENCRYPT, nonce, nwk_skey);
+    if (0 != ret) {
+        return ret;
+    }
 
     memset(nonce, 0, sizeof(nonce));
     nonce[0] = 0x02;
     memcpy(nonce + 1, app_nonce, 6);
     memcpy(nonce + 7, p_dev_nonce, 2);
-    ret = mbedtls_aes_crypt_ecb(&aes_ctx, MBEDTLS_AES_ENCRYPT, nonce, app_skey);
+    return mbedtls_aes_crypt_ecb(&ks->aes, MBEDTLS_AES_ENCRYPT, nonce, app_skey);
+}
 
-    exit: mbedtls_aes_free(&aes_ctx);
-    return ret;
+void flush_key_schedules(void)
+{
+    for (uint8_t i = 0; i < LORAMAC_CRYPTO_KEY_CACHE_SIZE; i++) {
+        if (key_cache[i].valid) {
+            mbedtls_aes_free(&key_cache[i].aes);
+        }
+    }
+    memset(key_cache, 0, sizeof(key_cache));
 }
 #else
 
@@ -323,6 +498,16 @@ int decrypt_payload(const uint8_t *, uint16_t , const uint8_t *, uint32_t,
     return LORAWAN_STATUS_CRYPTO_FAIL;
 }
 
+int encrypt_payload_and_compute_mic(const uint8_t *, uint16_t, const uint8_t *,
+                                    const uint8_t *, uint32_t, uint8_t,
+                                    uint32_t, uint8_t *, uint16_t, uint32_t *)
+{
+    MBED_ASSERT("[LoRaCrypto] Must enable AES, CMAC & CIPHER from mbedTLS");
+
+    // Never actually reaches here
+    return LORAWAN_STATUS_CRYPTO_FAIL;
+}
+
 int compute_join_frame_mic(const uint8_t *, uint16_t , const uint8_t *, uint32_t *)
 {
     MBED_ASSERT("[LoRaCrypto] Must enable AES, CMAC & CIPHER from mbedTLS");
@@ -348,4 +533,8 @@ int compute_skeys_for_join_frame(const uint8_t *, const uint8_t *, uint16_t ,
     return LORAWAN_STATUS_CRYPTO_FAIL;
 }
 
+void flush_key_schedules(void)
+{
+}
+
 #endif
@@ -77,6 +77,32 @@ int decrypt_payload(const uint8_t *buffer, uint16_t size, const uint8_t *key,
                     uint32_t address, uint8_t dir, uint32_t seq_counter,
                     uint8_t *dec_buffer);
 
+/**
+ * Encrypts the frame payload and computes the frame MIC in a single pass
+ *
+ * The frame header is expected at the start of the frame buffer, the
+ * encrypted payload is written right behind it. The MIC covers both.
+ *
+ * @param [in]  payload         - Plain text payload
+ * @param [in]  size            - Payload size
+ * @param [in]  enc_key         - AES key used for payload encryption
+ * @param [in]  mic_key         - AES key used for the MIC
+ * @param [in]  address         - Frame address
+ * @param [in]  dir             - Frame direction [0: uplink, 1: downlink]
+ * @param [in]  seq_counter     - Frame sequence counter
+ * @param [in,out] frame        - Frame buffer, header in, header + encrypted payload out
+ * @param [in]  header_len      - Length of the header already in the frame buffer
+ * @param [out] mic             - Computed MIC field
+ *
+ * @return                        0 if successful, or a cipher specific error code
+ */
+int encrypt_payload_and_compute_mic(const uint8_t *payload, uint16_t size,
+                                    const uint8_t *enc_key,
+                                    const uint8_t *mic_key, uint32_t address,
+                                    uint8_t dir, uint32_t seq_counter,
+                                    uint8_t *frame, uint16_t header_len,
+                                    uint32_t *mic);
+
 /**
  * Computes the LoRaMAC Join Request frame MIC field
  *
@@ -119,4 +145,13 @@ int compute_skeys_for_join_frame(const uint8_t *key, const uint8_t *app_nonce,
                                  uint16_t dev_nonce, uint8_t *nwk_skey,
                                  uint8_t *app_skey );
 
+/**
+ * Drops all cached AES key schedules and CMAC subkeys
+ *
+ * Expanded keys are cached across frames and are refreshed automatically
+ * when a different key is handed in. This wipes them explicitly, e.g. when
+ * the stack shuts down.
+ */
+void flush_key_schedules(void);
+
 #endif // MBED_LORAWAN_MAC_LORAMAC_CRYPTO_H__
@@ -395,23 +395,42 @@ uint8_t LoRaPHY::verify_link_ADR_req(verify_adr_params_t* verify_params,
     return status;
 }
 
-double LoRaPHY::compute_symb_timeout_lora(uint8_t phy_dr, uint32_t bandwidth)
+uint32_t LoRaPHY::compute_symb_timeout_lora(uint8_t phy_dr, uint32_t bandwidth)
 {
-    return ((double)(1 << phy_dr) / (double) bandwidth) * 1000;
+    // 2^SF / BW, in microseconds. All LoRa bandwidths are whole kHz, which
+    // keeps this exact and within 32 bits up to SF12.
+    if (bandwidth < 1000) {
+        // RFU datarate
+        return 0;
+    }
+
+    return ((1 << phy_dr) * 1000) / (bandwidth / 1000);
 }
 
-double LoRaPHY::compute_symb_timeout_fsk(uint8_t phy_dr)
+uint32_t LoRaPHY::compute_symb_timeout_fsk(uint8_t phy_dr)
 {
-    return (8.0 / (double) phy_dr); // 1 symbol equals 1 byte
+    return (8000 / phy_dr); // 1 symbol equals 1 byte, phy_dr in kbps
 }
 
-void LoRaPHY::get_rx_window_params(double t_symb, uint8_t min_rx_symb,
+void LoRaPHY::get_rx_window_params(uint32_t t_symb, uint8_t min_rx_symb,
                                    uint32_t rx_error, uint32_t wakeup_time,
                                    uint32_t* window_timeout, int32_t* window_offset)
 {
-    // Computed number of symbols
-    *window_timeout = MAX ((uint32_t) ceil(((2 * min_rx_symb - 8) * t_symb + 2 * rx_error) / t_symb), min_rx_symb );
-    *window_offset = (int32_t) ceil((4.0 * t_symb) - ((*window_timeout * t_symb) / 2.0 ) - wakeup_time);
+    if (t_symb == 0) {
+        *window_timeout = min_rx_symb;
+        *window_offset = -(int32_t) wakeup_time;
+        return;
+    }
+
+    // Computed number of symbols, rx_error is in ms while t_symb is in us
+    int32_t timeout = (2 * min_rx_symb - 8)
+            + (int32_t) ((2000 * rx_error + t_symb - 1) / t_symb);
+    *window_timeout = MAX(timeout, (int32_t) min_rx_symb);
+
+    // 4 * t_symb - window_timeout * t_symb / 2, rounded up to ms
+    int32_t offset = (8 - (int32_t) *window_timeout) * (int32_t) t_symb;
+    offset = offset > 0 ? (offset + 1999) / 2000 : offset / 2000;
+    *window_offset = offset - (int32_t) wakeup_time;
 }
 
 int8_t LoRaPHY::compute_tx_power(int8_t tx_power_idx, float max_eirp,
@@ -772,7 +791,7 @@ void LoRaPHY::compute_rx_win_params(int8_t datarate, uint8_t min_rx_symbols,
                                     uint32_t rx_error,
                                     rx_config_params_t *rx_conf_params)
 {
-    double t_symbol = 0.0;
+    uint32_t t_symbol = 0;
 
     // Get the datarate, perform a boundary check
     rx_conf_params->datarate = MIN( datarate, phy_params.max_rx_datarate);
@@ -575,19 +575,21 @@ protected:
                                 int8_t* tx_pow, uint8_t* nb_rep);
 
     /**
-     * Computes the symbol time for LoRa modulation.
+     * Computes the symbol time for LoRa modulation, in microseconds.
      */
-    double compute_symb_timeout_lora(uint8_t phy_dr, uint32_t bandwidth );
+    uint32_t compute_symb_timeout_lora(uint8_t phy_dr, uint32_t bandwidth );
 
     /**
-     * Computes the symbol time for FSK modulation.
+     * Computes the symbol time for FSK modulation, in microseconds.
      */
-    double compute_symb_timeout_fsk(uint8_t phy_dr);
+    uint32_t compute_symb_timeout_fsk(uint8_t phy_dr);
 
     /**
      * Computes the RX window timeout and the RX window offset.
+     *
+     * Integer only, as this runs right before the RX windows open.
      */
-    void get_rx_window_params(double t_symbol, uint8_t min_rx_symbols,
+    void get_rx_window_params(uint32_t t_symbol, uint8_t min_rx_symbols,
                               uint32_t rx_error, uint32_t wakeup_time,
                               uint32_t* window_timeout, int32_t* window_offset);
 
@@ -403,6 +403,38 @@ MBEDTLS_DEPRECATED void mbedtls_aes_decrypt( mbedtls_aes_context *ctx,
 extern "C" {
 #endif
 
+/**
+ * \brief           This function generates consecutive blocks of AES-CTR
+ *                  keystream.
+ *
+ *                  Each block is the encryption of \p nonce_counter, which
+ *                  is then incremented as a 128-bit big-endian integer, as in
+ *                  mbedtls_aes_crypt_ctr(). XORing the keystream with the
+ *                  data encrypts or decrypts it.
+ *
+ *                  Generating the keystream of whole buffers lets GCM and
+ *                  other callers run the block cipher once per buffer
+ *                  instead of once per block. Targets with an AES
+ *                  accelerator can provide their own implementation with
+ *                  \c MBEDTLS_AES_CTR_KEYSTREAM_ALT, also when the rest of
+ *                  the module is replaced with \c MBEDTLS_AES_ALT.
+ *
+ * \note            The context must be set up with mbedtls_aes_setkey_enc().
+ *
+ * \param ctx       The AES context to use.
+ * \param blocks    The number of 16-byte blocks to generate.
+ * \param nonce_counter The 128-bit nonce and counter of the first block.
+ *                  On return, the counter of the block following the last
+ *                  one generated.
+ * \param stream    The buffer for holding \p blocks * 16 Bytes of keystream.
+ *
+ * \return          \c 0 on success, or a hardware specific error code.
+ */
+int mbedtls_aes_ctr_keystream( mbedtls_aes_context *ctx,
+                               size_t blocks,
+                               unsigned char nonce_counter[16],
+                               unsigned char *stream );
+
 /**
  * \brief          Checkup routine.
  *
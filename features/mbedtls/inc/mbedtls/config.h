@@ -363,6 +363,7 @@
 //#define MBEDTLS_AES_SETKEY_DEC_ALT
 //#define MBEDTLS_AES_ENCRYPT_ALT
 //#define MBEDTLS_AES_DECRYPT_ALT
+//#define MBEDTLS_AES_CTR_KEYSTREAM_ALT
 //#define MBEDTLS_ECDH_GEN_PUBLIC_ALT
 //#define MBEDTLS_ECDH_COMPUTE_SHARED_ALT
 //#define MBEDTLS_ECDSA_VERIFY_ALT
@@ -470,6 +471,22 @@
  */
 //#define MBEDTLS_CAMELLIA_SMALL_MEMORY
 
+/**
+ * \def MBEDTLS_GCM_LARGE_TABLE
+ *
+ * Use 8-bit instead of 4-bit precomputed tables for the GHASH multiplication
+ * of GCM. This halves the number of table lookups per block, but adds about
+ * 3.8 KB to every mbedtls_gcm_context (4 KB of tables instead of 256 bytes)
+ * and 512 bytes of ROM.
+ *
+ * Module:  library/gcm.c
+ *
+ * Requires: MBEDTLS_GCM_C
+ *
+ * Uncomment this macro to use the larger tables for GCM.
+ */
+//#define MBEDTLS_GCM_LARGE_TABLE
+
 /**
  * \def MBEDTLS_CIPHER_MODE_CBC
  *
@@ -1030,6 +1047,22 @@
  */
 //#define MBEDTLS_MEMORY_BACKTRACE
 
+/**
+ * \def MBEDTLS_MEMORY_SIZE_CLASSES
+ *
+ * Keep the free blocks of the buffer allocator in lists segregated by size
+ * class instead of a single first-fit list, so that allocating and freeing
+ * take constant time however fragmented the buffer is. Small sizes, such as
+ * the bignums of elliptic curve operations, have a class per 8 bytes.
+ *
+ * This costs about 150 pointers of static RAM for the lists.
+ *
+ * Requires: MBEDTLS_MEMORY_BUFFER_ALLOC_C
+ *
+ * Uncomment this macro to use size classes in the buffer allocator.
+ */
+//#define MBEDTLS_MEMORY_SIZE_CLASSES
+
 /**
  * \def MBEDTLS_PK_RSA_ALT_SUPPORT
  *
@@ -1250,6 +1283,25 @@
  */
 #define MBEDTLS_SSL_MAX_FRAGMENT_LENGTH
 
+/**
+ * \def MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+ *
+ * Resize the I/O buffers of an SSL context once a handshake is over.
+ *
+ * The buffers are allocated with MBEDTLS_SSL_IN_BUFFER_LEN and
+ * MBEDTLS_SSL_OUT_BUFFER_LEN bytes for the handshake, then reduced to the
+ * record sizes that can still occur: the negotiated max_fragment_length on
+ * input and the smallest of MBEDTLS_SSL_OUT_CONTENT_LEN and the
+ * max_fragment_length on output. They are grown back before a
+ * renegotiation or a session reset.
+ *
+ * Resizing copies each buffer into a new allocation, so the heap must
+ * briefly hold both.
+ *
+ * Uncomment this macro to resize the buffers after the handshake
+ */
+//#define MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH
+
 /**
  * \def MBEDTLS_SSL_PROTO_SSL3
  *
@@ -2776,6 +2828,8 @@
 
 /* SSL options */
 //#define MBEDTLS_SSL_MAX_CONTENT_LEN             16384 /**< Maxium fragment length in bytes, determines the size of each of the two internal I/O buffers */
+//#define MBEDTLS_SSL_IN_CONTENT_LEN              16384 /**< Maximum length of incoming plaintext fragments, determines the size of the input buffer (default MBEDTLS_SSL_MAX_CONTENT_LEN). Below 16384, peers must be asked for shorter records with max_fragment_length */
+//#define MBEDTLS_SSL_OUT_CONTENT_LEN             16384 /**< Maximum length of outgoing plaintext fragments, determines the size of the output buffer (default MBEDTLS_SSL_MAX_CONTENT_LEN). Must fit the largest handshake message sent */
 //#define MBEDTLS_SSL_DEFAULT_TICKET_LIFETIME     86400 /**< Lifetime of session tickets (if enabled) */
 //#define MBEDTLS_PSK_MAX_LEN               32 /**< Max size of TLS pre-shared keys, in bytes (default 256 bits) */
 //#define MBEDTLS_SSL_COOKIE_TIMEOUT        60 /**< Default expiration delay of DTLS cookies, in seconds if HAVE_TIME, or in number of cookies issued */
@@ -153,7 +153,7 @@ typedef struct
     int (*t_post)(mbedtls_ecp_point *, void *); /*!< unused                         */
     void *t_data;                       /*!< unused                         */
     mbedtls_ecp_point *T;       /*!<  pre-computed points for ecp_mul_comb()        */
-    size_t T_size;      /*!<  number for pre-computed points                */
+    size_t T_size;      /*!<  number for pre-computed points, 0 if T is constant */
 }
 mbedtls_ecp_group;
 
@@ -216,15 +216,18 @@ mbedtls_ecp_keypair;
 
 #if !defined(MBEDTLS_ECP_FIXED_POINT_OPTIM)
 /*
- * Trade memory for speed on fixed-point multiplication.
+ * Trade ROM for speed on fixed-point multiplication.
  *
- * This speeds up repeated multiplication of the generator (that is, the
+ * This speeds up multiplication of the generator (that is, the
  * multiplication in ECDSA signatures, and half of the multiplications in
  * ECDSA verification and ECDHE) by a factor roughly 3 to 4.
  *
- * The cost is increasing EC peak memory usage by a factor roughly 2.
+ * The points precomputed for the generator of each enabled short Weierstrass
+ * curve are compiled in as constants, so no RAM and no time is spent on
+ * building them. The cost is about 1 KiB of ROM per curve of 256 bits or
+ * less, and 3 to 4.5 KiB per larger curve.
  *
- * Change this value to 0 to reduce peak memory usage.
+ * Change this value to 0 to reduce ROM usage.
  */
 #define MBEDTLS_ECP_FIXED_POINT_OPTIM  1   /**< Enable fixed-point speed-up */
 #endif /* MBEDTLS_ECP_FIXED_POINT_OPTIM */
@@ -44,6 +44,12 @@
 
 #if !defined(MBEDTLS_GCM_ALT)
 
+#if defined(MBEDTLS_GCM_LARGE_TABLE)
+#define MBEDTLS_GCM_HTABLE_SIZE  256     /**< Entries of the 8-bit GHASH tables. */
+#else
+#define MBEDTLS_GCM_HTABLE_SIZE  16      /**< Entries of the 4-bit GHASH tables. */
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -53,8 +59,8 @@ extern "C" {
  */
 typedef struct {
     mbedtls_cipher_context_t cipher_ctx;  /*!< The cipher context used. */
-    uint64_t HL[16];                      /*!< Precalculated HTable low. */
-    uint64_t HH[16];                      /*!< Precalculated HTable high. */
+    uint64_t HL[MBEDTLS_GCM_HTABLE_SIZE]; /*!< Precalculated HTable low. */
+    uint64_t HH[MBEDTLS_GCM_HTABLE_SIZE]; /*!< Precalculated HTable high. */
     uint64_t len;                         /*!< The total length of the encrypted data. */
     uint64_t add_len;                     /*!< The total length of the additional data. */
     unsigned char base_ectr[16];          /*!< The first ECTR for tag. */
@@ -194,6 +200,9 @@ int mbedtls_gcm_starts( mbedtls_gcm_context *ctx,
  *    `             The function expects input to be a multiple of 16
  *                  Bytes. Only the last call before calling
  *                  mbedtls_gcm_finish() can be less than 16 Bytes.
+ *                  With AES, feeding several blocks per call is faster, as
+ *                  their keystream is generated in one go, see
+ *                  mbedtls_aes_ctr_keystream().
  *
  * \note For decryption, the output buffer cannot be the same as input buffer.
  *       If the buffers overlap, the output buffer must trail at least 8 Bytes
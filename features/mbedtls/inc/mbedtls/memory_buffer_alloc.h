@@ -65,7 +65,8 @@ extern "C" {
  *           MBEDTLS_THREADING_C is defined)
  *
  * \note    This code is not optimized and provides a straight-forward
- *          implementation of a stack-based memory allocator.
+ *          implementation of a stack-based memory allocator, unless
+ *          MBEDTLS_MEMORY_SIZE_CLASSES is defined.
  *
  * \param buf   buffer to use as heap
  * \param len   size of the buffer
@@ -91,6 +91,8 @@ typedef struct mbedtls_x509_crt
     void *sig_opts;             /**< Signature options to be passed to mbedtls_pk_verify_ext(), e.g. for RSASSA-PSS */
 
     struct mbedtls_x509_crt *next;     /**< Next certificate in the CA-chain. */
+
+    int own_buffer;                     /**< 1 if raw was copied and is owned by the structure, 0 if it references the buffer given to mbedtls_x509_crt_parse_der_nocopy(). */
 }
 mbedtls_x509_crt;
 
@@ -174,6 +176,35 @@ extern const mbedtls_x509_crt_profile mbedtls_x509_crt_profile_suiteb;
 int mbedtls_x509_crt_parse_der( mbedtls_x509_crt *chain, const unsigned char *buf,
                         size_t buflen );
 
+/**
+ * \brief          Parse a single DER formatted certificate and add it
+ *                 to the chained list, referencing the DER data instead
+ *                 of copying it.
+ *
+ *                 This is meant for certificates kept in read-only memory,
+ *                 such as a CA bundle in flash: the DER is not duplicated
+ *                 in RAM, and the issuer and subject names, the subject
+ *                 alternative names and the extended key usage are only
+ *                 checked, not decoded into lists. Certificate
+ *                 verification and mbedtls_x509_crt_info() read them from
+ *                 the DER when needed.
+ *
+ * \param chain    points to the start of the chain
+ * \param buf      buffer holding the certificate DER data. It must not be
+ *                 modified or freed until the chain is freed.
+ * \param buflen   size of the buffer
+ *
+ * \note           The issuer, subject, subject_alt_names and ext_key_usage
+ *                 fields of a certificate parsed this way are empty.
+ *                 Use issuer_raw, subject_raw and v3_ext instead, or
+ *                 mbedtls_x509_crt_check_extended_key_usage().
+ *
+ * \return         0 if successful, or a specific X509 or PEM error code
+ */
+int mbedtls_x509_crt_parse_der_nocopy( mbedtls_x509_crt *chain,
+                                       const unsigned char *buf,
+                                       size_t buflen );
+
 /**
  * \brief          Parse one or more certificates and add them
  *                 to the chained list. Parses permissively. If some
@@ -1053,6 +1053,34 @@ int mbedtls_aes_crypt_ctr( mbedtls_aes_context *ctx,
 
 #endif /* !MBEDTLS_AES_ALT */
 
+/*
+ * AES-CTR keystream generation
+ */
+#if !defined(MBEDTLS_AES_CTR_KEYSTREAM_ALT)
+int mbedtls_aes_ctr_keystream( mbedtls_aes_context *ctx,
+                               size_t blocks,
+                               unsigned char nonce_counter[16],
+                               unsigned char *stream )
+{
+    int ret, i;
+
+    while( blocks-- > 0 )
+    {
+        if( ( ret = mbedtls_aes_crypt_ecb( ctx, MBEDTLS_AES_ENCRYPT,
+                                           nonce_counter, stream ) ) != 0 )
+            return( ret );
+
+        for( i = 16; i > 0; i-- )
+            if( ++nonce_counter[i - 1] != 0 )
+                break;
+
+        stream += 16;
+    }
+
+    return( 0 );
+}
+#endif /* !MBEDTLS_AES_CTR_KEYSTREAM_ALT */
+
 #if defined(MBEDTLS_SELF_TEST)
 /*
  * AES test vectors from:
@@ -339,7 +339,8 @@ void mbedtls_ecp_group_free( mbedtls_ecp_group *grp )
         mbedtls_mpi_free( &grp->N );
     }
 
-    if( grp->T != NULL )
+    /* T_size == 0 for a table of constants loaded with the group */
+    if( grp->T != NULL && grp->T_size != 0 )
     {
         for( i = 0; i < grp->T_size; i++ )
             mbedtls_ecp_point_free( &grp->T[i] );
@@ -1344,6 +1345,43 @@ cleanup:
     return( ret );
 }
 
+/*
+ * Pick window size based on curve size and whether we optimize for base point
+ */
+static unsigned char ecp_pick_window( const mbedtls_ecp_group *grp,
+                                      unsigned char p_eq_g )
+{
+    unsigned char w;
+
+    /*
+     * Minimize the number of multiplications, that is minimize
+     * 10 * d * w + 18 * 2^(w-1) + 11 * d + 7 * w, with d = ceil( nbits / w )
+     * (see costs of the various parts, with 1S = 1M)
+     */
+    w = grp->nbits >= 384 ? 5 : 4;
+
+    /*
+     * If P == G, pre-compute a bit more, since this may be re-used later.
+     * Just adding one avoids upping the cost of the first mul too much,
+     * and the memory cost too.
+     */
+    if( p_eq_g )
+        w++;
+
+    /*
+     * Make sure w is within bounds, unless a table of constants was made
+     * for this size (see ecp_curves.c).
+     * (The last test is useful only for very small curves in the test suite.)
+     */
+    if( ( ! p_eq_g || grp->T == NULL || grp->T_size != 0 ) &&
+        w > MBEDTLS_ECP_WINDOW_SIZE )
+        w = MBEDTLS_ECP_WINDOW_SIZE;
+    if( w >= grp->nbits )
+        w = 2;
+
+    return( w );
+}
+
 /*
  * Multiplication using the comb method,
  * for curves in short Weierstrass form
@@ -1367,35 +1405,14 @@ static int ecp_mul_comb( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
     if( mbedtls_mpi_get_bit( &grp->N, 0 ) != 1 )
         return( MBEDTLS_ERR_ECP_BAD_INPUT_DATA );
 
-    /*
-     * Minimize the number of multiplications, that is minimize
-     * 10 * d * w + 18 * 2^(w-1) + 11 * d + 7 * w, with d = ceil( nbits / w )
-     * (see costs of the various parts, with 1S = 1M)
-     */
-    w = grp->nbits >= 384 ? 5 : 4;
-
-    /*
-     * If P == G, pre-compute a bit more, since this may be re-used later.
-     * Just adding one avoids upping the cost of the first mul too much,
-     * and the memory cost too.
-     */
 #if MBEDTLS_ECP_FIXED_POINT_OPTIM == 1
     p_eq_g = ( mbedtls_mpi_cmp_mpi( &P->Y, &grp->G.Y ) == 0 &&
                mbedtls_mpi_cmp_mpi( &P->X, &grp->G.X ) == 0 );
-    if( p_eq_g )
-        w++;
 #else
     p_eq_g = 0;
 #endif
 
-    /*
-     * Make sure w is within bounds.
-     * (The last test is useful only for very small curves in the test suite.)
-     */
-    if( w > MBEDTLS_ECP_WINDOW_SIZE )
-        w = MBEDTLS_ECP_WINDOW_SIZE;
-    if( w >= grp->nbits )
-        w = 2;
+    w = ecp_pick_window( grp, p_eq_g );
 
     /* Other sizes that depend on w */
     pre_len = 1U << ( w - 1 );
@@ -1403,7 +1420,7 @@ static int ecp_mul_comb( mbedtls_ecp_group *grp, mbedtls_ecp_point *R,
 
     /*
      * Prepare precomputed points: if P == G we want to
-     * use grp->T if already initialized, or initialize it.
+     * use grp->T if already initialized (possibly from ROM), or initialize it.
      */
     T = p_eq_g ? grp->T : NULL;
 
@@ -2061,6 +2078,80 @@ cleanup:
 
 #if defined(MBEDTLS_SELF_TEST)
 
+#if MBEDTLS_ECP_FIXED_POINT_OPTIM == 1 && defined(ECP_SHORTWEIERSTRASS)
+/*
+ * Check the tables of constants loaded with the groups against the points
+ * computed by ecp_precompute_comb()
+ */
+static int ecp_self_test_comb_tables( int verbose )
+{
+    int ret = 0;
+    const mbedtls_ecp_curve_info *curve_info;
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point *T = NULL;
+    unsigned char w, pre_len, i;
+    size_t d;
+
+    mbedtls_ecp_group_init( &grp );
+
+    for( curve_info = mbedtls_ecp_curve_list();
+         curve_info->grp_id != MBEDTLS_ECP_DP_NONE;
+         curve_info++ )
+    {
+        MBEDTLS_MPI_CHK( mbedtls_ecp_group_load( &grp, curve_info->grp_id ) );
+
+        if( ecp_get_type( &grp ) != ECP_TYPE_SHORT_WEIERSTRASS ||
+            grp.T == NULL || grp.T_size != 0 )
+            continue;
+
+        w = ecp_pick_window( &grp, 1 );
+        pre_len = 1U << ( w - 1 );
+        d = ( grp.nbits + w - 1 ) / w;
+
+        T = mbedtls_calloc( pre_len, sizeof( mbedtls_ecp_point ) );
+        if( T == NULL )
+        {
+            ret = MBEDTLS_ERR_ECP_ALLOC_FAILED;
+            goto cleanup;
+        }
+
+        MBEDTLS_MPI_CHK( ecp_precompute_comb( &grp, T, &grp.G, w, d ) );
+
+        for( i = 0; i < pre_len; i++ )
+        {
+            if( mbedtls_mpi_cmp_mpi( &T[i].X, &grp.T[i].X ) != 0 ||
+                mbedtls_mpi_cmp_mpi( &T[i].Y, &grp.T[i].Y ) != 0 )
+            {
+                if( verbose != 0 )
+                    mbedtls_printf( "failed (%s, %u)\n", curve_info->name,
+                                    (unsigned int) i );
+
+                ret = 1;
+                goto cleanup;
+            }
+        }
+
+        for( i = 0; i < pre_len; i++ )
+            mbedtls_ecp_point_free( &T[i] );
+        mbedtls_free( T );
+        T = NULL;
+    }
+
+cleanup:
+
+    if( T != NULL )
+    {
+        for( i = 0; i < pre_len; i++ )
+            mbedtls_ecp_point_free( &T[i] );
+        mbedtls_free( T );
+    }
+
+    mbedtls_ecp_group_free( &grp );
+
+    return( ret );
+}
+#endif /* MBEDTLS_ECP_FIXED_POINT_OPTIM == 1 && ECP_SHORTWEIERSTRASS */
+
 /*
  * Checkup routine
  */
@@ -2172,6 +2263,16 @@ int mbedtls_ecp_self_test( int verbose )
     if( verbose != 0 )
         mbedtls_printf( "passed\n" );
 
+#if MBEDTLS_ECP_FIXED_POINT_OPTIM == 1 && defined(ECP_SHORTWEIERSTRASS)
+    if( verbose != 0 )
+        mbedtls_printf( "  ECP test #3 (precomputed tables in ROM): " );
+
+    MBEDTLS_MPI_CHK( ecp_self_test_comb_tables( verbose ) );
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+#endif
+
 cleanup:
 
     if( ret < 0 && verbose != 0 )
@@ -34,6 +34,10 @@
 
 #include <string.h>
 
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+#include <stdint.h>
+#endif
+
 #if defined(MBEDTLS_MEMORY_BACKTRACE)
 #include <execinfo.h>
 #endif
@@ -51,6 +55,29 @@ static void mbedtls_zeroize( void *v, size_t n ) {
 #define MAGIC2       0xEE119966
 #define MAX_BT 20
 
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+/*
+ * Free blocks are kept in one list per size class: a class per 8 bytes below
+ * 128 bytes, where the bignums of elliptic curve operations and most
+ * structures fall, then 8 classes per power of two. Blocks of 2^24 bytes and
+ * more share the last class.
+ *
+ * A block in a class above the class of a request is always large enough,
+ * so finding a block takes a walk of the request's class, whose blocks are
+ * less than a class width apart in size, and a search of the bitmap of
+ * non-empty classes.
+ */
+#define CLASS_LINEAR_LIMIT  128
+#define CLASS_LINEAR_SHIFT  3
+#define CLASS_LINEAR_COUNT  ( CLASS_LINEAR_LIMIT >> CLASS_LINEAR_SHIFT )
+#define CLASS_SL_LOG2       3
+#define CLASS_FL_MIN        7   /* log2( CLASS_LINEAR_LIMIT ) */
+#define CLASS_FL_MAX        23
+#define CLASS_COUNT         ( CLASS_LINEAR_COUNT + \
+                              ( ( CLASS_FL_MAX - CLASS_FL_MIN + 1 ) << CLASS_SL_LOG2 ) )
+#define CLASS_WORDS         ( ( CLASS_COUNT + 31 ) / 32 )
+#endif /* MBEDTLS_MEMORY_SIZE_CLASSES */
+
 typedef struct _memory_header memory_header;
 struct _memory_header
 {
@@ -73,7 +100,13 @@ typedef struct
     unsigned char   *buf;
     size_t          len;
     memory_header   *first;
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+    memory_header   *free_lists[CLASS_COUNT];
+    uint32_t        class_map[CLASS_WORDS];
+    uint32_t        word_map;
+#else
     memory_header   *first_free;
+#endif
     int             verify;
 #if defined(MBEDTLS_MEMORY_DEBUG)
     size_t          alloc_count;
@@ -91,6 +124,136 @@ buffer_alloc_ctx;
 
 static buffer_alloc_ctx heap;
 
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+/*
+ * Index of the lowest bit set in a non-zero word
+ */
+static size_t lowest_bit( uint32_t x )
+{
+    static const unsigned char debruijn[32] =
+    {
+         0,  1, 28,  2, 29, 14, 24,  3, 30, 22, 20, 15, 25, 17,  4,  8,
+        31, 27, 13, 23, 21, 19, 16,  7, 26, 12, 18,  6, 11,  5, 10,  9
+    };
+
+    return( debruijn[(uint32_t)( ( x & ( ~x + 1 ) ) * 0x077CB531U ) >> 27] );
+}
+
+static size_t size_class( size_t size )
+{
+    size_t fl = 0;
+    uint32_t x;
+
+    if( size < CLASS_LINEAR_LIMIT )
+        return( size >> CLASS_LINEAR_SHIFT );
+
+    if( ( size >> CLASS_FL_MAX ) > 1 )
+        return( CLASS_COUNT - 1 );
+
+    /* floor( log2( size ) ), size is below 2^24 here */
+    x = (uint32_t) size;
+#if defined(__GNUC__)
+    fl = 31 - __builtin_clz( x );
+#else
+    if( x >> 16 ) { x >>= 16; fl += 16; }
+    if( x >> 8 )  { x >>= 8;  fl += 8;  }
+    if( x >> 4 )  { x >>= 4;  fl += 4;  }
+    if( x >> 2 )  { x >>= 2;  fl += 2;  }
+    if( x >> 1 )  {           fl += 1;  }
+#endif
+
+    return( CLASS_LINEAR_COUNT + ( ( fl - CLASS_FL_MIN ) << CLASS_SL_LOG2 ) +
+            ( ( size >> ( fl - CLASS_SL_LOG2 ) ) &
+              ( ( 1 << CLASS_SL_LOG2 ) - 1 ) ) );
+}
+
+static void free_list_insert( memory_header *hdr, size_t c )
+{
+    hdr->prev_free = NULL;
+    hdr->next_free = heap.free_lists[c];
+    if( hdr->next_free != NULL )
+        hdr->next_free->prev_free = hdr;
+    heap.free_lists[c] = hdr;
+
+    heap.class_map[c / 32] |= (uint32_t) 1 << ( c % 32 );
+    heap.word_map |= (uint32_t) 1 << ( c / 32 );
+}
+
+static void free_list_remove( memory_header *hdr, size_t c )
+{
+    if( hdr->prev_free != NULL )
+        hdr->prev_free->next_free = hdr->next_free;
+    else
+        heap.free_lists[c] = hdr->next_free;
+
+    if( hdr->next_free != NULL )
+        hdr->next_free->prev_free = hdr->prev_free;
+
+    hdr->prev_free = NULL;
+    hdr->next_free = NULL;
+
+    if( heap.free_lists[c] == NULL )
+    {
+        heap.class_map[c / 32] &= ~( (uint32_t) 1 << ( c % 32 ) );
+        if( heap.class_map[c / 32] == 0 )
+            heap.word_map &= ~( (uint32_t) 1 << ( c / 32 ) );
+    }
+}
+
+/*
+ * Put hdr in the place of old in the list of class c
+ */
+static void free_list_replace( memory_header *old, memory_header *hdr, size_t c )
+{
+    hdr->prev_free = old->prev_free;
+    hdr->next_free = old->next_free;
+
+    if( hdr->prev_free != NULL )
+        hdr->prev_free->next_free = hdr;
+    else
+        heap.free_lists[c] = hdr;
+
+    if( hdr->next_free != NULL )
+        hdr->next_free->prev_free = hdr;
+}
+
+static memory_header *free_list_find( size_t len )
+{
+    memory_header *cur;
+    size_t c = size_class( len );
+    size_t w;
+    uint32_t bits;
+
+    /* Blocks of the class of the request may be smaller than it, the last
+     * class is not bounded */
+    for( cur = heap.free_lists[c]; cur != NULL; cur = cur->next_free )
+    {
+        if( cur->size >= len )
+            return( cur );
+    }
+
+    if( c == CLASS_COUNT - 1 )
+        return( NULL );
+
+    /* Lowest non-empty class above the class of the request */
+    c++;
+    w = c / 32;
+    bits = heap.class_map[w] & ( ~(uint32_t) 0 << ( c % 32 ) );
+
+    if( bits == 0 )
+    {
+        bits = heap.word_map & ( ~(uint32_t) 0 << ( w + 1 ) );
+        if( bits == 0 )
+            return( NULL );
+
+        w = lowest_bit( bits );
+        bits = heap.class_map[w];
+    }
+
+    return( heap.free_lists[w * 32 + lowest_bit( bits )] );
+}
+#endif /* MBEDTLS_MEMORY_SIZE_CLASSES */
+
 #if defined(MBEDTLS_MEMORY_DEBUG)
 static void debug_header( memory_header *hdr )
 {
@@ -116,6 +279,9 @@ static void debug_header( memory_header *hdr )
 static void debug_chain()
 {
     memory_header *cur = heap.first;
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+    size_t c;
+#endif
 
     mbedtls_fprintf( stderr, "\nBlock list\n" );
     while( cur != NULL )
@@ -125,6 +291,13 @@ static void debug_chain()
     }
 
     mbedtls_fprintf( stderr, "Free list\n" );
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+    for( c = 0; c < CLASS_COUNT; c++ )
+    {
+        for( cur = heap.free_lists[c]; cur != NULL; cur = cur->next_free )
+            debug_header( cur );
+    }
+#else
     cur = heap.first_free;
 
     while( cur != NULL )
@@ -132,6 +305,7 @@ static void debug_chain()
         debug_header( cur );
         cur = cur->next_free;
     }
+#endif
 }
 #endif /* MBEDTLS_MEMORY_DEBUG */
 
@@ -183,6 +357,9 @@ static int verify_header( memory_header *hdr )
 static int verify_chain()
 {
     memory_header *prv = heap.first, *cur = heap.first->next;
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+    size_t c;
+#endif
 
     if( verify_header( heap.first ) != 0 )
     {
@@ -226,15 +403,35 @@ static int verify_chain()
         cur = cur->next;
     }
 
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+    for( c = 0; c < CLASS_COUNT; c++ )
+    {
+        for( cur = heap.free_lists[c]; cur != NULL; cur = cur->next_free )
+        {
+            if( cur->alloc != 0 || size_class( cur->size ) != c )
+            {
+#if defined(MBEDTLS_MEMORY_DEBUG)
+                mbedtls_fprintf( stderr, "FATAL: verification failed: "
+                                          "block in wrong free list\n" );
+#endif
+                return( 1 );
+            }
+        }
+    }
+#endif
+
     return( 0 );
 }
 
 static void *buffer_alloc_calloc( size_t n, size_t size )
 {
-    memory_header *new, *cur = heap.first_free;
+    memory_header *new, *cur;
     unsigned char *p;
     void *ret;
     size_t original_len, len;
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+    size_t c;
+#endif
 #if defined(MBEDTLS_MEMORY_BACKTRACE)
     void *trace_buffer[MAX_BT];
     size_t trace_cnt;
@@ -256,6 +453,10 @@ static void *buffer_alloc_calloc( size_t n, size_t size )
 
     // Find block that fits
     //
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+    cur = free_list_find( len );
+#else
+    cur = heap.first_free;
     while( cur != NULL )
     {
         if( cur->size >= len )
@@ -263,6 +464,7 @@ static void *buffer_alloc_calloc( size_t n, size_t size )
 
         cur = cur->next_free;
     }
+#endif
 
     if( cur == NULL )
         return( NULL );
@@ -289,6 +491,9 @@ static void *buffer_alloc_calloc( size_t n, size_t size )
 
         // Remove from free_list
         //
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+        free_list_remove( cur, size_class( cur->size ) );
+#else
         if( cur->prev_free != NULL )
             cur->prev_free->next_free = cur->next_free;
         else
@@ -299,6 +504,7 @@ static void *buffer_alloc_calloc( size_t n, size_t size )
 
         cur->prev_free = NULL;
         cur->next_free = NULL;
+#endif
 
 #if defined(MBEDTLS_MEMORY_DEBUG)
         heap.total_used += cur->size;
@@ -337,6 +543,19 @@ static void *buffer_alloc_calloc( size_t n, size_t size )
     if( new->next != NULL )
         new->next->prev = new;
 
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+    // Replace cur with new in free_list if it stays in the same size class,
+    // move it to the list of its size class otherwise
+    //
+    c = size_class( cur->size );
+    if( size_class( new->size ) == c )
+        free_list_replace( cur, new, c );
+    else
+    {
+        free_list_remove( cur, c );
+        free_list_insert( new, size_class( new->size ) );
+    }
+#else
     // Replace cur with new in free_list
     //
     new->prev_free = cur->prev_free;
@@ -348,6 +567,7 @@ static void *buffer_alloc_calloc( size_t n, size_t size )
 
     if( new->next_free != NULL )
         new->next_free->prev_free = new;
+#endif
 
     cur->alloc = 1;
     cur->size = len;
@@ -382,6 +602,9 @@ static void buffer_alloc_free( void *ptr )
 {
     memory_header *hdr, *old = NULL;
     unsigned char *p = (unsigned char *) ptr;
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+    size_t c = CLASS_COUNT;
+#endif
 
     if( ptr == NULL || heap.buf == NULL || heap.first == NULL )
         return;
@@ -429,6 +652,9 @@ static void buffer_alloc_free( void *ptr )
     {
 #if defined(MBEDTLS_MEMORY_DEBUG)
         heap.header_count--;
+#endif
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+        c = size_class( hdr->prev->size );
 #endif
         hdr->prev->size += sizeof(memory_header) + hdr->size;
         hdr->prev->next = hdr->next;
@@ -447,11 +673,15 @@ static void buffer_alloc_free( void *ptr )
     {
 #if defined(MBEDTLS_MEMORY_DEBUG)
         heap.header_count--;
+#endif
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+        free_list_remove( hdr->next, size_class( hdr->next->size ) );
 #endif
         hdr->size += sizeof(memory_header) + hdr->next->size;
         old = hdr->next;
         hdr->next = hdr->next->next;
 
+#if !defined(MBEDTLS_MEMORY_SIZE_CLASSES)
         if( hdr->prev_free != NULL || hdr->next_free != NULL )
         {
             if( hdr->prev_free != NULL )
@@ -473,6 +703,7 @@ static void buffer_alloc_free( void *ptr )
 
         if( hdr->next_free != NULL )
             hdr->next_free->prev_free = hdr;
+#endif /* !MBEDTLS_MEMORY_SIZE_CLASSES */
 
         if( hdr->next != NULL )
             hdr->next->prev = hdr;
@@ -480,6 +711,18 @@ static void buffer_alloc_free( void *ptr )
         memset( old, 0, sizeof(memory_header) );
     }
 
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+    // Put the block in the list of its size class, unless it was merged
+    // with the block before and stays in the list of that one
+    //
+    if( size_class( hdr->size ) != c )
+    {
+        if( c != CLASS_COUNT )
+            free_list_remove( hdr, c );
+
+        free_list_insert( hdr, size_class( hdr->size ) );
+    }
+#else
     // Prepend to free_list if we have not merged
     // (Does not have to stay in same order as prev / next list)
     //
@@ -490,6 +733,7 @@ static void buffer_alloc_free( void *ptr )
             heap.first_free->prev_free = hdr;
         heap.first_free = hdr;
     }
+#endif
 
     if( ( heap.verify & MBEDTLS_MEMORY_VERIFY_FREE ) && verify_chain() != 0 )
         mbedtls_exit( 1 );
@@ -597,7 +841,11 @@ void mbedtls_memory_buffer_alloc_init( unsigned char *buf, size_t len )
     heap.first->size = len - sizeof(memory_header);
     heap.first->magic1 = MAGIC1;
     heap.first->magic2 = MAGIC2;
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+    free_list_insert( heap.first, size_class( heap.first->size ) );
+#else
     heap.first_free = heap.first;
+#endif
 }
 
 void mbedtls_memory_buffer_alloc_free()
@@ -626,7 +874,7 @@ static int check_all_free( )
 #if defined(MBEDTLS_MEMORY_DEBUG)
         heap.total_used != 0 ||
 #endif
-        heap.first != heap.first_free ||
+        heap.first->alloc != 0 || heap.first->next != NULL ||
         (void *) heap.first != (void *) heap.buf )
     {
         return( -1 );
@@ -649,6 +897,11 @@ int mbedtls_memory_buffer_alloc_self_test( int verbose )
 {
     unsigned char buf[1024];
     unsigned char *p, *q, *r, *end;
+    unsigned char *blocks[8];
+    size_t i;
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+    memory_header *last;
+#endif
     int ret = 0;
 
     if( verbose != 0 )
@@ -735,6 +988,85 @@ int mbedtls_memory_buffer_alloc_self_test( int verbose )
     if( verbose != 0 )
         mbedtls_printf( "passed\n" );
 
+    if( verbose != 0 )
+        mbedtls_printf( "  MBA test #4 (fragmented): " );
+
+    mbedtls_memory_buffer_alloc_init( buf, sizeof( buf ) );
+
+    for( i = 0; i < 8; i++ )
+    {
+        blocks[i] = mbedtls_calloc( 1, 8 + 8 * i );
+        TEST_ASSERT( check_pointer( blocks[i] ) == 0 );
+    }
+
+    for( i = 0; i < 8; i += 2 )
+        mbedtls_free( blocks[i] );
+
+    TEST_ASSERT( mbedtls_memory_buffer_alloc_verify( ) == 0 );
+
+    for( i = 0; i < 8; i += 2 )
+    {
+        blocks[i] = mbedtls_calloc( 1, 64 - 8 * i );
+        TEST_ASSERT( check_pointer( blocks[i] ) == 0 );
+    }
+
+    TEST_ASSERT( mbedtls_memory_buffer_alloc_verify( ) == 0 );
+
+    for( i = 0; i < 8; i++ )
+        mbedtls_free( blocks[7 - ( i * 3 ) % 8] );
+
+    TEST_ASSERT( check_all_free( ) == 0 );
+    TEST_ASSERT( mbedtls_memory_buffer_alloc_verify( ) == 0 );
+
+    mbedtls_memory_buffer_alloc_free( );
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+
+#if defined(MBEDTLS_MEMORY_SIZE_CLASSES)
+    if( verbose != 0 )
+        mbedtls_printf( "  MBA test #5 (same size class): " );
+
+    mbedtls_memory_buffer_alloc_init( buf, sizeof( buf ) );
+
+    /* Free blocks of 216 and 208 bytes, both in the 208-223 class, with the
+     * smaller one at the head of the class and no other free block */
+    p = mbedtls_calloc( 1, 216 );
+    blocks[0] = mbedtls_calloc( 1, 8 );
+    q = mbedtls_calloc( 1, 208 );
+    blocks[1] = mbedtls_calloc( 1, 8 );
+
+    TEST_ASSERT( check_pointer( p ) == 0 && check_pointer( q ) == 0 &&
+                 check_pointer( blocks[0] ) == 0 &&
+                 check_pointer( blocks[1] ) == 0 );
+
+    for( last = heap.first; last->next != NULL; last = last->next )
+        ;
+    r = mbedtls_calloc( 1, last->size );
+    TEST_ASSERT( check_pointer( r ) == 0 );
+
+    mbedtls_free( p );
+    mbedtls_free( q );
+
+    TEST_ASSERT( mbedtls_calloc( 1, 216 ) == p );
+    TEST_ASSERT( mbedtls_calloc( 1, 216 ) == NULL );
+    TEST_ASSERT( mbedtls_calloc( 1, 208 ) == q );
+
+    mbedtls_free( p );
+    mbedtls_free( q );
+    mbedtls_free( blocks[0] );
+    mbedtls_free( blocks[1] );
+    mbedtls_free( r );
+
+    TEST_ASSERT( check_all_free( ) == 0 );
+    TEST_ASSERT( mbedtls_memory_buffer_alloc_verify( ) == 0 );
+
+    mbedtls_memory_buffer_alloc_free( );
+
+    if( verbose != 0 )
+        mbedtls_printf( "passed\n" );
+#endif /* MBEDTLS_MEMORY_SIZE_CLASSES */
+
 cleanup:
     mbedtls_memory_buffer_alloc_free( );
 
@@ -186,6 +186,9 @@ static const char *features[] = {
 #if defined(MBEDTLS_AES_DECRYPT_ALT)
     "MBEDTLS_AES_DECRYPT_ALT",
 #endif /* MBEDTLS_AES_DECRYPT_ALT */
+#if defined(MBEDTLS_AES_CTR_KEYSTREAM_ALT)
+    "MBEDTLS_AES_CTR_KEYSTREAM_ALT",
+#endif /* MBEDTLS_AES_CTR_KEYSTREAM_ALT */
 #if defined(MBEDTLS_ECDH_GEN_PUBLIC_ALT)
     "MBEDTLS_ECDH_GEN_PUBLIC_ALT",
 #endif /* MBEDTLS_ECDH_GEN_PUBLIC_ALT */
@@ -240,6 +243,9 @@ static const char *features[] = {
 #if defined(MBEDTLS_CAMELLIA_SMALL_MEMORY)
     "MBEDTLS_CAMELLIA_SMALL_MEMORY",
 #endif /* MBEDTLS_CAMELLIA_SMALL_MEMORY */
+#if defined(MBEDTLS_GCM_LARGE_TABLE)
+    "MBEDTLS_GCM_LARGE_TABLE",
+#endif /* MBEDTLS_GCM_LARGE_TABLE */
 #if defined(MBEDTLS_CIPHER_MODE_CBC)
     "MBEDTLS_CIPHER_MODE_CBC",
 #endif /* MBEDTLS_CIPHER_MODE_CBC */
@@ -426,6 +432,9 @@ static const char *features[] = {
 #if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
     "MBEDTLS_SSL_MAX_FRAGMENT_LENGTH",
 #endif /* MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+    "MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH",
+#endif /* MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH */
 #if defined(MBEDTLS_SSL_PROTO_SSL3)
     "MBEDTLS_SSL_PROTO_SSL3",
 #endif /* MBEDTLS_SSL_PROTO_SSL3 */
@@ -480,6 +480,37 @@ int mbedtls_x509_get_name( unsigned char **p, const unsigned char *end,
     }
 }
 
+/*
+ * Get the next AttributeTypeAndValue of a Name without building a list, to
+ * walk a Name in place. *end_set is the end of the current
+ * RelativeDistinguishedName and must be NULL on the first call. The
+ * attributes and next_merged flags are the ones mbedtls_x509_get_name()
+ * would store, cur->next is always NULL.
+ */
+int mbedtls_x509_get_name_attr( unsigned char **p, const unsigned char *end,
+                                const unsigned char **end_set,
+                                mbedtls_x509_name *cur )
+{
+    int ret;
+    size_t set_len;
+
+    if( *end_set == NULL || *p == *end_set )
+    {
+        if( ( ret = mbedtls_asn1_get_tag( p, end, &set_len,
+                MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SET ) ) != 0 )
+            return( MBEDTLS_ERR_X509_INVALID_NAME + ret );
+
+        *end_set = *p + set_len;
+    }
+
+    if( ( ret = x509_get_attr_type_value( p, *end_set, cur ) ) != 0 )
+        return( ret );
+
+    cur->next_merged = ( *p != *end_set );
+
+    return( 0 );
+}
+
 static int x509_parse_int( unsigned char **p, size_t n, int *res )
 {
     *res = 0;
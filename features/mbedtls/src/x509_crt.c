@@ -516,6 +516,63 @@ static int x509_get_subject_alt_name( unsigned char **p,
     return( 0 );
 }
 
+/*
+ * Free the allocated entries of a list of names, the first entry is not
+ * allocated
+ */
+static void x509_crt_free_name( mbedtls_x509_name *name )
+{
+    mbedtls_x509_name *name_cur;
+    mbedtls_x509_name *name_prv;
+
+    name_cur = name->next;
+    while( name_cur != NULL )
+    {
+        name_prv = name_cur;
+        name_cur = name_cur->next;
+        mbedtls_zeroize( name_prv, sizeof( mbedtls_x509_name ) );
+        mbedtls_free( name_prv );
+    }
+}
+
+/*
+ * Free the allocated entries of a sequence, the first entry is not allocated
+ */
+static void x509_crt_free_sequence( mbedtls_x509_sequence *seq )
+{
+    mbedtls_x509_sequence *seq_cur;
+    mbedtls_x509_sequence *seq_prv;
+
+    seq_cur = seq->next;
+    while( seq_cur != NULL )
+    {
+        seq_prv = seq_cur;
+        seq_cur = seq_cur->next;
+        mbedtls_zeroize( seq_prv, sizeof( mbedtls_x509_sequence ) );
+        mbedtls_free( seq_prv );
+    }
+}
+
+/*
+ * Check a Name like mbedtls_x509_get_name() does, without building the list
+ * of its attributes
+ */
+static int x509_check_name( unsigned char **p, const unsigned char *end )
+{
+    int ret;
+    const unsigned char *end_set = NULL;
+    mbedtls_x509_name cur;
+
+    do
+    {
+        if( ( ret = mbedtls_x509_get_name_attr( p, end, &end_set, &cur ) ) != 0 )
+            return( ret );
+    }
+    while( *p != end );
+
+    return( 0 );
+}
+
 /*
  * X.509 v3 extensions
  *
@@ -527,6 +584,7 @@ static int x509_get_crt_ext( unsigned char **p,
     int ret;
     size_t len;
     unsigned char *end_ext_data, *end_ext_octet;
+    mbedtls_x509_sequence unused;
 
     if( ( ret = mbedtls_x509_get_ext( p, end, &crt->v3_ext, 3 ) ) != 0 )
     {
@@ -627,16 +685,23 @@ static int x509_get_crt_ext( unsigned char **p,
             break;
 
         case MBEDTLS_X509_EXT_EXTENDED_KEY_USAGE:
-            /* Parse extended key usage */
-            if( ( ret = x509_get_ext_key_usage( p, end_ext_octet,
-                    &crt->ext_key_usage ) ) != 0 )
+            /* Parse extended key usage, only check it if the DER is not
+             * copied, see mbedtls_x509_crt_parse_der_nocopy() */
+            memset( &unused, 0, sizeof( unused ) );
+            ret = x509_get_ext_key_usage( p, end_ext_octet,
+                    crt->own_buffer ? &crt->ext_key_usage : &unused );
+            x509_crt_free_sequence( &unused );
+            if( ret != 0 )
                 return( ret );
             break;
 
         case MBEDTLS_X509_EXT_SUBJECT_ALT_NAME:
-            /* Parse subject alt name */
-            if( ( ret = x509_get_subject_alt_name( p, end_ext_octet,
-                    &crt->subject_alt_names ) ) != 0 )
+            /* Parse subject alt name, likewise */
+            memset( &unused, 0, sizeof( unused ) );
+            ret = x509_get_subject_alt_name( p, end_ext_octet,
+                    crt->own_buffer ? &crt->subject_alt_names : &unused );
+            x509_crt_free_sequence( &unused );
+            if( ret != 0 )
                 return( ret );
             break;
 
@@ -660,10 +725,11 @@ static int x509_get_crt_ext( unsigned char **p,
 }
 
 /*
- * Parse and fill a single X.509 certificate in DER format
+ * Parse and fill a single X.509 certificate in DER format, referencing the
+ * DER in buf instead of copying it if make_copy is 0
  */
 static int x509_crt_parse_der_core( mbedtls_x509_crt *crt, const unsigned char *buf,
-                                    size_t buflen )
+                                    size_t buflen, int make_copy )
 {
     int ret;
     size_t len;
@@ -705,18 +771,29 @@ static int x509_crt_parse_der_core( mbedtls_x509_crt *crt, const unsigned char *
                 MBEDTLS_ERR_ASN1_LENGTH_MISMATCH );
     }
     crt_end = p + len;
-
-    // Create and populate a new buffer for the raw field
     crt->raw.len = crt_end - buf;
-    crt->raw.p = p = mbedtls_calloc( 1, crt->raw.len );
-    if( p == NULL )
-        return( MBEDTLS_ERR_X509_ALLOC_FAILED );
 
-    memcpy( p, buf, crt->raw.len );
+    if( make_copy != 0 )
+    {
+        // Create and populate a new buffer for the raw field
+        crt->raw.p = p = mbedtls_calloc( 1, crt->raw.len );
+        if( p == NULL )
+            return( MBEDTLS_ERR_X509_ALLOC_FAILED );
 
-    // Direct pointers to the new buffer 
-    p += crt->raw.len - len;
-    end = crt_end = p + len;
+        memcpy( p, buf, crt->raw.len );
+        crt->own_buffer = 1;
+
+        // Direct pointers to the new buffer
+        p += crt->raw.len - len;
+        crt_end = p + len;
+    }
+    else
+    {
+        crt->raw.p = (unsigned char *) buf;
+        crt->own_buffer = 0;
+    }
+
+    end = crt_end;
 
     /*
      * TBSCertificate  ::=  SEQUENCE  {
@@ -777,7 +854,12 @@ static int x509_crt_parse_der_core( mbedtls_x509_crt *crt, const unsigned char *
         return( MBEDTLS_ERR_X509_INVALID_FORMAT + ret );
     }
 
-    if( ( ret = mbedtls_x509_get_name( &p, p + len, &crt->issuer ) ) != 0 )
+    if( crt->own_buffer )
+        ret = mbedtls_x509_get_name( &p, p + len, &crt->issuer );
+    else
+        ret = x509_check_name( &p, p + len );
+
+    if( ret != 0 )
     {
         mbedtls_x509_crt_free( crt );
         return( ret );
@@ -810,7 +892,12 @@ static int x509_crt_parse_der_core( mbedtls_x509_crt *crt, const unsigned char *
         return( MBEDTLS_ERR_X509_INVALID_FORMAT + ret );
     }
 
-    if( len && ( ret = mbedtls_x509_get_name( &p, p + len, &crt->subject ) ) != 0 )
+    if( len && crt->own_buffer )
+        ret = mbedtls_x509_get_name( &p, p + len, &crt->subject );
+    else if( len )
+        ret = x509_check_name( &p, p + len );
+
+    if( ret != 0 )
     {
         mbedtls_x509_crt_free( crt );
         return( ret );
@@ -919,8 +1006,9 @@ static int x509_crt_parse_der_core( mbedtls_x509_crt *crt, const unsigned char *
  * Parse one X.509 certificate in DER format from a buffer and add them to a
  * chained list
  */
-int mbedtls_x509_crt_parse_der( mbedtls_x509_crt *chain, const unsigned char *buf,
-                        size_t buflen )
+static int x509_crt_parse_der_internal( mbedtls_x509_crt *chain,
+                                        const unsigned char *buf,
+                                        size_t buflen, int make_copy )
 {
     int ret;
     mbedtls_x509_crt *crt = chain, *prev = NULL;
@@ -952,7 +1040,7 @@ int mbedtls_x509_crt_parse_der( mbedtls_x509_crt *chain, const unsigned char *bu
         crt = crt->next;
     }
 
-    if( ( ret = x509_crt_parse_der_core( crt, buf, buflen ) ) != 0 )
+    if( ( ret = x509_crt_parse_der_core( crt, buf, buflen, make_copy ) ) != 0 )
     {
         if( prev )
             prev->next = NULL;
@@ -966,6 +1054,19 @@ int mbedtls_x509_crt_parse_der( mbedtls_x509_crt *chain, const unsigned char *bu
     return( 0 );
 }
 
+int mbedtls_x509_crt_parse_der( mbedtls_x509_crt *chain, const unsigned char *buf,
+                        size_t buflen )
+{
+    return( x509_crt_parse_der_internal( chain, buf, buflen, 1 ) );
+}
+
+int mbedtls_x509_crt_parse_der_nocopy( mbedtls_x509_crt *chain,
+                                       const unsigned char *buf,
+                                       size_t buflen )
+{
+    return( x509_crt_parse_der_internal( chain, buf, buflen, 0 ) );
+}
+
 /*
  * Parse one or more PEM certificates from a buffer and add them to the chained
  * list
@@ -1226,6 +1327,130 @@ cleanup:
 }
 #endif /* MBEDTLS_FS_IO */
 
+/*
+ * Find the value of an extension in the DER of a certificate, for the
+ * extensions that are not kept decoded. The extensions were checked when the
+ * certificate was parsed.
+ */
+static int x509_crt_find_ext( const mbedtls_x509_crt *crt, int ext_type,
+                              unsigned char **p, const unsigned char **end )
+{
+    int ret;
+    int type;
+    int is_critical;
+    size_t len;
+    unsigned char *q = crt->v3_ext.p;
+    unsigned char *end_ext;
+    const unsigned char *end_exts = crt->v3_ext.p + crt->v3_ext.len;
+    mbedtls_x509_buf oid;
+
+    if( ( ret = mbedtls_asn1_get_tag( &q, end_exts, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+        return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+    while( q < end_exts )
+    {
+        if( ( ret = mbedtls_asn1_get_tag( &q, end_exts, &len,
+                MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+            return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+        end_ext = q + len;
+
+        oid.tag = MBEDTLS_ASN1_OID;
+        if( ( ret = mbedtls_asn1_get_tag( &q, end_ext, &oid.len,
+                MBEDTLS_ASN1_OID ) ) != 0 )
+            return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+        oid.p = q;
+        q += oid.len;
+
+        if( ( ret = mbedtls_asn1_get_bool( &q, end_ext, &is_critical ) ) != 0 &&
+            ( ret != MBEDTLS_ERR_ASN1_UNEXPECTED_TAG ) )
+            return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+        if( ( ret = mbedtls_asn1_get_tag( &q, end_ext, &len,
+                MBEDTLS_ASN1_OCTET_STRING ) ) != 0 )
+            return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+        if( mbedtls_oid_get_x509_ext_type( &oid, &type ) == 0 &&
+            type == ext_type )
+        {
+            *p = q;
+            *end = q + len;
+            return( 0 );
+        }
+
+        q = end_ext;
+    }
+
+    return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS );
+}
+
+/*
+ * Get the subject alternative names or extended key usages of a
+ * certificate. For a certificate parsed with
+ * mbedtls_x509_crt_parse_der_nocopy() they are decoded into tmp, which must
+ * be released with x509_crt_free_sequence().
+ */
+static int x509_crt_get_sequence( const mbedtls_x509_crt *crt, int ext_type,
+                                  mbedtls_x509_sequence *tmp,
+                                  const mbedtls_x509_sequence **seq )
+{
+    int ret;
+    unsigned char *p;
+    const unsigned char *end;
+
+    memset( tmp, 0, sizeof( mbedtls_x509_sequence ) );
+
+    if( crt->own_buffer )
+    {
+        *seq = ( ext_type == MBEDTLS_X509_EXT_SUBJECT_ALT_NAME ) ?
+               &crt->subject_alt_names : &crt->ext_key_usage;
+        return( 0 );
+    }
+
+    *seq = tmp;
+
+    if( ( ret = x509_crt_find_ext( crt, ext_type, &p, &end ) ) != 0 )
+        return( ret );
+
+    if( ext_type == MBEDTLS_X509_EXT_SUBJECT_ALT_NAME )
+        return( x509_get_subject_alt_name( &p, end, tmp ) );
+
+    return( x509_get_ext_key_usage( &p, end, tmp ) );
+}
+
+/*
+ * Print a Name of a certificate, decoding it from raw for a certificate
+ * parsed with mbedtls_x509_crt_parse_der_nocopy()
+ */
+static int x509_crt_dn_gets( char *buf, size_t size,
+                             const mbedtls_x509_crt *crt,
+                             const mbedtls_x509_buf *raw,
+                             const mbedtls_x509_name *dn )
+{
+    int ret;
+    size_t len;
+    unsigned char *p = raw->p;
+    mbedtls_x509_name name;
+
+    if( crt->own_buffer )
+        return( mbedtls_x509_dn_gets( buf, size, dn ) );
+
+    memset( &name, 0, sizeof( name ) );
+
+    ret = mbedtls_asn1_get_tag( &p, raw->p + raw->len, &len,
+                                MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE );
+    if( ret == 0 && len != 0 )
+        ret = mbedtls_x509_get_name( &p, p + len, &name );
+    if( ret == 0 )
+        ret = mbedtls_x509_dn_gets( buf, size, &name );
+
+    x509_crt_free_name( &name );
+
+    return( ret );
+}
+
 static int x509_info_subject_alt_name( char **buf, size_t *size,
                                        const mbedtls_x509_sequence *subject_alt_name )
 {
@@ -1367,6 +1592,8 @@ int mbedtls_x509_crt_info( char *buf, size_t size, const char *prefix,
     size_t n;
     char *p;
     char key_size_str[BEFORE_COLON];
+    mbedtls_x509_sequence tmp;
+    const mbedtls_x509_sequence *seq;
 
     p = buf;
     n = size;
@@ -1391,12 +1618,12 @@ int mbedtls_x509_crt_info( char *buf, size_t size, const char *prefix,
 
     ret = mbedtls_snprintf( p, n, "\n%sissuer name       : ", prefix );
     MBEDTLS_X509_SAFE_SNPRINTF;
-    ret = mbedtls_x509_dn_gets( p, n, &crt->issuer  );
+    ret = x509_crt_dn_gets( p, n, crt, &crt->issuer_raw, &crt->issuer );
     MBEDTLS_X509_SAFE_SNPRINTF;
 
     ret = mbedtls_snprintf( p, n, "\n%ssubject name      : ", prefix );
     MBEDTLS_X509_SAFE_SNPRINTF;
-    ret = mbedtls_x509_dn_gets( p, n, &crt->subject );
+    ret = x509_crt_dn_gets( p, n, crt, &crt->subject_raw, &crt->subject );
     MBEDTLS_X509_SAFE_SNPRINTF;
 
     ret = mbedtls_snprintf( p, n, "\n%sissued  on        : " \
@@ -1453,8 +1680,12 @@ int mbedtls_x509_crt_info( char *buf, size_t size, const char *prefix,
         ret = mbedtls_snprintf( p, n, "\n%ssubject alt name  : ", prefix );
         MBEDTLS_X509_SAFE_SNPRINTF;
 
-        if( ( ret = x509_info_subject_alt_name( &p, &n,
-                                            &crt->subject_alt_names ) ) != 0 )
+        if( ( ret = x509_crt_get_sequence( crt, MBEDTLS_X509_EXT_SUBJECT_ALT_NAME,
+                                           &tmp, &seq ) ) == 0 )
+            ret = x509_info_subject_alt_name( &p, &n, seq );
+
+        x509_crt_free_sequence( &tmp );
+        if( ret != 0 )
             return( ret );
     }
 
@@ -1481,8 +1712,12 @@ int mbedtls_x509_crt_info( char *buf, size_t size, const char *prefix,
         ret = mbedtls_snprintf( p, n, "\n%sext key usage     : ", prefix );
         MBEDTLS_X509_SAFE_SNPRINTF;
 
-        if( ( ret = x509_info_ext_key_usage( &p, &n,
-                                             &crt->ext_key_usage ) ) != 0 )
+        if( ( ret = x509_crt_get_sequence( crt, MBEDTLS_X509_EXT_EXTENDED_KEY_USAGE,
+                                           &tmp, &seq ) ) == 0 )
+            ret = x509_info_ext_key_usage( &p, &n, seq );
+
+        x509_crt_free_sequence( &tmp );
+        if( ret != 0 )
             return( ret );
     }
 
@@ -1579,26 +1814,45 @@ int mbedtls_x509_crt_check_extended_key_usage( const mbedtls_x509_crt *crt,
                                        const char *usage_oid,
                                        size_t usage_len )
 {
-    const mbedtls_x509_sequence *cur;
+    int ret;
+    size_t len;
+    unsigned char *p;
+    const unsigned char *end;
+    mbedtls_x509_buf cur_oid;
 
     /* Extension is not mandatory, absent means no restriction */
     if( ( crt->ext_types & MBEDTLS_X509_EXT_EXTENDED_KEY_USAGE ) == 0 )
         return( 0 );
 
     /*
-     * Look for the requested usage (or wildcard ANY) in our list
+     * Look for the requested usage (or wildcard ANY) in the raw extension,
+     * which is there whether or not the DER was copied
      */
-    for( cur = &crt->ext_key_usage; cur != NULL; cur = cur->next )
+    if( ( ret = x509_crt_find_ext( crt, MBEDTLS_X509_EXT_EXTENDED_KEY_USAGE,
+                                   &p, &end ) ) != 0 )
+        return( ret );
+
+    if( ( ret = mbedtls_asn1_get_tag( &p, end, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) ) != 0 )
+        return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+    while( p < end )
     {
-        const mbedtls_x509_buf *cur_oid = &cur->buf;
+        cur_oid.tag = MBEDTLS_ASN1_OID;
+        if( ( ret = mbedtls_asn1_get_tag( &p, end, &cur_oid.len,
+                MBEDTLS_ASN1_OID ) ) != 0 )
+            return( MBEDTLS_ERR_X509_INVALID_EXTENSIONS + ret );
+
+        cur_oid.p = p;
+        p += cur_oid.len;
 
-        if( cur_oid->len == usage_len &&
-            memcmp( cur_oid->p, usage_oid, usage_len ) == 0 )
+        if( cur_oid.len == usage_len &&
+            memcmp( cur_oid.p, usage_oid, usage_len ) == 0 )
         {
             return( 0 );
         }
 
-        if( MBEDTLS_OID_CMP( MBEDTLS_OID_ANY_EXTENDED_KEY_USAGE, cur_oid ) == 0 )
+        if( MBEDTLS_OID_CMP( MBEDTLS_OID_ANY_EXTENDED_KEY_USAGE, &cur_oid ) == 0 )
             return( 0 );
     }
 
@@ -1755,7 +2009,7 @@ static int x509_memcasecmp( const void *s1, const void *s2, size_t len )
 /*
  * Return 0 if name matches wildcard, -1 otherwise
  */
-static int x509_check_wildcard( const char *cn, mbedtls_x509_buf *name )
+static int x509_check_wildcard( const char *cn, const mbedtls_x509_buf *name )
 {
     size_t i;
     size_t cn_idx = 0, cn_len = strlen( cn );
@@ -1784,6 +2038,89 @@ static int x509_check_wildcard( const char *cn, mbedtls_x509_buf *name )
     return( -1 );
 }
 
+/*
+ * Return 0 if name matches cn exactly (case-insensitive) or as a wildcard,
+ * -1 otherwise
+ */
+static int x509_crt_check_cn( const mbedtls_x509_buf *name,
+                              const char *cn, size_t cn_len )
+{
+    if( name->len == cn_len &&
+        x509_memcasecmp( cn, name->p, cn_len ) == 0 )
+        return( 0 );
+
+    if( name->len > 2 &&
+        memcmp( name->p, "*.", 2 ) == 0 &&
+        x509_check_wildcard( cn, name ) == 0 )
+        return( 0 );
+
+    return( -1 );
+}
+
+/*
+ * Check cn against the dNSName entries of the subject alternative names, or
+ * against the subject CNs if there are none. Both are read from the raw DER,
+ * so this works for certificates parsed with or without a copy.
+ *
+ * Return 0 if one matches, -1 otherwise.
+ */
+static int x509_crt_verify_name( const mbedtls_x509_crt *crt, const char *cn )
+{
+    size_t len;
+    size_t cn_len = strlen( cn );
+    unsigned char *p;
+    const unsigned char *end;
+    const unsigned char *end_set = NULL;
+    mbedtls_x509_buf buf;
+    mbedtls_x509_name name;
+
+    if( crt->ext_types & MBEDTLS_X509_EXT_SUBJECT_ALT_NAME )
+    {
+        if( x509_crt_find_ext( crt, MBEDTLS_X509_EXT_SUBJECT_ALT_NAME,
+                               &p, &end ) != 0 ||
+            mbedtls_asn1_get_tag( &p, end, &len,
+                MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) != 0 )
+            return( -1 );
+
+        while( p < end )
+        {
+            buf.tag = *p++;
+            if( mbedtls_asn1_get_len( &p, end, &buf.len ) != 0 )
+                return( -1 );
+
+            buf.p = p;
+            p += buf.len;
+
+            /* Only dNSName entries are matched */
+            if( buf.tag == ( MBEDTLS_ASN1_CONTEXT_SPECIFIC | 2 ) &&
+                x509_crt_check_cn( &buf, cn, cn_len ) == 0 )
+                return( 0 );
+        }
+
+        return( -1 );
+    }
+
+    p = crt->subject_raw.p;
+    end = crt->subject_raw.p + crt->subject_raw.len;
+
+    if( mbedtls_asn1_get_tag( &p, end, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) != 0 )
+        return( -1 );
+    end = p + len;
+
+    while( p < end )
+    {
+        if( mbedtls_x509_get_name_attr( &p, end, &end_set, &name ) != 0 )
+            return( -1 );
+
+        if( MBEDTLS_OID_CMP( MBEDTLS_OID_AT_CN, &name.oid ) == 0 &&
+            x509_crt_check_cn( &name.val, cn, cn_len ) == 0 )
+            return( 0 );
+    }
+
+    return( -1 );
+}
+
 /*
  * Compare two X.509 strings, case-insensitive, and allowing for some encoding
  * variations (but not all).
@@ -1811,7 +2148,9 @@ static int x509_string_cmp( const mbedtls_x509_buf *a, const mbedtls_x509_buf *b
 }
 
 /*
- * Compare two X.509 Names (aka rdnSequence).
+ * Compare two X.509 Names (aka rdnSequence), given as raw DER including the
+ * outer SEQUENCE. They are walked in place, so that certificates parsed
+ * without decoding their names compare the same way.
  *
  * See RFC 5280 section 7.1, though we don't implement the whole algorithm:
  * we sometimes return unequal when the full algorithm would return equal,
@@ -1820,35 +2159,54 @@ static int x509_string_cmp( const mbedtls_x509_buf *a, const mbedtls_x509_buf *b
  *
  * Return 0 if equal, -1 otherwise.
  */
-static int x509_name_cmp( const mbedtls_x509_name *a, const mbedtls_x509_name *b )
+static int x509_name_cmp( const mbedtls_x509_buf *a_raw,
+                          const mbedtls_x509_buf *b_raw )
 {
-    /* Avoid recursion, it might not be optimised by the compiler */
-    while( a != NULL || b != NULL )
+    size_t len;
+    unsigned char *p_a = a_raw->p;
+    unsigned char *p_b = b_raw->p;
+    const unsigned char *end_a = a_raw->p + a_raw->len;
+    const unsigned char *end_b = b_raw->p + b_raw->len;
+    const unsigned char *set_a = NULL;
+    const unsigned char *set_b = NULL;
+    mbedtls_x509_name a, b;
+
+    if( mbedtls_asn1_get_tag( &p_a, end_a, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) != 0 )
+        return( -1 );
+    end_a = p_a + len;
+
+    if( mbedtls_asn1_get_tag( &p_b, end_b, &len,
+            MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE ) != 0 )
+        return( -1 );
+    end_b = p_b + len;
+
+    while( p_a != end_a || p_b != end_b )
     {
-        if( a == NULL || b == NULL )
+        if( p_a == end_a || p_b == end_b )
+            return( -1 );
+
+        if( mbedtls_x509_get_name_attr( &p_a, end_a, &set_a, &a ) != 0 ||
+            mbedtls_x509_get_name_attr( &p_b, end_b, &set_b, &b ) != 0 )
             return( -1 );
 
         /* type */
-        if( a->oid.tag != b->oid.tag ||
-            a->oid.len != b->oid.len ||
-            memcmp( a->oid.p, b->oid.p, b->oid.len ) != 0 )
+        if( a.oid.tag != b.oid.tag ||
+            a.oid.len != b.oid.len ||
+            memcmp( a.oid.p, b.oid.p, b.oid.len ) != 0 )
         {
             return( -1 );
         }
 
         /* value */
-        if( x509_string_cmp( &a->val, &b->val ) != 0 )
+        if( x509_string_cmp( &a.val, &b.val ) != 0 )
             return( -1 );
 
         /* structure of the list of sets */
-        if( a->next_merged != b->next_merged )
+        if( a.next_merged != b.next_merged )
             return( -1 );
-
-        a = a->next;
-        b = b->next;
     }
 
-    /* a == NULL == b */
     return( 0 );
 }
 
@@ -1866,7 +2224,7 @@ static int x509_crt_check_parent( const mbedtls_x509_crt *child,
     int need_ca_bit;
 
     /* Parent must be the issuer */
-    if( x509_name_cmp( &child->issuer, &parent->subject ) != 0 )
+    if( x509_name_cmp( &child->issuer_raw, &parent->subject_raw ) != 0 )
         return( -1 );
 
     /* Parent must have the basicConstraints CA bit set as a general rule */
@@ -2056,7 +2414,7 @@ static int x509_crt_verify_child(
     const mbedtls_md_info_t *md_info;
 
     /* Counting intermediate self signed certificates */
-    if( ( path_cnt != 0 ) && x509_name_cmp( &child->issuer, &child->subject ) == 0 )
+    if( ( path_cnt != 0 ) && x509_name_cmp( &child->issuer_raw, &child->subject_raw ) == 0 )
         self_cnt++;
 
     /* path_cnt is 0 for the first intermediate CA */
@@ -2199,12 +2557,9 @@ int mbedtls_x509_crt_verify_with_profile( mbedtls_x509_crt *crt,
                      int (*f_vrfy)(void *, mbedtls_x509_crt *, int, uint32_t *),
                      void *p_vrfy )
 {
-    size_t cn_len;
     int ret;
     int pathlen = 0, selfsigned = 0;
     mbedtls_x509_crt *parent;
-    mbedtls_x509_name *name;
-    mbedtls_x509_sequence *cur = NULL;
     mbedtls_pk_type_t pk_type;
 
     *flags = 0;
@@ -2215,57 +2570,8 @@ int mbedtls_x509_crt_verify_with_profile( mbedtls_x509_crt *crt,
         goto exit;
     }
 
-    if( cn != NULL )
-    {
-        name = &crt->subject;
-        cn_len = strlen( cn );
-
-        if( crt->ext_types & MBEDTLS_X509_EXT_SUBJECT_ALT_NAME )
-        {
-            cur = &crt->subject_alt_names;
-
-            while( cur != NULL )
-            {
-                if( cur->buf.len == cn_len &&
-                    x509_memcasecmp( cn, cur->buf.p, cn_len ) == 0 )
-                    break;
-
-                if( cur->buf.len > 2 &&
-                    memcmp( cur->buf.p, "*.", 2 ) == 0 &&
-                    x509_check_wildcard( cn, &cur->buf ) == 0 )
-                {
-                    break;
-                }
-
-                cur = cur->next;
-            }
-
-            if( cur == NULL )
-                *flags |= MBEDTLS_X509_BADCERT_CN_MISMATCH;
-        }
-        else
-        {
-            while( name != NULL )
-            {
-                if( MBEDTLS_OID_CMP( MBEDTLS_OID_AT_CN, &name->oid ) == 0 )
-                {
-                    if( name->val.len == cn_len &&
-                        x509_memcasecmp( name->val.p, cn, cn_len ) == 0 )
-                        break;
-
-                    if( name->val.len > 2 &&
-                        memcmp( name->val.p, "*.", 2 ) == 0 &&
-                        x509_check_wildcard( cn, &name->val ) == 0 )
-                        break;
-                }
-
-                name = name->next;
-            }
-
-            if( name == NULL )
-                *flags |= MBEDTLS_X509_BADCERT_CN_MISMATCH;
-        }
-    }
+    if( cn != NULL && x509_crt_verify_name( crt, cn ) != 0 )
+        *flags |= MBEDTLS_X509_BADCERT_CN_MISMATCH;
 
     /* Check the type and size of the key */
     pk_type = mbedtls_pk_get_type( &crt->pk );
@@ -2348,10 +2654,6 @@ void mbedtls_x509_crt_free( mbedtls_x509_crt *crt )
 {
     mbedtls_x509_crt *cert_cur = crt;
     mbedtls_x509_crt *cert_prv;
-    mbedtls_x509_name *name_cur;
-    mbedtls_x509_name *name_prv;
-    mbedtls_x509_sequence *seq_cur;
-    mbedtls_x509_sequence *seq_prv;
 
     if( crt == NULL )
         return;
@@ -2364,43 +2666,12 @@ void mbedtls_x509_crt_free( mbedtls_x509_crt *crt )
         mbedtls_free( cert_cur->sig_opts );
 #endif
 
-        name_cur = cert_cur->issuer.next;
-        while( name_cur != NULL )
-        {
-            name_prv = name_cur;
-            name_cur = name_cur->next;
-            mbedtls_zeroize( name_prv, sizeof( mbedtls_x509_name ) );
-            mbedtls_free( name_prv );
-        }
-
-        name_cur = cert_cur->subject.next;
-        while( name_cur != NULL )
-        {
-            name_prv = name_cur;
-            name_cur = name_cur->next;
-            mbedtls_zeroize( name_prv, sizeof( mbedtls_x509_name ) );
-            mbedtls_free( name_prv );
-        }
-
-        seq_cur = cert_cur->ext_key_usage.next;
-        while( seq_cur != NULL )
-        {
-            seq_prv = seq_cur;
-            seq_cur = seq_cur->next;
-            mbedtls_zeroize( seq_prv, sizeof( mbedtls_x509_sequence ) );
-            mbedtls_free( seq_prv );
-        }
-
-        seq_cur = cert_cur->subject_alt_names.next;
-        while( seq_cur != NULL )
-        {
-            seq_prv = seq_cur;
-            seq_cur = seq_cur->next;
-            mbedtls_zeroize( seq_prv, sizeof( mbedtls_x509_sequence ) );
-            mbedtls_free( seq_prv );
-        }
+        x509_crt_free_name( &cert_cur->issuer );
+        x509_crt_free_name( &cert_cur->subject );
+        x509_crt_free_sequence( &cert_cur->ext_key_usage );
+        x509_crt_free_sequence( &cert_cur->subject_alt_names );
 
-        if( cert_cur->raw.p != NULL )
+        if( cert_cur->own_buffer && cert_cur->raw.p != NULL )
         {
             mbedtls_zeroize( cert_cur->raw.p, cert_cur->raw.len );
             mbedtls_free( cert_cur->raw.p );
@@ -22,6 +22,8 @@
 
 #define MBEDTLS_AES_ALT
 
+#define MBEDTLS_AES_CTR_KEYSTREAM_ALT
+
 #define MBEDTLS_SHA256_ALT
 
 #define MBEDTLS_SHA1_ALT
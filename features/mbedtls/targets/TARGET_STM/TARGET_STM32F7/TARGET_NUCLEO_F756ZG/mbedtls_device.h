@@ -21,6 +21,9 @@
 #define MBEDTLS_DEVICE_H
 
 #define MBEDTLS_AES_ALT
+
+#define MBEDTLS_AES_CTR_KEYSTREAM_ALT
+
 #define MBEDTLS_SHA1_ALT
 
 
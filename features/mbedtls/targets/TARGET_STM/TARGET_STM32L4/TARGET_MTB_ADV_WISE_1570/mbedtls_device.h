@@ -22,4 +22,6 @@
 
 #define MBEDTLS_AES_ALT
 
+#define MBEDTLS_AES_CTR_KEYSTREAM_ALT
+
 #endif /* MBEDTLS_DEVICE_H */
@@ -148,9 +148,8 @@ int mbedtls_aes_crypt_ecb( mbedtls_aes_context *ctx,
     return( 0 );
 }
 
-#if defined(MBEDTLS_CIPHER_MODE_CBC)
 #if defined (TARGET_STM32L486xG) || defined (TARGET_STM32L443xC)
-static int st_cbc_restore_context(mbedtls_aes_context *ctx){
+static int st_restore_context(mbedtls_aes_context *ctx){
     uint32_t tickstart;
     tickstart = HAL_GetTick();
     while((ctx->hcryp_aes.Instance->SR & AES_SR_BUSY) != 0){
@@ -163,6 +162,7 @@ static int st_cbc_restore_context(mbedtls_aes_context *ctx){
     return 0;
 }
 
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
 static int st_hal_cryp_cbc( mbedtls_aes_context *ctx, uint32_t opmode, size_t length, 
                             unsigned char iv[16], uint8_t *input, uint8_t *output) 
 {
@@ -181,8 +181,9 @@ static int st_hal_cryp_cbc( mbedtls_aes_context *ctx, uint32_t opmode, size_t le
         return ST_ERR_AES_BUSY;
     return 0;
 }
+#endif /* MBEDTLS_CIPHER_MODE_CBC */
 #else /* STM32F4 and STM32F7 */
-static int st_cbc_restore_context(mbedtls_aes_context *ctx){
+static int st_restore_context(mbedtls_aes_context *ctx){
     /* allow multi-instance of CRYP use: restore context for CRYP hw module */
     ctx->hcryp_aes.Instance->CR = ctx->ctx_save_cr;
     /* Re-initialize AES processor with proper parameters
@@ -196,6 +197,7 @@ static int st_cbc_restore_context(mbedtls_aes_context *ctx){
 
 #endif /* TARGET_STM32L486xG || TARGET_STM32L443xC */
 
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
 int mbedtls_aes_crypt_cbc( mbedtls_aes_context *ctx,
                     int mode,
                     size_t length,
@@ -208,7 +210,7 @@ int mbedtls_aes_crypt_cbc( mbedtls_aes_context *ctx,
     if( length % 16 )
         return( MBEDTLS_ERR_AES_INVALID_INPUT_LENGTH );
     ctx->hcryp_aes.Init.pInitVect = &iv[0];
-    if (st_cbc_restore_context(ctx) != 0)
+    if (st_restore_context(ctx) != 0)
         return (ST_ERR_AES_BUSY);
 
 #if defined (TARGET_STM32L486xG) || defined (TARGET_STM32L443xC)
@@ -373,6 +375,59 @@ int mbedtls_aes_crypt_ctr( mbedtls_aes_context *ctx,
 }
 #endif /* MBEDTLS_CIPHER_MODE_CTR */
 
+#if defined(MBEDTLS_AES_CTR_KEYSTREAM_ALT)
+/* Largest multiple of 16 bytes the HAL processes per call */
+#define ST_AES_CTR_MAX_BLOCKS   (0xFFFF / 16)
+
+int mbedtls_aes_ctr_keystream( mbedtls_aes_context *ctx,
+                               size_t blocks,
+                               unsigned char nonce_counter[16],
+                               unsigned char *stream )
+{
+    uint32_t low;
+    size_t n;
+    int i;
+
+    /* the keystream is the encryption of zeros in CTR mode */
+    memset( stream, 0, blocks * 16 );
+
+    while( blocks > 0 ) {
+        n = ( blocks < ST_AES_CTR_MAX_BLOCKS ) ? blocks : ST_AES_CTR_MAX_BLOCKS;
+
+        /* the crypto processor only increments the low 32 bits of the
+           counter: stop where they wrap and carry into the nonce below */
+        low = ( (uint32_t) nonce_counter[12] << 24 ) | ( (uint32_t) nonce_counter[13] << 16 ) |
+              ( (uint32_t) nonce_counter[14] <<  8 ) | ( (uint32_t) nonce_counter[15] );
+        if( n - 1 > 0xFFFFFFFF - low )
+            n = 0xFFFFFFFF - low + 1;
+
+        ctx->hcryp_aes.Init.pInitVect = nonce_counter;
+        if (st_restore_context(ctx) != 0)
+            return ST_ERR_AES_BUSY;
+        if (HAL_CRYP_AESCTR_Encrypt(&ctx->hcryp_aes, stream, n * 16, stream, 10) != HAL_OK)
+            return ST_ERR_AES_BUSY;
+        /* allow multi-instance of CRYP use: save context for CRYP HW module CR */
+        ctx->ctx_save_cr = ctx->hcryp_aes.Instance->CR;
+
+        low += (uint32_t) n;
+        nonce_counter[12] = (unsigned char)( low >> 24 );
+        nonce_counter[13] = (unsigned char)( low >> 16 );
+        nonce_counter[14] = (unsigned char)( low >>  8 );
+        nonce_counter[15] = (unsigned char)( low       );
+        if( low == 0 ) {
+            for( i = 12; i > 0; i-- )
+                if( ++nonce_counter[i - 1] != 0 )
+                    break;
+        }
+
+        blocks -= n;
+        stream += n * 16;
+    }
+
+    return( 0 );
+}
+#endif /* MBEDTLS_AES_CTR_KEYSTREAM_ALT */
+
 int mbedtls_internal_aes_encrypt( mbedtls_aes_context *ctx,
                           const unsigned char input[16],
                           unsigned char output[16] )
@@ -0,0 +1,191 @@
+/* Host benchmark of AES-CTR keystream generation and AES-GCM
+ *
+ * Reports the throughput of the AES block function, of the multi-block
+ * keystream of mbedtls_aes_ctr_keystream() and of GCM decryption fed in
+ * 16, 256 and 4096 byte chunks, as an OTA download would. Each result is
+ * checked against the block-by-block computation before it is timed.
+ *
+ * The GHASH table size is a build time option, build once for each
+ * configuration from this directory:
+ *
+ *   D=../..
+ *   gcc -O2 -DMBEDTLS_ENTROPY_HARDWARE_ALT -I$D -I$D/inc main.c $D/src/*.c -o gcm_benchmark
+ *   gcc -O2 -DMBEDTLS_ENTROPY_HARDWARE_ALT -DMBEDTLS_GCM_LARGE_TABLE -I$D -I$D/inc main.c $D/src/*.c -o gcm_benchmark_large
+ *   ./gcm_benchmark && ./gcm_benchmark_large
+ *
+ * Copyright (c) 2018 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "mbedtls/aes.h"
+#include "mbedtls/gcm.h"
+
+#define BUFFER_SIZE     (4096)
+#define MIN_TIME        (0.5)
+
+static unsigned char key[32];
+static unsigned char iv[12];
+static unsigned char plain[BUFFER_SIZE];
+static unsigned char cipher[BUFFER_SIZE];
+static unsigned char buf[BUFFER_SIZE];
+static unsigned char tag[16];
+
+/* Only the GCM and AES modules are used, the entropy source is never polled */
+int mbedtls_hardware_poll(void *data, unsigned char *output, size_t len, size_t *olen)
+{
+    (void)data;
+    memset(output, 0, len);
+    *olen = len;
+    return 0;
+}
+
+static double now(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void report(const char *name, double bytes, double seconds)
+{
+    printf("  %-36s %8.2f MB/s\n", name, bytes / seconds / 1e6);
+}
+
+static int check(int cond, const char *what)
+{
+    if (!cond) {
+        printf("FAIL: %s\n", what);
+        exit(1);
+    }
+    return 0;
+}
+
+static void bench_aes(unsigned int keybits)
+{
+    mbedtls_aes_context aes;
+    unsigned char ctr[16], ref[16], block[16];
+    double t0, t;
+    size_t bytes, i;
+    int k;
+    char name[64];
+
+    mbedtls_aes_init(&aes);
+    check(mbedtls_aes_setkey_enc(&aes, key, keybits) == 0, "setkey");
+
+    /* the keystream must be the encryption of consecutive counters */
+    memset(ctr, 0xff, sizeof(ctr));
+    ctr[0] = 0;
+    ctr[15] = 0xf0;
+    memcpy(ref, ctr, sizeof(ref));
+    check(mbedtls_aes_ctr_keystream(&aes, BUFFER_SIZE / 16, ctr, buf) == 0, "keystream");
+    for (i = 0; i < BUFFER_SIZE; i += 16) {
+        mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_ENCRYPT, ref, block);
+        check(memcmp(block, buf + i, 16) == 0, "keystream block");
+        for (k = 16; k > 0; k--) {
+            if (++ref[k - 1] != 0) {
+                break;
+            }
+        }
+    }
+    check(memcmp(ctr, ref, 16) == 0, "keystream counter");
+
+    bytes = 0;
+    t0 = now();
+    do {
+        for (i = 0; i < BUFFER_SIZE; i += 16) {
+            mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_ENCRYPT, buf + i, buf + i);
+        }
+        bytes += BUFFER_SIZE;
+    } while ((t = now() - t0) < MIN_TIME);
+    snprintf(name, sizeof(name), "AES-%u ECB, per block", keybits);
+    report(name, bytes, t);
+
+    bytes = 0;
+    t0 = now();
+    do {
+        mbedtls_aes_ctr_keystream(&aes, BUFFER_SIZE / 16, ctr, buf);
+        bytes += BUFFER_SIZE;
+    } while ((t = now() - t0) < MIN_TIME);
+    snprintf(name, sizeof(name), "AES-%u CTR keystream", keybits);
+    report(name, bytes, t);
+
+    mbedtls_aes_free(&aes);
+}
+
+static void bench_gcm(unsigned int keybits)
+{
+    static const size_t chunks[] = { 16, 256, BUFFER_SIZE };
+    mbedtls_gcm_context gcm;
+    unsigned char check_tag[16];
+    double t0, t;
+    size_t bytes, c, off;
+    char name[64];
+
+    mbedtls_gcm_init(&gcm);
+    check(mbedtls_gcm_setkey(&gcm, MBEDTLS_CIPHER_ID_AES, key, keybits) == 0, "gcm setkey");
+    check(mbedtls_gcm_crypt_and_tag(&gcm, MBEDTLS_GCM_ENCRYPT, BUFFER_SIZE, iv, sizeof(iv),
+                                    NULL, 0, plain, cipher, sizeof(tag), tag) == 0, "gcm encrypt");
+
+    for (c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        bytes = 0;
+        t0 = now();
+        do {
+            mbedtls_gcm_starts(&gcm, MBEDTLS_GCM_DECRYPT, iv, sizeof(iv), NULL, 0);
+            for (off = 0; off < BUFFER_SIZE; off += chunks[c]) {
+                mbedtls_gcm_update(&gcm, chunks[c], cipher + off, buf + off);
+            }
+            mbedtls_gcm_finish(&gcm, check_tag, sizeof(check_tag));
+            bytes += BUFFER_SIZE;
+        } while ((t = now() - t0) < MIN_TIME);
+
+        check(memcmp(buf, plain, BUFFER_SIZE) == 0, "gcm decrypt");
+        check(memcmp(check_tag, tag, sizeof(tag)) == 0, "gcm tag");
+        snprintf(name, sizeof(name), "AES-%u-GCM decrypt, %u B chunks", keybits, (unsigned)chunks[c]);
+        report(name, bytes, t);
+    }
+
+    mbedtls_gcm_free(&gcm);
+}
+
+int main(void)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(key); i++) {
+        key[i] = (unsigned char)(i * 7 + 1);
+    }
+    for (i = 0; i < sizeof(iv); i++) {
+        iv[i] = (unsigned char)(i * 13 + 5);
+    }
+    for (i = 0; i < sizeof(plain); i++) {
+        plain[i] = (unsigned char)rand();
+    }
+
+    printf("%d-bit GHASH tables, mbedtls_gcm_context %u bytes\n",
+           MBEDTLS_GCM_HTABLE_SIZE == 256 ? 8 : 4, (unsigned)sizeof(mbedtls_gcm_context));
+    check(mbedtls_gcm_self_test(0) == 0, "gcm self test");
+
+    bench_aes(128);
+    bench_aes(256);
+    bench_gcm(128);
+    bench_gcm(256);
+
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,313 @@
+/* Host measurement of the RAM held by a TLS client connection
+ *
+ * Runs an ECDSA handshake between a client and a server over memory pipes,
+ * transfers 8 KB each way and reports the heap still held by the client,
+ * for each maximum fragment length the client can request. The heap is
+ * counted through mbedtls_platform_set_calloc_free(). This is the host
+ * counterpart of TESTS/mbedtls/ssl_buffers, which reports the same values
+ * from the mbed heap statistics on a target.
+ *
+ * The buffer sizes are build time options, build once for each
+ * configuration from this directory:
+ *
+ *   D=../..
+ *   F="-O2 -DMBEDTLS_ENTROPY_HARDWARE_ALT -DMBEDTLS_PLATFORM_MEMORY -I$D -I$D/inc main.c $D/src/*.c"
+ *   gcc $F -o ssl_buffers
+ *   gcc $F -DMBEDTLS_SSL_OUT_CONTENT_LEN=2048 -o ssl_buffers_out
+ *   gcc $F -DMBEDTLS_SSL_OUT_CONTENT_LEN=2048 -DMBEDTLS_SSL_VARIABLE_BUFFER_LENGTH -o ssl_buffers_variable
+ *   ./ssl_buffers && ./ssl_buffers_out && ./ssl_buffers_variable
+ *
+ * Copyright (c) 2018 ARM Limited
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "mbedtls/platform.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/ssl_internal.h"
+#include "mbedtls/certs.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+
+#if !defined(MBEDTLS_PLATFORM_MEMORY)
+#error "build with -DMBEDTLS_PLATFORM_MEMORY"
+#endif
+
+#define TRANSFER_SIZE   (8192)
+
+/* Client and server talk through a pair of memory pipes */
+struct pipe {
+    unsigned char buf[4096];
+    size_t len;
+};
+
+struct end {
+    struct pipe *in;
+    struct pipe *out;
+};
+
+static struct pipe c2s, s2c;
+static struct end client_end = { &s2c, &c2s };
+static struct end server_end = { &c2s, &s2c };
+
+static mbedtls_entropy_context entropy;
+static mbedtls_ctr_drbg_context drbg;
+static mbedtls_x509_crt ca, srv_crt;
+static mbedtls_pk_context srv_key;
+static mbedtls_ssl_config client_conf, server_conf;
+
+static unsigned char tx_buf[TRANSFER_SIZE];
+static unsigned char rx_buf[TRANSFER_SIZE];
+
+/* Bytes currently allocated, each block is prefixed with its size */
+static size_t heap_size;
+
+static void *counting_calloc(size_t n, size_t size)
+{
+    size_t *block;
+
+    if (size != 0 && n > ((size_t)-1 - sizeof(size_t)) / size) {
+        return NULL;
+    }
+    block = calloc(1, sizeof(size_t) + n * size);
+    if (block == NULL) {
+        return NULL;
+    }
+    block[0] = n * size;
+    heap_size += n * size;
+    return block + 1;
+}
+
+static void counting_free(void *ptr)
+{
+    size_t *block = ptr;
+
+    if (block == NULL) {
+        return;
+    }
+    heap_size -= block[-1];
+    free(block - 1);
+}
+
+/* Only the DRBG seed comes from the entropy source, it does not need to be random here */
+int mbedtls_hardware_poll(void *data, unsigned char *output, size_t len, size_t *olen)
+{
+    size_t i;
+
+    (void)data;
+    for (i = 0; i < len; i++) {
+        output[i] = (unsigned char)rand();
+    }
+    *olen = len;
+    return 0;
+}
+
+static int check(int cond, const char *what)
+{
+    if (!cond) {
+        printf("FAIL: %s\n", what);
+        exit(1);
+    }
+    return 0;
+}
+
+static int pipe_send(void *ctx, const unsigned char *buf, size_t len)
+{
+    struct pipe *p = ((struct end *)ctx)->out;
+
+    if (len > sizeof(p->buf) - p->len) {
+        len = sizeof(p->buf) - p->len;
+    }
+    if (len == 0) {
+        return MBEDTLS_ERR_SSL_WANT_WRITE;
+    }
+    memcpy(p->buf + p->len, buf, len);
+    p->len += len;
+    return (int)len;
+}
+
+static int pipe_recv(void *ctx, unsigned char *buf, size_t len)
+{
+    struct pipe *p = ((struct end *)ctx)->in;
+
+    if (p->len == 0) {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+    if (len > p->len) {
+        len = p->len;
+    }
+    memcpy(buf, p->buf, len);
+    memmove(p->buf, p->buf + len, p->len - len);
+    p->len -= len;
+    return (int)len;
+}
+
+static int want(int ret)
+{
+    return ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE;
+}
+
+static void handshake(mbedtls_ssl_context *client, mbedtls_ssl_context *server)
+{
+    int client_ret = MBEDTLS_ERR_SSL_WANT_READ;
+    int server_ret = MBEDTLS_ERR_SSL_WANT_READ;
+
+    while (want(client_ret) || want(server_ret)) {
+        if (client_ret) {
+            client_ret = mbedtls_ssl_handshake(client);
+        }
+        if (server_ret) {
+            server_ret = mbedtls_ssl_handshake(server);
+        }
+    }
+    check(client_ret == 0, "client handshake");
+    check(server_ret == 0, "server handshake");
+}
+
+/* Sends the whole transfer buffer from one end to the other, in records
+ * limited by the sender's fragment length */
+static void transfer(mbedtls_ssl_context *from, mbedtls_ssl_context *to)
+{
+    size_t sent = 0;
+    size_t received = 0;
+    size_t i;
+    int ret;
+
+    for (i = 0; i < sizeof(tx_buf); i++) {
+        tx_buf[i] = (unsigned char)(i * 7 + 3);
+    }
+    memset(rx_buf, 0, sizeof(rx_buf));
+
+    while (received < sizeof(rx_buf)) {
+        ret = mbedtls_ssl_write(from, tx_buf + sent, sizeof(tx_buf) - sent);
+        if (ret > 0) {
+            sent += ret;
+        } else {
+            check(want(ret) || sent == sizeof(tx_buf), "write");
+        }
+
+        ret = mbedtls_ssl_read(to, rx_buf + received, sizeof(rx_buf) - received);
+        if (ret > 0) {
+            received += ret;
+        } else {
+            check(want(ret), "read");
+        }
+    }
+    check(memcmp(tx_buf, rx_buf, sizeof(tx_buf)) == 0, "transfer data");
+}
+
+static void setup_tls(void)
+{
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&drbg);
+    check(mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy, NULL, 0) == 0, "drbg seed");
+
+    mbedtls_x509_crt_init(&ca);
+    mbedtls_x509_crt_init(&srv_crt);
+    mbedtls_pk_init(&srv_key);
+    check(mbedtls_x509_crt_parse(&ca, (const unsigned char *)mbedtls_test_cas_pem,
+                                 mbedtls_test_cas_pem_len) == 0, "ca parse");
+    check(mbedtls_x509_crt_parse(&srv_crt, (const unsigned char *)mbedtls_test_srv_crt_ec,
+                                 mbedtls_test_srv_crt_ec_len) == 0, "server certificate parse");
+    check(mbedtls_pk_parse_key(&srv_key, (const unsigned char *)mbedtls_test_srv_key_ec,
+                               mbedtls_test_srv_key_ec_len, NULL, 0) == 0, "server key parse");
+
+    mbedtls_ssl_config_init(&server_conf);
+    check(mbedtls_ssl_config_defaults(&server_conf, MBEDTLS_SSL_IS_SERVER,
+                                      MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT) == 0,
+          "server config");
+    mbedtls_ssl_conf_rng(&server_conf, mbedtls_ctr_drbg_random, &drbg);
+    check(mbedtls_ssl_conf_own_cert(&server_conf, &srv_crt, &srv_key) == 0, "server certificate");
+
+    mbedtls_ssl_config_init(&client_conf);
+    check(mbedtls_ssl_config_defaults(&client_conf, MBEDTLS_SSL_IS_CLIENT,
+                                      MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT) == 0,
+          "client config");
+    mbedtls_ssl_conf_rng(&client_conf, mbedtls_ctr_drbg_random, &drbg);
+    mbedtls_ssl_conf_ca_chain(&client_conf, &ca, NULL);
+    mbedtls_ssl_conf_authmode(&client_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+}
+
+/* Measures the heap held by an established client connection, with the
+ * client requesting the given maximum fragment length */
+static void connection_ram(unsigned char mfl_code, size_t mfl_len)
+{
+    mbedtls_ssl_context client, server;
+    size_t start, setup_size, connection_size;
+    size_t out_len;
+
+    if (mbedtls_ssl_conf_max_frag_len(&client_conf, mfl_code) != 0) {
+        /* Longer than MBEDTLS_SSL_IN_CONTENT_LEN, the client could not receive it */
+        check(mfl_len > MBEDTLS_SSL_IN_CONTENT_LEN, "max fragment length refused");
+        printf("  max fragment length %5u: not supported\n", (unsigned)mfl_len);
+        return;
+    }
+
+    start = heap_size;
+    mbedtls_ssl_init(&client);
+    check(mbedtls_ssl_setup(&client, &client_conf) == 0, "client setup");
+    setup_size = heap_size - start;
+
+    mbedtls_ssl_init(&server);
+    check(mbedtls_ssl_setup(&server, &server_conf) == 0, "server setup");
+    check(mbedtls_ssl_set_hostname(&client, "localhost") == 0, "hostname");
+    mbedtls_ssl_set_bio(&client, &client_end, pipe_send, pipe_recv, NULL);
+    mbedtls_ssl_set_bio(&server, &server_end, pipe_send, pipe_recv, NULL);
+    c2s.len = 0;
+    s2c.len = 0;
+
+    handshake(&client, &server);
+    transfer(&client, &server);
+    transfer(&server, &client);
+
+    out_len = mfl_len < MBEDTLS_SSL_OUT_CONTENT_LEN ? mfl_len : MBEDTLS_SSL_OUT_CONTENT_LEN;
+    check(mbedtls_ssl_get_max_frag_len(&client) == out_len, "client fragment length");
+
+    /* Only the client is left */
+    mbedtls_ssl_free(&server);
+    connection_size = heap_size - start;
+
+    printf("  max fragment length %5u: %6u bytes at setup, %6u bytes per connection\n",
+           (unsigned)mfl_len, (unsigned)setup_size, (unsigned)connection_size);
+
+    mbedtls_ssl_free(&client);
+    check(heap_size == start, "client heap released");
+}
+
+int main(void)
+{
+    mbedtls_platform_set_calloc_free(counting_calloc, counting_free);
+
+    printf("IN_CONTENT_LEN %u, OUT_CONTENT_LEN %u, variable buffer length %s\n",
+           (unsigned)MBEDTLS_SSL_IN_CONTENT_LEN, (unsigned)MBEDTLS_SSL_OUT_CONTENT_LEN,
+#if defined(MBEDTLS_SSL_VARIABLE_BUFFER_LENGTH)
+           "on"
+#else
+           "off"
+#endif
+          );
+
+    setup_tls();
+    connection_ram(MBEDTLS_SSL_MAX_FRAG_LEN_NONE, 16384);
+    connection_ram(MBEDTLS_SSL_MAX_FRAG_LEN_4096, 4096);
+    connection_ram(MBEDTLS_SSL_MAX_FRAG_LEN_2048, 2048);
+    connection_ram(MBEDTLS_SSL_MAX_FRAG_LEN_1024, 1024);
+    connection_ram(MBEDTLS_SSL_MAX_FRAG_LEN_512, 512);
+
+    printf("OK\n");
+    return 0;
+}
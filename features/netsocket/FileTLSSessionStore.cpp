@@ -0,0 +1,141 @@
+/* FileTLSSessionStore
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FileTLSSessionStore.h"
+
+#if defined(MBEDTLS_SSL_CLI_C) && defined(MBEDTLS_GCM_C) && defined(MBEDTLS_AES_C)
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+FileTLSSessionStore::FileTLSSessionStore(const char *prefix)
+    : _prefix(prefix)
+{
+}
+
+FileTLSSessionStore::~FileTLSSessionStore()
+{
+}
+
+char *FileTLSSessionStore::path(int slot)
+{
+    size_t len = strlen(_prefix) + 4;
+    char *path = (char *)malloc(len);
+    if (path) {
+        snprintf(path, len, "%s%d", _prefix, slot);
+    }
+    return path;
+}
+
+nsapi_error_t FileTLSSessionStore::write_slot(int slot, const void *data, size_t size)
+{
+    char *name = path(slot);
+    if (!name) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    nsapi_error_t err = NSAPI_ERROR_OK;
+    FILE *file = fopen(name, "wb");
+    if (!file) {
+        err = NSAPI_ERROR_DEVICE_ERROR;
+    } else {
+        if (fwrite(data, 1, size, file) != size) {
+            err = NSAPI_ERROR_DEVICE_ERROR;
+        }
+        if (fclose(file) != 0) {
+            err = NSAPI_ERROR_DEVICE_ERROR;
+        }
+        if (err) {
+            // Do not leave a truncated record behind
+            ::remove(name);
+        }
+    }
+
+    free(name);
+    return err;
+}
+
+nsapi_error_t FileTLSSessionStore::slot_size(int slot, size_t &size)
+{
+    char *name = path(slot);
+    if (!name) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    nsapi_error_t err = NSAPI_ERROR_OK;
+    FILE *file = fopen(name, "rb");
+    if (!file) {
+        err = NSAPI_ERROR_NO_ADDRESS;
+    } else {
+        long end = -1;
+        if (fseek(file, 0, SEEK_END) == 0) {
+            end = ftell(file);
+        }
+        if (end < 0) {
+            err = NSAPI_ERROR_DEVICE_ERROR;
+        } else if (end == 0) {
+            err = NSAPI_ERROR_NO_ADDRESS;
+        } else {
+            size = end;
+        }
+        fclose(file);
+    }
+
+    free(name);
+    return err;
+}
+
+nsapi_error_t FileTLSSessionStore::read_slot(int slot, void *data, size_t size)
+{
+    char *name = path(slot);
+    if (!name) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    nsapi_error_t err = NSAPI_ERROR_OK;
+    FILE *file = fopen(name, "rb");
+    if (!file) {
+        err = NSAPI_ERROR_NO_ADDRESS;
+    } else {
+        if (fread(data, 1, size, file) != size) {
+            err = NSAPI_ERROR_NO_ADDRESS;
+        }
+        fclose(file);
+    }
+
+    free(name);
+    return err;
+}
+
+nsapi_error_t FileTLSSessionStore::erase_slot(int slot)
+{
+    char *name = path(slot);
+    if (!name) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    nsapi_error_t err = NSAPI_ERROR_OK;
+    if (::remove(name) != 0 && errno != ENOENT) {
+        err = NSAPI_ERROR_DEVICE_ERROR;
+    }
+
+    free(name);
+    return err;
+}
+
+#endif
@@ -0,0 +1,63 @@
+
+/** \addtogroup netsocket */
+/** @{*/
+/* FileTLSSessionStore
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FILE_TLS_SESSION_STORE_H
+#define FILE_TLS_SESSION_STORE_H
+
+#include "netsocket/TLSSessionStore.h"
+
+#if defined(MBEDTLS_SSL_CLI_C) && defined(MBEDTLS_GCM_C) && defined(MBEDTLS_AES_C)
+
+/** TLS session store kept in files
+ *
+ *  Uses one file per slot, named after a path prefix followed by the slot
+ *  number, for example "/fs/tls0", "/fs/tls1"... on a mounted file system.
+ */
+class FileTLSSessionStore : public TLSSessionStore {
+public:
+    /** Create a session store in files
+     *
+     *  @param prefix   Path prefix of the files, the string is not copied
+     *                  and must outlive the store
+     */
+    FileTLSSessionStore(const char *prefix);
+
+    /** Destroy a session store
+     *
+     *  The saved sessions are kept in the files.
+     */
+    virtual ~FileTLSSessionStore();
+
+protected:
+    virtual nsapi_error_t write_slot(int slot, const void *data, size_t size);
+    virtual nsapi_error_t slot_size(int slot, size_t &size);
+    virtual nsapi_error_t read_slot(int slot, void *data, size_t size);
+    virtual nsapi_error_t erase_slot(int slot);
+
+private:
+    char *path(int slot);
+
+    const char *_prefix;
+};
+
+#endif
+
+#endif
+
+/** @}*/
@@ -0,0 +1,84 @@
+/* NVStoreTLSSessionStore
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NVStoreTLSSessionStore.h"
+
+#if defined(MBEDTLS_SSL_CLI_C) && defined(MBEDTLS_GCM_C) && defined(MBEDTLS_AES_C) && NVSTORE_ENABLED
+
+static nsapi_error_t nvstore_error(int ret)
+{
+    switch (ret) {
+        case NVSTORE_SUCCESS:
+            return NSAPI_ERROR_OK;
+        case NVSTORE_NOT_FOUND:
+        case NVSTORE_DATA_CORRUPT:
+            return NSAPI_ERROR_NO_ADDRESS;
+        case NVSTORE_BAD_VALUE:
+        case NVSTORE_BUFF_TOO_SMALL:
+            return NSAPI_ERROR_PARAMETER;
+        case NVSTORE_FLASH_AREA_TOO_SMALL:
+            return NSAPI_ERROR_NO_MEMORY;
+        default:
+            return NSAPI_ERROR_DEVICE_ERROR;
+    }
+}
+
+NVStoreTLSSessionStore::NVStoreTLSSessionStore(uint16_t base_key)
+    : _base_key(base_key)
+{
+}
+
+NVStoreTLSSessionStore::~NVStoreTLSSessionStore()
+{
+}
+
+nsapi_error_t NVStoreTLSSessionStore::write_slot(int slot, const void *data, size_t size)
+{
+    if (size > 0xFFFF) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+    return nvstore_error(NVStore::get_instance().set(_base_key + slot, size, data));
+}
+
+nsapi_error_t NVStoreTLSSessionStore::slot_size(int slot, size_t &size)
+{
+    uint16_t actual_size = 0;
+    int ret = NVStore::get_instance().get_item_size(_base_key + slot, actual_size);
+    size = actual_size;
+    return nvstore_error(ret);
+}
+
+nsapi_error_t NVStoreTLSSessionStore::read_slot(int slot, void *data, size_t size)
+{
+    uint16_t actual_size = 0;
+    int ret = NVStore::get_instance().get(_base_key + slot, size, data, actual_size);
+    if (ret == NVSTORE_SUCCESS && actual_size != size) {
+        // Rewritten since slot_size
+        return NSAPI_ERROR_NO_ADDRESS;
+    }
+    return nvstore_error(ret);
+}
+
+nsapi_error_t NVStoreTLSSessionStore::erase_slot(int slot)
+{
+    int ret = NVStore::get_instance().remove(_base_key + slot);
+    if (ret == NVSTORE_NOT_FOUND) {
+        return NSAPI_ERROR_OK;
+    }
+    return nvstore_error(ret);
+}
+
+#endif
@@ -0,0 +1,81 @@
+
+/** \addtogroup netsocket */
+/** @{*/
+/* NVStoreTLSSessionStore
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NVSTORE_TLS_SESSION_STORE_H
+#define NVSTORE_TLS_SESSION_STORE_H
+
+#include "netsocket/TLSSessionStore.h"
+#include "nvstore.h"
+
+#if defined(MBEDTLS_SSL_CLI_C) && defined(MBEDTLS_GCM_C) && defined(MBEDTLS_AES_C) && NVSTORE_ENABLED
+
+/* set by nsapi.tls-session-store-base-key */
+#ifndef MBED_CONF_NSAPI_TLS_SESSION_STORE_BASE_KEY
+#define MBED_CONF_NSAPI_TLS_SESSION_STORE_BASE_KEY 9
+#endif
+
+#if (MBED_CONF_NSAPI_TLS_SESSION_STORE_BASE_KEY + MBED_CONF_NSAPI_TLS_SESSION_STORE_SLOTS) > NVSTORE_MAX_KEYS
+#error "nvstore.max_keys is too small to hold the TLS session store"
+#endif
+
+#if defined(BLE_SECURITY_DB_NVSTORE_BASE_KEY) && defined(BLE_SECURITY_DB_MAX_ENTRIES) && \
+    (BLE_SECURITY_DB_NVSTORE_BASE_KEY < MBED_CONF_NSAPI_TLS_SESSION_STORE_BASE_KEY + MBED_CONF_NSAPI_TLS_SESSION_STORE_SLOTS) && \
+    (MBED_CONF_NSAPI_TLS_SESSION_STORE_BASE_KEY < BLE_SECURITY_DB_NVSTORE_BASE_KEY + 1 + BLE_SECURITY_DB_MAX_ENTRIES)
+#error "ble.security-db-nvstore-base-key and nsapi.tls-session-store-base-key use the same NVStore keys"
+#endif
+
+/** TLS session store kept in NVStore
+ *
+ *  Uses one NVStore key per slot, starting at a base key given at
+ *  construction. The keys must not be shared with other NVStore users, the
+ *  default range, nsapi.tls-session-store-base-key, follows the keys of the
+ *  BLE security database.
+ */
+class NVStoreTLSSessionStore : public TLSSessionStore {
+public:
+    /** Create a session store in NVStore
+     *
+     *  nvstore.max_keys must be at least
+     *  base_key + nsapi.tls-session-store-slots.
+     *
+     *  @param base_key First NVStore key used by the store
+     */
+    NVStoreTLSSessionStore(uint16_t base_key = MBED_CONF_NSAPI_TLS_SESSION_STORE_BASE_KEY);
+
+    /** Destroy a session store
+     *
+     *  The saved sessions are kept in NVStore.
+     */
+    virtual ~NVStoreTLSSessionStore();
+
+protected:
+    virtual nsapi_error_t write_slot(int slot, const void *data, size_t size);
+    virtual nsapi_error_t slot_size(int slot, size_t &size);
+    virtual nsapi_error_t read_slot(int slot, void *data, size_t size);
+    virtual nsapi_error_t erase_slot(int slot);
+
+private:
+    uint16_t _base_key;
+};
+
+#endif
+
+#endif
+
+/** @}*/
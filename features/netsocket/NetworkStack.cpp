@@ -60,6 +60,51 @@ nsapi_error_t NetworkStack::getstackopt(int level, int optname, void *optval, un
     return NSAPI_ERROR_UNSUPPORTED;
 }
 
+nsapi_size_or_error_t NetworkStack::socket_sendto_batch(nsapi_socket_t handle, nsapi_dgram_t *msgs, unsigned count)
+{
+    unsigned sent = 0;
+
+    while (sent < count) {
+        nsapi_dgram_t *msg = &msgs[sent];
+        msg->result = socket_sendto(handle, SocketAddress(msg->addr, msg->port), msg->data, msg->size);
+        if (msg->result < 0) {
+            break;
+        }
+
+        sent++;
+    }
+
+    if (sent == 0 && count > 0) {
+        return msgs[0].result;
+    }
+
+    return sent;
+}
+
+nsapi_size_or_error_t NetworkStack::socket_recvfrom_batch(nsapi_socket_t handle, nsapi_dgram_t *msgs, unsigned count)
+{
+    unsigned received = 0;
+
+    while (received < count) {
+        nsapi_dgram_t *msg = &msgs[received];
+        SocketAddress address;
+        msg->result = socket_recvfrom(handle, &address, msg->data, msg->size);
+        if (msg->result < 0) {
+            break;
+        }
+
+        msg->addr = address.get_addr();
+        msg->port = address.get_port();
+        received++;
+    }
+
+    if (received == 0 && count > 0) {
+        return msgs[0].result;
+    }
+
+    return received;
+}
+
 nsapi_error_t NetworkStack::setsockopt(void *handle, int level, int optname, const void *optval, unsigned optlen)
 {
     return NSAPI_ERROR_UNSUPPORTED;
@@ -249,6 +294,24 @@ protected:
         return err;
     }
 
+    virtual nsapi_size_or_error_t socket_sendto_batch(nsapi_socket_t socket, nsapi_dgram_t *msgs, unsigned count)
+    {
+        if (!_stack_api()->socket_sendto_batch) {
+            return NetworkStack::socket_sendto_batch(socket, msgs, count);
+        }
+
+        return _stack_api()->socket_sendto_batch(_stack(), socket, msgs, count);
+    }
+
+    virtual nsapi_size_or_error_t socket_recvfrom_batch(nsapi_socket_t socket, nsapi_dgram_t *msgs, unsigned count)
+    {
+        if (!_stack_api()->socket_recvfrom_batch) {
+            return NetworkStack::socket_recvfrom_batch(socket, msgs, count);
+        }
+
+        return _stack_api()->socket_recvfrom_batch(_stack(), socket, msgs, count);
+    }
+
     virtual void socket_attach(nsapi_socket_t socket, void (*callback)(void *), void *data)
     {
         if (!_stack_api()->socket_attach) {
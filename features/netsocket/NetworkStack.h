@@ -253,6 +253,47 @@ protected:
     virtual nsapi_size_or_error_t socket_recvfrom(nsapi_socket_t handle, SocketAddress *address,
             void *buffer, nsapi_size_t size) = 0;
 
+    /** Send a batch of packets over a UDP socket
+     *
+     *  Sends each datagram in msgs in order, stopping at the first failure.
+     *  The result of each attempted datagram is stored in its result field.
+     *
+     *  The default implementation calls socket_sendto for each datagram.
+     *  Stacks that can submit several datagrams with one handoff to their
+     *  stack thread should override this.
+     *
+     *  This call is non-blocking. If the first sendto would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param handle   Socket handle
+     *  @param msgs     Array of datagrams to send
+     *  @param count    Number of datagrams in msgs
+     *  @return         Number of datagrams sent on success, negative error
+     *                  code if no datagram could be sent
+     */
+    virtual nsapi_size_or_error_t socket_sendto_batch(nsapi_socket_t handle,
+            nsapi_dgram_t *msgs, unsigned count);
+
+    /** Receive a batch of packets over a UDP socket
+     *
+     *  Receives up to count datagrams that are already pending on the
+     *  socket, filling in the address, port and result of each one.
+     *
+     *  The default implementation calls socket_recvfrom until it would
+     *  block or count datagrams have been received.
+     *
+     *  This call is non-blocking. If no datagram is pending,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param handle   Socket handle
+     *  @param msgs     Array of destination buffers for received datagrams
+     *  @param count    Number of entries in msgs
+     *  @return         Number of datagrams received on success, negative
+     *                  error code if no datagram could be received
+     */
+    virtual nsapi_size_or_error_t socket_recvfrom_batch(nsapi_socket_t handle,
+            nsapi_dgram_t *msgs, unsigned count);
+
     /** Register a callback on state change of the socket
      *
      *  The specified callback will be called on state changes such as when
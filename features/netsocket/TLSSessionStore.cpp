@@ -0,0 +1,428 @@
+/* TLSSessionStore
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "TLSSessionStore.h"
+
+#if defined(MBEDTLS_SSL_CLI_C) && defined(MBEDTLS_GCM_C) && defined(MBEDTLS_AES_C)
+
+#include <stdlib.h>
+#include <string.h>
+#if defined(MBEDTLS_HAVE_TIME)
+#include "mbedtls/platform_time.h"
+#endif
+
+// Record: version | nonce | encrypted session | tag
+// The version is authenticated as additional data, so records of another
+// format or written with another key both fail to decrypt.
+#define TLS_SESSION_STORE_VERSION       1
+#define TLS_SESSION_STORE_NONCE_SIZE    12
+#define TLS_SESSION_STORE_TAG_SIZE      16
+#define TLS_SESSION_STORE_HEADER_SIZE   (1 + TLS_SESSION_STORE_NONCE_SIZE)
+#define TLS_SESSION_STORE_OVERHEAD      (TLS_SESSION_STORE_HEADER_SIZE + TLS_SESSION_STORE_TAG_SIZE)
+
+// Session, all fields present whatever the configuration so that a record
+// stays readable after a change of the TLS options:
+// hostname length (1) | hostname | start (8) | ciphersuite (2) |
+// compression (1) | id length (1) | id (32) | master (48) |
+// verify result (4) | mfl code (1) | truncated hmac (1) |
+// encrypt then mac (1) | certificate length (3) | certificate |
+// ticket lifetime (4) | ticket length (3) | ticket
+#define TLS_SESSION_STORE_FIXED_SIZE    (1 + 8 + 2 + 1 + 1 + 32 + 48 + 4 + 1 + 1 + 1 + 3 + 4 + 3)
+
+/* Implementation that should never be optimized out by the compiler */
+static void zeroize(void *v, size_t n)
+{
+    volatile unsigned char *p = (volatile unsigned char *)v;
+    while (n--) {
+        *p++ = 0;
+    }
+}
+
+static unsigned char *put_be(unsigned char *p, uint64_t value, int bytes)
+{
+    for (int i = bytes - 1; i >= 0; i--) {
+        *p++ = (unsigned char)(value >> (8 * i));
+    }
+    return p;
+}
+
+static const unsigned char *get_be(const unsigned char *p, uint64_t &value, int bytes)
+{
+    value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value = (value << 8) | *p++;
+    }
+    return p;
+}
+
+static nsapi_error_t ssl_error(int ret)
+{
+    switch (ret) {
+        case 0:
+            return NSAPI_ERROR_OK;
+        case MBEDTLS_ERR_SSL_ALLOC_FAILED:
+            return NSAPI_ERROR_NO_MEMORY;
+        case MBEDTLS_ERR_SSL_BAD_INPUT_DATA:
+            return NSAPI_ERROR_PARAMETER;
+        default:
+            return NSAPI_ERROR_DEVICE_ERROR;
+    }
+}
+
+TLSSessionStore::TLSSessionStore()
+    : _f_rng(0), _p_rng(0)
+{
+    mbedtls_gcm_init(&_gcm);
+}
+
+TLSSessionStore::~TLSSessionStore()
+{
+    mbedtls_gcm_free(&_gcm);
+}
+
+nsapi_error_t TLSSessionStore::setup(const unsigned char *key, unsigned int key_bits,
+                                     int (*f_rng)(void *, unsigned char *, size_t), void *p_rng)
+{
+    if (!key || !f_rng) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    _mutex.lock();
+    int ret = mbedtls_gcm_setkey(&_gcm, MBEDTLS_CIPHER_ID_AES, key, key_bits);
+    if (ret == 0) {
+        _f_rng = f_rng;
+        _p_rng = p_rng;
+    } else {
+        _f_rng = 0;
+    }
+    _mutex.unlock();
+
+    return ret == 0 ? NSAPI_ERROR_OK : NSAPI_ERROR_PARAMETER;
+}
+
+int TLSSessionStore::find_slot(const char *hostname)
+{
+    // djb2, host names of a device are few so any spread will do
+    uint32_t hash = 5381;
+    for (const unsigned char *p = (const unsigned char *)hostname; *p; p++) {
+        hash = (hash << 5) + hash + *p;
+    }
+    return hash % MBED_CONF_NSAPI_TLS_SESSION_STORE_SLOTS;
+}
+
+size_t TLSSessionStore::session_size(const char *hostname, const mbedtls_ssl_session *session)
+{
+    size_t size = TLS_SESSION_STORE_FIXED_SIZE + strlen(hostname);
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    if (session->peer_cert) {
+        size += session->peer_cert->raw.len;
+    }
+#endif
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    if (session->ticket) {
+        size += session->ticket_len;
+    }
+#endif
+    return size;
+}
+
+void TLSSessionStore::write_session(unsigned char *p, const char *hostname, const mbedtls_ssl_session *session)
+{
+    size_t hostname_len = strlen(hostname);
+    uint64_t start = 0;
+    unsigned char mfl_code = 0;
+    unsigned char trunc_hmac = 0;
+    unsigned char encrypt_then_mac = 0;
+    const unsigned char *cert = 0;
+    size_t cert_len = 0;
+    uint32_t ticket_lifetime = 0;
+    const unsigned char *ticket = 0;
+    size_t ticket_len = 0;
+
+#if defined(MBEDTLS_HAVE_TIME)
+    start = (uint64_t)session->start;
+#endif
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    mfl_code = session->mfl_code;
+#endif
+#if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
+    trunc_hmac = session->trunc_hmac;
+#endif
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+    encrypt_then_mac = session->encrypt_then_mac;
+#endif
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    if (session->peer_cert) {
+        cert = session->peer_cert->raw.p;
+        cert_len = session->peer_cert->raw.len;
+    }
+#endif
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    if (session->ticket) {
+        ticket = session->ticket;
+        ticket_len = session->ticket_len;
+        ticket_lifetime = session->ticket_lifetime;
+    }
+#endif
+
+    *p++ = hostname_len;
+    memcpy(p, hostname, hostname_len);
+    p += hostname_len;
+    p = put_be(p, start, 8);
+    p = put_be(p, session->ciphersuite, 2);
+    *p++ = session->compression;
+    *p++ = session->id_len;
+    memcpy(p, session->id, 32);
+    p += 32;
+    memcpy(p, session->master, 48);
+    p += 48;
+    p = put_be(p, session->verify_result, 4);
+    *p++ = mfl_code;
+    *p++ = trunc_hmac;
+    *p++ = encrypt_then_mac;
+    p = put_be(p, cert_len, 3);
+    if (cert_len) {
+        memcpy(p, cert, cert_len);
+        p += cert_len;
+    }
+    p = put_be(p, ticket_lifetime, 4);
+    p = put_be(p, ticket_len, 3);
+    if (ticket_len) {
+        memcpy(p, ticket, ticket_len);
+    }
+}
+
+nsapi_error_t TLSSessionStore::read_session(const unsigned char *p, size_t len, const char *hostname,
+                                            mbedtls_ssl_context *ssl)
+{
+    const unsigned char *end = p + len;
+    size_t hostname_len = strlen(hostname);
+    uint64_t value;
+
+    if (len < TLS_SESSION_STORE_FIXED_SIZE || p[0] != hostname_len ||
+            len < TLS_SESSION_STORE_FIXED_SIZE + hostname_len ||
+            memcmp(p + 1, hostname, hostname_len) != 0) {
+        // Evicted by another host
+        return NSAPI_ERROR_NO_ADDRESS;
+    }
+    p += 1 + hostname_len;
+
+    mbedtls_ssl_session session;
+    memset(&session, 0, sizeof(session));
+
+    p = get_be(p, value, 8);
+#if defined(MBEDTLS_HAVE_TIME)
+    session.start = (mbedtls_time_t)value;
+#endif
+    p = get_be(p, value, 2);
+    session.ciphersuite = value;
+    session.compression = *p++;
+    session.id_len = *p++;
+    if (session.id_len > 32) {
+        return NSAPI_ERROR_NO_ADDRESS;
+    }
+    memcpy(session.id, p, 32);
+    p += 32;
+    memcpy(session.master, p, 48);
+    p += 48;
+    p = get_be(p, value, 4);
+    session.verify_result = value;
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    session.mfl_code = p[0];
+#endif
+#if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
+    session.trunc_hmac = p[1];
+#endif
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+    session.encrypt_then_mac = p[2];
+#endif
+    p += 3;
+
+    // Only the raw certificate is used when the session is copied into the
+    // context, so it is parsed once, there
+    p = get_be(p, value, 3);
+    size_t cert_len = value;
+    if ((size_t)(end - p) < cert_len + 7) {
+        zeroize(session.master, sizeof(session.master));
+        return NSAPI_ERROR_NO_ADDRESS;
+    }
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+    mbedtls_x509_crt cert;
+    if (cert_len) {
+        mbedtls_x509_crt_init(&cert);
+        cert.raw.p = (unsigned char *)p;
+        cert.raw.len = cert_len;
+        session.peer_cert = &cert;
+    }
+#endif
+    p += cert_len;
+
+    p = get_be(p, value, 4);
+    uint32_t ticket_lifetime = value;
+    p = get_be(p, value, 3);
+    size_t ticket_len = value;
+    if ((size_t)(end - p) < ticket_len) {
+        zeroize(session.master, sizeof(session.master));
+        return NSAPI_ERROR_NO_ADDRESS;
+    }
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    if (ticket_len) {
+        session.ticket = (unsigned char *)p;
+        session.ticket_len = ticket_len;
+        session.ticket_lifetime = ticket_lifetime;
+    }
+#endif
+
+    nsapi_error_t err = NSAPI_ERROR_OK;
+#if defined(MBEDTLS_HAVE_TIME)
+    // The server would refuse an expired ticket, save the round trip
+    mbedtls_time_t now = mbedtls_time(NULL);
+    if (ticket_len && ticket_lifetime && now >= session.start &&
+            (uint64_t)(now - session.start) > ticket_lifetime) {
+        err = NSAPI_ERROR_NO_ADDRESS;
+    }
+#endif
+#if !defined(MBEDTLS_SSL_SESSION_TICKETS)
+    // A ticket session without its ticket has no session ID to resume with
+    if (ticket_len && session.id_len == 0) {
+        err = NSAPI_ERROR_NO_ADDRESS;
+    }
+#endif
+
+    if (err == NSAPI_ERROR_OK) {
+        int ret = mbedtls_ssl_set_session(ssl, &session);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+        // A failed copy can leave the context pointing at our ticket
+        if (ret != 0 && ssl->session_negotiate && ssl->session_negotiate->ticket == session.ticket) {
+            ssl->session_negotiate->ticket = NULL;
+            ssl->session_negotiate->ticket_len = 0;
+        }
+#endif
+        err = ssl_error(ret);
+    }
+
+    // Certificate and ticket point into the record, only the secret is cleared
+    zeroize(session.master, sizeof(session.master));
+    return err;
+}
+
+nsapi_error_t TLSSessionStore::save(const char *hostname, const mbedtls_ssl_context *ssl)
+{
+    if (!hostname || !ssl || !ssl->session || strlen(hostname) > 255) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    size_t len = session_size(hostname, ssl->session);
+    unsigned char *record = (unsigned char *)malloc(TLS_SESSION_STORE_OVERHEAD + len);
+    if (!record) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+
+    unsigned char *nonce = record + 1;
+    unsigned char *data = record + TLS_SESSION_STORE_HEADER_SIZE;
+    record[0] = TLS_SESSION_STORE_VERSION;
+    write_session(data, hostname, ssl->session);
+
+    nsapi_error_t err = NSAPI_ERROR_OK;
+    _mutex.lock();
+    if (!_f_rng) {
+        err = NSAPI_ERROR_PARAMETER;
+    } else if (_f_rng(_p_rng, nonce, TLS_SESSION_STORE_NONCE_SIZE) != 0 ||
+               mbedtls_gcm_crypt_and_tag(&_gcm, MBEDTLS_GCM_ENCRYPT, len,
+                                         nonce, TLS_SESSION_STORE_NONCE_SIZE, record, 1,
+                                         data, data, TLS_SESSION_STORE_TAG_SIZE, data + len) != 0) {
+        err = NSAPI_ERROR_DEVICE_ERROR;
+    }
+    _mutex.unlock();
+
+    if (err == NSAPI_ERROR_OK) {
+        err = write_slot(find_slot(hostname), record, TLS_SESSION_STORE_OVERHEAD + len);
+    } else {
+        // Encryption failed, the plaintext is still there
+        zeroize(data, len);
+    }
+
+    free(record);
+    return err;
+}
+
+nsapi_error_t TLSSessionStore::resume(const char *hostname, mbedtls_ssl_context *ssl)
+{
+    if (!hostname || !ssl) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    int slot = find_slot(hostname);
+    size_t size;
+    nsapi_error_t err = slot_size(slot, size);
+    if (err) {
+        return err;
+    }
+    if (size <= TLS_SESSION_STORE_OVERHEAD) {
+        return NSAPI_ERROR_NO_ADDRESS;
+    }
+
+    // The session is decrypted in place, between the header and the tag
+    size_t len = size - TLS_SESSION_STORE_OVERHEAD;
+    unsigned char *record = (unsigned char *)malloc(size);
+    if (!record) {
+        return NSAPI_ERROR_NO_MEMORY;
+    }
+    unsigned char *session = record + TLS_SESSION_STORE_HEADER_SIZE;
+
+    err = read_slot(slot, record, size);
+    if (err) {
+        free(record);
+        return err;
+    }
+
+    if (record[0] != TLS_SESSION_STORE_VERSION) {
+        free(record);
+        return NSAPI_ERROR_NO_ADDRESS;
+    }
+
+    _mutex.lock();
+    if (!_f_rng) {
+        err = NSAPI_ERROR_PARAMETER;
+    } else if (mbedtls_gcm_auth_decrypt(&_gcm, len, record + 1, TLS_SESSION_STORE_NONCE_SIZE, record, 1,
+                                        record + size - TLS_SESSION_STORE_TAG_SIZE, TLS_SESSION_STORE_TAG_SIZE,
+                                        session, session) != 0) {
+        // Corrupted, or written with another key
+        err = NSAPI_ERROR_NO_ADDRESS;
+    }
+    _mutex.unlock();
+
+    if (err == NSAPI_ERROR_OK) {
+        err = read_session(session, len, hostname, ssl);
+    }
+
+    zeroize(session, len);
+    free(record);
+    return err;
+}
+
+nsapi_error_t TLSSessionStore::remove(const char *hostname)
+{
+    if (!hostname) {
+        return NSAPI_ERROR_PARAMETER;
+    }
+
+    // The host name is encrypted, so the slot is erased without checking
+    // which host it belongs to
+    return erase_slot(find_slot(hostname));
+}
+
+#endif /* MBEDTLS_SSL_CLI_C && MBEDTLS_GCM_C && MBEDTLS_AES_C */
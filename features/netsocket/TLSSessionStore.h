@@ -0,0 +1,190 @@
+
+/** \addtogroup netsocket */
+/** @{*/
+/* TLSSessionStore
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TLS_SESSION_STORE_H
+#define TLS_SESSION_STORE_H
+
+#if !defined(MBEDTLS_CONFIG_FILE)
+#include "mbedtls/config.h"
+#else
+#include MBEDTLS_CONFIG_FILE
+#endif
+
+#if defined(MBEDTLS_SSL_CLI_C) && defined(MBEDTLS_GCM_C) && defined(MBEDTLS_AES_C)
+
+#include <stddef.h>
+#include "mbedtls/ssl.h"
+#include "mbedtls/gcm.h"
+#include "netsocket/nsapi_types.h"
+#include "platform/NonCopyable.h"
+#include "platform/PlatformMutex.h"
+
+#ifndef MBED_CONF_NSAPI_TLS_SESSION_STORE_SLOTS
+#define MBED_CONF_NSAPI_TLS_SESSION_STORE_SLOTS 4
+#endif
+
+#if MBED_CONF_NSAPI_TLS_SESSION_STORE_SLOTS < 1 || MBED_CONF_NSAPI_TLS_SESSION_STORE_SLOTS > 100
+#error "nsapi.tls-session-store-slots must be between 1 and 100"
+#endif
+
+/** Persistent store of client TLS sessions
+ *
+ *  Keeps the state of established TLS sessions across reboots, so that a
+ *  client can attempt an abbreviated handshake (session ID or session ticket
+ *  resumption) instead of a full key exchange and certificate verification
+ *  after power-down.
+ *
+ *  Sessions are kept per host name in a small number of slots
+ *  (nsapi.tls-session-store-slots), a new session for a host replaces the
+ *  previous one and a host mapping to an occupied slot evicts its session.
+ *  Every record is encrypted and authenticated with AES-GCM using a key
+ *  provided by the application, so the master secrets are never stored in
+ *  the clear.
+ *
+ *  Subclasses provide the storage of the records, see NVStoreTLSSessionStore
+ *  and FileTLSSessionStore.
+ *
+ *  Usage with a client mbedtls_ssl_context:
+ *  @code
+ *  store.setup(key, 128, mbedtls_ctr_drbg_random, &drbg);
+ *  ...
+ *  mbedtls_ssl_setup(&ssl, &conf);
+ *  mbedtls_ssl_set_hostname(&ssl, host);
+ *  store.resume(host, &ssl);          // no error if there is no session
+ *  ret = mbedtls_ssl_handshake(&ssl);
+ *  if (ret == 0) {
+ *      store.save(host, &ssl);
+ *  }
+ *  @endcode
+ */
+class TLSSessionStore : private mbed::NonCopyable<TLSSessionStore> {
+public:
+    /** Create a session store
+     *
+     *  Must call setup before sessions can be saved or resumed.
+     */
+    TLSSessionStore();
+
+    /** Destroy a session store
+     */
+    virtual ~TLSSessionStore();
+
+    /** Set the key and the random generator used to protect the records
+     *
+     *  The key must be the same after every reboot, for example derived
+     *  from a device unique secret. Records written with another key are
+     *  ignored.
+     *
+     *  @param key      AES key
+     *  @param key_bits Key size, 128, 192 or 256
+     *  @param f_rng    Random generator, used for the record nonces
+     *  @param p_rng    Random generator context
+     *  @return         0 on success, negative error code on failure
+     */
+    nsapi_error_t setup(const unsigned char *key, unsigned int key_bits,
+                        int (*f_rng)(void *, unsigned char *, size_t), void *p_rng);
+
+    /** Save the session of a client context
+     *
+     *  Call after a successful handshake. Saving a resumed session refreshes
+     *  the record, for example with a new session ticket.
+     *
+     *  @param hostname Host name the session was established with
+     *  @param ssl      Client SSL context with a completed handshake
+     *  @return         0 on success, negative error code on failure
+     */
+    nsapi_error_t save(const char *hostname, const mbedtls_ssl_context *ssl);
+
+    /** Set the saved session of a host on a client context
+     *
+     *  Call after mbedtls_ssl_setup and before mbedtls_ssl_handshake. The
+     *  handshake then attempts to resume the session and falls back to a
+     *  full handshake if the server refuses.
+     *
+     *  @param hostname Host name to find the session of
+     *  @param ssl      Client SSL context
+     *  @return         0 on success, NSAPI_ERROR_NO_ADDRESS if there is no
+     *                  usable session for the host, negative error code on
+     *                  failure
+     */
+    nsapi_error_t resume(const char *hostname, mbedtls_ssl_context *ssl);
+
+    /** Remove the saved session of a host
+     *
+     *  Erases the slot of the host, which may hold the session of another
+     *  host mapping to the same slot.
+     *
+     *  @param hostname Host name to remove the session of
+     *  @return         0 on success, negative error code on failure
+     */
+    nsapi_error_t remove(const char *hostname);
+
+protected:
+    /** Write a record to a slot, replacing its previous content
+     *
+     *  @param slot     Slot number, less than nsapi.tls-session-store-slots
+     *  @param data     Record
+     *  @param size     Size of the record in bytes
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual nsapi_error_t write_slot(int slot, const void *data, size_t size) = 0;
+
+    /** Get the size of the record in a slot
+     *
+     *  @param slot     Slot number
+     *  @param size     Size of the record in bytes
+     *  @return         0 on success, NSAPI_ERROR_NO_ADDRESS if the slot is
+     *                  empty, negative error code on failure
+     */
+    virtual nsapi_error_t slot_size(int slot, size_t &size) = 0;
+
+    /** Read the record of a slot
+     *
+     *  @param slot     Slot number
+     *  @param data     Buffer of slot_size bytes
+     *  @param size     Size of the buffer in bytes
+     *  @return         0 on success, negative error code on failure
+     */
+    virtual nsapi_error_t read_slot(int slot, void *data, size_t size) = 0;
+
+    /** Remove the record of a slot
+     *
+     *  @param slot     Slot number
+     *  @return         0 on success or if the slot is empty, negative error
+     *                  code on failure
+     */
+    virtual nsapi_error_t erase_slot(int slot) = 0;
+
+private:
+    static int find_slot(const char *hostname);
+    static size_t session_size(const char *hostname, const mbedtls_ssl_session *session);
+    static void write_session(unsigned char *p, const char *hostname, const mbedtls_ssl_session *session);
+    nsapi_error_t read_session(const unsigned char *p, size_t len, const char *hostname, mbedtls_ssl_context *ssl);
+
+    PlatformMutex _mutex;
+    mbedtls_gcm_context _gcm;
+    int (*_f_rng)(void *, unsigned char *, size_t);
+    void *_p_rng;
+};
+
+#endif /* MBEDTLS_SSL_CLI_C && MBEDTLS_GCM_C && MBEDTLS_AES_C */
+
+#endif
+
+/** @}*/
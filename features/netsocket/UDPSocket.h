@@ -113,6 +113,44 @@ public:
     nsapi_size_or_error_t recvfrom(SocketAddress *address,
             void *data, nsapi_size_t size);
 
+    /** Send a batch of packets over a UDP socket
+     *
+     *  Sends each datagram in msgs to its own destination address, in order,
+     *  stopping at the first failure. The number of bytes sent or the error
+     *  for each attempted datagram is stored in its result field. Where the
+     *  network stack supports it, the whole batch is handed to the stack in
+     *  one operation.
+     *
+     *  By default, sendto_batch blocks until at least one datagram is sent.
+     *  If socket is set to non-blocking or times out, NSAPI_ERROR_WOULD_BLOCK
+     *  is returned immediately.
+     *
+     *  @param msgs     Array of datagrams to send
+     *  @param count    Number of datagrams in msgs
+     *  @return         Number of datagrams sent on success, negative error
+     *                  code if no datagram could be sent
+     */
+    nsapi_size_or_error_t sendto_batch(nsapi_dgram_t *msgs, unsigned count);
+
+    /** Receive a batch of datagrams over a UDP socket
+     *
+     *  Receives up to count datagrams into the buffers described by msgs,
+     *  storing the source address, port and number of bytes received in each
+     *  entry. If a datagram is larger than its buffer, the excess data is
+     *  silently discarded.
+     *
+     *  By default, recvfrom_batch blocks until at least one datagram is
+     *  received, then returns every further datagram that is already pending
+     *  without blocking again. If socket is set to non-blocking or times out
+     *  with no datagram, NSAPI_ERROR_WOULD_BLOCK is returned.
+     *
+     *  @param msgs     Array of destination buffers for received datagrams
+     *  @param count    Number of entries in msgs
+     *  @return         Number of datagrams received on success, negative
+     *                  error code if no datagram could be received
+     */
+    nsapi_size_or_error_t recvfrom_batch(nsapi_dgram_t *msgs, unsigned count);
+
 protected:
     virtual nsapi_protocol_t get_proto();
     virtual void event();
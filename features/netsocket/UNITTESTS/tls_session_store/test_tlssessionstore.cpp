@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_tlssessionstore.h"
+#include "TLSSessionStore.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "mbedtls/certs.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ssl_cache.h"
+#include "mbedtls/ssl_ticket.h"
+
+#define HOST            "localhost"
+#define RESUME_COUNT    4
+
+// Slots kept in RAM, shared by every instance so that a new store stands in
+// for a reboot
+class RamTLSSessionStore : public TLSSessionStore {
+public:
+    static unsigned char *slots[MBED_CONF_NSAPI_TLS_SESSION_STORE_SLOTS];
+    static size_t sizes[MBED_CONF_NSAPI_TLS_SESSION_STORE_SLOTS];
+
+    static void clear()
+    {
+        for (int i = 0; i < MBED_CONF_NSAPI_TLS_SESSION_STORE_SLOTS; i++) {
+            free(slots[i]);
+            slots[i] = NULL;
+            sizes[i] = 0;
+        }
+    }
+
+protected:
+    virtual nsapi_error_t write_slot(int slot, const void *data, size_t size)
+    {
+        unsigned char *copy = (unsigned char *)malloc(size);
+        if (!copy) {
+            return NSAPI_ERROR_NO_MEMORY;
+        }
+        memcpy(copy, data, size);
+        free(slots[slot]);
+        slots[slot] = copy;
+        sizes[slot] = size;
+        return NSAPI_ERROR_OK;
+    }
+
+    virtual nsapi_error_t slot_size(int slot, size_t &size)
+    {
+        if (!slots[slot]) {
+            return NSAPI_ERROR_NO_ADDRESS;
+        }
+        size = sizes[slot];
+        return NSAPI_ERROR_OK;
+    }
+
+    virtual nsapi_error_t read_slot(int slot, void *data, size_t size)
+    {
+        if (!slots[slot] || size != sizes[slot]) {
+            return NSAPI_ERROR_DEVICE_ERROR;
+        }
+        memcpy(data, slots[slot], size);
+        return NSAPI_ERROR_OK;
+    }
+
+    virtual nsapi_error_t erase_slot(int slot)
+    {
+        free(slots[slot]);
+        slots[slot] = NULL;
+        sizes[slot] = 0;
+        return NSAPI_ERROR_OK;
+    }
+};
+
+unsigned char *RamTLSSessionStore::slots[MBED_CONF_NSAPI_TLS_SESSION_STORE_SLOTS];
+size_t RamTLSSessionStore::sizes[MBED_CONF_NSAPI_TLS_SESSION_STORE_SLOTS];
+
+// Client and server talk through a pair of memory pipes
+struct pipe_t {
+    unsigned char buf[4096];
+    size_t len;
+};
+
+struct end_t {
+    pipe_t *in;
+    pipe_t *out;
+};
+
+static pipe_t c2s, s2c;
+static end_t client_end = {&s2c, &c2s};
+static end_t server_end = {&c2s, &s2c};
+
+static bool tls_ready;
+static mbedtls_entropy_context entropy;
+static mbedtls_ctr_drbg_context drbg;
+static mbedtls_x509_crt ca, srv_crt;
+static mbedtls_pk_context srv_key;
+static mbedtls_ssl_cache_context cache;
+static mbedtls_ssl_ticket_context ticket;
+static mbedtls_ssl_config client_conf, server_conf;
+
+static const unsigned char store_key[16] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+    0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+// Only the DRBG seed comes from the entropy source, it does not need to be random here
+extern "C" int mbedtls_hardware_poll(void *data, unsigned char *output, size_t len, size_t *olen)
+{
+    for (size_t i = 0; i < len; i++) {
+        output[i] = (unsigned char)rand();
+    }
+    *olen = len;
+    return 0;
+}
+
+static double now_us()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e6 + t.tv_nsec * 1e-3;
+}
+
+static int pipe_send(void *ctx, const unsigned char *buf, size_t len)
+{
+    pipe_t *pipe = ((end_t *)ctx)->out;
+    if (len > sizeof(pipe->buf) - pipe->len) {
+        len = sizeof(pipe->buf) - pipe->len;
+    }
+    if (len == 0) {
+        return MBEDTLS_ERR_SSL_WANT_WRITE;
+    }
+    memcpy(pipe->buf + pipe->len, buf, len);
+    pipe->len += len;
+    return len;
+}
+
+static int pipe_recv(void *ctx, unsigned char *buf, size_t len)
+{
+    pipe_t *pipe = ((end_t *)ctx)->in;
+    if (pipe->len == 0) {
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    }
+    if (len > pipe->len) {
+        len = pipe->len;
+    }
+    memcpy(buf, pipe->buf, len);
+    memmove(pipe->buf, pipe->buf + len, pipe->len - len);
+    pipe->len -= len;
+    return len;
+}
+
+static void setup_tls()
+{
+    if (tls_ready) {
+        return;
+    }
+    tls_ready = true;
+
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&drbg);
+    CHECK_EQUAL(0, mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy, NULL, 0));
+
+    mbedtls_x509_crt_init(&ca);
+    mbedtls_x509_crt_init(&srv_crt);
+    mbedtls_pk_init(&srv_key);
+    CHECK_EQUAL(0, mbedtls_x509_crt_parse(&ca, (const unsigned char *)mbedtls_test_cas_pem,
+                                          mbedtls_test_cas_pem_len));
+    CHECK_EQUAL(0, mbedtls_x509_crt_parse(&srv_crt, (const unsigned char *)mbedtls_test_srv_crt_ec,
+                                          mbedtls_test_srv_crt_ec_len));
+    CHECK_EQUAL(0, mbedtls_pk_parse_key(&srv_key, (const unsigned char *)mbedtls_test_srv_key_ec,
+                                        mbedtls_test_srv_key_ec_len, NULL, 0));
+
+    mbedtls_ssl_cache_init(&cache);
+    mbedtls_ssl_ticket_init(&ticket);
+    CHECK_EQUAL(0, mbedtls_ssl_ticket_setup(&ticket, mbedtls_ctr_drbg_random, &drbg,
+                                            MBEDTLS_CIPHER_AES_128_GCM, 86400));
+
+    mbedtls_ssl_config_init(&client_conf);
+    CHECK_EQUAL(0, mbedtls_ssl_config_defaults(&client_conf, MBEDTLS_SSL_IS_CLIENT,
+                                               MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT));
+    mbedtls_ssl_conf_rng(&client_conf, mbedtls_ctr_drbg_random, &drbg);
+    mbedtls_ssl_conf_ca_chain(&client_conf, &ca, NULL);
+    mbedtls_ssl_conf_authmode(&client_conf, MBEDTLS_SSL_VERIFY_REQUIRED);
+
+    mbedtls_ssl_config_init(&server_conf);
+}
+
+static void setup_server(bool tickets)
+{
+    mbedtls_ssl_config_free(&server_conf);
+    mbedtls_ssl_config_init(&server_conf);
+    CHECK_EQUAL(0, mbedtls_ssl_config_defaults(&server_conf, MBEDTLS_SSL_IS_SERVER,
+                                               MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT));
+    mbedtls_ssl_conf_rng(&server_conf, mbedtls_ctr_drbg_random, &drbg);
+    CHECK_EQUAL(0, mbedtls_ssl_conf_own_cert(&server_conf, &srv_crt, &srv_key));
+    mbedtls_ssl_conf_session_cache(&server_conf, &cache, mbedtls_ssl_cache_get, mbedtls_ssl_cache_set);
+    if (tickets) {
+        mbedtls_ssl_conf_session_tickets_cb(&server_conf, mbedtls_ssl_ticket_write,
+                                            mbedtls_ssl_ticket_parse, &ticket);
+    }
+}
+
+// Runs one handshake, optionally resuming from the store, and saves the
+// resulting session. Returns the result of resume and the handshake time.
+static nsapi_error_t handshake(TLSSessionStore &store, unsigned char master[48], double &time_us)
+{
+    mbedtls_ssl_context client, server;
+    mbedtls_ssl_init(&client);
+    mbedtls_ssl_init(&server);
+    CHECK_EQUAL(0, mbedtls_ssl_setup(&client, &client_conf));
+    CHECK_EQUAL(0, mbedtls_ssl_setup(&server, &server_conf));
+    CHECK_EQUAL(0, mbedtls_ssl_set_hostname(&client, HOST));
+    mbedtls_ssl_set_bio(&client, &client_end, pipe_send, pipe_recv, NULL);
+    mbedtls_ssl_set_bio(&server, &server_end, pipe_send, pipe_recv, NULL);
+    c2s.len = 0;
+    s2c.len = 0;
+
+    double start = now_us();
+    nsapi_error_t resumed = store.resume(HOST, &client);
+
+    int client_ret = MBEDTLS_ERR_SSL_WANT_READ;
+    int server_ret = MBEDTLS_ERR_SSL_WANT_READ;
+    while (client_ret == MBEDTLS_ERR_SSL_WANT_READ || server_ret == MBEDTLS_ERR_SSL_WANT_READ) {
+        if (client_ret) {
+            client_ret = mbedtls_ssl_handshake(&client);
+        }
+        if (server_ret) {
+            server_ret = mbedtls_ssl_handshake(&server);
+        }
+    }
+    time_us = now_us() - start;
+    CHECK_EQUAL(0, client_ret);
+    CHECK_EQUAL(0, server_ret);
+
+    memcpy(master, client.session->master, 48);
+    CHECK_EQUAL(0, store.save(HOST, &client));
+
+    mbedtls_ssl_free(&client);
+    mbedtls_ssl_free(&server);
+    return resumed;
+}
+
+// Alternates full handshakes and handshakes resumed after a simulated
+// reboot, and reports the average time of each
+static void resume_after_reboot(bool tickets)
+{
+    unsigned char master[48];
+    unsigned char resumed_master[48];
+    double full_us = 0;
+    double resumed_us = 0;
+    double time_us;
+
+    setup_server(tickets);
+    for (int i = 0; i < RESUME_COUNT; i++) {
+        {
+            RamTLSSessionStore store;
+            CHECK_EQUAL(0, store.setup(store_key, 128, mbedtls_ctr_drbg_random, &drbg));
+            CHECK_EQUAL(0, store.remove(HOST));
+            CHECK_EQUAL(NSAPI_ERROR_NO_ADDRESS, handshake(store, master, time_us));
+            full_us += time_us;
+        }
+
+        // Only the slots survive the reboot
+        RamTLSSessionStore store;
+        CHECK_EQUAL(0, store.setup(store_key, 128, mbedtls_ctr_drbg_random, &drbg));
+        CHECK_EQUAL(0, handshake(store, resumed_master, time_us));
+        resumed_us += time_us;
+
+        // Only an abbreviated handshake keeps the master secret
+        MEMCMP_EQUAL(master, resumed_master, 48);
+    }
+
+    printf("\n%s: full handshake %.0f us, resumed handshake %.0f us\n",
+           tickets ? "session ticket" : "session ID",
+           full_us / RESUME_COUNT, resumed_us / RESUME_COUNT);
+}
+
+Test_TLSSessionStore::Test_TLSSessionStore()
+{
+    setup_tls();
+    RamTLSSessionStore::clear();
+}
+
+Test_TLSSessionStore::~Test_TLSSessionStore()
+{
+    RamTLSSessionStore::clear();
+}
+
+void Test_TLSSessionStore::test_TLSSessionStore_resume_ticket()
+{
+    resume_after_reboot(true);
+}
+
+void Test_TLSSessionStore::test_TLSSessionStore_resume_id()
+{
+    resume_after_reboot(false);
+}
+
+void Test_TLSSessionStore::test_TLSSessionStore_resume_rejected()
+{
+    unsigned char master[48];
+    double time_us;
+
+    setup_server(true);
+    RamTLSSessionStore store;
+    mbedtls_ssl_context client;
+    mbedtls_ssl_init(&client);
+    CHECK_EQUAL(0, mbedtls_ssl_setup(&client, &client_conf));
+
+    // Nothing saved yet
+    CHECK_EQUAL(0, store.setup(store_key, 128, mbedtls_ctr_drbg_random, &drbg));
+    CHECK_EQUAL(NSAPI_ERROR_NO_ADDRESS, store.resume(HOST, &client));
+    handshake(store, master, time_us);
+    CHECK_EQUAL(0, store.resume(HOST, &client));
+
+    // Unknown host
+    CHECK_EQUAL(NSAPI_ERROR_NO_ADDRESS, store.resume("unknown.example", &client));
+
+    // Other key
+    unsigned char other_key[16] = {0};
+    RamTLSSessionStore other;
+    CHECK_EQUAL(0, other.setup(other_key, 128, mbedtls_ctr_drbg_random, &drbg));
+    CHECK_EQUAL(NSAPI_ERROR_NO_ADDRESS, other.resume(HOST, &client));
+
+    // Removed
+    CHECK_EQUAL(0, store.remove(HOST));
+    CHECK_EQUAL(NSAPI_ERROR_NO_ADDRESS, store.resume(HOST, &client));
+
+    mbedtls_ssl_free(&client);
+}
+
+void Test_TLSSessionStore::test_TLSSessionStore_corrupted_record()
+{
+    unsigned char master[48];
+    double time_us;
+
+    setup_server(true);
+    RamTLSSessionStore store;
+    CHECK_EQUAL(0, store.setup(store_key, 128, mbedtls_ctr_drbg_random, &drbg));
+    handshake(store, master, time_us);
+
+    int slot = -1;
+    for (int i = 0; i < MBED_CONF_NSAPI_TLS_SESSION_STORE_SLOTS; i++) {
+        if (RamTLSSessionStore::slots[i]) {
+            slot = i;
+        }
+    }
+    CHECK(slot >= 0);
+
+    mbedtls_ssl_context client;
+    mbedtls_ssl_init(&client);
+    CHECK_EQUAL(0, mbedtls_ssl_setup(&client, &client_conf));
+
+    // Every byte is authenticated, the version byte as additional data
+    for (size_t i = 0; i < RamTLSSessionStore::sizes[slot]; i++) {
+        RamTLSSessionStore::slots[slot][i] ^= 0x01;
+        CHECK_EQUAL(NSAPI_ERROR_NO_ADDRESS, store.resume(HOST, &client));
+        RamTLSSessionStore::slots[slot][i] ^= 0x01;
+    }
+    CHECK_EQUAL(0, store.resume(HOST, &client));
+
+    mbedtls_ssl_free(&client);
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TEST_TLSSESSIONSTORE_H
+#define TEST_TLSSESSIONSTORE_H
+
+class Test_TLSSessionStore
+{
+public:
+    Test_TLSSessionStore();
+
+    virtual ~Test_TLSSessionStore();
+
+    void test_TLSSessionStore_resume_ticket();
+
+    void test_TLSSessionStore_resume_id();
+
+    void test_TLSSessionStore_resume_rejected();
+
+    void test_TLSSessionStore_corrupted_record();
+};
+
+#endif // TEST_TLSSESSIONSTORE_H
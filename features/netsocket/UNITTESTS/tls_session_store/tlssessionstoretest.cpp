@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_tlssessionstore.h"
+
+TEST_GROUP(TLSSessionStore)
+{
+    Test_TLSSessionStore* unit;
+
+    void setup()
+    {
+        unit = new Test_TLSSessionStore();
+    }
+
+    void teardown()
+    {
+        delete unit;
+    }
+};
+
+TEST(TLSSessionStore, Create)
+{
+    CHECK(unit != NULL);
+}
+
+TEST(TLSSessionStore, test_TLSSessionStore_resume_ticket)
+{
+    unit->test_TLSSessionStore_resume_ticket();
+}
+
+TEST(TLSSessionStore, test_TLSSessionStore_resume_id)
+{
+    unit->test_TLSSessionStore_resume_id();
+}
+
+TEST(TLSSessionStore, test_TLSSessionStore_resume_rejected)
+{
+    unit->test_TLSSessionStore_resume_rejected();
+}
+
+TEST(TLSSessionStore, test_TLSSessionStore_corrupted_record)
+{
+    unit->test_TLSSessionStore_corrupted_record();
+}
@@ -302,6 +302,24 @@ typedef struct nsapi_ip_mreq {
     nsapi_addr_t imr_interface; /* local IP address of interface */
 } nsapi_ip_mreq_t;
 
+/** nsapi_dgram structure
+ *
+ *  Describes a single datagram in a batched UDP send or receive.
+ *
+ *  For sends, addr and port give the destination and data and size the
+ *  payload. For receives, data and size give the destination buffer and
+ *  addr and port are filled in with the source of the datagram. In both
+ *  cases result is set to the number of bytes transferred or a negative
+ *  error code.
+ */
+typedef struct nsapi_dgram {
+    nsapi_addr_t addr;              /* Remote address */
+    uint16_t port;                  /* Remote port */
+    void *data;                     /* Payload or destination buffer */
+    nsapi_size_t size;              /* Size of the payload or buffer in bytes */
+    nsapi_size_or_error_t result;   /* Bytes transferred or negative error code */
+} nsapi_dgram_t;
+
 /** nsapi_stack_api structure
  *
  *  Common api structure for network stack operations. A network stack
@@ -591,6 +609,44 @@ typedef struct nsapi_stack_api
      */
     nsapi_error_t (*getsockopt)(nsapi_stack_t *stack, nsapi_socket_t socket, int level,
             int optname, void *optval, unsigned *optlen);
+
+    /** Send a batch of packets over a UDP socket
+     *
+     *  Sends each datagram in msgs in order, stopping at the first failure.
+     *  The result of each attempted datagram is stored in its result field.
+     *  Stacks should submit the whole batch with a single handoff to the
+     *  stack thread.
+     *
+     *  This call is non-blocking. If the first sendto would block,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param stack    Stack handle
+     *  @param socket   Socket handle
+     *  @param msgs     Array of datagrams to send
+     *  @param count    Number of datagrams in msgs
+     *  @return         Number of datagrams sent on success, negative error
+     *                  code if no datagram could be sent
+     */
+    nsapi_size_or_error_t (*socket_sendto_batch)(nsapi_stack_t *stack, nsapi_socket_t socket,
+            nsapi_dgram_t *msgs, unsigned count);
+
+    /** Receive a batch of packets over a UDP socket
+     *
+     *  Receives up to count datagrams that are already pending on the
+     *  socket, filling in the address, port and result of each one.
+     *
+     *  This call is non-blocking. If no datagram is pending,
+     *  NSAPI_ERROR_WOULD_BLOCK is returned immediately.
+     *
+     *  @param stack    Stack handle
+     *  @param socket   Socket handle
+     *  @param msgs     Array of destination buffers for received datagrams
+     *  @param count    Number of entries in msgs
+     *  @return         Number of datagrams received on success, negative
+     *                  error code if no datagram could be received
+     */
+    nsapi_size_or_error_t (*socket_recvfrom_batch)(nsapi_stack_t *stack, nsapi_socket_t socket,
+            nsapi_dgram_t *msgs, unsigned count);
 } nsapi_stack_api_t;
 
 
@@ -48,6 +48,8 @@ typedef enum {
     NVSTORE_FIRST_PREDEFINED_KEY        = 0,
 
     // All predefined keys used for internal features should be defined here
+    // Keys 0-8 are the default range of the BLE security database (ble.security-db-nvstore-base-key)
+    // Keys 9-12 are the default range of the TLS session store (nsapi.tls-session-store-base-key)
 
     NVSTORE_LAST_PREDEFINED_KEY         = 15,
     NVSTORE_NUM_PREDEFINED_KEYS
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_usbmsd.h"
+#include "HeapBlockDevice.h"
+#include "ProfilingBlockDevice.h"
+#include "USBMSDBlockDevice.h"
+#include "USBDevice_stub.h"
+
+#define TEST_SECTOR_SIZE 512
+#define TEST_ERASE_SIZE 2048
+#define TEST_BLOCK_DEVICE_SIZE (32 * TEST_ERASE_SIZE)
+
+#define CBW_SIGNATURE 0x43425355
+#define CBW_SIZE 31
+#define CSW_STATUS_PASSED 0
+
+#define READ_CAPACITY 0x25
+#define READ10 0x28
+#define WRITE10 0x2A
+
+// Exposes the bulk endpoint callbacks, which the USB stack calls on a target
+class TestMSD : public USBMSDBlockDevice {
+public:
+    TestMSD(BlockDevice *bd) : USBMSDBlockDevice(bd)
+    {
+    }
+
+    bool out(const uint8_t *data, uint32_t size)
+    {
+        USBDevice_stub::out_data = data;
+        USBDevice_stub::out_size = size;
+        return EPBULK_OUT_callback();
+    }
+
+    bool in_complete()
+    {
+        return EPBULK_IN_callback();
+    }
+};
+
+static uint8_t pattern(bd_addr_t addr, uint8_t seed)
+{
+    return (uint8_t)(addr * 7 + seed + (addr >> 8));
+}
+
+static void fill(BlockDevice &bd, uint8_t seed)
+{
+    uint8_t unit[TEST_ERASE_SIZE];
+
+    for (bd_addr_t addr = 0; addr < bd.size(); addr += sizeof(unit)) {
+        for (size_t i = 0; i < sizeof(unit); i++) {
+            unit[i] = pattern(addr + i, seed);
+        }
+        LONGS_EQUAL(0, bd.erase(addr, sizeof(unit)));
+        LONGS_EQUAL(0, bd.program(unit, addr, sizeof(unit)));
+    }
+}
+
+static void put_be32(uint8_t *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static uint32_t get_le32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Sends a command block wrapper for a 10 byte SCSI command
+static void send_command(TestMSD &msd, uint8_t opcode, uint32_t lba, uint16_t blocks, uint32_t data_length)
+{
+    uint8_t cbw[CBW_SIZE] = { 0 };
+
+    put_le32(cbw, CBW_SIGNATURE);
+    put_le32(cbw + 4, 0x1234);
+    put_le32(cbw + 8, data_length);
+    cbw[12] = (opcode == WRITE10) ? 0x00 : 0x80;
+    cbw[14] = 10;
+    cbw[15] = opcode;
+    put_be32(cbw + 17, lba);
+    cbw[22] = blocks >> 8;
+    cbw[23] = blocks;
+    CHECK(msd.out(cbw, sizeof(cbw)));
+}
+
+// Completes IN packets until the command status wrapper has been sent
+static void complete_in(TestMSD &msd)
+{
+    for (int i = 0; i < 1000 && !USBDevice_stub::csw_sent; i++) {
+        msd.in_complete();
+    }
+    CHECK(USBDevice_stub::csw_sent);
+    // the host received the status, back to waiting for a command
+    msd.in_complete();
+}
+
+static void check_status(uint32_t residue)
+{
+    CHECK(USBDevice_stub::csw_sent);
+    LONGS_EQUAL(0x1234, get_le32(USBDevice_stub::csw + 4));
+    LONGS_EQUAL(residue, get_le32(USBDevice_stub::csw + 8));
+    LONGS_EQUAL(CSW_STATUS_PASSED, USBDevice_stub::csw[12]);
+}
+
+// Writes the blocks from the host, in packets of the bulk endpoint size
+static void host_write(TestMSD &msd, uint32_t lba, uint16_t blocks, uint8_t seed)
+{
+    uint8_t packet[MAX_PACKET_SIZE_EPBULK];
+    bd_addr_t addr = lba * TEST_SECTOR_SIZE;
+    bd_size_t size = blocks * TEST_SECTOR_SIZE;
+
+    USBDevice_stub::reset();
+    send_command(msd, WRITE10, lba, blocks, size);
+    for (bd_size_t off = 0; off < size; off += sizeof(packet)) {
+        for (size_t i = 0; i < sizeof(packet); i++) {
+            packet[i] = pattern(addr + off + i, seed);
+        }
+        CHECK_FALSE(USBDevice_stub::csw_sent);
+        CHECK(msd.out(packet, sizeof(packet)));
+    }
+    check_status(0);
+    msd.in_complete();
+}
+
+static void check_blocks(BlockDevice &bd, uint32_t lba, uint16_t blocks, uint8_t seed)
+{
+    uint8_t sector[TEST_SECTOR_SIZE];
+
+    for (uint32_t b = lba; b < lba + blocks; b++) {
+        LONGS_EQUAL(0, bd.read(sector, b * TEST_SECTOR_SIZE, sizeof(sector)));
+        for (size_t i = 0; i < sizeof(sector); i++) {
+            LONGS_EQUAL(pattern(b * TEST_SECTOR_SIZE + i, seed), sector[i]);
+        }
+    }
+}
+
+Test_USBMSD::Test_USBMSD()
+{
+    USBDevice_stub::reset();
+}
+
+Test_USBMSD::~Test_USBMSD()
+{
+}
+
+void Test_USBMSD::test_USBMSD_unaligned_write()
+{
+    HeapBlockDevice heap(TEST_BLOCK_DEVICE_SIZE, 1, 1, TEST_ERASE_SIZE);
+    ProfilingBlockDevice bd(&heap);
+    TestMSD msd(&bd);
+
+    CHECK(msd.connect(false));
+    fill(bd, 1);
+    bd.reset();
+
+    // Blocks 3 to 5 end the first erase unit and start the second one
+    host_write(msd, 3, 3, 2);
+
+    // Each partial unit is read, erased and programmed once
+    LONGS_EQUAL(2 * TEST_ERASE_SIZE, bd.get_read_count());
+    LONGS_EQUAL(2 * TEST_ERASE_SIZE, bd.get_erase_count());
+    LONGS_EQUAL(2 * TEST_ERASE_SIZE, bd.get_program_count());
+
+    check_blocks(bd, 0, 3, 1);
+    check_blocks(bd, 3, 3, 2);
+    check_blocks(bd, 6, 2, 1);
+    check_blocks(bd, 8, TEST_BLOCK_DEVICE_SIZE / TEST_SECTOR_SIZE - 8, 1);
+}
+
+void Test_USBMSD::test_USBMSD_aligned_write()
+{
+    HeapBlockDevice heap(TEST_BLOCK_DEVICE_SIZE, 1, 1, TEST_ERASE_SIZE);
+    ProfilingBlockDevice bd(&heap);
+    TestMSD msd(&bd);
+
+    CHECK(msd.connect(false));
+    fill(bd, 1);
+    bd.reset();
+
+    // Two whole erase units, nothing needs to be read back
+    host_write(msd, 4, 8, 3);
+
+    LONGS_EQUAL(0, bd.get_read_count());
+    LONGS_EQUAL(2 * TEST_ERASE_SIZE, bd.get_erase_count());
+    LONGS_EQUAL(2 * TEST_ERASE_SIZE, bd.get_program_count());
+
+    check_blocks(bd, 0, 4, 1);
+    check_blocks(bd, 4, 8, 3);
+    check_blocks(bd, 12, TEST_BLOCK_DEVICE_SIZE / TEST_SECTOR_SIZE - 12, 1);
+}
+
+void Test_USBMSD::test_USBMSD_multi_block_read()
+{
+    HeapBlockDevice heap(TEST_BLOCK_DEVICE_SIZE, 1, 1, TEST_ERASE_SIZE);
+    ProfilingBlockDevice bd(&heap);
+    TestMSD msd(&bd);
+
+    CHECK(msd.connect(false));
+    fill(bd, 5);
+    bd.reset();
+
+    // Ten blocks, more than both halves of the staging buffer hold
+    USBDevice_stub::reset();
+    send_command(msd, READ10, 1, 10, 10 * TEST_SECTOR_SIZE);
+    complete_in(msd);
+    check_status(0);
+
+    LONGS_EQUAL(10 * TEST_SECTOR_SIZE, USBDevice_stub::in_size);
+    for (uint32_t i = 0; i < USBDevice_stub::in_size; i++) {
+        LONGS_EQUAL(pattern(TEST_SECTOR_SIZE + i, 5), USBDevice_stub::in_data[i]);
+    }
+
+    // Every block is read once, in runs of an erase unit
+    LONGS_EQUAL(10 * TEST_SECTOR_SIZE, bd.get_read_count());
+}
+
+void Test_USBMSD::test_USBMSD_read_capacity()
+{
+    HeapBlockDevice heap(TEST_BLOCK_DEVICE_SIZE, 1, 1, TEST_ERASE_SIZE);
+    TestMSD msd(&heap);
+
+    CHECK(msd.connect(false));
+
+    USBDevice_stub::reset();
+    send_command(msd, READ_CAPACITY, 0, 0, 8);
+    complete_in(msd);
+    check_status(0);
+
+    // Last block address and block size
+    LONGS_EQUAL(8, USBDevice_stub::in_size);
+    LONGS_EQUAL(TEST_BLOCK_DEVICE_SIZE / TEST_SECTOR_SIZE - 1,
+                USBDevice_stub::in_data[3] | (USBDevice_stub::in_data[2] << 8));
+    LONGS_EQUAL(TEST_SECTOR_SIZE, USBDevice_stub::in_data[7] | (USBDevice_stub::in_data[6] << 8));
+}
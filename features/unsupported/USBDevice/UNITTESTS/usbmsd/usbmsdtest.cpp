@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_usbmsd.h"
+
+TEST_GROUP(USBMSD)
+{
+    Test_USBMSD* unit;
+
+    void setup()
+    {
+        unit = new Test_USBMSD();
+    }
+
+    void teardown()
+    {
+        delete unit;
+    }
+};
+
+TEST(USBMSD, Create)
+{
+    CHECK(unit != NULL);
+}
+
+TEST(USBMSD, test_USBMSD_unaligned_write)
+{
+    unit->test_USBMSD_unaligned_write();
+}
+
+TEST(USBMSD, test_USBMSD_aligned_write)
+{
+    unit->test_USBMSD_aligned_write();
+}
+
+TEST(USBMSD, test_USBMSD_multi_block_read)
+{
+    unit->test_USBMSD_multi_block_read();
+}
+
+TEST(USBMSD, test_USBMSD_read_capacity)
+{
+    unit->test_USBMSD_read_capacity();
+}
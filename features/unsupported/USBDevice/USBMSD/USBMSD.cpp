@@ -68,6 +68,10 @@ USBMSD::USBMSD(uint16_t vendor_id, uint16_t product_id, uint16_t product_release
     memset((void *)&cbw, 0, sizeof(CBW));
     memset((void *)&csw, 0, sizeof(CSW));
     page = NULL;
+    TransferBlocks = 1;
+    bufLength[0] = bufLength[1] = 0;
+    bufCurrent = 0;
+    diskError = false;
 }
 
 USBMSD::~USBMSD() {
@@ -120,8 +124,12 @@ bool USBMSD::connect(bool blocking) {
     if (BlockCount > 0) {
         BlockSize = MemorySize / BlockCount;
         if (BlockSize != 0) {
+            TransferBlocks = disk_transfer_blocks();
+            if (TransferBlocks == 0) {
+                TransferBlocks = 1;
+            }
             free(page);
-            page = (uint8_t *)malloc(BlockSize * sizeof(uint8_t));
+            page = (uint8_t *)malloc(2 * TransferBlocks * BlockSize * sizeof(uint8_t));
             if (page == NULL)
                 return false;
         }
@@ -145,6 +153,10 @@ void USBMSD::reset() {
     stage = READ_CBW;
 }
 
+uint8_t USBMSD::disk_transfer_blocks() {
+    return 1;
+}
+
 
 // Called in ISR context called when a data is received
 bool USBMSD::EPBULK_OUT_callback() {
@@ -225,27 +237,38 @@ void USBMSD::memoryWrite (uint8_t * buf, uint16_t size) {
         stallEndpoint(EPBULK_OUT);
     }
 
-    // we fill an array in RAM of 1 block before writing it in memory
-    for (int i = 0; i < size; i++)
-        page[addr%BlockSize + i] = buf[i];
-
-    // if the array is filled, write it in memory
-    if (!((addr + size)%BlockSize)) {
-        if (!(disk_status() & WRITE_PROTECT)) {
-            disk_write(page, addr/BlockSize, 1);
-        }
-    }
+    // we fill an array in RAM of up to TransferBlocks blocks before writing it in memory
+    memcpy(&page[addr - writeAddr], buf, size);
 
     addr += size;
     length -= size;
     csw.DataResidue -= size;
 
+    // write the staged blocks once a transfer unit is complete or at the end of the transfer
+    if (!(addr % (TransferBlocks * BlockSize)) || (!length) || (stage != PROCESS_CBW)) {
+        flushBlocks();
+    }
+
     if ((!length) || (stage != PROCESS_CBW)) {
-        csw.Status = (stage == ERROR) ? CSW_FAILED : CSW_PASSED;
+        csw.Status = ((stage == ERROR) || diskError) ? CSW_FAILED : CSW_PASSED;
         sendCSW();
     }
 }
 
+void USBMSD::flushBlocks (void) {
+    // only complete blocks are written
+    uint32_t count = (addr - writeAddr) / BlockSize;
+
+    if (count) {
+        if (!(disk_status() & WRITE_PROTECT)) {
+            if (disk_write(page, writeAddr/BlockSize, count)) {
+                diskError = true;
+            }
+        }
+        writeAddr += count * BlockSize;
+    }
+}
+
 void USBMSD::memoryVerify (uint8_t * buf, uint16_t size) {
     uint32_t n;
 
@@ -503,24 +526,51 @@ void USBMSD::memoryRead (void) {
         stage = ERROR;
     }
 
-    // we read an entire block
-    if (!(addr%BlockSize))
-        disk_read(page, addr/BlockSize, 1);
+    // first packet of the transfer: nothing has been loaded yet
+    if (!bufLength[bufCurrent] && (loadAddr < endAddr))
+        loadBlocks(bufCurrent);
 
     // write data which are in RAM
-    writeNB(EPBULK_IN, &page[addr%BlockSize], n, MAX_PACKET_SIZE_EPBULK);
+    uint8_t * data = &page[bufCurrent * TransferBlocks * BlockSize];
+    if (bufLength[bufCurrent])
+        data += addr - bufAddr[bufCurrent];
+    writeNB(EPBULK_IN, data, n, MAX_PACKET_SIZE_EPBULK);
 
     addr += n;
     length -= n;
 
     csw.DataResidue -= n;
 
+    // read the next blocks in the other half while the packet is being sent
+    if (!bufLength[bufCurrent ^ 1] && (loadAddr < endAddr))
+        loadBlocks(bufCurrent ^ 1);
+
+    // all the data of this half has been sent, continue with the other one
+    if (bufLength[bufCurrent] && (addr >= bufAddr[bufCurrent] + bufLength[bufCurrent])) {
+        bufLength[bufCurrent] = 0;
+        bufCurrent ^= 1;
+    }
+
     if ( !length || (stage != PROCESS_CBW)) {
-        csw.Status = (stage == PROCESS_CBW) ? CSW_PASSED : CSW_FAILED;
+        csw.Status = ((stage == PROCESS_CBW) && !diskError) ? CSW_PASSED : CSW_FAILED;
         stage = (stage == PROCESS_CBW) ? SEND_CSW : stage;
     }
 }
 
+void USBMSD::loadBlocks (uint8_t half) {
+    uint32_t count = (endAddr - loadAddr + BlockSize - 1) / BlockSize;
+
+    if (count > TransferBlocks)
+        count = TransferBlocks;
+
+    if (disk_read(&page[half * TransferBlocks * BlockSize], loadAddr/BlockSize, count))
+        diskError = true;
+
+    bufAddr[half] = loadAddr;
+    bufLength[half] = count * BlockSize;
+    loadAddr += count * BlockSize;
+}
+
 
 bool USBMSD::infoTransfer (void) {
     uint32_t n;
@@ -546,6 +596,14 @@ bool USBMSD::infoTransfer (void) {
 
     length = n * BlockSize;
 
+    // reset the staging buffer for the new transfer
+    bufLength[0] = bufLength[1] = 0;
+    bufCurrent = 0;
+    loadAddr = addr;
+    endAddr = ((uint64_t)addr + length > MemorySize) ? MemorySize : addr + length;
+    writeAddr = addr;
+    diskError = false;
+
     if (!cbw.DataLength) {              // host requests no data
         csw.Status = CSW_FAILED;
         sendCSW();
@@ -39,8 +39,8 @@
  * How to use this class with your chip ?
  *
  * You have to inherit and define some pure virtual functions (mandatory step):
- *   - virtual int disk_read(char * data, int block): function to read a block
- *   - virtual int disk_write(const char * data, int block): function to write a block
+ *   - virtual int disk_read(uint8_t * data, uint64_t block, uint8_t count): function to read one or more blocks
+ *   - virtual int disk_write(const uint8_t * data, uint64_t block, uint8_t count): function to write one or more blocks
  *   - virtual int disk_initialize(): function to initialize the memory
  *   - virtual int disk_sectors(): return the number of blocks
  *   - virtual int disk_size(): return the memory size
@@ -54,6 +54,12 @@
  * of USBMSD to connect your mass storage device. connect() will first call disk_status() to test the status of the disk.
  * If disk_status() returns 1 (disk not initialized), then disk_initialize() is called. After this step, connect() will collect information
  * such as the number of blocks and the memory size.
+ *
+ * Data is staged in a RAM buffer of two halves of disk_transfer_blocks() blocks each. Reads are
+ * double-buffered: while the packets of one half are sent to the host, the next blocks are read into
+ * the other half. Writes are gathered and passed to disk_write() in units of disk_transfer_blocks()
+ * blocks, aligned on multiples of that count. Override disk_transfer_blocks() to batch storage
+ * accesses into larger units (the erase size of a flash for instance).
  */
 class USBMSD: public USBDevice {
 public:
@@ -134,6 +140,15 @@ protected:
     */
     virtual int disk_status() = 0;
 
+    /*
+    * Number of blocks to read or write in a single disk_read()/disk_write() call
+    *
+    * The staging buffer holds twice this number of blocks.
+    *
+    * @returns number of blocks, 1 by default
+    */
+    virtual uint8_t disk_transfer_blocks();
+
     /*
     * Get string product descriptor
     *
@@ -225,8 +240,29 @@ private:
     bool memOK;
 
     // cache in RAM before writing in memory. Useful also to read a block.
+    // Holds two halves of TransferBlocks blocks.
     uint8_t * page;
 
+    // number of blocks in each half of page
+    uint32_t TransferBlocks;
+
+    // read pipeline: address and length of the data loaded in each half of page
+    uint32_t bufAddr[2];
+    uint32_t bufLength[2];
+
+    // half of page the next packet is sent from
+    uint8_t bufCurrent;
+
+    // next address to load and end of the current read
+    uint32_t loadAddr;
+    uint32_t endAddr;
+
+    // address of the first byte staged in page during a write
+    uint32_t writeAddr;
+
+    // a disk_read or disk_write failed during the current transfer
+    bool diskError;
+
     int BlockSize;
     uint64_t MemorySize;
     uint64_t BlockCount;
@@ -239,6 +275,8 @@ private:
     bool readCapacity (void);
     bool infoTransfer (void);
     void memoryRead (void);
+    void loadBlocks (uint8_t half);
+    void flushBlocks (void);
     bool modeSense6 (void);
     void testUnitReady (void);
     bool requestSense (void);
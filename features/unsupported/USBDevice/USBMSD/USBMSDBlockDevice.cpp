@@ -0,0 +1,149 @@
+/* Copyright (c) 2018 mbed.org, MIT License
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+* and associated documentation files (the "Software"), to deal in the Software without
+* restriction, including without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or
+* substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+* BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+* DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "stdint.h"
+#include "USBMSDBlockDevice.h"
+
+#define DISK_OK         0x00
+#define NO_INIT         0x01
+
+// Sector size presented to the host when the block device allows it
+#define DEFAULT_SECTOR_SIZE 512
+
+USBMSDBlockDevice::USBMSDBlockDevice(BlockDevice *bd, uint16_t vendor_id, uint16_t product_id, uint16_t product_release)
+    : USBMSD(vendor_id, product_id, product_release), _bd(bd), _sector_size(DEFAULT_SECTOR_SIZE),
+      _erase_size(DEFAULT_SECTOR_SIZE), _erase_buf(NULL), _initialized(false) {
+}
+
+USBMSDBlockDevice::~USBMSDBlockDevice() {
+    disconnect();
+    if (_initialized) {
+        _bd->deinit();
+    }
+    free(_erase_buf);
+}
+
+int USBMSDBlockDevice::disk_initialize() {
+    int err = _bd->init();
+    if (err) {
+        return err;
+    }
+
+    // smallest power of two multiple of 512 that the block device can read and program
+    _sector_size = DEFAULT_SECTOR_SIZE;
+    while ((_sector_size % _bd->get_read_size()) || (_sector_size % _bd->get_program_size())) {
+        _sector_size *= 2;
+    }
+
+    _erase_size = _bd->get_erase_size();
+    if (_erase_size < _sector_size) {
+        _erase_size = _sector_size;
+    }
+
+    // partial erase units need a read-modify-write
+    if ((_erase_size > _sector_size) || (_erase_size % _sector_size)) {
+        free(_erase_buf);
+        _erase_buf = (uint8_t *)malloc(_erase_size);
+        if (_erase_buf == NULL) {
+            _bd->deinit();
+            return -1;
+        }
+    }
+
+    _initialized = true;
+    return 0;
+}
+
+int USBMSDBlockDevice::disk_status() {
+    return _initialized ? DISK_OK : NO_INIT;
+}
+
+uint64_t USBMSDBlockDevice::disk_sectors() {
+    return _bd->size() / _sector_size;
+}
+
+uint64_t USBMSDBlockDevice::disk_size() {
+    return disk_sectors() * _sector_size;
+}
+
+uint8_t USBMSDBlockDevice::disk_transfer_blocks() {
+    bd_size_t size = _erase_size;
+    if ((size % _sector_size) || (size > USBMSD_BD_MAX_TRANSFER_SIZE)) {
+        size = USBMSD_BD_MAX_TRANSFER_SIZE;
+    }
+
+    bd_size_t blocks = size / _sector_size;
+    if (blocks == 0) {
+        blocks = 1;
+    } else if (blocks > 255) {
+        blocks = 255;
+    }
+    return blocks;
+}
+
+int USBMSDBlockDevice::disk_read(uint8_t* data, uint64_t block, uint8_t count) {
+    return _bd->read(data, block * _sector_size, count * _sector_size);
+}
+
+int USBMSDBlockDevice::disk_write(const uint8_t* data, uint64_t block, uint8_t count) {
+    bd_addr_t addr = block * _sector_size;
+    bd_size_t size = count * _sector_size;
+    int err;
+
+    while (size) {
+        bd_addr_t unit = addr - (addr % _erase_size);
+        bd_size_t offset = addr - unit;
+
+        if ((offset == 0) && (size >= _erase_size)) {
+            // whole erase units: erase and program them in one go
+            bd_size_t chunk = size - (size % _erase_size);
+            err = _bd->erase(addr, chunk);
+            if (!err) {
+                err = _bd->program(data, addr, chunk);
+            }
+            if (err) {
+                return err;
+            }
+            addr += chunk;
+            data += chunk;
+            size -= chunk;
+        } else {
+            // part of an erase unit: read-modify-write the whole unit
+            bd_size_t chunk = _erase_size - offset;
+            if (chunk > size) {
+                chunk = size;
+            }
+            err = _bd->read(_erase_buf, unit, _erase_size);
+            if (!err) {
+                memcpy(_erase_buf + offset, data, chunk);
+                err = _bd->erase(unit, _erase_size);
+            }
+            if (!err) {
+                err = _bd->program(_erase_buf, unit, _erase_size);
+            }
+            if (err) {
+                return err;
+            }
+            addr += chunk;
+            data += chunk;
+            size -= chunk;
+        }
+    }
+
+    return _bd->sync();
+}
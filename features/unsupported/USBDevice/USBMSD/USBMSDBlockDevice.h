@@ -0,0 +1,95 @@
+/* Copyright (c) 2018 mbed.org, MIT License
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+* and associated documentation files (the "Software"), to deal in the Software without
+* restriction, including without limitation the rights to use, copy, modify, merge, publish,
+* distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all copies or
+* substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+* BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+* NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+* DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef USBMSDBLOCKDEVICE_H
+#define USBMSDBLOCKDEVICE_H
+
+#include "USBMSD.h"
+#include "BlockDevice.h"
+
+/* Maximum size of a batched disk transfer. Two such buffers are allocated by USBMSD. */
+#ifndef USBMSD_BD_MAX_TRANSFER_SIZE
+#define USBMSD_BD_MAX_TRANSFER_SIZE     4096
+#endif
+
+/**
+ * USBMSDBlockDevice class: expose a BlockDevice as a USB mass storage device
+ *
+ * The block device is presented to the host as sectors of 512 bytes, or of the smallest multiple
+ * of its read and program sizes if they are bigger. Transfers are batched in units of the erase
+ * size of the block device (up to USBMSD_BD_MAX_TRANSFER_SIZE bytes), so that each aligned unit
+ * written by the host is erased and programmed once. Writes that only cover part of an erase unit
+ * are handled with a read-modify-write of the whole unit.
+ *
+ * @code
+ * #include "mbed.h"
+ * #include "HeapBlockDevice.h"
+ * #include "USBMSDBlockDevice.h"
+ *
+ * HeapBlockDevice bd(64 * 1024, 512);
+ * USBMSDBlockDevice msd(&bd);
+ *
+ * int main() {
+ *     msd.connect();
+ *     while (true) {
+ *         wait(1);
+ *     }
+ * }
+ * @endcode
+ */
+class USBMSDBlockDevice: public USBMSD {
+public:
+
+    /**
+    * Constructor
+    *
+    * @param bd block device to expose, must stay valid while this object exists
+    * @param vendor_id Your vendor_id
+    * @param product_id Your product_id
+    * @param product_release Your preoduct_release
+    */
+    USBMSDBlockDevice(BlockDevice *bd, uint16_t vendor_id = 0x0703, uint16_t product_id = 0x0104, uint16_t product_release = 0x0001);
+
+    /**
+    * Destructor
+    */
+    virtual ~USBMSDBlockDevice();
+
+protected:
+
+    virtual int disk_read(uint8_t* data, uint64_t block, uint8_t count);
+    virtual int disk_write(const uint8_t* data, uint64_t block, uint8_t count);
+    virtual int disk_initialize();
+    virtual uint64_t disk_sectors();
+    virtual uint64_t disk_size();
+    virtual int disk_status();
+    virtual uint8_t disk_transfer_blocks();
+
+private:
+
+    BlockDevice *_bd;
+    bd_size_t _sector_size;
+    bd_size_t _erase_size;
+
+    // scratch buffer of one erase unit, used for partial writes
+    uint8_t *_erase_buf;
+
+    bool _initialized;
+};
+
+#endif
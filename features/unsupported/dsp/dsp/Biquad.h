@@ -0,0 +1,107 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef BIQUAD_H
+#define BIQUAD_H
+
+#include <stdint.h>
+#include <string.h>
+#include "arm_math.h"
+
+namespace dsp {
+
+/* CMSIS-DSP biquad cascade kernels for each supported sample type:
+ * transposed direct form II for float32_t, direct form I for fixed point */
+template<typename T> struct biquad_kernel;
+
+template<> struct biquad_kernel<float32_t> {
+    typedef arm_biquad_cascade_df2T_instance_f32 instance_t;
+    static const uint32_t coeffs_per_stage = 5;
+    static const uint32_t state_per_stage = 2;
+    static void init(instance_t *S, uint8_t num_stages, const float32_t *coeff, float32_t *state, int8_t) {
+        arm_biquad_cascade_df2T_init_f32(S, num_stages, (float32_t*)coeff, state);
+    }
+    static void run(const instance_t *S, float32_t *sgn_in, float32_t *sgn_out, uint32_t block_size) {
+        arm_biquad_cascade_df2T_f32(S, sgn_in, sgn_out, block_size);
+    }
+};
+
+template<> struct biquad_kernel<q31_t> {
+    typedef arm_biquad_casd_df1_inst_q31 instance_t;
+    static const uint32_t coeffs_per_stage = 5;
+    static const uint32_t state_per_stage = 4;
+    static void init(instance_t *S, uint8_t num_stages, const q31_t *coeff, q31_t *state, int8_t post_shift) {
+        arm_biquad_cascade_df1_init_q31(S, num_stages, (q31_t*)coeff, state, post_shift);
+    }
+    static void run(const instance_t *S, q31_t *sgn_in, q31_t *sgn_out, uint32_t block_size) {
+        arm_biquad_cascade_df1_q31(S, sgn_in, sgn_out, block_size);
+    }
+};
+
+template<> struct biquad_kernel<q15_t> {
+    typedef arm_biquad_casd_df1_inst_q15 instance_t;
+    static const uint32_t coeffs_per_stage = 6;
+    static const uint32_t state_per_stage = 4;
+    static void init(instance_t *S, uint8_t num_stages, const q15_t *coeff, q15_t *state, int8_t post_shift) {
+        arm_biquad_cascade_df1_init_q15(S, num_stages, (q15_t*)coeff, state, post_shift);
+    }
+    static void run(const instance_t *S, q15_t *sgn_in, q15_t *sgn_out, uint32_t block_size) {
+        arm_biquad_cascade_df1_q15(S, sgn_in, sgn_out, block_size);
+    }
+};
+
+/** IIR filter stage made of a cascade of biquads
+ *
+ * @tparam T            Sample type: float32_t, q31_t or q15_t
+ * @tparam num_stages   Number of second order sections
+ * @tparam block_size   Number of samples processed by each call to process()
+ *
+ * The coefficients use the CMSIS-DSP layout: {b0, b1, b2, a1, a2} for each stage, with
+ * a 0 after b0 for q15_t ({b0, 0, b1, b2, a1, a2}). Fixed point coefficients are scaled
+ * down by 2^post_shift. The filter can run in place (sgn_in == sgn_out).
+ */
+template<typename T, uint8_t num_stages, uint32_t block_size=32>
+class Biquad {
+public:
+    typedef T sample_t;
+    static const uint32_t input_size = block_size;
+    static const uint32_t output_size = block_size;
+    static const bool in_place = true;
+
+    Biquad(const T *coeff, int8_t post_shift = 0) {
+        biquad_kernel<T>::init(&_biquad, num_stages, coeff, _state, post_shift);
+    }
+
+    void process(T *sgn_in, T *sgn_out) {
+        biquad_kernel<T>::run(&_biquad, sgn_in, sgn_out, block_size);
+    }
+
+    void reset(void) {
+        memset(_state, 0, sizeof(_state));
+    }
+
+private:
+    typename biquad_kernel<T>::instance_t _biquad;
+    T _state[num_stages * biquad_kernel<T>::state_per_stage];
+};
+
+}
+#endif
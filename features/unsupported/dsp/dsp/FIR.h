@@ -0,0 +1,107 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef FIR_H
+#define FIR_H
+
+#include <stdint.h>
+#include <string.h>
+#include "arm_math.h"
+
+namespace dsp {
+
+/* CMSIS-DSP FIR kernels for each supported sample type */
+template<typename T> struct fir_kernel;
+
+template<> struct fir_kernel<float32_t> {
+    typedef arm_fir_instance_f32 instance_t;
+    static arm_status init(instance_t *S, uint16_t num_taps, const float32_t *coeff, float32_t *state, uint32_t block_size) {
+        arm_fir_init_f32(S, num_taps, (float32_t*)coeff, state, block_size);
+        return ARM_MATH_SUCCESS;
+    }
+    static void run(const instance_t *S, float32_t *sgn_in, float32_t *sgn_out, uint32_t block_size) {
+        arm_fir_f32(S, sgn_in, sgn_out, block_size);
+    }
+};
+
+template<> struct fir_kernel<q31_t> {
+    typedef arm_fir_instance_q31 instance_t;
+    static arm_status init(instance_t *S, uint16_t num_taps, const q31_t *coeff, q31_t *state, uint32_t block_size) {
+        arm_fir_init_q31(S, num_taps, (q31_t*)coeff, state, block_size);
+        return ARM_MATH_SUCCESS;
+    }
+    static void run(const instance_t *S, q31_t *sgn_in, q31_t *sgn_out, uint32_t block_size) {
+        arm_fir_q31(S, sgn_in, sgn_out, block_size);
+    }
+};
+
+template<> struct fir_kernel<q15_t> {
+    typedef arm_fir_instance_q15 instance_t;
+    static arm_status init(instance_t *S, uint16_t num_taps, const q15_t *coeff, q15_t *state, uint32_t block_size) {
+        return arm_fir_init_q15(S, num_taps, (q15_t*)coeff, state, block_size);
+    }
+    static void run(const instance_t *S, q15_t *sgn_in, q15_t *sgn_out, uint32_t block_size) {
+        arm_fir_q15(S, sgn_in, sgn_out, block_size);
+    }
+};
+
+/** FIR filter stage
+ *
+ * @tparam T            Sample type: float32_t, q31_t or q15_t
+ * @tparam num_taps     Number of coefficients (must be even and at least 4 for q15_t)
+ * @tparam block_size   Number of samples processed by each call to process()
+ *
+ * The filter can run in place (sgn_in == sgn_out).
+ */
+template<typename T, uint16_t num_taps, uint32_t block_size=32>
+class FIR {
+public:
+    typedef T sample_t;
+    static const uint32_t input_size = block_size;
+    static const uint32_t output_size = block_size;
+    static const bool in_place = true;
+
+    FIR(const T *coeff) {
+        _status = fir_kernel<T>::init(&_fir, num_taps, coeff, _state, block_size);
+    }
+
+    void process(T *sgn_in, T *sgn_out) {
+        fir_kernel<T>::run(&_fir, sgn_in, sgn_out, block_size);
+    }
+
+    void reset(void) {
+        memset(_state, 0, sizeof(_state));
+    }
+
+    /** ARM_MATH_SUCCESS or ARM_MATH_ARGUMENT_ERROR if the kernel rejected num_taps */
+    arm_status status(void) const {
+        return _status;
+    }
+
+private:
+    typename fir_kernel<T>::instance_t _fir;
+    // q15 kernels need one more state sample than the other types
+    T _state[block_size + num_taps];
+    arm_status _status;
+};
+
+}
+#endif
@@ -0,0 +1,145 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef PING_PONG_BUFFER_H
+#define PING_PONG_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "platform/mbed_assert.h"
+
+namespace dsp {
+
+/** Double buffer filled by a circular DMA transfer
+ *
+ * The DMA writes the whole buffer returned by data() in a loop and the half transfer
+ * and transfer complete interrupts call half_complete() and complete(). The thread
+ * side processes each half in turn while the DMA fills the other one, straight from
+ * the DMA memory and without copying it.
+ *
+ * @tparam T            Sample type
+ * @tparam block_size   Number of samples in each half
+ *
+ * Example:
+ * @code
+ * PingPongBuffer<q15_t, 64> adc_buffer;
+ *
+ * void dma_half_isr() { adc_buffer.half_complete(); }
+ * void dma_full_isr() { adc_buffer.complete(); }
+ *
+ * // start a circular transfer of adc_buffer.size() samples into adc_buffer.data()
+ * while (true) {
+ *     if (adc_buffer.process(pipeline, spectrum)) {
+ *         // use spectrum
+ *     }
+ * }
+ * @endcode
+ */
+template<typename T, uint32_t block_size>
+class PingPongBuffer {
+public:
+    typedef T sample_t;
+
+    PingPongBuffer() : _next(0), _overruns(0) {
+        _ready[0] = false;
+        _ready[1] = false;
+    }
+
+    /** Memory to give to the DMA, holds size() samples */
+    T *data(void) {
+        return _buffer;
+    }
+
+    /** Number of samples in the whole buffer (both halves) */
+    uint32_t size(void) const {
+        return 2 * block_size;
+    }
+
+    /** To be called from the half transfer interrupt: the first half is full */
+    void half_complete(void) {
+        filled(0);
+    }
+
+    /** To be called from the transfer complete interrupt: the second half is full */
+    void complete(void) {
+        filled(1);
+    }
+
+    /** Get the next full half, or NULL if the DMA has not filled it yet
+     *
+     * The block stays valid until release() is called. Processing must be done before
+     * the DMA wraps around to this half again, otherwise an overrun is counted.
+     */
+    T *acquire(void) {
+        if (!_ready[_next]) {
+            return NULL;
+        }
+        return _buffer + _next * block_size;
+    }
+
+    /** Give the half returned by acquire() back to the DMA */
+    void release(void) {
+        _ready[_next] = false;
+        _next ^= 1;
+    }
+
+    /** Run a pipeline on the next full half, if any
+     *
+     * The pipeline processes the samples in place in the DMA memory, which is
+     * overwritten.
+     *
+     * @param pipeline  Stage or Chain with an input_size of block_size
+     * @param sgn_out   Receives pipeline.output_size samples
+     * @return true if a block was processed, false if no block was ready
+     */
+    template<typename P>
+    bool process(P &pipeline, T *sgn_out) {
+        MBED_STATIC_ASSERT(P::input_size == block_size, "Pipeline input size must match the block size");
+        T *sgn_in = acquire();
+        if (sgn_in == NULL) {
+            return false;
+        }
+        pipeline.process(sgn_in, sgn_out);
+        release();
+        return true;
+    }
+
+    /** Number of halves the DMA refilled before they were released */
+    uint32_t overruns(void) const {
+        return _overruns;
+    }
+
+private:
+    void filled(uint8_t half) {
+        if (_ready[half]) {
+            _overruns++;
+        }
+        _ready[half] = true;
+    }
+
+    T _buffer[2 * block_size];
+    volatile bool _ready[2];
+    uint8_t _next;
+    volatile uint32_t _overruns;
+};
+
+}
+#endif
@@ -0,0 +1,106 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+#include "platform/mbed_assert.h"
+
+namespace dsp {
+
+template<typename A, typename B> struct same_type { static const bool value = false; };
+template<typename A> struct same_type<A, A> { static const bool value = true; };
+
+/* Intermediate block between two chained stages: the input block itself when the
+ * first stage can run in place, a scratch buffer otherwise */
+template<typename T, uint32_t size, bool in_place> struct chain_buffer;
+
+template<typename T, uint32_t size> struct chain_buffer<T, size, true> {
+    T *get(T *sgn_in) {
+        return sgn_in;
+    }
+};
+
+template<typename T, uint32_t size> struct chain_buffer<T, size, false> {
+    T *get(T *) {
+        return _buffer;
+    }
+    T _buffer[size];
+};
+
+/** Two processing stages run one after the other on each block
+ *
+ * A stage is any class with a sample_t typedef, input_size, output_size and in_place
+ * constants, and process(sample_t *sgn_in, sample_t *sgn_out) and reset() members:
+ * FIR, Biquad, Decimator, RFFT or another Chain, so longer pipelines are built by
+ * nesting chains.
+ *
+ * When the first stage can run in place, the second stage reads its input straight
+ * from the input block and no intermediate buffer or copy is needed. The input block
+ * is therefore used as working memory and is overwritten by process().
+ *
+ * Example:
+ * @code
+ * FIR<q15_t, 32, 64> fir(fir_coeffs);
+ * Decimator<q15_t, 16, 4, 64> decimator(decimator_coeffs);
+ * RFFT<q15_t, 16> fft;
+ *
+ * Chain<FIR<q15_t, 32, 64>, Decimator<q15_t, 16, 4, 64> > front(fir, decimator);
+ * Chain<Chain<FIR<q15_t, 32, 64>, Decimator<q15_t, 16, 4, 64> >, RFFT<q15_t, 16> > pipeline(front, fft);
+ *
+ * q15_t spectrum[pipeline.output_size];
+ * pipeline.process(samples, spectrum);
+ * @endcode
+ */
+template<typename A, typename B>
+class Chain {
+public:
+    typedef typename A::sample_t sample_t;
+    static const uint32_t input_size = A::input_size;
+    static const uint32_t output_size = B::output_size;
+    /* process(sgn, sgn) is allowed; sgn must then hold max(input_size, output_size) samples */
+    static const bool in_place = A::in_place ? B::in_place : true;
+
+    Chain(A &first, B &second) : _first(first), _second(second) {
+        MBED_STATIC_ASSERT((same_type<typename A::sample_t, typename B::sample_t>::value), "Chained stages must use the same sample type");
+        MBED_STATIC_ASSERT(A::output_size == B::input_size, "Output size of a stage must match the input size of the next one");
+    }
+
+    void process(sample_t *sgn_in, sample_t *sgn_out) {
+        sample_t *sgn_mid = _buffer.get(sgn_in);
+        _first.process(sgn_in, sgn_mid);
+        _second.process(sgn_mid, sgn_out);
+    }
+
+    void reset(void) {
+        _first.reset();
+        _second.reset();
+    }
+
+private:
+    A &_first;
+    B &_second;
+    chain_buffer<sample_t, A::output_size, A::in_place> _buffer;
+};
+
+}
+#endif
@@ -0,0 +1,108 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef RFFT_H
+#define RFFT_H
+
+#include <stdint.h>
+#include "arm_math.h"
+
+namespace dsp {
+
+/* CMSIS-DSP real FFT kernels for each supported sample type */
+template<typename T> struct rfft_kernel;
+
+template<> struct rfft_kernel<float32_t> {
+    typedef arm_rfft_fast_instance_f32 instance_t;
+    // packed spectrum: {X[0], X[N/2], Re(X[1]), Im(X[1]), ...}
+    static const uint32_t output_factor = 1;
+    static arm_status init(instance_t *S, uint32_t fft_size) {
+        return arm_rfft_fast_init_f32(S, fft_size);
+    }
+    static void run(instance_t *S, float32_t *sgn_in, float32_t *sgn_out) {
+        arm_rfft_fast_f32(S, sgn_in, sgn_out, 0);
+    }
+};
+
+template<> struct rfft_kernel<q31_t> {
+    typedef arm_rfft_instance_q31 instance_t;
+    // full complex spectrum, N complex values
+    static const uint32_t output_factor = 2;
+    static arm_status init(instance_t *S, uint32_t fft_size) {
+        return arm_rfft_init_q31(S, fft_size, 0, 1);
+    }
+    static void run(instance_t *S, q31_t *sgn_in, q31_t *sgn_out) {
+        arm_rfft_q31(S, sgn_in, sgn_out);
+    }
+};
+
+template<> struct rfft_kernel<q15_t> {
+    typedef arm_rfft_instance_q15 instance_t;
+    // full complex spectrum, N complex values
+    static const uint32_t output_factor = 2;
+    static arm_status init(instance_t *S, uint32_t fft_size) {
+        return arm_rfft_init_q15(S, fft_size, 0, 1);
+    }
+    static void run(instance_t *S, q15_t *sgn_in, q15_t *sgn_out) {
+        arm_rfft_q15(S, sgn_in, sgn_out);
+    }
+};
+
+/** Forward real FFT stage
+ *
+ * @tparam T            Sample type: float32_t, q31_t or q15_t
+ * @tparam fft_size     Number of real input samples, a power of two supported by CMSIS-DSP
+ *
+ * The output is the CMSIS-DSP spectrum format of the sample type: fft_size values for
+ * float32_t, 2 * fft_size values for q31_t and q15_t (scaled down by the kernel).
+ * The input block is used as working memory, so sgn_in and sgn_out must not overlap.
+ */
+template<typename T, uint16_t fft_size>
+class RFFT {
+public:
+    typedef T sample_t;
+    static const uint32_t input_size = fft_size;
+    static const uint32_t output_size = fft_size * rfft_kernel<T>::output_factor;
+    static const bool in_place = false;
+
+    RFFT() {
+        _status = rfft_kernel<T>::init(&_rfft, fft_size);
+    }
+
+    void process(T *sgn_in, T *sgn_out) {
+        rfft_kernel<T>::run(&_rfft, sgn_in, sgn_out);
+    }
+
+    void reset(void) {
+    }
+
+    /** ARM_MATH_SUCCESS or ARM_MATH_ARGUMENT_ERROR if fft_size is not supported */
+    arm_status status(void) const {
+        return _status;
+    }
+
+private:
+    typename rfft_kernel<T>::instance_t _rfft;
+    arm_status _status;
+};
+
+}
+#endif
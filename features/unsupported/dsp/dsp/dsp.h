@@ -26,6 +26,12 @@
 #include "arm_math.h"
 
 #include "FIR_f32.h"
+#include "FIR.h"
+#include "Biquad.h"
+#include "Decimator.h"
+#include "RFFT.h"
+#include "Pipeline.h"
+#include "PingPongBuffer.h"
 #include "Sine_f32.h"
 
 using namespace dsp;
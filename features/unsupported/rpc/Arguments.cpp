@@ -25,6 +25,8 @@ Arguments::Arguments(const char* rqs) {
     obj_name = NULL;
     method_name = NULL;
     argc = 0;
+    bin_data = NULL;
+    bin_end = NULL;
 
     // This copy can be removed if we can assume the request string is
     // persistent and writable for the duration of the call
@@ -54,6 +56,26 @@ Arguments::Arguments(const char* rqs) {
     index = -1;
 }
 
+Arguments::Arguments(const uint8_t *data, size_t length) {
+    obj_name = NULL;
+    method_name = NULL;
+    argc = 0;
+    request[0] = '\0';
+    index = -1;
+    bin_data = data;
+    bin_end = data + length;
+}
+
+void Arguments::read_binary(void *arg, size_t size) {
+    size_t available = bin_end - bin_data;
+    if (available > size) {
+        available = size;
+    }
+    memcpy(arg, bin_data, available);
+    memset((char*)arg + available, 0, size - available);
+    bin_data += available;
+}
+
 char* Arguments::search_arg(char **arg, char *p, char next_sep) {
     char *s = p;
     while (true) {
@@ -70,32 +92,68 @@ char* Arguments::search_arg(char **arg, char *p, char next_sep) {
 
 template<> PinName Arguments::getArg<PinName>(void) {
     index++;
+    if (bin_data != NULL) {
+        int32_t pin;
+        read_binary(&pin, sizeof(pin));
+        return (PinName)pin;
+    }
     return parse_pins(argv[index]);
 }
 
 template<> int Arguments::getArg<int>(void) {
     index++;
+    if (bin_data != NULL) {
+        int32_t i;
+        read_binary(&i, sizeof(i));
+        return i;
+    }
     char *pEnd;
     return strtol(argv[index], &pEnd, 10);
 }
 
 template<> const char* Arguments::getArg<const char*>(void) {
     index++;
+    if (bin_data != NULL) {
+        const char *s = (const char*)bin_data;
+        const uint8_t *nul = (const uint8_t*)memchr(bin_data, '\0', bin_end - bin_data);
+        if (nul == NULL) {
+            // Unterminated string
+            bin_data = bin_end;
+            return "";
+        }
+        bin_data = nul + 1;
+        return s;
+    }
     return argv[index];
 }
 
 template<> char Arguments::getArg<char>(void) {
     index++;
+    if (bin_data != NULL) {
+        char c;
+        read_binary(&c, sizeof(c));
+        return c;
+    }
     return *argv[index];
 }
 
 template<> double Arguments::getArg<double>(void) {
     index++;
+    if (bin_data != NULL) {
+        double d;
+        read_binary(&d, sizeof(d));
+        return d;
+    }
     return atof(argv[index]);
 }
 
 template<> float Arguments::getArg<float>(void) {
     index++;
+    if (bin_data != NULL) {
+        float f;
+        read_binary(&f, sizeof(f));
+        return f;
+    }
     return atof(argv[index]);
 }
 
@@ -103,6 +161,38 @@ Reply::Reply(char* r) {
     first = true;
     *r = '\0';
     reply = r;
+    bin_start = NULL;
+    bin_end = NULL;
+    bin_overflow = false;
+}
+
+Reply::Reply(uint8_t *r, size_t size) {
+    first = true;
+    reply = (char*)r;
+    bin_start = (char*)r;
+    bin_end = (char*)r + size;
+    bin_overflow = false;
+}
+
+size_t Reply::length(void) const {
+    return (bin_end != NULL) ? (size_t)(reply - bin_start) : 0;
+}
+
+bool Reply::overflow(void) const {
+    return bin_overflow;
+}
+
+bool Reply::write_binary(const void *data, size_t size) {
+    if (bin_end == NULL) {
+        return false;
+    }
+    if (size > (size_t)(bin_end - reply)) {
+        bin_overflow = true;
+    } else {
+        memcpy(reply, data, size);
+        reply += size;
+    }
+    return true;
 }
 
 void Reply::separator(void) {
@@ -114,26 +204,32 @@ void Reply::separator(void) {
 }
 
 template<> void Reply::putData<const char*>(const char* s) {
+    if (write_binary(s, strlen(s) + 1)) return;
     separator();
     reply += sprintf(reply, "%s", s);
 }
 
 template<> void Reply::putData<char*>(char* s) {
+    if (write_binary(s, strlen(s) + 1)) return;
     separator();
     reply += sprintf(reply, "%s", s);
 }
 
 template<> void Reply::putData<char>(char c) {
+    if (write_binary(&c, sizeof(c))) return;
     separator();
     reply += sprintf(reply, "%c", c);
 }
 
 template<> void Reply::putData<int>(int v) {
+    int32_t i = v;
+    if (write_binary(&i, sizeof(i))) return;
     separator();
     reply += sprintf(reply, "%d", v);
 }
 
 template<> void Reply::putData<float>(float f) {
+    if (write_binary(&f, sizeof(f))) return;
     separator();
     reply += sprintf(reply, "%.17g", f);
 }
@@ -28,6 +28,14 @@ class Arguments {
 public:
     Arguments(const char* rqs);
 
+    /* Arguments of a call in a binary frame (see RPC::call_binary)
+     *
+     * Each argument is stored in its native little-endian form: 4 bytes for int,
+     * float and PinName, 8 bytes for double, 1 byte for char and a null terminated
+     * string for const char*. Missing bytes are read as 0.
+     */
+    Arguments(const uint8_t *data, size_t length);
+
     template<typename Arg>
     Arg   getArg(void);
 
@@ -43,19 +51,41 @@ private:
     char  request[RPC_MAX_STRING];
     int index;
     char* search_arg(char **arg, char *p, char next_sep);
+
+    // Binary arguments, bin_data is NULL for a text request
+    const uint8_t *bin_data;
+    const uint8_t *bin_end;
+    void read_binary(void *arg, size_t size);
 };
 
 class Reply {
 public:
     Reply(char* r);
 
+    /* Reply to a call in a binary frame, data is stored in the same form as
+     * binary arguments. Data that does not fit in size bytes is dropped and
+     * flagged by overflow().
+     */
+    Reply(uint8_t *r, size_t size);
+
     template<typename Data>
     void putData(Data d);
 
+    /* Number of bytes written to a binary reply */
+    size_t length(void) const;
+
+    bool overflow(void) const;
+
 private:
     void separator(void);
     bool first;
     char* reply;
+
+    // Binary reply, bin_end is NULL for a text reply
+    char* bin_start;
+    char* bin_end;
+    bool bin_overflow;
+    bool write_binary(const void *data, size_t size);
 };
 
 
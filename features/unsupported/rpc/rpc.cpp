@@ -19,6 +19,16 @@ using namespace std;
 
 namespace mbed {
 
+/* FNV-1a hash of an object name */
+static uint32_t name_hash(const char *name) {
+    uint32_t hash = 2166136261UL;
+    while (*name != '\0') {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
 RPC::RPC(const char *name) {
     _from_construct = false;
     if (name != NULL) {
@@ -31,19 +41,38 @@ RPC::RPC(const char *name) {
     // put this object at head of the list
     _next = _head;
     _head = this;
+
+    // allocate an id that is not 0 and not in use
+    do {
+        _last_id++;
+    } while ((_last_id == 0) || (lookup(_last_id) != NULL));
+    _id = _last_id;
+
+    _hash = name_hash(_name);
+    RPC **bucket = &_names[_hash & (RPC_HASH_BUCKETS - 1)];
+    _next_name = *bucket;
+    *bucket = this;
+    bucket = &_ids[_id & (RPC_HASH_BUCKETS - 1)];
+    _next_id = *bucket;
+    *bucket = this;
 }
 
 RPC::~RPC() {
-    // remove this object from the list
-    if (_head == this) { // first in the list, so just drop me
-        _head = _next;
-    } else {            // find the object before me, then drop me
-        RPC* p = _head;
-        while (p->_next != this) {
-            p = p->_next;
-        }
-        p->_next = _next;
+    // remove this object from the list and the registry
+    unlink(&_head, &RPC::_next);
+    unlink(&_names[_hash & (RPC_HASH_BUCKETS - 1)], &RPC::_next_name);
+    unlink(&_ids[_id & (RPC_HASH_BUCKETS - 1)], &RPC::_next_id);
+}
+
+void RPC::unlink(RPC **list, RPC *RPC::*next) {
+    while (*list != this) {
+        list = &((*list)->*next);
     }
+    *list = this->*next;
+}
+
+uint16_t RPC::get_rpc_id() const {
+    return _id;
 }
 
 const rpc_method *RPC::get_rpc_methods() {
@@ -55,16 +84,41 @@ const rpc_method *RPC::get_rpc_methods() {
 }
 
 RPC *RPC::lookup(const char *name) {
-    size_t len = strlen(name);
-    for (RPC *p = _head; p != NULL; p = p->_next) {
-        /* Check that p->_name matches name and is the correct length */
-        if (strncmp(p->_name, name, len) == 0 && (strlen(p->_name) == len)) {
+    uint32_t hash = name_hash(name);
+    for (RPC *p = _names[hash & (RPC_HASH_BUCKETS - 1)]; p != NULL; p = p->_next_name) {
+        if ((p->_hash == hash) && (strcmp(p->_name, name) == 0)) {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+RPC *RPC::lookup(uint16_t id) {
+    for (RPC *p = _ids[id & (RPC_HASH_BUCKETS - 1)]; p != NULL; p = p->_next_id) {
+        if (p->_id == id) {
             return p;
         }
     }
     return NULL;
 }
 
+/* Methods are numbered in the order they are listed, superclass methods last */
+const rpc_method *RPC::find_method(RPC *p, int method_id) {
+    const rpc_method *cur_method = p->get_rpc_methods();
+    while (true) {
+        for (; cur_method->name != NULL; cur_method++) {
+            if (method_id-- == 0) {
+                return cur_method;
+            }
+        }
+        if (cur_method->super != 0) {
+            cur_method = cur_method->super(p);
+        } else {
+            return NULL;
+        }
+    }
+}
+
 void RPC::delete_self() {
     delete[] _name;
     if (_from_construct) {
@@ -92,9 +146,35 @@ void RPC::clear(Arguments*, Reply*) {
     }
 }
 
+void RPC::get_id(Arguments *args, Reply *result) {
+    RPC *p = (args->argc >= 1) ? lookup(args->getArg<const char*>()) : NULL;
+    result->putData<int>((p != NULL) ? p->_id : -1);
+}
+
+void RPC::get_method_id(Arguments *args, Reply *result) {
+    if (args->argc < 2) {
+        result->putData<int>(-1);
+        return;
+    }
+    RPC *p = lookup(args->getArg<const char*>());
+    const char *method_name = args->getArg<const char*>();
+    if (p != NULL) {
+        const rpc_method *method;
+        for (int method_id = 0; (method = find_method(p, method_id)) != NULL; method_id++) {
+            if (strcmp(method->name, method_name) == 0) {
+                result->putData<int>(method_id);
+                return;
+            }
+        }
+    }
+    result->putData<int>(-1);
+}
+
 const rpc_function RPC::_RPC_funcs[] = {
     {"clear", &RPC::clear },
     { "objects", &RPC::list_objs },
+    { "id", &RPC::get_id },
+    { "method", &RPC::get_method_id },
     RPC_METHOD_END
 };
 
@@ -102,6 +182,12 @@ rpc_class RPC::_RPC_class = { "RPC", _RPC_funcs, NULL };
 
 RPC *RPC::_head = NULL;
 
+RPC *RPC::_names[RPC_HASH_BUCKETS] = { NULL };
+
+RPC *RPC::_ids[RPC_HASH_BUCKETS] = { NULL };
+
+uint16_t RPC::_last_id = 0;
+
 rpc_class *RPC::_classes = &_RPC_class;
 
 bool RPC::call(const char *request, char *reply) {
@@ -188,4 +274,49 @@ bool RPC::call(const char *request, char *reply) {
     return false;
 }
 
+int RPC::call_binary(const uint8_t *request, size_t length, uint8_t *result, size_t size) {
+    if ((request == NULL) || (length < 2) || (request[0] != RPC_BINARY_SYNC) || (size < 2)) return -1;
+
+    const uint8_t *end = request + length;
+    const uint8_t *call = request + 2;
+    uint8_t *reply = result + 2;
+    uint8_t *reply_end = result + size;
+    uint8_t count = request[1];
+
+    result[0] = RPC_BINARY_SYNC;
+    result[1] = count;
+    for (uint8_t n = 0; n < count; n++) {
+        if ((end - call) < 4) return -1;
+        uint16_t id = call[0] | (call[1] << 8);
+        uint8_t method_id = call[2];
+        uint8_t args_length = call[3];
+        call += 4;
+        if ((end - call) < args_length) return -1;
+        if ((reply_end - reply) < 2) return -1;
+
+        /* Reply data goes after the status and length bytes */
+        size_t available = reply_end - reply - 2;
+        if (available > 0xFF) {
+            available = 0xFF;
+        }
+        Arguments args(call, args_length);
+        Reply r(reply + 2, available);
+        call += args_length;
+
+        RPC *p = lookup(id);
+        const rpc_method *method = (p != NULL) ? find_method(p, method_id) : NULL;
+        if (p == NULL) {
+            reply[0] = RPC_BINARY_NO_OBJECT;
+        } else if (method == NULL) {
+            reply[0] = RPC_BINARY_NO_METHOD;
+        } else {
+            (method->method_caller)(p, &args, &r);
+            reply[0] = r.overflow() ? RPC_BINARY_OVERFLOW : RPC_BINARY_OK;
+        }
+        reply[1] = r.length();
+        reply += 2 + r.length();
+    }
+    return reply - result;
+}
+
 } // namespace mbed
@@ -23,6 +23,30 @@ namespace mbed {
 
 #define RPC_MAX_STRING      128
 
+/* Number of buckets of the object registry, must be a power of two */
+#define RPC_HASH_BUCKETS    16
+
+/* Binary framing
+ *  A binary request starts with RPC_BINARY_SYNC, where a text request starts
+ *  with '/', followed by the number of calls in the frame. Each call is:
+ *   object id (2 bytes, little-endian), method id (1 byte),
+ *   argument length (1 byte), arguments (see Arguments).
+ *  The reply repeats RPC_BINARY_SYNC and the number of calls, followed by the
+ *  reply to each call:
+ *   status (1 byte, RPC_BINARY_OK...), reply length (1 byte), reply data.
+ *
+ *  Object ids are returned by "/RPC/id <object>" and method ids by
+ *  "/RPC/method <object> <method>", so the names only need to be resolved once.
+ */
+#define RPC_BINARY_SYNC     0xA5
+
+enum {
+    RPC_BINARY_OK = 0,
+    RPC_BINARY_NO_OBJECT,
+    RPC_BINARY_NO_METHOD,
+    RPC_BINARY_OVERFLOW
+};
+
 struct rpc_function {
     const char *name;
     void (*function_caller)(Arguments*, Reply*);
@@ -66,6 +90,19 @@ public:
 
     static bool call(const char *buf, char *result);
 
+    /* Function call_binary
+     *  Run all the calls of a binary request frame and write the reply frame.
+     *
+     * Variables
+     *  request - the request frame, starting with RPC_BINARY_SYNC.
+     *  length - the length of the request frame.
+     *  result - the buffer that receives the reply frame.
+     *  size - the size of the result buffer.
+     *  returns - the length of the reply frame, or -1 if the request frame is
+     *            malformed or the reply does not fit in the result buffer.
+     */
+    static int call_binary(const uint8_t *request, size_t length, uint8_t *result, size_t size);
+
     /* Function lookup
      *  Lookup and return the object that has the given name.
      *
@@ -74,6 +111,19 @@ public:
      */
     static RPC *lookup(const char *name);
 
+    /* Function lookup
+     *  Lookup and return the object that has the given id.
+     *
+     * Variables
+     *  id - the id to lookup.
+     */
+    static RPC *lookup(uint16_t id);
+
+    /* Function get_rpc_id
+     *  Returns the id used to address this object in binary requests.
+     */
+    uint16_t get_rpc_id() const;
+
 protected:
     static RPC *_head;
     RPC *_next;
@@ -86,9 +136,23 @@ private:
     static const rpc_function _RPC_funcs[];
     static rpc_class _RPC_class;
 
+    /* Registry buckets, indexed by name hash and by id */
+    static RPC *_names[RPC_HASH_BUCKETS];
+    static RPC *_ids[RPC_HASH_BUCKETS];
+    static uint16_t _last_id;
+    uint32_t _hash;
+    uint16_t _id;
+    RPC *_next_name;
+    RPC *_next_id;
+
+    void unlink(RPC **list, RPC *RPC::*next);
+    static const rpc_method *find_method(RPC *p, int method_id);
+
     void delete_self();
     static void list_objs(Arguments *args, Reply *result);
     static void clear(Arguments *args, Reply *result);
+    static void get_id(Arguments *args, Reply *result);
+    static void get_method_id(Arguments *args, Reply *result);
 
 public:
     /* Function add_rpc_class
@@ -0,0 +1,29 @@
+/* Minimal stand-in for the CMSIS core header so that the portable C kernels of
+ * CMSIS-DSP (ARM_MATH_CM0) can be built and benchmarked on a host machine */
+#ifndef HOST_CORE_CM0_H
+#define HOST_CORE_CM0_H
+
+#include <stdint.h>
+
+#define __INLINE            inline
+#define __STATIC_INLINE     static inline
+
+__STATIC_INLINE uint32_t __CLZ(uint32_t value)
+{
+    return value ? (uint32_t)__builtin_clz(value) : 32;
+}
+
+__STATIC_INLINE int32_t __SSAT(int32_t value, uint32_t bits)
+{
+    const int32_t max = (int32_t)((1U << (bits - 1)) - 1);
+    const int32_t min = -max - 1;
+    return value > max ? max : (value < min ? min : value);
+}
+
+__STATIC_INLINE uint32_t __ROR(uint32_t value, uint32_t shift)
+{
+    shift &= 31;
+    return shift ? (value >> shift) | (value << (32 - shift)) : value;
+}
+
+#endif
@@ -0,0 +1,168 @@
+/* Host benchmark of the DSP pipeline templates
+ *
+ * Runs the same FIR -> decimator -> real FFT pipeline twice for each sample type:
+ * once the usual way, copying the DMA block into a working buffer and giving each
+ * stage its own output buffer, and once as a Chain processing the block in place.
+ * Both must produce the same spectrum; the time per input sample and the RAM used
+ * by the intermediate buffers are reported.
+ *
+ * Build from this directory with the portable C kernels of CMSIS-DSP:
+ *
+ *   DSP=../../../../dsp
+ *   for f in $(find $DSP/cmsis_dsp -name "arm_*.c"); do gcc -O2 -c -DARM_MATH_CM0 -I. -I$DSP/cmsis_dsp $f; done
+ *   g++ -O2 -fpermissive -DARM_MATH_CM0 -I. -I$DSP/dsp -I$DSP/cmsis_dsp -I../../../../../.. main.cpp *.o -o pipeline_benchmark
+ *   ./pipeline_benchmark
+ *
+ * -fpermissive is only needed on 64 bit hosts, where arm_math.h casts pointers to int32_t.
+ */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "arm_math.h"
+#include "FIR.h"
+#include "Decimator.h"
+#include "RFFT.h"
+#include "Pipeline.h"
+
+using namespace dsp;
+
+#define BLOCK_SIZE      (256)
+#define NUM_TAPS        (32)
+#define DECIMATION      (4)
+#define FFT_SIZE        (BLOCK_SIZE / DECIMATION)
+#define NUM_BLOCKS      (20000)
+
+extern "C" {
+
+/* C versions of the bit reversal routines that CMSIS-DSP only provides in assembly
+ * (arm_bitreversal2.S). The table holds byte offsets of the complex values to swap. */
+void arm_bitreversal_32(uint32_t *pSrc, const uint16_t bitRevLen, const uint16_t *pBitRevTable)
+{
+    for (uint32_t i = 0; i + 1 < bitRevLen; i += 2) {
+        uint32_t a = pBitRevTable[i] >> 2;
+        uint32_t b = pBitRevTable[i + 1] >> 2;
+        uint32_t tmp;
+        tmp = pSrc[a]; pSrc[a] = pSrc[b]; pSrc[b] = tmp;
+        tmp = pSrc[a + 1]; pSrc[a + 1] = pSrc[b + 1]; pSrc[b + 1] = tmp;
+    }
+}
+
+void arm_bitreversal_16(uint16_t *pSrc, const uint16_t bitRevLen, const uint16_t *pBitRevTable)
+{
+    for (uint32_t i = 0; i + 1 < bitRevLen; i += 2) {
+        uint32_t a = pBitRevTable[i] >> 2;
+        uint32_t b = pBitRevTable[i + 1] >> 2;
+        uint16_t tmp;
+        tmp = pSrc[a]; pSrc[a] = pSrc[b]; pSrc[b] = tmp;
+        tmp = pSrc[a + 1]; pSrc[a + 1] = pSrc[b + 1]; pSrc[b + 1] = tmp;
+    }
+}
+
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void convert(const float32_t *src, float32_t *dst, uint32_t n) { memcpy(dst, src, n * sizeof(float32_t)); }
+static void convert(const float32_t *src, q31_t *dst, uint32_t n) { arm_float_to_q31((float32_t*)src, dst, n); }
+static void convert(const float32_t *src, q15_t *dst, uint32_t n) { arm_float_to_q15((float32_t*)src, dst, n); }
+
+template<typename T>
+static bool benchmark(const char *name, const float32_t *coeffs_f32, const float32_t *signal_f32)
+{
+    typedef FIR<T, NUM_TAPS, BLOCK_SIZE> LowPass;
+    typedef Decimator<T, NUM_TAPS, DECIMATION, BLOCK_SIZE> Down;
+    typedef RFFT<T, FFT_SIZE> Spectrum;
+
+    T coeffs[NUM_TAPS];
+    convert(coeffs_f32, coeffs, NUM_TAPS);
+    static T signal[NUM_BLOCKS * BLOCK_SIZE];
+    convert(signal_f32, signal, NUM_BLOCKS * BLOCK_SIZE);
+
+    // Copying implementation: one buffer per stage
+    LowPass fir_a(coeffs);
+    Down decimator_a(coeffs);
+    Spectrum fft_a;
+    static T work[BLOCK_SIZE], filtered[BLOCK_SIZE], decimated[FFT_SIZE], fft_in[FFT_SIZE];
+    static T spectrum_a[Spectrum::output_size];
+
+    // Chained implementation: in place in the input block
+    LowPass fir_b(coeffs);
+    Down decimator_b(coeffs);
+    Spectrum fft_b;
+    Chain<LowPass, Down> front(fir_b, decimator_b);
+    Chain<Chain<LowPass, Down>, Spectrum> pipeline(front, fft_b);
+    static T block[BLOCK_SIZE];
+    static T spectrum_b[Spectrum::output_size];
+
+    if (fir_a.status() != ARM_MATH_SUCCESS || decimator_a.status() != ARM_MATH_SUCCESS || fft_a.status() != ARM_MATH_SUCCESS) {
+        printf("%s: invalid parameters\n", name);
+        return false;
+    }
+
+    double copy_ns = 0, chain_ns = 0;
+    bool match = true;
+    for (uint32_t n = 0; n < NUM_BLOCKS; n++) {
+        const T *dma = signal + n * BLOCK_SIZE;
+
+        double t0 = now_ns();
+        memcpy(work, dma, sizeof(work));
+        fir_a.process(work, filtered);
+        decimator_a.process(filtered, decimated);
+        memcpy(fft_in, decimated, sizeof(fft_in));
+        fft_a.process(fft_in, spectrum_a);
+        double t1 = now_ns();
+
+        // the copy into block stands for the DMA having written it
+        memcpy(block, dma, sizeof(block));
+        double t2 = now_ns();
+        pipeline.process(block, spectrum_b);
+        double t3 = now_ns();
+
+        copy_ns += t1 - t0;
+        chain_ns += t3 - t2;
+        if (memcmp(spectrum_a, spectrum_b, sizeof(spectrum_a)) != 0) {
+            match = false;
+        }
+    }
+
+    uint32_t samples = NUM_BLOCKS * BLOCK_SIZE;
+    printf("%-4s copy: %6.2f ns/sample, %5u bytes of buffers | chain: %6.2f ns/sample, %5u bytes of chains | %s\n",
+           name, copy_ns / samples,
+           (unsigned)(sizeof(work) + sizeof(filtered) + sizeof(decimated) + sizeof(fft_in)),
+           chain_ns / samples,
+           (unsigned)(sizeof(pipeline) + sizeof(front)),
+           match ? "outputs match" : "OUTPUTS DIFFER");
+    return match;
+}
+
+int main()
+{
+    float32_t coeffs[NUM_TAPS];
+    for (int i = 0; i < NUM_TAPS; i++) {
+        // Hann windowed sinc, cutoff at fs / (2 * DECIMATION)
+        float32_t x = i - (NUM_TAPS - 1) / 2.0f;
+        float32_t sinc = (x == 0) ? 1.0f : sinf(PI * x / DECIMATION) / (PI * x / DECIMATION);
+        float32_t window = 0.5f - 0.5f * cosf(2 * PI * i / (NUM_TAPS - 1));
+        coeffs[i] = sinc * window / DECIMATION;
+    }
+
+    static float32_t signal[NUM_BLOCKS * BLOCK_SIZE];
+    srand(1);
+    for (uint32_t i = 0; i < NUM_BLOCKS * BLOCK_SIZE; i++) {
+        float32_t noise = (rand() / (float32_t)RAND_MAX - 0.5f) * 0.1f;
+        signal[i] = 0.4f * sinf(2 * PI * i / 32) + 0.3f * sinf(2 * PI * i / 5) + noise;
+    }
+
+    bool ok = true;
+    ok &= benchmark<float32_t>("f32", coeffs, signal);
+    ok &= benchmark<q31_t>("q31", coeffs, signal);
+    ok &= benchmark<q15_t>("q15", coeffs, signal);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+#include "mbed.h"
+#include "dsp.h"
+
+#define BLOCK_SIZE              (128)
+#define DECIMATION              (2)
+#define FFT_SIZE                (BLOCK_SIZE / DECIMATION)
+#define NUM_BLOCKS              (8)
+
+#define SAMPLE_RATE             (48000)
+
+/* 1.5KHz falls on bin 4 of the 64 points FFT at 24KHz, 15KHz aliases to 9KHz (bin 24) */
+#define SIGNAL_BIN              (4)
+#define ALIAS_BIN               (24)
+#define REJECTION_THRESHOLD     (100.0f)
+
+/* FIR Coefficients buffer generated using fir1() MATLAB function: fir1(28, 6/24) */
+#define NUM_TAPS            29
+const float32_t firCoeffs32[NUM_TAPS] = {
+    -0.0018225230f, -0.0015879294f, +0.0000000000f, +0.0036977508f, +0.0080754303f,
+    +0.0085302217f, -0.0000000000f, -0.0173976984f, -0.0341458607f, -0.0333591565f,
+    +0.0000000000f, +0.0676308395f, +0.1522061835f, +0.2229246956f, +0.2504960933f,
+    +0.2229246956f, +0.1522061835f, +0.0676308395f, +0.0000000000f, -0.0333591565f,
+    -0.0341458607f, -0.0173976984f, -0.0000000000f, +0.0085302217f, +0.0080754303f,
+    +0.0036977508f, +0.0000000000f, -0.0015879294f, -0.0018225230f
+};
+
+/* Two stages low pass biquad: {b0, 0, b1, b2, a1, a2} per stage, post shift of 1 */
+#define NUM_STAGES          2
+const q15_t biquadCoeffsQ15[6 * NUM_STAGES] = {
+    1024, 0, 2048, 1024, 15000, -6000,
+    1024, 0, 2048, 1024, 12000, -4000
+};
+
+typedef FIR<float32_t, NUM_TAPS, BLOCK_SIZE> LowPass;
+typedef Decimator<float32_t, NUM_TAPS, DECIMATION, BLOCK_SIZE> Down;
+typedef RFFT<float32_t, FFT_SIZE> Spectrum;
+
+typedef FIR<q15_t, 30, BLOCK_SIZE> LowPassQ15;
+typedef Biquad<q15_t, NUM_STAGES, BLOCK_SIZE> BiquadQ15;
+
+float32_t magnitude(const float32_t *spectrum, uint32_t bin) {
+    float32_t re = spectrum[2 * bin], im = spectrum[2 * bin + 1];
+    float32_t mag;
+    arm_sqrt_f32(re * re + im * im, &mag);
+    return mag;
+}
+
+bool test_spectrum() {
+    Sine_f32 sine_1_5KHz(1500, SAMPLE_RATE, 1.0, 0.0, BLOCK_SIZE);
+    Sine_f32 sine_15KHz(15000, SAMPLE_RATE, 0.5, 0.0, BLOCK_SIZE);
+
+    LowPass fir(firCoeffs32);
+    Down decimator(firCoeffs32);
+    Spectrum fft;
+    if (decimator.status() != ARM_MATH_SUCCESS || fft.status() != ARM_MATH_SUCCESS) {
+        return false;
+    }
+    Chain<LowPass, Down> front(fir, decimator);
+    Chain<Chain<LowPass, Down>, Spectrum> pipeline(front, fft);
+
+    // The DMA is emulated by generating each half and signalling it as an interrupt would
+    PingPongBuffer<float32_t, BLOCK_SIZE> adc;
+    float32_t spectrum[Spectrum::output_size];
+    for (uint32_t i = 0; i < NUM_BLOCKS; i++) {
+        float32_t *half = adc.data() + (i & 1) * BLOCK_SIZE;
+        sine_1_5KHz.generate(half);
+        sine_15KHz.process(half, half);
+        if (i & 1) {
+            adc.complete();
+        } else {
+            adc.half_complete();
+        }
+        if (!adc.process(pipeline, spectrum)) {
+            return false;
+        }
+    }
+    if (adc.overruns() != 0) {
+        return false;
+    }
+
+    float32_t signal = magnitude(spectrum, SIGNAL_BIN);
+    float32_t alias = magnitude(spectrum, ALIAS_BIN);
+    printf("signal: %f alias: %f\n\r", signal, alias);
+    return signal > alias * REJECTION_THRESHOLD;
+}
+
+bool test_in_place_chain() {
+    q15_t coeffs[30];
+    for (int i = 0; i < 30; i++) {
+        coeffs[i] = 1000;
+    }
+    LowPassQ15 fir_a(coeffs), fir_b(coeffs);
+    BiquadQ15 biquad_a(biquadCoeffsQ15, 1), biquad_b(biquadCoeffsQ15, 1);
+    if (fir_a.status() != ARM_MATH_SUCCESS) {
+        return false;
+    }
+    Chain<LowPassQ15, BiquadQ15> chain(fir_a, biquad_a);
+
+    // Chaining in place must give the same result as running each stage with its own buffers
+    q15_t input[BLOCK_SIZE], chained[BLOCK_SIZE], buffer[BLOCK_SIZE], expected[BLOCK_SIZE];
+    for (uint32_t block = 0; block < NUM_BLOCKS; block++) {
+        for (uint32_t i = 0; i < BLOCK_SIZE; i++) {
+            input[i] = (q15_t)((i * 2654435761u + block) >> 17);
+        }
+        memcpy(chained, input, sizeof(input));
+        chain.process(chained, chained);
+
+        fir_b.process(input, buffer);
+        biquad_b.process(buffer, expected);
+        if (memcmp(chained, expected, sizeof(expected)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    if (test_spectrum() && test_in_place_chain()) {
+        printf("Success\n\r");
+    } else {
+        printf("Failed\n\r");
+    }
+}
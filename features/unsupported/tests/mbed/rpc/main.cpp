@@ -22,6 +22,46 @@ bool rpc_test(const char *input, const char *expected) {
     return result;
 }
 
+bool rpc_binary_test(const char *object) {
+    char outbuf[RPC_MAX_STRING] = {0};
+    char request_text[RPC_MAX_STRING];
+
+    // Resolve the ids once with text requests
+    sprintf(request_text, "/RPC/id %s", object);
+    RPC::call(request_text, outbuf);
+    uint16_t id = atoi(outbuf);
+    sprintf(request_text, "/RPC/method %s write", object);
+    RPC::call(request_text, outbuf);
+    uint8_t write = atoi(outbuf);
+    sprintf(request_text, "/RPC/method %s read", object);
+    RPC::call(request_text, outbuf);
+    uint8_t read = atoi(outbuf);
+
+    // Batch a write, a read and a call to an unknown object in a single frame
+    const uint8_t request[] = {
+        RPC_BINARY_SYNC, 3,
+        (uint8_t)(id & 0xFF), (uint8_t)(id >> 8), write, 4, 0, 0, 0, 0,
+        (uint8_t)(id & 0xFF), (uint8_t)(id >> 8), read, 0,
+        0xFF, 0xFF, read, 0
+    };
+    const uint8_t expected[] = {
+        RPC_BINARY_SYNC, 3,
+        RPC_BINARY_OK, 0,
+        RPC_BINARY_OK, 4, 0, 0, 0, 0,
+        RPC_BINARY_NO_OBJECT, 0
+    };
+    uint8_t reply[RPC_MAX_STRING];
+    int length = RPC::call_binary(request, sizeof(request), reply, sizeof(reply));
+    printf("RPC binary: %s (id %d) -> ", object, id);
+
+    if ((length != sizeof(expected)) || (memcmp(reply, expected, sizeof(expected)) != 0)) {
+        printf("%d bytes ... [FAIL]\r\n", length);
+        return false;
+    }
+    printf("%d bytes ... [OK]\r\n", length);
+    return true;
+}
+
 #define RPC_TEST(INPUT,EXPECTED) result = result && rpc_test(INPUT,EXPECTED); if (result == false) { notify_completion(result); exit(1); }
 
 int main() {
@@ -62,6 +102,10 @@ int main() {
     RPC_TEST("/led2/delete", "");
     RPC_TEST("/", "led1 foo f DigitalOut RPC");
 
+    // Binary frame
+    result = result && rpc_binary_test("led1");
+    RPC_TEST("/led1/read", "0");
+
     notify_completion(result);
     return 0;
 }
@@ -80,6 +80,19 @@ extern "C" {
  */
 void i2c_init(i2c_t *obj, PinName sda, PinName scl);
 
+#if DEVICE_I2C_COUNT
+/** Get the peripheral the pins are routed to
+ *
+ *  Only required on targets defining DEVICE_I2C_COUNT. It lets the driver
+ *  layer track ownership, locking and queued transfers per peripheral.
+ *
+ *  @param sda  The sda pin
+ *  @param scl  The scl pin
+ *  @return     The I2C peripheral, in the range [0, DEVICE_I2C_COUNT)
+ */
+I2CName i2c_get_peripheral_name(PinName sda, PinName scl);
+#endif
+
 /** Configure the I2C frequency
  *
  *  @param obj The I2C object
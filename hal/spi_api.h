@@ -71,6 +71,19 @@ extern "C" {
  */
 void spi_init(spi_t *obj, PinName mosi, PinName miso, PinName sclk, PinName ssel);
 
+#if DEVICE_SPI_COUNT
+/** Get the peripheral the pins are routed to
+ *
+ * Only required on targets defining DEVICE_SPI_COUNT. It lets the driver
+ * layer track ownership, locking and queued transfers per peripheral.
+ * @param[in]  mosi The pin to use for MOSI
+ * @param[in]  miso The pin to use for MISO
+ * @param[in]  sclk The pin to use for SCLK
+ * @return     The SPI peripheral, in the range [0, DEVICE_SPI_COUNT)
+ */
+SPIName spi_get_peripheral_name(PinName mosi, PinName miso, PinName sclk);
+#endif
+
 /** Release a SPI object
  *
  * TODO: spi_free is currently unimplemented
@@ -18,6 +18,7 @@
  *
  */
 
+#include <ctype.h>
 #include "ATCmdParser.h"
 #include "mbed_poll.h"
 #include "mbed_debug.h"
@@ -36,6 +37,313 @@
 #define CR  13
 #endif
 
+// Response matching
+//
+// Instead of running sscanf over the whole received line for each new
+// character, a response line is compiled into a small program which is
+// then run once on each received character. The program is stored at
+// the front of _buffer, in place of the rewritten format used with sscanf.
+enum {
+    AT_OP_END,      // end of the format
+    AT_OP_SPACE,    // any amount of whitespace, including none
+    AT_OP_LITERAL,  // length, characters
+    AT_OP_FIELD,    // conversion, width (2 bytes, 0 for none), for %[: negated, length, set
+    AT_OP_COUNT     // %n, matches nothing
+};
+
+struct at_match {
+    const char *op;
+    int pos;        // characters matched by the current operation
+    bool digits;    // the current numeric field has matched a digit
+    bool failed;
+};
+
+static int at_op_size(const char *op)
+{
+    switch (op[0]) {
+        case AT_OP_LITERAL:
+            return 2 + (uint8_t)op[1];
+        case AT_OP_FIELD:
+            return (op[1] == '[') ? 6 + (uint8_t)op[5] : 4;
+        default:
+            return 1;
+    }
+}
+
+// Compile the first length characters of a scanf format, returns the
+// program size or -1 if the format uses conversions that are not supported
+// or the program does not fit in size bytes
+static int at_compile(const char *format, int length, char *program, int size)
+{
+    int p = 0;
+    int literal = -1;
+    int i = 0;
+
+    while (i < length) {
+        if (p + 6 > size) {
+            return -1;
+        }
+        char c = format[i];
+        if (isspace((unsigned char)c)) {
+            program[p++] = AT_OP_SPACE;
+            literal = -1;
+            while (i < length && isspace((unsigned char)format[i])) {
+                i++;
+            }
+            continue;
+        }
+
+        if (c == '%') {
+            // "%%" skips whitespace with some C libraries and not others,
+            // leave it to sscanf
+            if (i + 1 >= length || format[i + 1] == '%') {
+                return -1;
+            }
+            i++;
+            if (format[i] == '*') {
+                i++;
+            }
+            int width = 0;
+            while (i < length && isdigit((unsigned char)format[i])) {
+                width = width * 10 + (format[i++] - '0');
+            }
+            while (i < length && format[i] && strchr("hljztLq", format[i])) {
+                i++;
+            }
+            if (i >= length || width > 0xFFFF) {
+                return -1;
+            }
+            char conv = format[i++];
+            literal = -1;
+            if (conv == 'n') {
+                program[p++] = AT_OP_COUNT;
+                continue;
+            }
+            if (!conv || !strchr("dusc[", conv)) {
+                return -1;
+            }
+            if (conv == 'c' && width == 0) {
+                width = 1;
+            }
+            program[p++] = AT_OP_FIELD;
+            program[p++] = conv;
+            program[p++] = width & 0xFF;
+            program[p++] = width >> 8;
+            if (conv == '[') {
+                bool negated = (i < length && format[i] == '^');
+                if (negated) {
+                    i++;
+                }
+                int start = i;
+                // a ']' right after the opening bracket is part of the set
+                if (i < length && format[i] == ']') {
+                    i++;
+                }
+                while (i < length && format[i] != ']') {
+                    i++;
+                }
+                int set_length = i - start;
+                if (i >= length || set_length > 0xFF || p + 2 + set_length > size) {
+                    return -1;
+                }
+                i++;
+                program[p++] = negated;
+                program[p++] = set_length;
+                memcpy(program + p, format + start, set_length);
+                p += set_length;
+            }
+            continue;
+        }
+
+        // Literal character, appended to the current literal when possible
+        if (literal < 0 || (uint8_t)program[literal + 1] == 0xFF) {
+            literal = p;
+            program[p++] = AT_OP_LITERAL;
+            program[p++] = 0;
+        }
+        program[literal + 1]++;
+        program[p++] = c;
+        i++;
+    }
+
+    program[p++] = AT_OP_END;
+    return p;
+}
+
+static bool at_in_set(const char *op, char c)
+{
+    bool negated = op[4];
+    int length = (uint8_t)op[5];
+    const char *set = op + 6;
+    for (int i = 0; i < length; i++) {
+        if (i + 2 < length && set[i + 1] == '-') {
+            if ((unsigned char)c >= (unsigned char)set[i] && (unsigned char)c <= (unsigned char)set[i + 2]) {
+                return !negated;
+            }
+            i += 2;
+        } else if (c == set[i]) {
+            return !negated;
+        }
+    }
+    return negated;
+}
+
+// Whether the characters matched by the current field form a valid conversion
+static bool at_field_valid(const at_match *m)
+{
+    switch (m->op[1]) {
+        case 'd':
+        case 'u':
+            return m->digits;
+        default:
+            // like sscanf, this includes a %c cut short by the end of the input
+            return m->pos > 0;
+    }
+}
+
+static void at_match_start(at_match *m, const char *program)
+{
+    m->op = program;
+    m->pos = 0;
+    m->digits = false;
+    m->failed = false;
+}
+
+static void at_match_advance(at_match *m)
+{
+    m->op += at_op_size(m->op);
+    m->pos = 0;
+    m->digits = false;
+}
+
+// Run the program on the next received character
+static void at_match_next(at_match *m, char c)
+{
+    while (!m->failed) {
+        const char *op = m->op;
+        switch (op[0]) {
+            case AT_OP_SPACE:
+                if (isspace((unsigned char)c)) {
+                    return;
+                }
+                at_match_advance(m);
+                break;
+
+            case AT_OP_LITERAL:
+                if (c != op[2 + m->pos]) {
+                    m->failed = true;
+                    return;
+                }
+                if (++m->pos == (uint8_t)op[1]) {
+                    at_match_advance(m);
+                }
+                return;
+
+            case AT_OP_COUNT:
+                at_match_advance(m);
+                break;
+
+            case AT_OP_FIELD: {
+                char conv = op[1];
+                int width = (uint8_t)op[2] | ((uint8_t)op[3] << 8);
+                bool accepted;
+                if (m->pos == 0 && conv != 'c' && conv != '[' && isspace((unsigned char)c)) {
+                    // leading whitespace is skipped
+                    return;
+                }
+                switch (conv) {
+                    case 'd':
+                    case 'u':
+                        accepted = isdigit((unsigned char)c) || (m->pos == 0 && (c == '+' || c == '-'));
+                        m->digits |= isdigit((unsigned char)c) != 0;
+                        break;
+                    case 's':
+                        accepted = !isspace((unsigned char)c);
+                        break;
+                    case '[':
+                        accepted = at_in_set(op, c);
+                        break;
+                    default:
+                        accepted = true;
+                        break;
+                }
+                if (accepted) {
+                    if (++m->pos == width) {
+                        if (!at_field_valid(m)) {
+                            m->failed = true;
+                            return;
+                        }
+                        at_match_advance(m);
+                    }
+                    return;
+                }
+                // the character ends the field and goes to the next operation
+                if (!at_field_valid(m)) {
+                    m->failed = true;
+                    return;
+                }
+                at_match_advance(m);
+                break;
+            }
+
+            default:
+                // characters after the end of the format
+                m->failed = true;
+                return;
+        }
+    }
+}
+
+// Whether the whole format matches the characters received so far,
+// which is what sscanf reports by reaching a final %n
+static bool at_match_complete(const at_match *m)
+{
+    if (m->failed) {
+        return false;
+    }
+    const char *op = m->op;
+    if (op[0] == AT_OP_FIELD) {
+        if (!at_field_valid(m)) {
+            return false;
+        }
+        op += at_op_size(op);
+    } else if (op[0] == AT_OP_LITERAL) {
+        return false;
+    }
+    for (; op[0] != AT_OP_END; op += at_op_size(op)) {
+        if (op[0] != AT_OP_SPACE && op[0] != AT_OP_COUNT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Copy a format for the sscanf fallback: value-matches are clobbered with
+// asterisks and a %n is added to find out if the entire string was matched
+static int at_scanf_format(const char *format, int length, char *buffer)
+{
+    int i = 0;
+    int offset = 0;
+
+    while (i < length) {
+        if (format[i] == '%' && format[i+1] == '%') {
+            buffer[offset++] = format[i++];
+            buffer[offset++] = format[i++];
+        } else if (format[i] == '%' && format[i+1] != '*') {
+            buffer[offset++] = '%';
+            buffer[offset++] = '*';
+            i++;
+        } else {
+            buffer[offset++] = format[i++];
+        }
+    }
+
+    buffer[offset++] = '%';
+    buffer[offset++] = 'n';
+    buffer[offset++] = 0;
+    return offset;
+}
+
 // getc/putc handling with timeouts
 int ATCmdParser::putc(char c)
 {
@@ -120,37 +428,20 @@ int ATCmdParser::vprintf(const char *format, va_list args)
 
 int ATCmdParser::vscanf(const char *format, va_list args)
 {
-    // Since format is const, we need to copy it into our buffer to
-    // add the line's null terminator and clobber value-matches with asterisks.
+    // Since format is const, we need to compile it into our buffer, or copy it
+    // to add the line's null terminator and clobber value-matches with asterisks
+    // if the matcher cannot handle it.
     //
     // We just use the beginning of the buffer to avoid unnecessary allocations.
-    int i = 0;
-    int offset = 0;
-
-    while (format[i]) {
-        if (format[i] == '%' && format[i+1] != '%' && format[i+1] != '*') {
-            _buffer[offset++] = '%';
-            _buffer[offset++] = '*';
-            i++;
-        } else {
-            _buffer[offset++] = format[i++];
-        }
+    int length = strlen(format);
+    int offset = at_compile(format, length, _buffer, _buffer_size / 2);
+    bool compiled = (offset > 0);
+    if (!compiled) {
+        offset = at_scanf_format(format, length, _buffer);
     }
 
-    // Scanf has very poor support for catching errors
-    // fortunately, we can abuse the %n specifier to determine
-    // if the entire string was matched.
-    _buffer[offset++] = '%';
-    _buffer[offset++] = 'n';
-    _buffer[offset++] = 0;
-
-    // To workaround scanf's lack of error reporting, we actually
-    // make two passes. One checks the validity with the modified
-    // format string that only stores the matched characters (%n).
-    // The other reads in the actual matched values.
-    //
-    // We keep trying the match until we succeed or some other error
-    // derails us.
+    at_match match;
+    at_match_start(&match, _buffer);
     int j = 0;
 
     while (true) {
@@ -168,7 +459,17 @@ int ATCmdParser::vscanf(const char *format, va_list args)
 
         // Check for match
         int count = -1;
-        sscanf(_buffer+offset, _buffer, &count);
+        if (compiled) {
+            at_match_next(&match, c);
+            if (at_match_complete(&match)) {
+                count = j;
+            }
+        } else {
+            // Scanf has very poor support for catching errors
+            // fortunately, we can abuse the %n specifier to determine
+            // if the entire string was matched.
+            sscanf(_buffer+offset, _buffer, &count);
+        }
 
         // We only succeed if all characters in the response are matched
         if (count == j) {
@@ -211,44 +512,38 @@ restart:
     _aborted = false;
     // Iterate through each line in the expected response
     while (response[0]) {
-        // Since response is const, we need to copy it into our buffer to
-        // add the line's null terminator and clobber value-matches with asterisks.
-        //
-        // We just use the beginning of the buffer to avoid unnecessary allocations.
+        // Find the end of the line, taking care not to be fooled by linebreaks
+        // in a %[^\n] conversion specification
         int i = 0;
-        int offset = 0;
         bool whole_line_wanted = false;
 
         while (response[i]) {
-            if (response[i] == '%' && response[i+1] != '%' && response[i+1] != '*') {
-                _buffer[offset++] = '%';
-                _buffer[offset++] = '*';
-                i++;
-            } else {
-                _buffer[offset++] = response[i++];
-                // Find linebreaks, taking care not to be fooled if they're in a %[^\n] conversion specification
-                if (response[i - 1] == '\n' && !(i >= 3 && response[i-3] == '[' && response[i-2] == '^')) {
-                    whole_line_wanted = true;
-                    break;
-                }
+            i++;
+            if (response[i - 1] == '\n' && !(i >= 3 && response[i-3] == '[' && response[i-2] == '^')) {
+                whole_line_wanted = true;
+                break;
             }
         }
 
-        // Scanf has very poor support for catching errors
-        // fortunately, we can abuse the %n specifier to determine
-        // if the entire string was matched.
-        _buffer[offset++] = '%';
-        _buffer[offset++] = 'n';
-        _buffer[offset++] = 0;
-
-        debug_if(_dbg_on, "AT? %s\n", _buffer);
-        // To workaround scanf's lack of error reporting, we actually
-        // make two passes. One checks the validity with the modified
-        // format string that only stores the matched characters (%n).
-        // The other reads in the actual matched values.
+        // Since response is const, we need to compile the line into our buffer,
+        // or copy it to add the line's null terminator and clobber value-matches
+        // with asterisks if the matcher cannot handle it.
         //
-        // We keep trying the match until we succeed or some other error
-        // derails us.
+        // We just use the beginning of the buffer to avoid unnecessary allocations.
+        int offset = at_compile(response, i, _buffer, _buffer_size / 2);
+        bool compiled = (offset > 0);
+        if (!compiled) {
+            offset = at_scanf_format(response, i, _buffer);
+        }
+        // Leave room to copy the line back for the final vsscanf
+        if (offset < i + 1) {
+            offset = i + 1;
+        }
+
+        debug_if(_dbg_on, "AT? %.*s\n", i, response);
+        at_match match;
+        at_match_start(&match, _buffer);
+        oob_node *oob_level = _oob_trie;
         int j = 0;
 
         while (true) {
@@ -275,29 +570,37 @@ restart:
             _buffer[offset + j] = 0;
 
             // Check for oob data
-            for (struct oob *oob = _oobs; oob; oob = oob->next) {
-                if ((unsigned)j == oob->len && memcmp(
-                        oob->prefix, _buffer+offset, oob->len) == 0) {
-                    debug_if(_dbg_on, "AT! %s\n", oob->prefix);
-                    oob->cb();
-
-                    if (_aborted) {
-                        debug_if(_dbg_on, "AT(Aborted)\n");
-                        return false;
-                    }
-                    // oob may have corrupted non-reentrant buffer,
-                    // so we need to set it up again
-                    goto restart;
+            struct oob *oob = match_oob(oob_level, c);
+            if (oob) {
+                debug_if(_dbg_on, "AT! %s\n", oob->prefix);
+                oob->cb();
+
+                if (_aborted) {
+                    debug_if(_dbg_on, "AT(Aborted)\n");
+                    return false;
                 }
+                // oob may have corrupted non-reentrant buffer,
+                // so we need to set it up again
+                goto restart;
             }
 
             // Check for match
             int count = -1;
+            if (compiled) {
+                at_match_next(&match, c);
+            }
             if (whole_line_wanted && c != '\n') {
                 // Don't attempt scanning until we get delimiter if they included it in format
                 // This allows recv("Foo: %s\n") to work, and not match with just the first character of a string
                 // (scanf does not itself match whitespace in its format string, so \n is not significant to it)
+            } else if (compiled) {
+                if (at_match_complete(&match)) {
+                    count = j;
+                }
             } else {
+                // Scanf has very poor support for catching errors
+                // fortunately, we can abuse the %n specifier to determine
+                // if the entire string was matched.
                 sscanf(_buffer+offset, _buffer, &count);
             }
 
@@ -321,6 +624,8 @@ restart:
             if (c == '\n' || j+1 >= _buffer_size - offset) {
                 debug_if(_dbg_on, "AT< %s", _buffer+offset);
                 j = 0;
+                at_match_start(&match, _buffer);
+                oob_level = _oob_trie;
             }
         }
     }
@@ -374,6 +679,50 @@ void ATCmdParser::oob(const char *prefix, Callback<void()> cb)
     oob->cb = cb;
     oob->next = _oobs;
     _oobs = oob;
+
+    // Add the prefix to the trie, a newer handler takes over the prefix of an older one
+    oob_node **level = &_oob_trie;
+    oob_node *node = NULL;
+    for (const char *p = prefix; *p; p++) {
+        for (node = *level; node && node->c != *p; node = node->sibling);
+        if (!node) {
+            node = new oob_node;
+            node->c = *p;
+            node->match = NULL;
+            node->child = NULL;
+            node->sibling = *level;
+            *level = node;
+        }
+        level = &node->child;
+    }
+    if (node) {
+        node->match = oob;
+    }
+}
+
+struct ATCmdParser::oob *ATCmdParser::match_oob(oob_node *&level, char c)
+{
+    oob_node *node = level;
+    while (node && node->c != c) {
+        node = node->sibling;
+    }
+    if (!node) {
+        // No prefix starts like this line, stop looking until the next line
+        level = NULL;
+        return NULL;
+    }
+    level = node->child;
+    return node->match;
+}
+
+void ATCmdParser::free_oob_trie(oob_node *node)
+{
+    while (node) {
+        oob_node *sibling = node->sibling;
+        free_oob_trie(node->child);
+        delete node;
+        node = sibling;
+    }
 }
 
 void ATCmdParser::abort()
@@ -388,6 +737,7 @@ bool ATCmdParser::process_oob()
     }
 
     int i = 0;
+    oob_node *oob_level = _oob_trie;
     while (true) {
         // Receive next character
         int c = getc();
@@ -411,15 +761,11 @@ bool ATCmdParser::process_oob()
         _buffer[i] = 0;
 
         // Check for oob data
-        struct oob *oob = _oobs;
-        while (oob) {
-            if (i == (int)oob->len && memcmp(
-                    oob->prefix, _buffer, oob->len) == 0) {
-                debug_if(_dbg_on, "AT! %s\r\n", oob->prefix);
-                oob->cb();
-                return true;
-            }
-            oob = oob->next;
+        struct oob *oob = match_oob(oob_level, c);
+        if (oob) {
+            debug_if(_dbg_on, "AT! %s\r\n", oob->prefix);
+            oob->cb();
+            return true;
         }
         
         // Clear the buffer when we hit a newline or ran out of space
@@ -427,6 +773,7 @@ bool ATCmdParser::process_oob()
         if (((i+1) >= _buffer_size) || (c == '\n')) {
             debug_if(_dbg_on, "AT< %s", _buffer);
             i = 0;
+            oob_level = _oob_trie;
         }
     }
 }
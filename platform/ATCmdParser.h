@@ -78,6 +78,18 @@ private:
     };
     oob *_oobs;
 
+    // Trie of the oob prefixes, walked one received character at a time
+    struct oob_node {
+        char c;
+        struct oob *match;
+        oob_node *child;
+        oob_node *sibling;
+    };
+    oob_node *_oob_trie;
+
+    struct oob *match_oob(oob_node *&level, char c);
+    static void free_oob_trie(oob_node *node);
+
 public:
 
     /**
@@ -91,7 +103,7 @@ public:
      */
     ATCmdParser(FileHandle *fh, const char *output_delimiter = "\r",
              int buffer_size = 256, int timeout = 8000, bool debug = false)
-            : _fh(fh), _buffer_size(buffer_size), _in_prev(0), _oobs(NULL)
+            : _fh(fh), _buffer_size(buffer_size), _in_prev(0), _oobs(NULL), _oob_trie(NULL)
     {
         _buffer = new char[buffer_size];
         set_timeout(timeout);
@@ -109,6 +121,7 @@ public:
             _oobs = oob->next;
             delete oob;
         }
+        free_oob_trie(_oob_trie);
         delete[] _buffer;
     }
 
@@ -209,6 +222,11 @@ public:
      * Any received data that does not match the response is ignored until
      * a timeout occurs.
      *
+     * Each line of the response is compiled once and matched as the characters
+     * arrive. Formats made of literals, whitespace and the %d, %u, %s, %c, %[...]
+     * and %n conversions are matched without calling sscanf until the whole line
+     * has matched; other conversions fall back to sscanf on every character.
+     *
      * @param response scanf-like format string of response to expect
      * @param ... all scanf-like arguments to extract from response
      * @return true only if response is successfully matched
@@ -0,0 +1,1440 @@
+/* mbed Microcontroller Library
+ * Copyright (c) 2018 ARM Limited
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef MBED_INPLACECALLBACK_H
+#define MBED_INPLACECALLBACK_H
+
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include "platform/Callback.h"
+#include "platform/mbed_assert.h"
+#include "platform/mbed_toolchain.h"
+
+namespace mbed {
+/** \addtogroup platform */
+/** @{*/
+/**
+ * \defgroup platform_InplaceCallback InplaceCallback class
+ * @{
+ */
+
+/** Default inline storage of an InplaceCallback, in bytes
+ *
+ *  Large enough for a member function bound to an object plus one
+ *  extra word of captured state.
+ */
+#ifndef MBED_INPLACE_CALLBACK_SIZE
+#define MBED_INPLACE_CALLBACK_SIZE (4 * sizeof(void*))
+#endif
+
+/** Callback class with inline storage for larger function objects
+ *
+ *  Unlike Callback, which is limited to a single word of function object
+ *  state, an InplaceCallback stores function objects of up to Size bytes
+ *  directly in the object, so functors with bound arguments need neither
+ *  heap allocation nor a wrapper object that outlives the callback.
+ *
+ *  Static functions are called directly without going through a thunk,
+ *  and trivially copyable targets (functions, bound members and plain
+ *  function objects) are copied and destroyed without any dispatch.
+ *
+ *  @note Synchronization level: Not protected
+ */
+template <typename F, size_t Size = MBED_INPLACE_CALLBACK_SIZE>
+class InplaceCallback;
+
+// Internal sfinae declarations
+//
+// Function objects are accepted if they have a call operator and fit in
+// the inline storage, the remaining checks are shared with Callback
+#define MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, M, S)                 \
+    typename detail::enable_if<                                             \
+            detail::is_type<M, &F::operator()>::value &&                    \
+            sizeof(F) <= (S)                                                \
+        >::type = detail::nil()
+
+// Trivially copyable function objects skip the move and destroy operations.
+// Toolchains without the type trait intrinsics always use them.
+#if defined(__GNUC__) || defined(__clang__)
+#define MBED_INPLACE_CALLBACK_TRIVIAL(F) \
+    (__has_trivial_copy(F) && __has_trivial_destructor(F))
+#else
+#define MBED_INPLACE_CALLBACK_TRIVIAL(F) false
+#endif
+
+namespace detail {
+
+// Member function bound to an object, stored inline
+template <typename O, typename M>
+struct inplace_method_context {
+    M method;
+    O *obj;
+};
+
+// Static function bound to a pointer argument, stored inline
+template <typename F, typename A>
+struct inplace_function_context {
+    F func;
+    A *arg;
+};
+
+// Equality of stored function objects of the same type. Bound functions
+// compare their function and object pointers, other function objects
+// compare their bytes as Callback does.
+template <typename F>
+inline bool inplace_equal(const F &l, const F &r) {
+    return memcmp(&l, &r, sizeof(F)) == 0;
+}
+
+template <typename O, typename M>
+inline bool inplace_equal(const inplace_method_context<O, M> &l,
+                          const inplace_method_context<O, M> &r) {
+    return l.method == r.method && l.obj == r.obj;
+}
+
+template <typename F, typename A>
+inline bool inplace_equal(const inplace_function_context<F, A> &l,
+                          const inplace_function_context<F, A> &r) {
+    return l.func == r.func && l.arg == r.arg;
+}
+
+template <typename F>
+inline bool inplace_equal(const Callback<F> &l, const Callback<F> &r) {
+    return l == r;
+}
+
+/** Storage of an InplaceCallback, shared by all its arities
+ *
+ *  @tparam S Static function type of the callback
+ *  @tparam T Thunk type calling a stored function object
+ *  @tparam Size Inline storage in bytes
+ */
+template <typename S, typename T, size_t Size>
+class InplaceCallbackBase {
+public:
+    /** Test if function has been attached
+     */
+    operator bool() const {
+        return _thunk || _storage._staticfunc;
+    }
+
+    /** Test for equality
+     */
+    friend bool operator==(const InplaceCallbackBase &l, const InplaceCallbackBase &r) {
+        if (l._thunk != r._thunk || l._ops != r._ops) {
+            return false;
+        }
+        if (!l._ops) {
+            return l._storage._staticfunc == r._storage._staticfunc;
+        }
+        return l._ops->equal(&l._storage, &r._storage);
+    }
+
+    /** Test for inequality
+     */
+    friend bool operator!=(const InplaceCallbackBase &l, const InplaceCallbackBase &r) {
+        return !(l == r);
+    }
+
+protected:
+    InplaceCallbackBase(S func = 0) {
+        memset(&_storage, 0, sizeof(_storage));
+        _storage._staticfunc = func;
+        _thunk = 0;
+        _ops = 0;
+    }
+
+    InplaceCallbackBase(const InplaceCallbackBase &that) {
+        copy(that);
+    }
+
+    ~InplaceCallbackBase() {
+        if (_ops && _ops->dtor) {
+            _ops->dtor(&_storage);
+        }
+    }
+
+    InplaceCallbackBase &operator=(const InplaceCallbackBase &that) {
+        if (this != &that) {
+            this->~InplaceCallbackBase();
+            copy(that);
+        }
+
+        return *this;
+    }
+
+    // Store a function object in an empty callback
+    template <typename F>
+    void generate(const F &f, T thunk, bool trivial) {
+        static const ops trivial_ops = {
+            0,
+            0,
+            &InplaceCallbackBase::function_equal<F>,
+        };
+        static const ops full_ops = {
+            &InplaceCallbackBase::function_move<F>,
+            &InplaceCallbackBase::function_dtor<F>,
+            &InplaceCallbackBase::function_equal<F>,
+        };
+
+        MBED_STATIC_ASSERT(sizeof(_storage) >= sizeof(F),
+                "Type F must not exceed the inline storage of the InplaceCallback");
+        new (&_storage) F(f);
+        _thunk = thunk;
+        _ops = trivial ? &trivial_ops : &full_ops;
+    }
+
+    // Function object storage, aligned for any of the stored types.
+    // Static functions are stored in _staticfunc and have no thunk.
+    struct _class;
+    union {
+        S _staticfunc;
+        void (_class::*_methodfunc)();
+        void *_obj;
+        uint64_t _align;
+        double _falign;
+        unsigned char _data[Size];
+    } _storage;
+
+    // Call thunk for function objects, NULL for static functions
+    T _thunk;
+
+private:
+    // Operations for function objects, NULL for static functions. Trivially
+    // copyable function objects have no move and dtor, their storage is
+    // copied as raw memory.
+    const struct ops {
+        void (*move)(void*, const void*);
+        void (*dtor)(void*);
+        bool (*equal)(const void*, const void*);
+    } *_ops;
+
+    void copy(const InplaceCallbackBase &that) {
+        if (that._ops && that._ops->move) {
+            memset(&_storage, 0, sizeof(_storage));
+            that._ops->move(&_storage, &that._storage);
+        } else {
+            memcpy(&_storage, &that._storage, sizeof(_storage));
+        }
+        _thunk = that._thunk;
+        _ops = that._ops;
+    }
+
+    template <typename F>
+    static void function_move(void *d, const void *p) {
+        new (d) F(*(F*)p);
+    }
+
+    template <typename F>
+    static void function_dtor(void *p) {
+        ((F*)p)->~F();
+    }
+
+    template <typename F>
+    static bool function_equal(const void *l, const void *r) {
+        return inplace_equal(*(const F*)l, *(const F*)r);
+    }
+};
+
+} // namespace detail
+
+/** Callback class with inline storage based on template specialization
+ *
+ * @note Synchronization level: Not protected
+ */
+template <typename R, size_t Size>
+class InplaceCallback<R(), Size>
+    : public detail::InplaceCallbackBase<R (*)(), R (*)(const void*), Size> {
+    typedef detail::InplaceCallbackBase<R (*)(), R (*)(const void*), Size> Base;
+
+public:
+    /** Create an InplaceCallback with a static function
+     *  @param func     Static function to attach
+     */
+    InplaceCallback(R (*func)() = 0)
+        : Base(func) {
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(U *obj, R (T::*method)()) {
+        generate_method<T, R (T::*)()>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(const U *obj, R (T::*method)() const) {
+        generate_method<const T, R (T::*)() const>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(volatile U *obj, R (T::*method)() volatile) {
+        generate_method<volatile T, R (T::*)() volatile>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(const volatile U *obj, R (T::*method)() const volatile) {
+        generate_method<const volatile T, R (T::*)() const volatile>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(T*), U *arg) {
+        generate_function<R (*)(T*), T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(const T*), const U *arg) {
+        generate_function<R (*)(const T*), const T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(volatile T*), volatile U *arg) {
+        generate_function<R (*)(volatile T*), volatile T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(const volatile T*), const volatile U *arg) {
+        generate_function<R (*)(const volatile T*), const volatile T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(), Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(const F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)() const, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(volatile F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)() volatile, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(const volatile F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)() const volatile, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback from a Callback
+     *  @param func     The Callback to attach
+     */
+    InplaceCallback(const Callback<R()> &func) {
+        if (func) {
+            this->generate(func, &InplaceCallback::function_call<Callback<R()> >, false);
+        }
+    }
+
+    /** Call the attached function
+     */
+    R call() const {
+        if (this->_thunk) {
+            return this->_thunk(&this->_storage);
+        }
+
+        MBED_ASSERT(this->_storage._staticfunc);
+        return this->_storage._staticfunc();
+    }
+
+    /** Call the attached function
+     */
+    R operator()() const {
+        return call();
+    }
+
+    /** Static thunk for passing as C-style function
+     *  @param func InplaceCallback to call passed as void pointer
+     *  @return the value as determined by func which is of
+     *      type and determined by the signiture of func
+     */
+    static R thunk(void *func) {
+        return static_cast<InplaceCallback*>(func)->call();
+    }
+
+private:
+    template <typename O, typename M>
+    void generate_method(O *obj, M method) {
+        detail::inplace_method_context<O, M> context = { method, obj };
+        this->generate(context, &InplaceCallback::method_call<O, M>, true);
+    }
+
+    template <typename F, typename A>
+    void generate_function(F func, A *arg) {
+        detail::inplace_function_context<F, A> context = { func, arg };
+        this->generate(context, &InplaceCallback::function_context_call<F, A>, true);
+    }
+
+    // Call thunks of the stored function objects
+    template <typename F>
+    static R function_call(const void *p) {
+        return (*(F*)p)();
+    }
+
+    template <typename O, typename M>
+    static R method_call(const void *p) {
+        const detail::inplace_method_context<O, M> *context =
+            static_cast<const detail::inplace_method_context<O, M>*>(p);
+        return (context->obj->*context->method)();
+    }
+
+    template <typename F, typename A>
+    static R function_context_call(const void *p) {
+        const detail::inplace_function_context<F, A> *context =
+            static_cast<const detail::inplace_function_context<F, A>*>(p);
+        return context->func(context->arg);
+    }
+};
+
+/** Callback class with inline storage based on template specialization
+ *
+ * @note Synchronization level: Not protected
+ */
+template <typename R, typename A0, size_t Size>
+class InplaceCallback<R(A0), Size>
+    : public detail::InplaceCallbackBase<R (*)(A0), R (*)(const void*, A0), Size> {
+    typedef detail::InplaceCallbackBase<R (*)(A0), R (*)(const void*, A0), Size> Base;
+
+public:
+    /** Create an InplaceCallback with a static function
+     *  @param func     Static function to attach
+     */
+    InplaceCallback(R (*func)(A0) = 0)
+        : Base(func) {
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(U *obj, R (T::*method)(A0)) {
+        generate_method<T, R (T::*)(A0)>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(const U *obj, R (T::*method)(A0) const) {
+        generate_method<const T, R (T::*)(A0) const>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(volatile U *obj, R (T::*method)(A0) volatile) {
+        generate_method<volatile T, R (T::*)(A0) volatile>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(const volatile U *obj, R (T::*method)(A0) const volatile) {
+        generate_method<const volatile T, R (T::*)(A0) const volatile>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(T*, A0), U *arg) {
+        generate_function<R (*)(T*, A0), T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(const T*, A0), const U *arg) {
+        generate_function<R (*)(const T*, A0), const T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(volatile T*, A0), volatile U *arg) {
+        generate_function<R (*)(volatile T*, A0), volatile T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(const volatile T*, A0), const volatile U *arg) {
+        generate_function<R (*)(const volatile T*, A0), const volatile T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0), Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(const F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0) const, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(volatile F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0) volatile, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(const volatile F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0) const volatile, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback from a Callback
+     *  @param func     The Callback to attach
+     */
+    InplaceCallback(const Callback<R(A0)> &func) {
+        if (func) {
+            this->generate(func, &InplaceCallback::function_call<Callback<R(A0)> >, false);
+        }
+    }
+
+    /** Call the attached function
+     */
+    R call(A0 a0) const {
+        if (this->_thunk) {
+            return this->_thunk(&this->_storage, a0);
+        }
+
+        MBED_ASSERT(this->_storage._staticfunc);
+        return this->_storage._staticfunc(a0);
+    }
+
+    /** Call the attached function
+     */
+    R operator()(A0 a0) const {
+        return call(a0);
+    }
+
+    /** Static thunk for passing as C-style function
+     *  @param func InplaceCallback to call passed as void pointer
+     *  @param a0 An argument to be called with function func
+     *  @return the value as determined by func which is of
+     *      type and determined by the signiture of func
+     */
+    static R thunk(void *func, A0 a0) {
+        return static_cast<InplaceCallback*>(func)->call(a0);
+    }
+
+private:
+    template <typename O, typename M>
+    void generate_method(O *obj, M method) {
+        detail::inplace_method_context<O, M> context = { method, obj };
+        this->generate(context, &InplaceCallback::method_call<O, M>, true);
+    }
+
+    template <typename F, typename A>
+    void generate_function(F func, A *arg) {
+        detail::inplace_function_context<F, A> context = { func, arg };
+        this->generate(context, &InplaceCallback::function_context_call<F, A>, true);
+    }
+
+    // Call thunks of the stored function objects
+    template <typename F>
+    static R function_call(const void *p, A0 a0) {
+        return (*(F*)p)(a0);
+    }
+
+    template <typename O, typename M>
+    static R method_call(const void *p, A0 a0) {
+        const detail::inplace_method_context<O, M> *context =
+            static_cast<const detail::inplace_method_context<O, M>*>(p);
+        return (context->obj->*context->method)(a0);
+    }
+
+    template <typename F, typename A>
+    static R function_context_call(const void *p, A0 a0) {
+        const detail::inplace_function_context<F, A> *context =
+            static_cast<const detail::inplace_function_context<F, A>*>(p);
+        return context->func(context->arg, a0);
+    }
+};
+
+/** Callback class with inline storage based on template specialization
+ *
+ * @note Synchronization level: Not protected
+ */
+template <typename R, typename A0, typename A1, size_t Size>
+class InplaceCallback<R(A0, A1), Size>
+    : public detail::InplaceCallbackBase<R (*)(A0, A1), R (*)(const void*, A0, A1), Size> {
+    typedef detail::InplaceCallbackBase<R (*)(A0, A1), R (*)(const void*, A0, A1), Size> Base;
+
+public:
+    /** Create an InplaceCallback with a static function
+     *  @param func     Static function to attach
+     */
+    InplaceCallback(R (*func)(A0, A1) = 0)
+        : Base(func) {
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(U *obj, R (T::*method)(A0, A1)) {
+        generate_method<T, R (T::*)(A0, A1)>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(const U *obj, R (T::*method)(A0, A1) const) {
+        generate_method<const T, R (T::*)(A0, A1) const>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(volatile U *obj, R (T::*method)(A0, A1) volatile) {
+        generate_method<volatile T, R (T::*)(A0, A1) volatile>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(const volatile U *obj, R (T::*method)(A0, A1) const volatile) {
+        generate_method<const volatile T, R (T::*)(A0, A1) const volatile>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(T*, A0, A1), U *arg) {
+        generate_function<R (*)(T*, A0, A1), T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(const T*, A0, A1), const U *arg) {
+        generate_function<R (*)(const T*, A0, A1), const T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(volatile T*, A0, A1), volatile U *arg) {
+        generate_function<R (*)(volatile T*, A0, A1), volatile T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(const volatile T*, A0, A1), const volatile U *arg) {
+        generate_function<R (*)(const volatile T*, A0, A1), const volatile T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1), Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(const F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1) const, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(volatile F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1) volatile, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(const volatile F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1) const volatile, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback from a Callback
+     *  @param func     The Callback to attach
+     */
+    InplaceCallback(const Callback<R(A0, A1)> &func) {
+        if (func) {
+            this->generate(func, &InplaceCallback::function_call<Callback<R(A0, A1)> >, false);
+        }
+    }
+
+    /** Call the attached function
+     */
+    R call(A0 a0, A1 a1) const {
+        if (this->_thunk) {
+            return this->_thunk(&this->_storage, a0, a1);
+        }
+
+        MBED_ASSERT(this->_storage._staticfunc);
+        return this->_storage._staticfunc(a0, a1);
+    }
+
+    /** Call the attached function
+     */
+    R operator()(A0 a0, A1 a1) const {
+        return call(a0, a1);
+    }
+
+    /** Static thunk for passing as C-style function
+     *  @param func InplaceCallback to call passed as void pointer
+     *  @param a0 An argument to be called with function func
+     *  @param a1 An argument to be called with function func
+     *  @return the value as determined by func which is of
+     *      type and determined by the signiture of func
+     */
+    static R thunk(void *func, A0 a0, A1 a1) {
+        return static_cast<InplaceCallback*>(func)->call(a0, a1);
+    }
+
+private:
+    template <typename O, typename M>
+    void generate_method(O *obj, M method) {
+        detail::inplace_method_context<O, M> context = { method, obj };
+        this->generate(context, &InplaceCallback::method_call<O, M>, true);
+    }
+
+    template <typename F, typename A>
+    void generate_function(F func, A *arg) {
+        detail::inplace_function_context<F, A> context = { func, arg };
+        this->generate(context, &InplaceCallback::function_context_call<F, A>, true);
+    }
+
+    // Call thunks of the stored function objects
+    template <typename F>
+    static R function_call(const void *p, A0 a0, A1 a1) {
+        return (*(F*)p)(a0, a1);
+    }
+
+    template <typename O, typename M>
+    static R method_call(const void *p, A0 a0, A1 a1) {
+        const detail::inplace_method_context<O, M> *context =
+            static_cast<const detail::inplace_method_context<O, M>*>(p);
+        return (context->obj->*context->method)(a0, a1);
+    }
+
+    template <typename F, typename A>
+    static R function_context_call(const void *p, A0 a0, A1 a1) {
+        const detail::inplace_function_context<F, A> *context =
+            static_cast<const detail::inplace_function_context<F, A>*>(p);
+        return context->func(context->arg, a0, a1);
+    }
+};
+
+/** Callback class with inline storage based on template specialization
+ *
+ * @note Synchronization level: Not protected
+ */
+template <typename R, typename A0, typename A1, typename A2, size_t Size>
+class InplaceCallback<R(A0, A1, A2), Size>
+    : public detail::InplaceCallbackBase<R (*)(A0, A1, A2), R (*)(const void*, A0, A1, A2), Size> {
+    typedef detail::InplaceCallbackBase<R (*)(A0, A1, A2), R (*)(const void*, A0, A1, A2), Size> Base;
+
+public:
+    /** Create an InplaceCallback with a static function
+     *  @param func     Static function to attach
+     */
+    InplaceCallback(R (*func)(A0, A1, A2) = 0)
+        : Base(func) {
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(U *obj, R (T::*method)(A0, A1, A2)) {
+        generate_method<T, R (T::*)(A0, A1, A2)>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(const U *obj, R (T::*method)(A0, A1, A2) const) {
+        generate_method<const T, R (T::*)(A0, A1, A2) const>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(volatile U *obj, R (T::*method)(A0, A1, A2) volatile) {
+        generate_method<volatile T, R (T::*)(A0, A1, A2) volatile>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(const volatile U *obj, R (T::*method)(A0, A1, A2) const volatile) {
+        generate_method<const volatile T, R (T::*)(A0, A1, A2) const volatile>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(T*, A0, A1, A2), U *arg) {
+        generate_function<R (*)(T*, A0, A1, A2), T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(const T*, A0, A1, A2), const U *arg) {
+        generate_function<R (*)(const T*, A0, A1, A2), const T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(volatile T*, A0, A1, A2), volatile U *arg) {
+        generate_function<R (*)(volatile T*, A0, A1, A2), volatile T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(const volatile T*, A0, A1, A2), const volatile U *arg) {
+        generate_function<R (*)(const volatile T*, A0, A1, A2), const volatile T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1, A2), Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(const F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1, A2) const, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(volatile F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1, A2) volatile, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(const volatile F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1, A2) const volatile, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback from a Callback
+     *  @param func     The Callback to attach
+     */
+    InplaceCallback(const Callback<R(A0, A1, A2)> &func) {
+        if (func) {
+            this->generate(func, &InplaceCallback::function_call<Callback<R(A0, A1, A2)> >, false);
+        }
+    }
+
+    /** Call the attached function
+     */
+    R call(A0 a0, A1 a1, A2 a2) const {
+        if (this->_thunk) {
+            return this->_thunk(&this->_storage, a0, a1, a2);
+        }
+
+        MBED_ASSERT(this->_storage._staticfunc);
+        return this->_storage._staticfunc(a0, a1, a2);
+    }
+
+    /** Call the attached function
+     */
+    R operator()(A0 a0, A1 a1, A2 a2) const {
+        return call(a0, a1, a2);
+    }
+
+    /** Static thunk for passing as C-style function
+     *  @param func InplaceCallback to call passed as void pointer
+     *  @param a0 An argument to be called with function func
+     *  @param a1 An argument to be called with function func
+     *  @param a2 An argument to be called with function func
+     *  @return the value as determined by func which is of
+     *      type and determined by the signiture of func
+     */
+    static R thunk(void *func, A0 a0, A1 a1, A2 a2) {
+        return static_cast<InplaceCallback*>(func)->call(a0, a1, a2);
+    }
+
+private:
+    template <typename O, typename M>
+    void generate_method(O *obj, M method) {
+        detail::inplace_method_context<O, M> context = { method, obj };
+        this->generate(context, &InplaceCallback::method_call<O, M>, true);
+    }
+
+    template <typename F, typename A>
+    void generate_function(F func, A *arg) {
+        detail::inplace_function_context<F, A> context = { func, arg };
+        this->generate(context, &InplaceCallback::function_context_call<F, A>, true);
+    }
+
+    // Call thunks of the stored function objects
+    template <typename F>
+    static R function_call(const void *p, A0 a0, A1 a1, A2 a2) {
+        return (*(F*)p)(a0, a1, a2);
+    }
+
+    template <typename O, typename M>
+    static R method_call(const void *p, A0 a0, A1 a1, A2 a2) {
+        const detail::inplace_method_context<O, M> *context =
+            static_cast<const detail::inplace_method_context<O, M>*>(p);
+        return (context->obj->*context->method)(a0, a1, a2);
+    }
+
+    template <typename F, typename A>
+    static R function_context_call(const void *p, A0 a0, A1 a1, A2 a2) {
+        const detail::inplace_function_context<F, A> *context =
+            static_cast<const detail::inplace_function_context<F, A>*>(p);
+        return context->func(context->arg, a0, a1, a2);
+    }
+};
+
+/** Callback class with inline storage based on template specialization
+ *
+ * @note Synchronization level: Not protected
+ */
+template <typename R, typename A0, typename A1, typename A2, typename A3, size_t Size>
+class InplaceCallback<R(A0, A1, A2, A3), Size>
+    : public detail::InplaceCallbackBase<R (*)(A0, A1, A2, A3), R (*)(const void*, A0, A1, A2, A3), Size> {
+    typedef detail::InplaceCallbackBase<R (*)(A0, A1, A2, A3), R (*)(const void*, A0, A1, A2, A3), Size> Base;
+
+public:
+    /** Create an InplaceCallback with a static function
+     *  @param func     Static function to attach
+     */
+    InplaceCallback(R (*func)(A0, A1, A2, A3) = 0)
+        : Base(func) {
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(U *obj, R (T::*method)(A0, A1, A2, A3)) {
+        generate_method<T, R (T::*)(A0, A1, A2, A3)>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(const U *obj, R (T::*method)(A0, A1, A2, A3) const) {
+        generate_method<const T, R (T::*)(A0, A1, A2, A3) const>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(volatile U *obj, R (T::*method)(A0, A1, A2, A3) volatile) {
+        generate_method<volatile T, R (T::*)(A0, A1, A2, A3) volatile>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(const volatile U *obj, R (T::*method)(A0, A1, A2, A3) const volatile) {
+        generate_method<const volatile T, R (T::*)(A0, A1, A2, A3) const volatile>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(T*, A0, A1, A2, A3), U *arg) {
+        generate_function<R (*)(T*, A0, A1, A2, A3), T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(const T*, A0, A1, A2, A3), const U *arg) {
+        generate_function<R (*)(const T*, A0, A1, A2, A3), const T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(volatile T*, A0, A1, A2, A3), volatile U *arg) {
+        generate_function<R (*)(volatile T*, A0, A1, A2, A3), volatile T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(const volatile T*, A0, A1, A2, A3), const volatile U *arg) {
+        generate_function<R (*)(const volatile T*, A0, A1, A2, A3), const volatile T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1, A2, A3), Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(const F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1, A2, A3) const, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(volatile F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1, A2, A3) volatile, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(const volatile F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1, A2, A3) const volatile, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback from a Callback
+     *  @param func     The Callback to attach
+     */
+    InplaceCallback(const Callback<R(A0, A1, A2, A3)> &func) {
+        if (func) {
+            this->generate(func, &InplaceCallback::function_call<Callback<R(A0, A1, A2, A3)> >, false);
+        }
+    }
+
+    /** Call the attached function
+     */
+    R call(A0 a0, A1 a1, A2 a2, A3 a3) const {
+        if (this->_thunk) {
+            return this->_thunk(&this->_storage, a0, a1, a2, a3);
+        }
+
+        MBED_ASSERT(this->_storage._staticfunc);
+        return this->_storage._staticfunc(a0, a1, a2, a3);
+    }
+
+    /** Call the attached function
+     */
+    R operator()(A0 a0, A1 a1, A2 a2, A3 a3) const {
+        return call(a0, a1, a2, a3);
+    }
+
+    /** Static thunk for passing as C-style function
+     *  @param func InplaceCallback to call passed as void pointer
+     *  @param a0 An argument to be called with function func
+     *  @param a1 An argument to be called with function func
+     *  @param a2 An argument to be called with function func
+     *  @param a3 An argument to be called with function func
+     *  @return the value as determined by func which is of
+     *      type and determined by the signiture of func
+     */
+    static R thunk(void *func, A0 a0, A1 a1, A2 a2, A3 a3) {
+        return static_cast<InplaceCallback*>(func)->call(a0, a1, a2, a3);
+    }
+
+private:
+    template <typename O, typename M>
+    void generate_method(O *obj, M method) {
+        detail::inplace_method_context<O, M> context = { method, obj };
+        this->generate(context, &InplaceCallback::method_call<O, M>, true);
+    }
+
+    template <typename F, typename A>
+    void generate_function(F func, A *arg) {
+        detail::inplace_function_context<F, A> context = { func, arg };
+        this->generate(context, &InplaceCallback::function_context_call<F, A>, true);
+    }
+
+    // Call thunks of the stored function objects
+    template <typename F>
+    static R function_call(const void *p, A0 a0, A1 a1, A2 a2, A3 a3) {
+        return (*(F*)p)(a0, a1, a2, a3);
+    }
+
+    template <typename O, typename M>
+    static R method_call(const void *p, A0 a0, A1 a1, A2 a2, A3 a3) {
+        const detail::inplace_method_context<O, M> *context =
+            static_cast<const detail::inplace_method_context<O, M>*>(p);
+        return (context->obj->*context->method)(a0, a1, a2, a3);
+    }
+
+    template <typename F, typename A>
+    static R function_context_call(const void *p, A0 a0, A1 a1, A2 a2, A3 a3) {
+        const detail::inplace_function_context<F, A> *context =
+            static_cast<const detail::inplace_function_context<F, A>*>(p);
+        return context->func(context->arg, a0, a1, a2, a3);
+    }
+};
+
+/** Callback class with inline storage based on template specialization
+ *
+ * @note Synchronization level: Not protected
+ */
+template <typename R, typename A0, typename A1, typename A2, typename A3, typename A4, size_t Size>
+class InplaceCallback<R(A0, A1, A2, A3, A4), Size>
+    : public detail::InplaceCallbackBase<R (*)(A0, A1, A2, A3, A4), R (*)(const void*, A0, A1, A2, A3, A4), Size> {
+    typedef detail::InplaceCallbackBase<R (*)(A0, A1, A2, A3, A4), R (*)(const void*, A0, A1, A2, A3, A4), Size> Base;
+
+public:
+    /** Create an InplaceCallback with a static function
+     *  @param func     Static function to attach
+     */
+    InplaceCallback(R (*func)(A0, A1, A2, A3, A4) = 0)
+        : Base(func) {
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(U *obj, R (T::*method)(A0, A1, A2, A3, A4)) {
+        generate_method<T, R (T::*)(A0, A1, A2, A3, A4)>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(const U *obj, R (T::*method)(A0, A1, A2, A3, A4) const) {
+        generate_method<const T, R (T::*)(A0, A1, A2, A3, A4) const>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(volatile U *obj, R (T::*method)(A0, A1, A2, A3, A4) volatile) {
+        generate_method<volatile T, R (T::*)(A0, A1, A2, A3, A4) volatile>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a member function
+     *  @param obj      Pointer to object to invoke member function on
+     *  @param method   Member function to attach
+     */
+    template<typename T, typename U>
+    InplaceCallback(const volatile U *obj, R (T::*method)(A0, A1, A2, A3, A4) const volatile) {
+        generate_method<const volatile T, R (T::*)(A0, A1, A2, A3, A4) const volatile>(obj, method);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(T*, A0, A1, A2, A3, A4), U *arg) {
+        generate_function<R (*)(T*, A0, A1, A2, A3, A4), T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(const T*, A0, A1, A2, A3, A4), const U *arg) {
+        generate_function<R (*)(const T*, A0, A1, A2, A3, A4), const T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(volatile T*, A0, A1, A2, A3, A4), volatile U *arg) {
+        generate_function<R (*)(volatile T*, A0, A1, A2, A3, A4), volatile T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a static function and bound pointer
+     *  @param func     Static function to attach
+     *  @param arg      Pointer argument to function
+     */
+    template<typename T, typename U>
+    InplaceCallback(R (*func)(const volatile T*, A0, A1, A2, A3, A4), const volatile U *arg) {
+        generate_function<R (*)(const volatile T*, A0, A1, A2, A3, A4), const volatile T>(func, arg);
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1, A2, A3, A4), Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(const F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1, A2, A3, A4) const, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(volatile F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1, A2, A3, A4) volatile, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback with a function object
+     *  @param f Function object to attach
+     *  @note The function object is limited to Size bytes of storage
+     */
+    template <typename F>
+    InplaceCallback(const volatile F f, MBED_ENABLE_IF_INPLACE_CALLBACK_COMPATIBLE(F, R (F::*)(A0, A1, A2, A3, A4) const volatile, Size)) {
+        this->generate(f, &InplaceCallback::function_call<F>, MBED_INPLACE_CALLBACK_TRIVIAL(F));
+    }
+
+    /** Create an InplaceCallback from a Callback
+     *  @param func     The Callback to attach
+     */
+    InplaceCallback(const Callback<R(A0, A1, A2, A3, A4)> &func) {
+        if (func) {
+            this->generate(func, &InplaceCallback::function_call<Callback<R(A0, A1, A2, A3, A4)> >, false);
+        }
+    }
+
+    /** Call the attached function
+     */
+    R call(A0 a0, A1 a1, A2 a2, A3 a3, A4 a4) const {
+        if (this->_thunk) {
+            return this->_thunk(&this->_storage, a0, a1, a2, a3, a4);
+        }
+
+        MBED_ASSERT(this->_storage._staticfunc);
+        return this->_storage._staticfunc(a0, a1, a2, a3, a4);
+    }
+
+    /** Call the attached function
+     */
+    R operator()(A0 a0, A1 a1, A2 a2, A3 a3, A4 a4) const {
+        return call(a0, a1, a2, a3, a4);
+    }
+
+    /** Static thunk for passing as C-style function
+     *  @param func InplaceCallback to call passed as void pointer
+     *  @param a0 An argument to be called with function func
+     *  @param a1 An argument to be called with function func
+     *  @param a2 An argument to be called with function func
+     *  @param a3 An argument to be called with function func
+     *  @param a4 An argument to be called with function func
+     *  @return the value as determined by func which is of
+     *      type and determined by the signiture of func
+     */
+    static R thunk(void *func, A0 a0, A1 a1, A2 a2, A3 a3, A4 a4) {
+        return static_cast<InplaceCallback*>(func)->call(a0, a1, a2, a3, a4);
+    }
+
+private:
+    template <typename O, typename M>
+    void generate_method(O *obj, M method) {
+        detail::inplace_method_context<O, M> context = { method, obj };
+        this->generate(context, &InplaceCallback::method_call<O, M>, true);
+    }
+
+    template <typename F, typename A>
+    void generate_function(F func, A *arg) {
+        detail::inplace_function_context<F, A> context = { func, arg };
+        this->generate(context, &InplaceCallback::function_context_call<F, A>, true);
+    }
+
+    // Call thunks of the stored function objects
+    template <typename F>
+    static R function_call(const void *p, A0 a0, A1 a1, A2 a2, A3 a3, A4 a4) {
+        return (*(F*)p)(a0, a1, a2, a3, a4);
+    }
+
+    template <typename O, typename M>
+    static R method_call(const void *p, A0 a0, A1 a1, A2 a2, A3 a3, A4 a4) {
+        const detail::inplace_method_context<O, M> *context =
+            static_cast<const detail::inplace_method_context<O, M>*>(p);
+        return (context->obj->*context->method)(a0, a1, a2, a3, a4);
+    }
+
+    template <typename F, typename A>
+    static R function_context_call(const void *p, A0 a0, A1 a1, A2 a2, A3 a3, A4 a4) {
+        const detail::inplace_function_context<F, A> *context =
+            static_cast<const detail::inplace_function_context<F, A>*>(p);
+        return context->func(context->arg, a0, a1, a2, a3, a4);
+    }
+};
+
+/**@}*/
+
+/**@}*/
+
+} // namespace mbed
+
+#endif
@@ -40,13 +40,16 @@ typedef struct {
 } transaction_t;
 
 /** Transaction class defines a transaction.
+ *
+ * Drivers needing more than transaction_t describes may store their own
+ * transaction structure instead.
  *
  * @note Synchronization level: Not protected
  */
-template<typename Class>
+template<typename Class, typename Data = transaction_t>
 class Transaction {
 public:
-    Transaction(Class *tpointer, const transaction_t& transaction) : _obj(tpointer), _data(transaction) {
+    Transaction(Class *tpointer, const Data& transaction) : _obj(tpointer), _data(transaction) {
     }
 
     Transaction() : _obj(), _data() {
@@ -67,13 +70,13 @@ public:
      *
      * @return The transaction which was stored
      */
-    transaction_t* get_transaction() {
+    Data* get_transaction() {
         return &_data;
     }
 
 private:
     Class* _obj;
-    transaction_t _data;
+    Data _data;
 };
 /**@}*/
 
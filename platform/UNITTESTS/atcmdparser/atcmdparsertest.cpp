@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_atcmdparser.h"
+
+TEST_GROUP(ATCmdParser)
+{
+    Test_ATCmdParser* unit;
+
+    void setup()
+    {
+        unit = new Test_ATCmdParser();
+    }
+
+    void teardown()
+    {
+        delete unit;
+    }
+};
+
+TEST(ATCmdParser, Create)
+{
+    CHECK(unit != NULL);
+}
+
+TEST(ATCmdParser, test_ATCmdParser_recv_fields)
+{
+    unit->test_ATCmdParser_recv_fields();
+}
+
+TEST(ATCmdParser, test_ATCmdParser_recv_skips_other_lines)
+{
+    unit->test_ATCmdParser_recv_skips_other_lines();
+}
+
+TEST(ATCmdParser, test_ATCmdParser_recv_sets_and_widths)
+{
+    unit->test_ATCmdParser_recv_sets_and_widths();
+}
+
+TEST(ATCmdParser, test_ATCmdParser_recv_sscanf_fallback)
+{
+    unit->test_ATCmdParser_recv_sscanf_fallback();
+}
+
+TEST(ATCmdParser, test_ATCmdParser_scanf)
+{
+    unit->test_ATCmdParser_scanf();
+}
+
+TEST(ATCmdParser, test_ATCmdParser_oob_prefixes)
+{
+    unit->test_ATCmdParser_oob_prefixes();
+}
+
+TEST(ATCmdParser, test_ATCmdParser_oob_abort)
+{
+    unit->test_ATCmdParser_oob_abort();
+}
+
+TEST(ATCmdParser, test_ATCmdParser_process_oob)
+{
+    unit->test_ATCmdParser_process_oob();
+}
+
+TEST(ATCmdParser, test_ATCmdParser_recv_benchmark)
+{
+    unit->test_ATCmdParser_recv_benchmark();
+}
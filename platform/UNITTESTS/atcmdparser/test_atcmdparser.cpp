@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "CppUTest/TestHarness.h"
+#include "test_atcmdparser.h"
+#include "platform/ATCmdParser.h"
+#include "mbed_poll_stub.h"
+#include <errno.h>
+#include <time.h>
+
+using namespace mbed;
+
+// FileHandle that plays back a scripted modem output
+class ScriptedFileHandle : public FileHandle {
+public:
+    ScriptedFileHandle(const char *script) : _script(script), _length(strlen(script)), _pos(0)
+    {
+    }
+
+    void rewind()
+    {
+        _pos = 0;
+    }
+
+    virtual ssize_t read(void *buffer, size_t size)
+    {
+        if (size > _length - _pos) {
+            size = _length - _pos;
+        }
+        memcpy(buffer, _script + _pos, size);
+        _pos += size;
+        return size;
+    }
+
+    virtual ssize_t write(const void *buffer, size_t size)
+    {
+        return size;
+    }
+
+    virtual off_t seek(off_t offset, int whence = SEEK_SET)
+    {
+        return -ESPIPE;
+    }
+
+    virtual int close()
+    {
+        return 0;
+    }
+
+    virtual short poll(short events) const
+    {
+        return (_pos < _length) ? (POLLIN | POLLOUT) : POLLOUT;
+    }
+
+private:
+    const char *_script;
+    size_t _length;
+    size_t _pos;
+};
+
+static ATCmdParser *oob_parser;
+static int creg_count;
+static int creg_stat;
+static int cgev_count;
+static int cgev_old_count;
+static int abort_count;
+
+static void on_creg()
+{
+    creg_count++;
+    oob_parser->recv("%d\n", &creg_stat);
+}
+
+static void on_cgev()
+{
+    cgev_count++;
+}
+
+static void on_cgev_old()
+{
+    cgev_old_count++;
+}
+
+static void on_abort()
+{
+    abort_count++;
+    oob_parser->abort();
+}
+
+static double now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+Test_ATCmdParser::Test_ATCmdParser()
+{
+    oob_parser = NULL;
+    creg_count = 0;
+    creg_stat = -1;
+    cgev_count = 0;
+    cgev_old_count = 0;
+    abort_count = 0;
+
+    // Always ready, the end of a script reads nothing
+    mbed_poll_stub::revents_value = POLLIN | POLLOUT;
+    mbed_poll_stub::int_value = 1;
+}
+
+Test_ATCmdParser::~Test_ATCmdParser()
+{
+}
+
+void Test_ATCmdParser::test_ATCmdParser_recv_fields()
+{
+    ScriptedFileHandle fh("\r\n+CSQ: 21,99\r\nOK\r\n+VAL: -5\r\n");
+    ATCmdParser at(&fh, "\r\n");
+    int rssi = 0, ber = 0, val = 0;
+
+    CHECK(at.recv("+CSQ: %d,%d\nOK", &rssi, &ber));
+    LONGS_EQUAL(21, rssi);
+    LONGS_EQUAL(99, ber);
+
+    CHECK(at.recv("+VAL: %d\n", &val));
+    LONGS_EQUAL(-5, val);
+
+    // Nothing left to match
+    CHECK(!at.recv("OK"));
+}
+
+void Test_ATCmdParser::test_ATCmdParser_recv_skips_other_lines()
+{
+    ScriptedFileHandle fh("+COPS: junk\r\nnoise\r\n+COPS: 0,0,\"Operator One\",7\r\nOK\r\n");
+    ATCmdParser at(&fh, "\r\n");
+    int mode = -1, format = -1, act = -1;
+    char name[32] = "";
+
+    CHECK(at.recv("+COPS: %d,%d,\"%[^\"]\",%d\n", &mode, &format, name, &act));
+    LONGS_EQUAL(0, mode);
+    LONGS_EQUAL(0, format);
+    STRCMP_EQUAL("Operator One", name);
+    LONGS_EQUAL(7, act);
+    CHECK(at.recv("OK"));
+}
+
+void Test_ATCmdParser::test_ATCmdParser_recv_sets_and_widths()
+{
+    ScriptedFileHandle fh("+CIFSR:STAMAC,\"18:fe:34:00:11:22\"\r\nabcde\r\nid: token rest\r\n");
+    ATCmdParser at(&fh, "\r\n");
+    char mac[18] = "";
+    char three[4] = "";
+    char word[16] = "";
+
+    CHECK(at.recv("+CIFSR:STAMAC,\"%17[^\"]\"\n", mac));
+    STRCMP_EQUAL("18:fe:34:00:11:22", mac);
+
+    CHECK(at.recv("ab%3c\n", three));
+    three[3] = '\0';
+    STRCMP_EQUAL("cde", three);
+
+    CHECK(at.recv("id: %s rest\n", word));
+    STRCMP_EQUAL("token", word);
+}
+
+void Test_ATCmdParser::test_ATCmdParser_recv_sscanf_fallback()
+{
+    // %x and %% are left to sscanf
+    ScriptedFileHandle fh("+HEX: 1f\r\n+P: 50%\r\n");
+    ATCmdParser at(&fh, "\r\n");
+    unsigned hex = 0;
+    int percent = 0;
+
+    CHECK(at.recv("+HEX: %x\n", &hex));
+    LONGS_EQUAL(0x1f, hex);
+    CHECK(at.recv("+P: %d%%\n", &percent));
+    LONGS_EQUAL(50, percent);
+}
+
+void Test_ATCmdParser::test_ATCmdParser_scanf()
+{
+    ScriptedFileHandle fh("42,rest");
+    ATCmdParser at(&fh, "\r\n");
+    int n = 0;
+
+    LONGS_EQUAL(3, at.scanf("%d,", &n));
+    LONGS_EQUAL(42, n);
+}
+
+void Test_ATCmdParser::test_ATCmdParser_oob_prefixes()
+{
+    ScriptedFileHandle fh("+CREG: 1\r\n+CGEV: ME DETACH\r\n+CGDCONT: 1\r\nOK\r\n");
+    ATCmdParser at(&fh, "\r\n");
+    oob_parser = &at;
+
+    at.oob("+CGEV:", on_cgev_old);
+    at.oob("+CREG:", on_creg);
+    // A newer handler takes over the prefix
+    at.oob("+CGEV:", on_cgev);
+
+    CHECK(at.recv("OK"));
+    LONGS_EQUAL(1, creg_count);
+    LONGS_EQUAL(1, creg_stat);
+    LONGS_EQUAL(1, cgev_count);
+    LONGS_EQUAL(0, cgev_old_count);
+}
+
+void Test_ATCmdParser::test_ATCmdParser_oob_abort()
+{
+    ScriptedFileHandle fh("+ABORT\r\nOK\r\n");
+    ATCmdParser at(&fh, "\r\n");
+    oob_parser = &at;
+
+    at.oob("+ABORT", on_abort);
+    CHECK(!at.recv("OK"));
+    LONGS_EQUAL(1, abort_count);
+
+    // The rest of the stream can still be received
+    CHECK(at.recv("OK"));
+}
+
+void Test_ATCmdParser::test_ATCmdParser_process_oob()
+{
+    ScriptedFileHandle fh("+CGEV: NW DETACH\r\n+CREG: 5\r\n");
+    ATCmdParser at(&fh, "\r\n");
+    oob_parser = &at;
+
+    at.oob("+CREG:", on_creg);
+    CHECK(at.process_oob());
+    LONGS_EQUAL(1, creg_count);
+    LONGS_EQUAL(5, creg_stat);
+    CHECK(!at.process_oob());
+}
+
+#define BENCHMARK_LINES 200
+
+void Test_ATCmdParser::test_ATCmdParser_recv_benchmark()
+{
+    static const char line[] = "+CGDCONT: 1,\"IPV4V6\",\"internet.operator.example.com\",\"10.120.34.56\",0,0,0,0\r\nOK\r\n";
+    static char script[sizeof(line) * BENCHMARK_LINES];
+    script[0] = '\0';
+    for (int i = 0; i < BENCHMARK_LINES; i++) {
+        strcat(script, line);
+    }
+    ScriptedFileHandle fh(script);
+    ATCmdParser at(&fh, "\r\n");
+    int cid;
+    char type[16], apn[64], addr[32];
+
+    // %d lines run on the compiled matcher, %i lines on the sscanf fallback
+    const char *formats[] = {
+        "+CGDCONT: %d,\"%15[^\"]\",\"%63[^\"]\",\"%31[^\"]\"",
+        "+CGDCONT: %i,\"%15[^\"]\",\"%63[^\"]\",\"%31[^\"]\""
+    };
+    const char *names[] = { "compiled", "sscanf" };
+
+    for (int f = 0; f < 2; f++) {
+        fh.rewind();
+        double start = now_ns();
+        for (int i = 0; i < BENCHMARK_LINES; i++) {
+            cid = 0;
+            apn[0] = '\0';
+            CHECK(at.recv(formats[f], &cid, type, apn, addr));
+            CHECK(at.recv("OK"));
+        }
+        double elapsed = now_ns() - start;
+        LONGS_EQUAL(1, cid);
+        STRCMP_EQUAL("IPV4V6", type);
+        STRCMP_EQUAL("internet.operator.example.com", apn);
+        STRCMP_EQUAL("10.120.34.56", addr);
+        printf("\nATCmdParser %s: %.1f ns per received byte\n", names[f],
+               elapsed / (BENCHMARK_LINES * (sizeof(line) - 1)));
+    }
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2018, Arm Limited and affiliates.
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef TEST_ATCMDPARSER_H
+#define TEST_ATCMDPARSER_H
+
+class Test_ATCmdParser
+{
+public:
+    Test_ATCmdParser();
+
+    virtual ~Test_ATCmdParser();
+
+    void test_ATCmdParser_recv_fields();
+
+    void test_ATCmdParser_recv_skips_other_lines();
+
+    void test_ATCmdParser_recv_sets_and_widths();
+
+    void test_ATCmdParser_recv_sscanf_fallback();
+
+    void test_ATCmdParser_scanf();
+
+    void test_ATCmdParser_oob_prefixes();
+
+    void test_ATCmdParser_oob_abort();
+
+    void test_ATCmdParser_process_oob();
+
+    void test_ATCmdParser_recv_benchmark();
+};
+
+#endif // TEST_ATCMDPARSER_H
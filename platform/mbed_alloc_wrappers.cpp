@@ -19,11 +19,16 @@
 #include "platform/mbed_toolchain.h"
 #include "platform/SingletonPtr.h"
 #include "platform/PlatformMutex.h"
+#include "platform/mbed_critical.h"
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
+#if MBED_CONF_RTOS_PRESENT
+#include "cmsis_os2.h"
+#endif
+
 /* There are two memory tracers in mbed OS:
 
 - the first can be used to detect the maximum heap usage at runtime. It is
@@ -43,12 +48,212 @@ are active, the second one (MBED_MEM_TRACING_ENABLED) will trace the first one's
 /* Size must be a multiple of 8 to keep alignment */
 typedef struct {
     uint32_t size;
-    uint32_t pad;
+    uint8_t thread_slot;        /* Index in heap_thread_stats, 0 if not tracked */
+    uint8_t thread_gen;         /* Generation of the thread slot at allocation time */
+    uint16_t caller_slot;       /* Index in heap_caller_stats, 0 if not tracked */
 } alloc_info_t;
 
 #ifdef MBED_HEAP_STATS_ENABLED
+
+#ifndef MBED_CONF_PLATFORM_HEAP_STATS_THREAD_SLOTS
+#define MBED_CONF_PLATFORM_HEAP_STATS_THREAD_SLOTS 0
+#endif
+
+#ifndef MBED_CONF_PLATFORM_HEAP_STATS_CALLER_SLOTS
+#define MBED_CONF_PLATFORM_HEAP_STATS_CALLER_SLOTS 0
+#endif
+
+#define HEAP_THREAD_SLOTS   MBED_CONF_PLATFORM_HEAP_STATS_THREAD_SLOTS
+#define HEAP_CALLER_SLOTS   MBED_CONF_PLATFORM_HEAP_STATS_CALLER_SLOTS
+
+/* Maximum number of hash table entries examined to find a thread or caller */
+#define HEAP_STATS_MAX_PROBE 8
+
+#if HEAP_THREAD_SLOTS > 255
+#error "platform.heap-stats-thread-slots must not exceed 255"
+#endif
+
+#if HEAP_CALLER_SLOTS > 65535
+#error "platform.heap-stats-caller-slots must not exceed 65535"
+#endif
+
 static SingletonPtr<PlatformMutex> malloc_stats_mutex;
 static mbed_stats_heap_t heap_stats = {0, 0, 0, 0, 0};
+
+/* Entry 0 of each table accumulates the allocations that don't fit in a slot.
+ * All the tables are only accessed with malloc_stats_mutex held, so the per
+ * thread and per caller accounting doesn't add any locking to malloc/free. */
+#if HEAP_THREAD_SLOTS
+static mbed_stats_heap_thread_t heap_thread_stats[HEAP_THREAD_SLOTS + 1];
+/* Bumped when the thread of a slot terminates, so that its blocks freed later
+ * are credited to entry 0 rather than to the next thread using the slot. It
+ * wraps after 256 threads, long after the blocks of most threads are freed. */
+static uint8_t heap_thread_gen[HEAP_THREAD_SLOTS + 1];
+#endif
+#if HEAP_CALLER_SLOTS
+static mbed_stats_heap_caller_t heap_caller_stats[HEAP_CALLER_SLOTS + 1];
+#endif
+
+/* Find the slot of 'key' in 'table', claiming a free slot if 'key' isn't there yet.
+ * Thread slots are released, so the whole probe window is searched before
+ * claiming the first free slot. */
+template <typename T>
+static uint32_t heap_stats_find_slot(T *table, uint32_t slots, uint32_t T::*field, uint32_t key)
+{
+    uint32_t free_slot = 0;
+
+    if (key == 0) {
+        return 0;
+    }
+    uint32_t start = ((key >> 2) * 2654435761UL) % slots;
+    for (uint32_t i = 0; i < slots && i < HEAP_STATS_MAX_PROBE; i++) {
+        uint32_t slot = 1 + (start + i) % slots;
+        if (table[slot].*field == key) {
+            return slot;
+        }
+        if (table[slot].*field == 0 && free_slot == 0) {
+            free_slot = slot;
+        }
+    }
+    if (free_slot != 0) {
+        table[free_slot].*field = key;
+    }
+    return free_slot;
+}
+
+template <typename T>
+static void heap_stats_add(T *entry, uint32_t size)
+{
+    entry->current_size += size;
+    entry->total_size += size;
+    entry->alloc_cnt += 1;
+    if (entry->current_size > entry->max_size) {
+        entry->max_size = entry->current_size;
+    }
+}
+
+template <typename T>
+static void heap_stats_remove(T *entry, uint32_t size)
+{
+    entry->current_size -= size;
+    entry->alloc_cnt -= 1;
+}
+
+#if HEAP_THREAD_SLOTS
+static uint32_t heap_stats_thread_id()
+{
+#if MBED_CONF_RTOS_PRESENT
+    return (uint32_t)(uintptr_t)osThreadGetId();
+#else
+    return 0;
+#endif
+}
+#endif
+
+/* Account a successful allocation described by 'alloc_info'. Called with malloc_stats_mutex held. */
+static void heap_stats_alloc(alloc_info_t *alloc_info, uint32_t size, void *caller)
+{
+    (void)caller;
+    alloc_info->size = size;
+    alloc_info->thread_slot = 0;
+    alloc_info->thread_gen = 0;
+    alloc_info->caller_slot = 0;
+    heap_stats_add(&heap_stats, size);
+#if HEAP_THREAD_SLOTS
+    alloc_info->thread_slot = heap_stats_find_slot(heap_thread_stats, HEAP_THREAD_SLOTS,
+                              &mbed_stats_heap_thread_t::thread_id, heap_stats_thread_id());
+    alloc_info->thread_gen = heap_thread_gen[alloc_info->thread_slot];
+    heap_stats_add(&heap_thread_stats[alloc_info->thread_slot], size);
+#endif
+#if HEAP_CALLER_SLOTS
+    alloc_info->caller_slot = heap_stats_find_slot(heap_caller_stats, HEAP_CALLER_SLOTS,
+                              &mbed_stats_heap_caller_t::caller, (uint32_t)(uintptr_t)caller);
+    heap_stats_add(&heap_caller_stats[alloc_info->caller_slot], size);
+#endif
+}
+
+/* Account a failed allocation. Called with malloc_stats_mutex held. */
+static void heap_stats_alloc_fail(void *caller)
+{
+    (void)caller;
+    heap_stats.alloc_fail_cnt += 1;
+#if HEAP_THREAD_SLOTS
+    heap_thread_stats[heap_stats_find_slot(heap_thread_stats, HEAP_THREAD_SLOTS,
+                      &mbed_stats_heap_thread_t::thread_id, heap_stats_thread_id())].alloc_fail_cnt += 1;
+#endif
+#if HEAP_CALLER_SLOTS
+    heap_caller_stats[heap_stats_find_slot(heap_caller_stats, HEAP_CALLER_SLOTS,
+                      &mbed_stats_heap_caller_t::caller, (uint32_t)(uintptr_t)caller)].alloc_fail_cnt += 1;
+#endif
+}
+
+/* Account the release of the allocation described by 'alloc_info'. Called with malloc_stats_mutex held. */
+static void heap_stats_free(const alloc_info_t *alloc_info)
+{
+    heap_stats_remove(&heap_stats, alloc_info->size);
+#if HEAP_THREAD_SLOTS
+    uint32_t thread_slot = alloc_info->thread_slot;
+    if (heap_thread_gen[thread_slot] != alloc_info->thread_gen) {
+        // The thread terminated, its remaining blocks moved to entry 0
+        thread_slot = 0;
+    }
+    heap_stats_remove(&heap_thread_stats[thread_slot], alloc_info->size);
+#endif
+#if HEAP_CALLER_SLOTS
+    heap_stats_remove(&heap_caller_stats[alloc_info->caller_slot], alloc_info->size);
+#endif
+}
+
+#if HEAP_THREAD_SLOTS
+/* Release the slot of a terminated thread. Its counters are merged into entry
+ * 0, which then also accounts the blocks of the thread still allocated. */
+static void heap_stats_thread_terminated(uint32_t thread_id)
+{
+    malloc_stats_mutex->lock();
+    uint32_t start = ((thread_id >> 2) * 2654435761UL) % HEAP_THREAD_SLOTS;
+    for (uint32_t i = 0; i < HEAP_THREAD_SLOTS && i < HEAP_STATS_MAX_PROBE; i++) {
+        uint32_t slot = 1 + (start + i) % HEAP_THREAD_SLOTS;
+        mbed_stats_heap_thread_t *entry = &heap_thread_stats[slot];
+        if (entry->thread_id != thread_id) {
+            continue;
+        }
+
+        mbed_stats_heap_thread_t *retired = &heap_thread_stats[0];
+        retired->current_size += entry->current_size;
+        retired->total_size += entry->total_size;
+        retired->alloc_cnt += entry->alloc_cnt;
+        retired->alloc_fail_cnt += entry->alloc_fail_cnt;
+        if (retired->current_size > retired->max_size) {
+            retired->max_size = retired->current_size;
+        }
+
+        memset(entry, 0, sizeof(*entry));
+        heap_thread_gen[slot]++;
+        break;
+    }
+    malloc_stats_mutex->unlock();
+}
+#endif
+
+/* Copy the used entries of 'table' to 'stats', the overflow entry last */
+template <typename T>
+static size_t heap_stats_get_each(const T *table, uint32_t slots, uint32_t T::*field, T *stats, size_t count)
+{
+    size_t i = 0;
+
+    malloc_stats_mutex->lock();
+    for (uint32_t slot = 1; slot <= slots && i < count; slot++) {
+        if (table[slot].*field != 0) {
+            stats[i++] = table[slot];
+        }
+    }
+    if (i < count && (table[0].total_size != 0 || table[0].alloc_fail_cnt != 0)) {
+        stats[i++] = table[0];
+    }
+    malloc_stats_mutex->unlock();
+
+    return i;
+}
 #endif
 
 void mbed_stats_heap_get(mbed_stats_heap_t *stats)
@@ -65,6 +270,40 @@ void mbed_stats_heap_get(mbed_stats_heap_t *stats)
 #endif
 }
 
+size_t mbed_stats_heap_get_each_thread(mbed_stats_heap_thread_t *stats, size_t count)
+{
+    memset(stats, 0, count * sizeof(mbed_stats_heap_thread_t));
+#if defined(MBED_HEAP_STATS_ENABLED) && HEAP_THREAD_SLOTS
+    return heap_stats_get_each(heap_thread_stats, HEAP_THREAD_SLOTS,
+                               &mbed_stats_heap_thread_t::thread_id, stats, count);
+#else
+    return 0;
+#endif
+}
+
+void mbed_stats_heap_thread_terminated(uint32_t thread_id)
+{
+#if defined(MBED_HEAP_STATS_ENABLED) && HEAP_THREAD_SLOTS
+    // osThreadTerminate fails from interrupts, and so would the mutex
+    if (thread_id != 0 && !core_util_is_isr_active()) {
+        heap_stats_thread_terminated(thread_id);
+    }
+#else
+    (void)thread_id;
+#endif
+}
+
+size_t mbed_stats_heap_get_each_caller(mbed_stats_heap_caller_t *stats, size_t count)
+{
+    memset(stats, 0, count * sizeof(mbed_stats_heap_caller_t));
+#if defined(MBED_HEAP_STATS_ENABLED) && HEAP_CALLER_SLOTS
+    return heap_stats_get_each(heap_caller_stats, HEAP_CALLER_SLOTS,
+                               &mbed_stats_heap_caller_t::caller, stats, count);
+#else
+    return 0;
+#endif
+}
+
 /******************************************************************************/
 /* GCC memory allocation wrappers                                             */
 /******************************************************************************/
@@ -101,16 +340,10 @@ extern "C" void * malloc_wrapper(struct _reent * r, size_t size, void * caller)
     malloc_stats_mutex->lock();
     alloc_info_t *alloc_info = (alloc_info_t*)__real__malloc_r(r, size + sizeof(alloc_info_t));
     if (alloc_info != NULL) {
-        alloc_info->size = size;
+        heap_stats_alloc(alloc_info, size, caller);
         ptr = (void*)(alloc_info + 1);
-        heap_stats.current_size += size;
-        heap_stats.total_size += size;
-        heap_stats.alloc_cnt += 1;
-        if (heap_stats.current_size > heap_stats.max_size) {
-            heap_stats.max_size = heap_stats.current_size;
-        }
     } else {
-        heap_stats.alloc_fail_cnt += 1;
+        heap_stats_alloc_fail(caller);
     }
     malloc_stats_mutex->unlock();
 #else // #ifdef MBED_HEAP_STATS_ENABLED
@@ -143,9 +376,9 @@ extern "C" void * __wrap__realloc_r(struct _reent * r, void * ptr, size_t size)
         old_size = alloc_info->size;
     }
 
-    // Allocate space
+    // Allocate space, accounted to the caller of realloc
     if (size != 0) {
-        new_ptr = malloc(size);
+        new_ptr = malloc_wrapper(r, size, MBED_CALLER_ADDR());
     }
 
     // If the new buffer has been allocated copy the data to it
@@ -153,7 +386,7 @@ extern "C" void * __wrap__realloc_r(struct _reent * r, void * ptr, size_t size)
     if (new_ptr != NULL) {
         uint32_t copy_size = (old_size < size) ? old_size : size;
         memcpy(new_ptr, (void*)ptr, copy_size);
-        free(ptr);
+        free_wrapper(r, ptr, MBED_CALLER_ADDR());
     }
 #else // #ifdef MBED_HEAP_STATS_ENABLED
     new_ptr = __real__realloc_r(r, ptr, size);
@@ -178,8 +411,7 @@ extern "C" void free_wrapper(struct _reent * r, void * ptr, void * caller) {
     alloc_info_t *alloc_info = NULL;
     if (ptr != NULL) {
         alloc_info = ((alloc_info_t*)ptr) - 1;
-        heap_stats.current_size -= alloc_info->size;
-        heap_stats.alloc_cnt -= 1;
+        heap_stats_free(alloc_info);
     }
     __real__free_r(r, (void*)alloc_info);
     malloc_stats_mutex->unlock();
@@ -200,7 +432,7 @@ extern "C" void * __wrap__calloc_r(struct _reent * r, size_t nmemb, size_t size)
 #ifdef MBED_HEAP_STATS_ENABLED
     // Note - no lock needed since malloc is thread safe
 
-    ptr = malloc(nmemb * size);
+    ptr = malloc_wrapper(r, nmemb * size, MBED_CALLER_ADDR());
     if (ptr != NULL) {
         memset(ptr, 0, nmemb * size);
     }
@@ -273,16 +505,10 @@ extern "C" void* malloc_wrapper(size_t size, void* caller) {
     malloc_stats_mutex->lock();
     alloc_info_t *alloc_info = (alloc_info_t*)SUPER_MALLOC(size + sizeof(alloc_info_t));
     if (alloc_info != NULL) {
-        alloc_info->size = size;
+        heap_stats_alloc(alloc_info, size, caller);
         ptr = (void*)(alloc_info + 1);
-        heap_stats.current_size += size;
-        heap_stats.total_size += size;
-        heap_stats.alloc_cnt += 1;
-        if (heap_stats.current_size > heap_stats.max_size) {
-            heap_stats.max_size = heap_stats.current_size;
-        }
     } else {
-        heap_stats.alloc_fail_cnt += 1;
+        heap_stats_alloc_fail(caller);
     }
     malloc_stats_mutex->unlock();
 #else // #ifdef MBED_HEAP_STATS_ENABLED
@@ -311,9 +537,9 @@ extern "C" void* SUB_REALLOC(void *ptr, size_t size) {
         old_size = alloc_info->size;
     }
 
-    // Allocate space
+    // Allocate space, accounted to the caller of realloc
     if (size != 0) {
-        new_ptr = malloc(size);
+        new_ptr = malloc_wrapper(size, MBED_CALLER_ADDR());
     }
 
     // If the new buffer has been allocated copy the data to it
@@ -321,7 +547,7 @@ extern "C" void* SUB_REALLOC(void *ptr, size_t size) {
     if (new_ptr != NULL) {
         uint32_t copy_size = (old_size < size) ? old_size : size;
         memcpy(new_ptr, (void*)ptr, copy_size);
-        free(ptr);
+        free_wrapper(ptr, MBED_CALLER_ADDR());
     }
 #else // #ifdef MBED_HEAP_STATS_ENABLED
     new_ptr = SUPER_REALLOC(ptr, size);
@@ -340,7 +566,7 @@ extern "C" void *SUB_CALLOC(size_t nmemb, size_t size) {
 #endif
 #ifdef MBED_HEAP_STATS_ENABLED
     // Note - no lock needed since malloc is thread safe
-    ptr = malloc(nmemb * size);
+    ptr = malloc_wrapper(nmemb * size, MBED_CALLER_ADDR());
     if (ptr != NULL) {
         memset(ptr, 0, nmemb * size);
     }
@@ -367,8 +593,7 @@ extern "C" void free_wrapper(void *ptr, void* caller) {
     alloc_info_t *alloc_info = NULL;
     if (ptr != NULL) {
         alloc_info = ((alloc_info_t*)ptr) - 1;
-        heap_stats.current_size -= alloc_info->size;
-        heap_stats.alloc_cnt -= 1;
+        heap_stats_free(alloc_info);
     }
     SUPER_FREE((void*)alloc_info);
     malloc_stats_mutex->unlock();
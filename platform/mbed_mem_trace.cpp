@@ -21,6 +21,18 @@
 #include "platform/mbed_critical.h"
 #include "platform/SingletonPtr.h"
 #include "platform/PlatformMutex.h"
+#include "platform/mbed_assert.h"
+#include "hal/us_ticker_api.h"
+#if defined(DEVICE_ITM)
+#include "hal/itm_api.h"
+#endif
+#if MBED_CONF_RTOS_PRESENT
+#include "cmsis_os2.h"
+#endif
+
+#ifndef MBED_CONF_PLATFORM_MEMORY_TRACE_BINARY_RECORDS
+#define MBED_CONF_PLATFORM_MEMORY_TRACE_BINARY_RECORDS 64
+#endif
 
 /******************************************************************************
  * Internal variables, functions and helpers
@@ -36,6 +48,31 @@ static SingletonPtr<PlatformMutex> mem_trace_mutex;
 
 #define TRACE_FIRST_LOCK() (trace_lock_count < 2)
 
+#define BINARY_TRACE_RECORDS MBED_CONF_PLATFORM_MEMORY_TRACE_BINARY_RECORDS
+
+MBED_STATIC_ASSERT((BINARY_TRACE_RECORDS & (BINARY_TRACE_RECORDS - 1)) == 0 && BINARY_TRACE_RECORDS > 0,
+                   "platform.memory-trace-binary-records must be a power of two");
+MBED_STATIC_ASSERT(sizeof(mbed_mem_trace_record_t) == 28, "Unexpected binary trace record size");
+
+/* Ring buffer used by the binary tracer. 'binary_trace_head' is only written
+ * by the producer (which runs with the trace lock held) and 'binary_trace_tail'
+ * only by the consumer. Both are free running, so the ring size has to be a
+ * power of two. */
+static mbed_mem_trace_record_t binary_trace_ring[BINARY_TRACE_RECORDS];
+static volatile uint32_t binary_trace_head;
+static volatile uint32_t binary_trace_tail;
+static volatile uint32_t binary_trace_dropped;
+static uint16_t binary_trace_sequence;
+
+static uint32_t binary_trace_thread_id()
+{
+#if MBED_CONF_RTOS_PRESENT
+    return (uint32_t)(uintptr_t)osThreadGetId();
+#else
+    return 0;
+#endif
+}
+
 
 /******************************************************************************
  * Public interface
@@ -127,3 +164,102 @@ void mbed_mem_trace_default_callback(uint8_t op, void *res, void *caller, ...) {
     va_end(va);
 }
 
+
+void mbed_mem_trace_binary_callback(uint8_t op, void *res, void *caller, ...) {
+    va_list va;
+    uint32_t ptr = 0, size = 0;
+    size_t nmemb;
+
+    va_start(va, caller);
+    switch(op) {
+        case MBED_MEM_TRACE_MALLOC:
+            size = va_arg(va, size_t);
+            break;
+
+        case MBED_MEM_TRACE_REALLOC:
+            ptr = (uint32_t)(uintptr_t)va_arg(va, void*);
+            size = va_arg(va, size_t);
+            break;
+
+        case MBED_MEM_TRACE_CALLOC:
+            nmemb = va_arg(va, size_t);
+            size = nmemb * va_arg(va, size_t);
+            break;
+
+        case MBED_MEM_TRACE_FREE:
+            ptr = (uint32_t)(uintptr_t)va_arg(va, void*);
+            break;
+
+        default:
+            break;
+    }
+    va_end(va);
+
+    uint16_t sequence = binary_trace_sequence++;
+    uint32_t head = binary_trace_head;
+    if (head - binary_trace_tail >= BINARY_TRACE_RECORDS) {
+        core_util_atomic_incr_u32(&binary_trace_dropped, 1);
+        return;
+    }
+
+    mbed_mem_trace_record_t *record = &binary_trace_ring[head & (BINARY_TRACE_RECORDS - 1)];
+    record->op = op;
+    record->flags = 0;
+    record->sequence = sequence;
+    record->timestamp = ticker_read(get_us_ticker_data());
+    record->thread = binary_trace_thread_id();
+    record->caller = (uint32_t)(uintptr_t)caller;
+    record->res = (uint32_t)(uintptr_t)res;
+    record->ptr = ptr;
+    record->size = size;
+
+    /* Publish the record only once it is complete */
+    core_util_atomic_incr_u32(&binary_trace_head, 1);
+}
+
+size_t mbed_mem_trace_binary_read(mbed_mem_trace_record_t *records, size_t count) {
+    size_t read = 0;
+    uint32_t tail = binary_trace_tail;
+
+    while (read < count && tail != binary_trace_head) {
+        records[read++] = binary_trace_ring[tail & (BINARY_TRACE_RECORDS - 1)];
+        tail++;
+        core_util_atomic_incr_u32(&binary_trace_tail, 1);
+    }
+    return read;
+}
+
+size_t mbed_mem_trace_binary_drain(mbed_mem_trace_write_t write) {
+    const uint32_t sync = MBED_MEM_TRACE_BINARY_SYNC;
+    mbed_mem_trace_record_t record;
+    size_t drained = 0;
+
+    while (mbed_mem_trace_binary_read(&record, 1)) {
+        write(&sync, sizeof(sync));
+        write(&record, sizeof(record));
+        drained++;
+    }
+    return drained;
+}
+
+#if defined(DEVICE_ITM)
+size_t mbed_mem_trace_binary_drain_itm(void) {
+    mbed_mem_trace_record_t record;
+    size_t drained = 0;
+
+    mbed_itm_init();
+    while (mbed_mem_trace_binary_read(&record, 1)) {
+        const uint32_t *words = (const uint32_t *)&record;
+        mbed_itm_send(ITM_PORT_SWO, MBED_MEM_TRACE_BINARY_SYNC);
+        for (size_t i = 0; i < sizeof(record) / sizeof(uint32_t); i++) {
+            mbed_itm_send(ITM_PORT_SWO, words[i]);
+        }
+        drained++;
+    }
+    return drained;
+}
+#endif
+
+uint32_t mbed_mem_trace_binary_dropped(void) {
+    return binary_trace_dropped;
+}
@@ -150,6 +150,94 @@ void mbed_mem_trace_free(void *ptr, void *caller);
  */
 void mbed_mem_trace_default_callback(uint8_t op, void *res, void *caller, ...);
 
+/* Synchronisation word that precedes each record in a drained binary stream
+ * ("MTRC" when read as little-endian bytes) */
+#define MBED_MEM_TRACE_BINARY_SYNC      0x4352544D
+
+/**
+ * Fixed size record produced by the binary tracer.
+ *
+ * All fields are stored in target (little-endian) byte order. Records are
+ * written into a RAM ring buffer by 'mbed_mem_trace_binary_callback' and
+ * removed from it with 'mbed_mem_trace_binary_read' or one of the drain
+ * functions.
+ */
+typedef struct {
+    uint8_t op;             /**< MBED_MEM_TRACE_MALLOC, _REALLOC, _CALLOC or _FREE */
+    uint8_t flags;          /**< Reserved, always 0 */
+    uint16_t sequence;      /**< Incremented for every traced operation, gaps reveal dropped records */
+    uint32_t timestamp;     /**< us ticker value when the operation was traced */
+    uint32_t thread;        /**< ID of the calling thread (0 without an RTOS) */
+    uint32_t caller;        /**< Caller of the memory operation (might be unreliable) */
+    uint32_t res;           /**< Result of the operation (0 for 'free') */
+    uint32_t ptr;           /**< 'ptr' argument of 'realloc' or 'free', 0 otherwise */
+    uint32_t size;          /**< Requested size in bytes ('nmemb * size' for 'calloc', 0 for 'free') */
+} mbed_mem_trace_record_t;
+
+/**
+ * Type of the function used to output a drained binary trace.
+ *
+ * @param data pointer to the bytes to write.
+ * @param size number of bytes to write.
+ */
+typedef void (*mbed_mem_trace_write_t)(const void *data, size_t size);
+
+/**
+ * Binary memory trace callback. DO NOT CALL DIRECTLY. It is meant to be used
+ * as the argument of 'mbed_mem_trace_set_callback'.
+ *
+ * Instead of formatting each operation with 'printf', the binary callback
+ * fills in a 'mbed_mem_trace_record_t' and stores it in a ring buffer of
+ * MBED_CONF_PLATFORM_MEMORY_TRACE_BINARY_RECORDS entries. Storing a record
+ * never blocks: when the ring is full the record is dropped and counted (see
+ * 'mbed_mem_trace_binary_dropped').
+ *
+ * The ring has a single producer, serialised by the trace lock, and a single
+ * consumer, so records can be read out from any thread without taking the
+ * trace lock. The records can be decoded on the host with
+ * tools/debug_tools/mem_trace/mem_trace_parser.py.
+ */
+void mbed_mem_trace_binary_callback(uint8_t op, void *res, void *caller, ...);
+
+/**
+ * Remove records from the binary trace ring buffer.
+ *
+ * @param records buffer that receives the records.
+ * @param count maximum number of records to copy into 'records'.
+ * @return the number of records copied.
+ */
+size_t mbed_mem_trace_binary_read(mbed_mem_trace_record_t *records, size_t count);
+
+/**
+ * Write all pending binary trace records using the given output function.
+ *
+ * Each record is preceded by MBED_MEM_TRACE_BINARY_SYNC, so that a host tool
+ * can find record boundaries in a stream that was joined midway. Use this to
+ * send the trace over a UART or any other byte stream.
+ *
+ * @param write function called once for each synchronisation word and record.
+ * @return the number of records written.
+ */
+size_t mbed_mem_trace_binary_drain(mbed_mem_trace_write_t write);
+
+#if defined(DEVICE_ITM)
+/**
+ * Write all pending binary trace records to the SWO stimulus port.
+ *
+ * The stream has the same format as the output of 'mbed_mem_trace_binary_drain'.
+ *
+ * @return the number of records written.
+ */
+size_t mbed_mem_trace_binary_drain_itm(void);
+#endif
+
+/**
+ * Get the number of binary trace records dropped because the ring buffer was full.
+ *
+ * @return the number of dropped records since boot.
+ */
+uint32_t mbed_mem_trace_binary_dropped(void);
+
 /** @}*/
 
 #ifdef __cplusplus
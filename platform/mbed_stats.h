@@ -48,6 +48,64 @@ typedef struct {
  */
 void mbed_stats_heap_get(mbed_stats_heap_t *stats);
 
+/**
+ * struct mbed_stats_heap_thread_t definition
+ */
+typedef struct {
+    uint32_t thread_id;         /**< Identifier of the thread that made the allocations or 0 for threads that didn't fit in a slot or terminated. */
+    uint32_t current_size;      /**< Bytes allocated currently by the thread. */
+    uint32_t max_size;          /**< Max bytes allocated by the thread at a given time. */
+    uint32_t total_size;        /**< Cumulative sum of bytes ever allocated by the thread. */
+    uint32_t alloc_cnt;         /**< Current number of allocations made by the thread. */
+    uint32_t alloc_fail_cnt;    /**< Number of failed allocations made by the thread. */
+} mbed_stats_heap_thread_t;
+
+/**
+ *  Fill the passed array of stat structures with the heap stats of each thread that allocated memory.
+ *
+ *  Memory is accounted to the thread that allocated it, even when it is freed by another thread.
+ *  Up to MBED_CONF_PLATFORM_HEAP_STATS_THREAD_SLOTS threads are tracked individually, allocations
+ *  made by other threads are accumulated in an entry with a thread_id of 0. The slot of a thread
+ *  is released when the thread terminates, and its statistics, including the memory it still
+ *  has allocated, move to the entry with a thread_id of 0.
+ *
+ *  @param stats    A pointer to an array of mbed_stats_heap_thread_t structures to fill
+ *  @param count    The number of mbed_stats_heap_thread_t structures in the provided array
+ *  @return         The number of mbed_stats_heap_thread_t structures that have been filled
+ */
+size_t mbed_stats_heap_get_each_thread(mbed_stats_heap_thread_t *stats, size_t count);
+
+/**
+ *  Release the heap statistics slot of a thread, called by the RTOS when the thread terminates.
+ *
+ *  @param thread_id    Identifier of the terminating thread
+ */
+void mbed_stats_heap_thread_terminated(uint32_t thread_id);
+
+/**
+ * struct mbed_stats_heap_caller_t definition
+ */
+typedef struct {
+    uint32_t caller;            /**< Address the allocations were made from or 0 for callers that didn't fit in a slot. */
+    uint32_t current_size;      /**< Bytes allocated currently from this address. */
+    uint32_t max_size;          /**< Max bytes allocated from this address at a given time. */
+    uint32_t total_size;        /**< Cumulative sum of bytes ever allocated from this address. */
+    uint32_t alloc_cnt;         /**< Current number of allocations made from this address. */
+    uint32_t alloc_fail_cnt;    /**< Number of failed allocations made from this address. */
+} mbed_stats_heap_caller_t;
+
+/**
+ *  Fill the passed array of stat structures with the heap stats of each address that allocated memory.
+ *
+ *  Callers are kept in a hash table of MBED_CONF_PLATFORM_HEAP_STATS_CALLER_SLOTS entries, allocations
+ *  made by callers that don't fit in the table are accumulated in an entry with a caller of 0.
+ *
+ *  @param stats    A pointer to an array of mbed_stats_heap_caller_t structures to fill
+ *  @param count    The number of mbed_stats_heap_caller_t structures in the provided array
+ *  @return         The number of mbed_stats_heap_caller_t structures that have been filled
+ */
+size_t mbed_stats_heap_get_each_caller(mbed_stats_heap_caller_t *stats, size_t count);
+
 /**
  * struct mbed_stats_stack_t definition
  */
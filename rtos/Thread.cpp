@@ -24,6 +24,7 @@
 #include "mbed.h"
 #include "rtos/rtos_idle.h"
 #include "mbed_assert.h"
+#include "platform/mbed_stats.h"
 
 #define ALIGN_UP(pos, align) ((pos) % (align) ? (pos) +  ((align) - (pos) % (align)) : (pos))
 MBED_STATIC_ASSERT(ALIGN_UP(0, 8) == 0, "ALIGN_UP macro error");
@@ -36,6 +37,9 @@ MBED_STATIC_ASSERT(ALIGN_DOWN(8, 8) == 8, "ALIGN_DOWN macro error");
 static void (*terminate_hook)(osThreadId_t id) = 0;
 extern "C" void thread_terminate_hook(osThreadId_t id)
 {
+    // Thread IDs are reused, release the heap statistics of this one
+    mbed_stats_heap_thread_terminated((uint32_t)(uintptr_t)id);
+
     if (terminate_hook != (void (*)(osThreadId_t))NULL) {
         terminate_hook(id);
     }
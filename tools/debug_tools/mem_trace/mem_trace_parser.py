@@ -0,0 +1,299 @@
+#!/usr/bin/env python
+"""
+mbed SDK
+Copyright (c) 2018 ARM Limited
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+LIBRARIES BUILD
+"""
+
+from __future__ import print_function
+import re
+import bisect
+import struct
+from subprocess import check_output
+
+# Must match MBED_MEM_TRACE_* in platform/mbed_mem_trace.h
+OP_MALLOC, OP_REALLOC, OP_CALLOC, OP_FREE = range(4)
+OP_NAMES = {OP_MALLOC: "malloc", OP_REALLOC: "realloc", OP_CALLOC: "calloc", OP_FREE: "free"}
+
+# MBED_MEM_TRACE_BINARY_SYNC followed by a mbed_mem_trace_record_t
+_SYNC = struct.pack("<I", 0x4352544D)
+_RECORD = struct.Struct("<BBHIIIIII")
+
+# Output of mbed_mem_trace_default_callback
+_TEXT_PTN = re.compile(r"#([mrcf]):(?:0x)?([0-9a-fA-F]+|\(nil\));(?:0x)?([0-9a-fA-F]+|\(nil\))-([^\r\n]*)")
+
+#arm-none-eabi-nm -nl <elf file>
+_NM_EXEC = "arm-none-eabi-nm"
+_OPT = "-nlC"
+_NM_PTN = re.compile("([0-9a-f]*) ([Tt]) ([^\t\n]*)(?:\t(.*):([0-9]*))?")
+
+
+class Record(object):
+    def __init__(self, op, sequence, timestamp, thread, caller, res, ptr, size):
+        self.op = op
+        self.sequence = sequence
+        self.timestamp = timestamp
+        self.thread = thread
+        self.caller = caller
+        self.res = res
+        self.ptr = ptr
+        self.size = size
+
+
+class ElfHelper(object):
+    def __init__(self, elf_file):
+        op = check_output([_NM_EXEC, _OPT, elf_file]).decode("utf-8", "replace")
+        self.matches = _NM_PTN.findall(op)
+        self.addrs = [int(x[0], 16) for x in self.matches]
+
+    def function_name_for_addr(self, addr):
+        i = bisect.bisect_right(self.addrs, addr)
+        if i == 0:
+            return "?"
+        return self.matches[i-1][2]
+
+
+def strip_itm(data):
+    """Extract the payload of stimulus port 0 from a raw SWO capture"""
+    out = bytearray()
+    data = bytearray(data)
+    i = 0
+    while i < len(data):
+        header = data[i]
+        size = {1: 1, 2: 2, 3: 4}.get(header & 0x3, 0)
+        if size and not (header & 0x4):
+            # Software source (instrumentation) packet
+            if (header >> 3) == 0:
+                out += data[i+1:i+1+size]
+            i += 1 + size
+        elif size:
+            # Hardware source packet, not used by the tracer
+            i += 1 + size
+        else:
+            # Synchronisation, overflow or protocol packet
+            i += 1
+    return bytes(out)
+
+
+def parse_binary(data):
+    """Decode a stream produced by mbed_mem_trace_binary_drain()"""
+    records = []
+    pos = data.find(_SYNC)
+    while pos >= 0 and pos + len(_SYNC) + _RECORD.size <= len(data):
+        start = pos + len(_SYNC)
+        fields = _RECORD.unpack_from(data, start)
+        op, _flags, sequence, timestamp, thread, caller, res, ptr, size = fields
+        if op in OP_NAMES:
+            records.append(Record(op, sequence, timestamp, thread, caller, res, ptr, size))
+            pos = data.find(_SYNC, start + _RECORD.size)
+        else:
+            # False sync match, resynchronise on the next candidate
+            pos = data.find(_SYNC, pos + 1)
+    return records
+
+
+def _text_int(value):
+    return 0 if value == "(nil)" else int(value, 16)
+
+
+def parse_text(lines):
+    """Decode the output of mbed_mem_trace_default_callback()"""
+    records = []
+    for line in lines:
+        match = _TEXT_PTN.search(line)
+        if not match:
+            continue
+        op, res, caller, args = match.groups()
+        args = args.split(";")
+        res = _text_int(res)
+        caller = _text_int(caller)
+        ptr = size = 0
+        if op == "m":
+            op, size = OP_MALLOC, int(args[0])
+        elif op == "r":
+            op, ptr, size = OP_REALLOC, _text_int(args[0].replace("0x", "")), int(args[1])
+        elif op == "c":
+            op, size = OP_CALLOC, int(args[0]) * int(args[1])
+        else:
+            op, ptr = OP_FREE, _text_int(args[0].replace("0x", ""))
+        # The text format has no timestamps: use the operation index instead
+        index = len(records)
+        records.append(Record(op, index & 0xFFFF, index, 0, caller, res, ptr, size))
+    return records
+
+
+class CallSite(object):
+    def __init__(self, caller):
+        self.caller = caller
+        self.allocs = 0
+        self.frees = 0
+        self.bytes = 0
+        self.peak = 0
+
+
+class HeapReplay(object):
+    """Rebuild the live heap from a sequence of trace records"""
+
+    def __init__(self, records):
+        self.live = {}
+        self.sites = {}
+        self.timeline = []
+        self.live_bytes = 0
+        self.peak_bytes = 0
+        self.peak_time = 0
+        self.dropped = 0
+        self.unknown_frees = 0
+        self.failed = 0
+
+        last_sequence = None
+        last_timestamp = None
+        wraps = 0
+        for record in records:
+            if last_sequence is not None:
+                self.dropped += (record.sequence - last_sequence - 1) & 0xFFFF
+            last_sequence = record.sequence
+            # Unwrap the 32-bit us ticker
+            if last_timestamp is not None and record.timestamp < last_timestamp:
+                wraps += 1
+            last_timestamp = record.timestamp
+            self._apply(record, record.timestamp + (wraps << 32))
+
+    def _site(self, caller):
+        site = self.sites.get(caller)
+        if site is None:
+            site = self.sites[caller] = CallSite(caller)
+        return site
+
+    def _add(self, ptr, size, caller):
+        site = self._site(caller)
+        site.allocs += 1
+        site.bytes += size
+        site.peak = max(site.peak, site.bytes)
+        self.live[ptr] = (size, caller)
+        self.live_bytes += size
+
+    def _remove(self, ptr):
+        block = self.live.pop(ptr, None)
+        if block is None:
+            self.unknown_frees += 1
+            return
+        size, caller = block
+        site = self._site(caller)
+        site.frees += 1
+        site.bytes -= size
+        self.live_bytes -= size
+
+    def _apply(self, record, time):
+        if record.op in (OP_MALLOC, OP_CALLOC):
+            if record.res:
+                self._add(record.res, record.size, record.caller)
+            else:
+                self.failed += 1
+        elif record.op == OP_REALLOC:
+            if record.res:
+                if record.ptr:
+                    self._remove(record.ptr)
+                self._add(record.res, record.size, record.caller)
+            elif record.size == 0 and record.ptr:
+                self._remove(record.ptr)
+            else:
+                # Failed realloc leaves the original block untouched
+                self.failed += 1
+        elif record.ptr:
+            self._remove(record.ptr)
+
+        if self.live_bytes > self.peak_bytes:
+            self.peak_bytes = self.live_bytes
+            self.peak_time = time
+        self.timeline.append((time, self.live_bytes, len(self.live)))
+
+    def leaks(self):
+        """Blocks still allocated at the end of the trace, grouped by caller"""
+        leaks = {}
+        for ptr, (size, caller) in self.live.items():
+            leaks.setdefault(caller, []).append((ptr, size))
+        return leaks
+
+
+def print_report(replay, records, elf=None):
+    def name(addr):
+        if elf:
+            return "0x%08X %s" % (addr, elf.function_name_for_addr(addr))
+        return "0x%08X" % addr
+
+    print("Records: %d (%d dropped)" % (len(records), replay.dropped))
+    print("Peak live heap: %d bytes at t=%d" % (replay.peak_bytes, replay.peak_time))
+    print("Live heap at end: %d bytes in %d blocks" % (replay.live_bytes, len(replay.live)))
+    if replay.failed:
+        print("Failed allocations: %d" % replay.failed)
+    if replay.unknown_frees:
+        print("Frees of untraced blocks: %d" % replay.unknown_frees)
+
+    print("\nPer callsite usage:")
+    print("%-10s %10s %10s %10s  %s" % ("allocs", "frees", "live", "peak", "caller"))
+    for site in sorted(replay.sites.values(), key=lambda s: s.peak, reverse=True):
+        print("%-10d %10d %10d %10d  %s" % (site.allocs, site.frees, site.bytes, site.peak, name(site.caller)))
+
+    leaks = replay.leaks()
+    if leaks:
+        print("\nLeaks:")
+        for caller, blocks in sorted(leaks.items(), key=lambda l: sum(b[1] for b in l[1]), reverse=True):
+            print("%s: %d bytes in %d blocks" % (name(caller), sum(b[1] for b in blocks), len(blocks)))
+            for ptr, size in sorted(blocks):
+                print("\t0x%08X %d" % (ptr, size))
+
+
+def write_timeline(replay, out):
+    out.write("time,live_bytes,live_blocks\n")
+    for time, live_bytes, live_blocks in replay.timeline:
+        out.write("%d,%d,%d\n" % (time, live_bytes, live_blocks))
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser(description='Analyse an mbed-os memory trace. Rebuilds the live heap over time, per callsite peak usage and leaked blocks. Symbolisation requires arm-gcc binary utilities to be available in current path as it uses \'nm\' command')
+
+    parser.add_argument(metavar='TRACE', dest='trace',
+                        help='File containing a binary trace (mbed_mem_trace_binary_drain) or the text output of the default tracer')
+    parser.add_argument('--format', choices=['auto', 'binary', 'itm', 'text'], default='auto',
+                        help='Trace format. \'itm\' is a raw SWO capture of mbed_mem_trace_binary_drain_itm (default: auto)')
+    parser.add_argument('--elf', help='ELF file used to resolve callers to function names')
+    parser.add_argument('--timeline', type=argparse.FileType('w'),
+                        help='Write the live heap over time as CSV to this file')
+
+    args = parser.parse_args()
+
+    with open(args.trace, 'rb') as f:
+        data = f.read()
+
+    fmt = args.format
+    if fmt == 'auto':
+        fmt = 'binary' if _SYNC in data else 'text'
+
+    if fmt == 'text':
+        records = parse_text(data.decode('utf-8', 'replace').splitlines())
+    elif fmt == 'itm':
+        records = parse_binary(strip_itm(data))
+    else:
+        records = parse_binary(data)
+
+    elf = ElfHelper(args.elf) if args.elf else None
+    replay = HeapReplay(records)
+    print_report(replay, records, elf)
+    if args.timeline:
+        write_timeline(replay, args.timeline)
+        args.timeline.close()
@@ -710,6 +710,11 @@ TESTS = [
         "source_dir": join(TEST_DIR, "dsp", "mbed", "fir_f32"),
         "dependencies": [MBED_LIBRARIES, DSP_LIBRARIES],
     },
+    {
+        "id": "DSP_2", "description": "Pipeline",
+        "source_dir": join(TEST_DIR, "dsp", "mbed", "pipeline"),
+        "dependencies": [MBED_LIBRARIES, DSP_LIBRARIES],
+    },
 
     # KL25Z
     {